@@ -15,6 +15,20 @@
 bool init_rak12002(void);
 void set_rak12002(uint16_t year, uint8_t month, uint8_t date, uint8_t hour, uint8_t minute);
 void read_rak12002(void);
+void set_epoch_rak12002(uint32_t epoch);
+uint32_t get_epoch_rak12002(void);
+uint32_t get_unix_time_rak12002(void);
+uint32_t next_boundary_rak12002(uint32_t interval_ms);
+extern bool g_rtc_align;
+
+/** Interval to read the RTC again in ms, between reads the time is advanced with millis() */
+#define RTC_RESYNC_INTERVAL 3600000
+/** Seconds from 1970-01-01 to 2000-01-01 */
+#define RTC_UNIX_OFFSET 946684800UL
+/** Minimum time to the next aligned wakeup in ms */
+#define RTC_ALIGN_MIN_WAIT 5000
+/** Random delay after the aligned wakeup in ms, avoids that aligned devices send at the same time */
+#define RTC_ALIGN_JITTER 3000
 
 /** RTC date/time structure */
 struct date_time_s
@@ -14,6 +14,7 @@
 
 bool init_rak12004(void);
 void read_rak12004(void);
+bool start_rak12004(void);
 
 /** Gas Sensor stuff RAK12004 and RAK12009 */
 /** Logic high enables the device. Logic low disables the device */
@@ -32,8 +32,16 @@
 // Slot F      WB_IO6
 //******************************************************************//
 
+/** Timing budget limits and default in ms */
+#define RAK12014_BUDGET_MIN 20
+#define RAK12014_BUDGET_MAX 500
+#define RAK12014_BUDGET_DEFAULT 33
+
 extern uint8_t xshut_pin;
+extern uint8_t tof_int_pin;
+extern uint16_t g_tof_budget;
 bool init_rak12014(void);
 void read_rak12014(void);
+bool set_budget_rak12014(uint16_t new_budget);
 
 #endif // RAK12014_H
\ No newline at end of file
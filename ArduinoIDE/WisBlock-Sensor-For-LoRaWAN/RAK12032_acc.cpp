@@ -43,6 +43,74 @@ ADXL313 adxl313;
 /** Interrupt pin, depends on slot */
 uint8_t acc2_int_pin = WB_IO3;
 
+/** Output data rate in Hz while awake and in sleep mode */
+#define RAK12032_ODR 400
+#define RAK12032_ODR_SLEEP 8
+
+/** ADXL313 registers and values not covered by the library */
+#define RAK12032_REG_ACT_STATUS 0x2B
+#define RAK12032_REG_BW_RATE 0x2C
+#define RAK12032_REG_DATA_FORMAT 0x31
+#define RAK12032_REG_DATA 0x32
+#define RAK12032_REG_FIFO_CTL 0x38
+#define RAK12032_REG_FIFO_STATUS 0x39
+#define RAK12032_RATE_400HZ 0x0C
+#define RAK12032_FULL_RES 0x08
+#define RAK12032_FIFO_STREAM 0x80
+#define RAK12032_ASLEEP 0x08
+#define RAK12032_FIFO_ENTRIES_MASK 0x3F
+
+/** Size of the hardware FIFO */
+#define RAK12032_FIFO_SIZE 32
+
+/** Q8 scale in full resolution mode, 1024 LSB/g => micro g */
+#define RAK12032_ACC_SCALE 250000
+
+/**
+ * @brief Write RAK12032 register
+ *
+ * @param chip_reg register address
+ * @param dataToWrite data to write
+ * @return true write success
+ * @return false write failed
+ */
+static bool rak12032_writeRegister(uint8_t chip_reg, uint8_t dataToWrite)
+{
+	Wire.beginTransmission(found_sensors[ACC2_ID].i2c_addr);
+	Wire.write(chip_reg);
+	Wire.write(dataToWrite);
+	return (Wire.endTransmission() == 0);
+}
+
+/**
+ * @brief Burst read of RAK12032 registers
+ *     The ADXL313 increments the register address on multi byte reads
+ *
+ * @param buffer buffer for the register values
+ * @param chip_reg start register address
+ * @param len number of bytes to read
+ * @return true read success
+ * @return false read failed
+ */
+static bool rak12032_readBurst(uint8_t *buffer, uint8_t chip_reg, uint8_t len)
+{
+	Wire.beginTransmission(found_sensors[ACC2_ID].i2c_addr);
+	Wire.write(chip_reg);
+	if (Wire.endTransmission(false) != 0)
+	{
+		return false;
+	}
+	if (Wire.requestFrom(found_sensors[ACC2_ID].i2c_addr, len) != len)
+	{
+		return false;
+	}
+	for (uint8_t idx = 0; idx < len; idx++)
+	{
+		buffer[idx] = Wire.read();
+	}
+	return true;
+}
+
 /**
  * @brief Initialize ADXL313 3-axis
  * acceleration sensor
@@ -77,6 +145,15 @@ bool init_rak12032(void)
 
 	adxl313.setRange(ADXL313_RANGE_2_G);
 
+	// Full resolution keeps 1024 LSB/g independent of the range
+	uint8_t data_format = 0;
+	rak12032_readBurst(&data_format, RAK12032_REG_DATA_FORMAT, 1);
+	rak12032_writeRegister(RAK12032_REG_DATA_FORMAT, data_format | RAK12032_FULL_RES);
+
+	// Higher data rate, samples are collected in the FIFO in stream mode
+	rak12032_writeRegister(RAK12032_REG_BW_RATE, RAK12032_RATE_400HZ);
+	rak12032_writeRegister(RAK12032_REG_FIFO_CTL, RAK12032_FIFO_STREAM);
+
 	// setup activity sensing options
 	adxl313.setActivityX(true);		  // enable x-axis participation in detecting inactivity
 	adxl313.setActivityY(true);		  // disable y-axis participation in detecting inactivity
@@ -161,6 +238,51 @@ void clear_int_rak12032(void)
 		adxl313.readAccel(); // read all 3 axis, they are stored in class variables: myAdxl.x, myAdxl.y and myAdxl.z
 		MYLOG("ACC2", "x: %d y: %d z: %d", adxl313.x, adxl313.y, adxl313.z);
 	}
+
+	read_fifo_rak12032();
+}
+
+/**
+ * @brief Drain the FIFO into the inertial pipeline
+ *     Each FIFO entry is read with one 6 byte burst
+ *
+ * @return uint16_t number of samples read
+ */
+uint16_t read_fifo_rak12032(void)
+{
+	uint8_t act_status = 0;
+	uint8_t fifo_status = 0;
+	if (!rak12032_readBurst(&act_status, RAK12032_REG_ACT_STATUS, 1) || !rak12032_readBurst(&fifo_status, RAK12032_REG_FIFO_STATUS, 1))
+	{
+		MYLOG("ACC2", "FIFO status read failed");
+		return 0;
+	}
+	uint32_t last_timestamp = micros();
+	// In auto sleep the sensor samples with the low sleep rate
+	uint16_t odr = (act_status & RAK12032_ASLEEP) ? RAK12032_ODR_SLEEP : RAK12032_ODR;
+
+	uint8_t num_samples = fifo_status & RAK12032_FIFO_ENTRIES_MASK;
+	if (num_samples > RAK12032_FIFO_SIZE)
+	{
+		num_samples = RAK12032_FIFO_SIZE;
+	}
+
+	int16_t values[RAK12032_FIFO_SIZE * 3];
+	uint8_t raw[6];
+	uint8_t sample_idx = 0;
+	for (; sample_idx < num_samples; sample_idx++)
+	{
+		if (!rak12032_readBurst(raw, RAK12032_REG_DATA, 6))
+		{
+			MYLOG("ACC2", "FIFO burst read failed");
+			break;
+		}
+		for (uint8_t axis = 0; axis < 3; axis++)
+		{
+			values[sample_idx * 3 + axis] = (int16_t)(raw[axis * 2] | (raw[axis * 2 + 1] << 8));
+		}
+	}
+	return imu_push_block(IMU_SRC_RAK12032, IMU_TYPE_ACC, values, sample_idx, RAK12032_ACC_SCALE, odr, last_timestamp);
 }
 #else // ARDUINO_ARCH_RP2040
 //**********************************************************/
@@ -197,4 +319,14 @@ void clear_int_rak12032(void)
 {
 }
 
+/**
+ * @brief Drain the FIFO into the inertial pipeline
+ *
+ * @return uint16_t number of samples read
+ */
+uint16_t read_fifo_rak12032(void)
+{
+	return 0;
+}
+
 #endif // ARDUINO_ARCH_RP2040
\ No newline at end of file
@@ -36,5 +36,6 @@
 bool init_rak12032(void);
 void int_assign_rak12032(uint8_t new_irq_pin);
 void clear_int_rak12032(void);
+uint16_t read_fifo_rak12032(void);
 
 #endif // RAK12032_H
\ No newline at end of file
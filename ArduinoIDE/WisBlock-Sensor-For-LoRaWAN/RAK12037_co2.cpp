@@ -14,8 +14,32 @@
 /** Sensor instance */
 SCD30 scd30;
 
+/** Last good measurement */
+static uint16_t last_co2 = 0;
+static float last_temp = 0.0;
+static float last_humid = 0.0;
+/** millis() of the last good measurement */
+static time_t last_read_time = 0;
+/** Flag if a measurement was read since power up */
+static bool has_reading = false;
+
+/** Ambient pressure sent to the sensor in mbar, 0 = not set */
+static uint16_t scd30_pressure = 0;
+
 /**
- * @brief Initialize MQ2 gas sensor
+ * @brief Callback for the RDY pin
+ * Wakes up application with signal SENSOR_REQ
+ *
+ */
+void int_rak12037(void)
+{
+	api_wake_loop(SENSOR_REQ);
+}
+
+/**
+ * @brief Initialize SCD30 CO2 sensor
+ *     The measurement interval is set to half of the send interval,
+ *     so a fresh value is available for each uplink
  *
  * @return true success
  * @return false failed
@@ -36,7 +60,26 @@ bool init_rak12037(void)
 
 	//**************init SCD30 sensor *****************************************************
 	// Change number of seconds between measurements: 2 to 1800 (30 minutes), stored in non-volatile memory of SCD30
-	scd30.setMeasurementInterval(10);
+	uint16_t new_interval = SCD30_INTERVAL_DEFAULT;
+	if (g_lorawan_settings.send_repeat_time != 0)
+	{
+		new_interval = g_lorawan_settings.send_repeat_time / 1000 / 2;
+	}
+	if (new_interval < SCD30_INTERVAL_MIN)
+	{
+		new_interval = SCD30_INTERVAL_MIN;
+	}
+	if (new_interval > SCD30_INTERVAL_MAX)
+	{
+		new_interval = SCD30_INTERVAL_MAX;
+	}
+	// Write only if changed, the interval is kept in the sensor flash
+	uint16_t old_interval = 0;
+	if (!scd30.getMeasurementInterval(&old_interval) || (old_interval != new_interval))
+	{
+		scd30.setMeasurementInterval(new_interval);
+	}
+	MYLOG("SCD30", "Measurement interval %d s", new_interval);
 
 	// Disable self calibration
 	scd30.setAutoSelfCalibration(false);
@@ -44,43 +87,100 @@ bool init_rak12037(void)
 	// Start the measurements
 	scd30.beginMeasuring();
 
+	// RDY goes high when a new measurement is available
+	pinMode(RDY_CO2_PIN, INPUT);
+	attachInterrupt(digitalPinToInterrupt(RDY_CO2_PIN), int_rak12037, RISING);
+
+	return true;
+}
+
+/**
+ * @brief Get a new measurement from the sensor if one is available
+ *     Called on the RDY wake up, does not wait for data
+ *
+ * @return true new measurement was read
+ * @return false no new data
+ */
+bool fetch_rak12037(void)
+{
+	if (!scd30.readMeasurement())
+	{
+		return false;
+	}
+	last_co2 = scd30.getCO2();
+	last_temp = scd30.getTemperature();
+	last_humid = scd30.getHumidity();
+	last_read_time = millis();
+	has_reading = true;
+	MYLOG("SCD30", "New data CO2 %dppm T %.2f H %.2f", last_co2, last_temp, last_humid);
 	return true;
 }
 
+/**
+ * @brief Set the ambient pressure for the CO2 compensation
+ *     The sensor is only updated on a change of more than 1 mbar, because
+ *     it restarts the measurement.
+ *
+ * @param pressure ambient pressure in hPa
+ */
+static void set_pressure_rak12037(float pressure)
+{
+	// Valid range of the sensor is 700 to 1400 mbar
+	if ((pressure < 700.0) || (pressure > 1400.0))
+	{
+		return;
+	}
+	uint16_t new_pressure = (uint16_t)(pressure + 0.5);
+	if (abs((int)new_pressure - (int)scd30_pressure) <= 1)
+	{
+		return;
+	}
+	MYLOG("SCD30", "Set pressure compensation %d mbar", new_pressure);
+	if (scd30.setAmbientPressure(new_pressure))
+	{
+		scd30_pressure = new_pressure;
+	}
+}
+
 /**
  * @brief Read CO2 sensor data
  *     Data is added to Cayenne LPP payload as channels
- *     LPP_CHANNEL_CO2_2, LPP_CHANNEL_CO2_Temp_2 and LPP_CHANNEL_CO2_HUMID_2
+ *     LPP_CHANNEL_CO2_2, LPP_CHANNEL_CO2_Temp_2, LPP_CHANNEL_CO2_HUMID_2
+ *     and the age of the values in seconds as LPP_CHANNEL_CO2_AGE
+ *     Does not wait for new data, the last good values are sent instead
  *
  */
 void read_rak12037(void)
 {
-	time_t start_time = millis();
-	while (!scd30.dataAvailable())
+	// Pressure compensation from the environment sensors
+	float pressure;
+	if (env_get_p(&pressure, env_max_age()))
 	{
-		MYLOG("SCD30", "Waiting for data");
-		delay(500);
-		if ((millis() - start_time) > 5000)
-		{
-			// timeout, no data available
-			MYLOG("SCD30", "Timeout");
-			return;
-		}
+		set_pressure_rak12037(pressure);
 	}
 
-	uint16_t co2_reading = scd30.getCO2();
-	float temp_reading = scd30.getTemperature();
-	float humid_reading = scd30.getHumidity();
+	// Get new data in case the RDY wake up was missed
+	fetch_rak12037();
 
-	MYLOG("SCD30", "CO2 level %dppm", co2_reading);
-	MYLOG("SCD30", "Temperature %.2f", temp_reading);
-	MYLOG("SCD30", "Humidity %.2f", humid_reading);
+	if (!has_reading)
+	{
+		MYLOG("SCD30", "No data yet");
+		return;
+	}
+
+	uint32_t data_age = (millis() - last_read_time) / 1000;
 
-	g_solution_data.addConcentration(LPP_CHANNEL_CO2_2, co2_reading);
-	g_solution_data.addTemperature(LPP_CHANNEL_CO2_Temp_2, temp_reading);
-	g_solution_data.addRelativeHumidity(LPP_CHANNEL_CO2_HUMID_2, humid_reading);
+	MYLOG("SCD30", "CO2 level %dppm", last_co2);
+	MYLOG("SCD30", "Temperature %.2f", last_temp);
+	MYLOG("SCD30", "Humidity %.2f", last_humid);
+	MYLOG("SCD30", "Data age %ld s", data_age);
+
+	g_solution_data.addConcentration(LPP_CHANNEL_CO2_2, last_co2);
+	g_solution_data.addTemperature(LPP_CHANNEL_CO2_Temp_2, last_temp);
+	g_solution_data.addRelativeHumidity(LPP_CHANNEL_CO2_HUMID_2, last_humid);
+	g_solution_data.addGenericSensor(LPP_CHANNEL_CO2_AGE, data_age);
 
 #if HAS_EPD > 0
-	set_co2_rak14000(co2_reading);
+	set_co2_rak14000(last_co2);
 #endif
-}
\ No newline at end of file
+}
@@ -12,7 +12,24 @@
 #define RAK12037_H
 #include <Arduino.h>
 
+//******************************************************************//
+// RAK12037 RDY pin guide
+//******************************************************************//
+// Slot A      WB_IO1
+// Slot B      WB_IO2 ( not recommended, pin is used as power enable)
+// Slot C      WB_IO3
+// Slot D      WB_IO5
+//******************************************************************//
+#define RDY_CO2_PIN WB_IO1 // Slot A installation
+
+/** Measurement interval limits and default in seconds */
+#define SCD30_INTERVAL_MIN 2
+#define SCD30_INTERVAL_MAX 1800
+#define SCD30_INTERVAL_DEFAULT 10
+
 bool init_rak12037(void);
 void read_rak12037(void);
+bool fetch_rak12037(void);
+void int_rak12037(void);
 
 #endif // RAK12037_H
\ No newline at end of file
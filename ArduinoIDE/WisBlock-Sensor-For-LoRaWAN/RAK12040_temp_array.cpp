@@ -2,7 +2,7 @@
  * @file RAK12040_temp_array.cpp
  * @author Bernd Giesecke (bernd.giesecke@rakwireless.com)
  * @brief Initialize and read data from AMG8833 sensor
- * @version 0.2
+ * @version 0.3
  * @date 2022-04-12
  *
  * @copyright Copyright (c) 2022
@@ -14,18 +14,25 @@
 /** Sensor instance */
 GridEYE amg8833;
 
+/** AMG8833 I2C address */
+#define AMG_ADDRESS 0x68
+/** First pixel register, 64 pixels with 2 bytes each */
+#define AMG_PIXEL_REG 0x80
+/** Size of a frame in bytes */
+#define AMG_FRAME_SIZE 128
+/** Maximum bytes per I2C read, reduce if the Wire buffer is smaller */
+#define AMG_I2C_CHUNK 128
+
 /** HOT value (in degrees C) to adjust the contrast */
 #define HOT 40
 /** COLD value (in degrees C) to adjust the contrast */
 #define COLD 20
 
-/**
- * @brief This table can be of type int because we map the pixel
- * temperature to 0-3. Temperatures are reported by the
- * library as floats
- *
- */
-int pixelTable[64];
+/** Frame buffer, pixel temperatures in 0.01 degree C */
+int16_t amg_frame[64];
+
+/** Analytics settings, a person is 1.5 degree C above the background and covers at least 2 pixels */
+thermal_params_t amg_params = {150, 2, true};
 
 /**
  * @brief Initialize the AMG8833 sensor
@@ -37,7 +44,7 @@ bool init_rak12040(void)
 {
 	digitalWrite(WB_IO2, HIGH);
 	Wire.begin();
-	amg8833.begin(0x68, Wire);
+	amg8833.begin(AMG_ADDRESS, Wire);
 
 	amg8833.setFramerate10FPS();
 
@@ -45,51 +52,90 @@ bool init_rak12040(void)
 }
 
 /**
- * @brief Read and display measured values
+ * @brief Read all 64 pixels in one burst instead of 64 single reads
+ *     Pixels are 12 bit two's complement with 0.25 degree C resolution
  *
+ * @return true frame read
+ * @return false I2C error
  */
-void read_rak12040()
+bool read_frame_rak12040(void)
 {
-	// loop through all 64 pixels on the device and map each float value to a number
-	// between 0 and 3 using the HOT and COLD values we set at the top of the sketch
-	for (unsigned char i = 0; i < 64; i++)
-	{
-		pixelTable[i] = map(amg8833.getPixelTemperature(i), COLD, HOT, 0, 3);
-	}
-
-	// for (unsigned char x = 0; x < 64; x++)
-	// {
-	// 	pixelTable[x] = map(amg8833.getPixelTemperature[x], COLD, HOT, 0, 3);
-	// 	Serial.print(amg8833.getPixelTemperature[x]);
-	// 	Serial.print(" ");
-	// }
-	// Serial.println();
-
-	// loop through the table of mapped values and print a character corresponding to each
-	// pixel's temperature. Add a space between each. Start a new line every 8 in order to
-	// create an 8x8 grid
-	for (unsigned char i = 0; i < 64; i++)
+	uint8_t raw[AMG_FRAME_SIZE];
+	for (uint8_t offset = 0; offset < AMG_FRAME_SIZE; offset += AMG_I2C_CHUNK)
 	{
-		if (pixelTable[i] == 0)
+		uint8_t len = (AMG_FRAME_SIZE - offset) < AMG_I2C_CHUNK ? (AMG_FRAME_SIZE - offset) : AMG_I2C_CHUNK;
+		Wire.beginTransmission(AMG_ADDRESS);
+		Wire.write(AMG_PIXEL_REG + offset);
+		if (Wire.endTransmission(false) != 0)
 		{
-			Serial.print(".");
+			return false;
 		}
-		else if (pixelTable[i] == 1)
+		if (Wire.requestFrom((uint8_t)AMG_ADDRESS, len) != len)
 		{
-			Serial.print("o");
+			return false;
 		}
-		else if (pixelTable[i] == 2)
+		for (uint8_t idx = 0; idx < len; idx++)
 		{
-			Serial.print("0");
+			raw[offset + idx] = Wire.read();
 		}
-		else if (pixelTable[i] == 3)
+	}
+
+	for (uint8_t pixel = 0; pixel < 64; pixel++)
+	{
+		int16_t value = ((uint16_t)raw[pixel * 2 + 1] << 8 | raw[pixel * 2]) & 0x0FFF;
+		if (value & 0x0800)
 		{
-			Serial.print("O");
+			value -= 0x1000;
 		}
+		amg_frame[pixel] = value * 25;
+	}
+	return true;
+}
+
+/**
+ * @brief Read a frame and add the analytics to the payload
+ *     Data is added to Cayenne LPP payload as channels
+ *     LPP_CHANNEL_TARR_MIN, LPP_CHANNEL_TARR_MAX, LPP_CHANNEL_TARR_MEAN,
+ *     LPP_CHANNEL_TARR_HOT_X, LPP_CHANNEL_TARR_HOT_Y and LPP_CHANNEL_TARR_PERSONS
+ *
+ */
+void read_rak12040()
+{
+	if (!read_frame_rak12040())
+	{
+		MYLOG("AMG", "Frame read failed");
+		return;
+	}
+
+	thermal_result_t result;
+	if (!thermal_analyze(amg_frame, 8, 8, &amg_params, &result))
+	{
+		return;
+	}
+
+	g_solution_data.addTemperature(LPP_CHANNEL_TARR_MIN, result.min / 100.0);
+	g_solution_data.addTemperature(LPP_CHANNEL_TARR_MAX, result.max / 100.0);
+	g_solution_data.addTemperature(LPP_CHANNEL_TARR_MEAN, result.mean / 100.0);
+	g_solution_data.addAnalogInput(LPP_CHANNEL_TARR_HOT_X, (float)result.hot_x / THERMAL_SUBPIXEL);
+	g_solution_data.addAnalogInput(LPP_CHANNEL_TARR_HOT_Y, (float)result.hot_y / THERMAL_SUBPIXEL);
+	g_solution_data.addPresence(LPP_CHANNEL_TARR_PERSONS, result.persons);
+
+	MYLOG("AMG", "Min %.2f Max %.2f Mean %.2f Background %.2f", result.min / 100.0, result.max / 100.0, result.mean / 100.0, result.background / 100.0);
+	MYLOG("AMG", "Hotspot %.2f/%.2f Persons %d", (float)result.hot_x / THERMAL_SUBPIXEL, (float)result.hot_y / THERMAL_SUBPIXEL, result.persons);
+
+#if MY_DEBUG > 0
+	// Print the frame as an 8x8 grid, each pixel mapped to 0-3 between the COLD and HOT values
+	const char levels[] = ".o0O";
+	for (uint8_t pixel = 0; pixel < 64; pixel++)
+	{
+		long level = map(amg_frame[pixel], COLD * 100, HOT * 100, 0, 3);
+		level = level < 0 ? 0 : (level > 3 ? 3 : level);
+		Serial.print(levels[level]);
 		Serial.print(" ");
-		if ((i + 1) % 8 == 0)
+		if ((pixel + 1) % 8 == 0)
 		{
 			Serial.println();
 		}
 	}
+#endif
 }
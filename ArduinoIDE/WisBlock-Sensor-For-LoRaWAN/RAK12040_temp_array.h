@@ -14,5 +14,6 @@
 
 bool init_rak12040(void);
 void read_rak12040(void);
+bool read_frame_rak12040(void);
 
 #endif // RAK12040_H
\ No newline at end of file
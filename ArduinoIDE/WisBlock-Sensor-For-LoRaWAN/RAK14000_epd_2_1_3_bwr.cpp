@@ -575,7 +575,9 @@ void status_general_rak14000(bool has_pm)
 		snprintf(disp_text, 59, "Battery: %.2f V", batt_val);
 		rak14000_text(x_pos, y_pos, disp_text, use_txt_color, 1);
 		y_pos = y_pos + 10;
+		i2c_lock();
 		read_rak12002();
+		i2c_unlock();
 
 		snprintf(disp_text, 59, "%d/%d/%d %02d:%02d", g_date_time.date, g_date_time.month, g_date_time.year,
 				 g_date_time.hour, g_date_time.minute);
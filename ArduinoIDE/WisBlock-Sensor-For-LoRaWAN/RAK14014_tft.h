@@ -25,7 +25,7 @@ void wake_rak14014(void);
 void clear_rak14014(void);
 void refresh_rak14014(void);
 void set_voc_rak14000(uint16_t voc_value);
-extern bool voc_valid;
+extern volatile bool voc_valid;
 void set_temp_rak14000(float temp_value);
 void set_humid_rak14000(float humid_value);
 void set_baro_rak14000(float baro_value);
@@ -28,6 +28,278 @@ INA219_PGAIN gain_mode = PG_320;
 /** Default bus range */
 INA219_BUS_RANGE bus_range = BRNG_32;
 
+/** Shunt resistor in Ohm */
+#define INA_SHUNT_OHM 0.1
+
+/** Sampler rate in Hz, 0 = sampler off */
+uint8_t g_ina_rate = INA_RATE_DEFAULT;
+
+/** Units of the accumulators per µAh or µWh (µA * µs or µW * µs) */
+#define INA_US_PER_HOUR 3600000000LL
+
+/** Charge and energy integrated since the last uplink */
+static ina_accu_t ina_accu;
+
+/** Last sample, the integration uses trapezoids between two samples */
+static int32_t last_current_ua = 0;
+static int32_t last_power_uw = 0;
+static uint32_t last_sample_time = 0;
+static bool sampler_started = false;
+
+#if defined NRF52_SERIES || defined ESP32
+/** Task handle */
+TaskHandle_t ina_task_handle;
+
+/** Task declaration */
+void ina_task(void *pvParameters);
+
+/** Accumulator access from the app loop and the sampler task */
+static SemaphoreHandle_t ina_mutex = NULL;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** The sampler thread */
+Thread ina_task_handle(osPriorityLow, 4096);
+
+/** Task declaration */
+void ina_task(void);
+
+/** Accumulator access from the app loop and the sampler thread */
+static Mutex ina_mutex;
+#endif
+
+/**
+ * @brief Lock the accumulators
+ *
+ */
+static void ina_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreTake(ina_mutex, portMAX_DELAY);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	ina_mutex.lock();
+#endif
+}
+
+/**
+ * @brief Unlock the accumulators
+ *
+ */
+static void ina_unlock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGive(ina_mutex);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	ina_mutex.unlock();
+#endif
+}
+
+/**
+ * @brief Add to an accumulator without wrapping around
+ *
+ * @param value accumulator
+ * @param add value to add
+ * @return int64_t sum, saturated at the int64_t limits
+ */
+static int64_t ina_sat_add(int64_t value, int64_t add)
+{
+	if ((add > 0) && (value > INT64_MAX - add))
+	{
+		return INT64_MAX;
+	}
+	if ((add < 0) && (value < INT64_MIN - add))
+	{
+		return INT64_MIN;
+	}
+	return value + add;
+}
+
+/**
+ * @brief Add an area to a fractional accumulator
+ *     Whole units are moved into the integral, the remainder
+ *     stays below one unit, so it can never overflow.
+ *
+ * @param integral whole units (µAh or µWh)
+ * @param remainder fraction in µA * µs or µW * µs
+ * @param area area to add in µA * µs or µW * µs
+ */
+static void ina_accumulate(int64_t *integral, int64_t *remainder, int64_t area)
+{
+	*remainder += area;
+	int64_t whole = *remainder / INA_US_PER_HOUR;
+	*remainder -= whole * INA_US_PER_HOUR;
+	*integral = ina_sat_add(*integral, whole);
+}
+
+/**
+ * @brief Integrate one sample into the accumulators
+ *     Trapezoidal integration between the previous and this sample.
+ *
+ * @param accu accumulators
+ * @param prev_current_ua previous current in µA
+ * @param prev_power_uw previous power in µW
+ * @param current_ua current in µA
+ * @param power_uw power in µW
+ * @param dt_us time between the samples in µs
+ */
+static void ina_integrate(ina_accu_t *accu, int32_t prev_current_ua, int32_t prev_power_uw, int32_t current_ua, int32_t power_uw, uint32_t dt_us)
+{
+	ina_accumulate(&accu->charge_uah, &accu->charge_rem, ((int64_t)prev_current_ua + current_ua) * dt_us / 2);
+	ina_accumulate(&accu->energy_uwh, &accu->energy_rem, ((int64_t)prev_power_uw + power_uw) * dt_us / 2);
+	if (abs(current_ua) > abs(accu->peak_ua))
+	{
+		accu->peak_ua = current_ua;
+	}
+	accu->duration_ms = accu->duration_ms + ((accu->duration_us + dt_us) / 1000);
+	accu->duration_us = (accu->duration_us + dt_us) % 1000;
+	accu->samples++;
+}
+
+/**
+ * @brief Select the longest ADC averaging that fits into one sample period
+ *     Shunt and bus voltage are converted one after the other.
+ *
+ * @param rate sample rate in Hz
+ * @return INA219_ADC_MODE ADC mode
+ */
+static INA219_ADC_MODE ina_adc_mode(uint8_t rate)
+{
+	uint32_t period_us = 1000000UL / rate;
+	if (period_us >= 2 * 68100)
+	{
+		return SAMPLE_MODE_128;
+	}
+	if (period_us >= 2 * 34050)
+	{
+		return SAMPLE_MODE_64;
+	}
+	if (period_us >= 2 * 17020)
+	{
+		return SAMPLE_MODE_32;
+	}
+	if (period_us >= 2 * 8510)
+	{
+		return SAMPLE_MODE_16;
+	}
+	return SAMPLE_MODE_8;
+}
+
+/**
+ * @brief Read one sample and integrate it
+ *
+ */
+static void ina_sample(void)
+{
+	i2c_lock();
+	uint32_t now = micros();
+	float shuntVoltage_mV = ina219.getShuntVoltage_mV();
+	float busVoltage_V = ina219.getBusVoltage_V();
+	i2c_unlock();
+
+	// I = U / R in µA, P = U * I in µW
+	int32_t current_ua = (int32_t)(shuntVoltage_mV * 1000.0 / INA_SHUNT_OHM);
+	int32_t power_uw = (int32_t)(busVoltage_V * (float)current_ua);
+
+	ina_lock();
+	if (sampler_started)
+	{
+		ina_integrate(&ina_accu, last_current_ua, last_power_uw, current_ua, power_uw, now - last_sample_time);
+	}
+	last_current_ua = current_ua;
+	last_power_uw = power_uw;
+	last_sample_time = now;
+	sampler_started = true;
+	ina_unlock();
+}
+
+/**
+ * @brief Sampler task, samples the INA219 with the selected rate
+ *
+ */
+#if defined NRF52_SERIES || defined ESP32
+void ina_task(void *pvParameters)
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	void ina_task(void)
+#endif
+{
+	MYLOG("INA", "Sampler task started");
+#if defined NRF52_SERIES || defined ESP32
+	TickType_t last_wake = xTaskGetTickCount();
+#endif
+	while (1)
+	{
+		if (g_ina_rate == 0)
+		{
+			// Sampler is disabled, check again later
+			sampler_started = false;
+			delay(1000);
+#if defined NRF52_SERIES || defined ESP32
+			last_wake = xTaskGetTickCount();
+#endif
+			continue;
+		}
+
+		ina_sample();
+
+#if defined NRF52_SERIES || defined ESP32
+		vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000 / g_ina_rate));
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+		delay(1000 / g_ina_rate);
+#endif
+	}
+}
+
+/**
+ * @brief Start the background sampler task
+ *
+ * @return true task started
+ * @return false task could not be started
+ */
+bool start_rak16000(void)
+{
+#ifdef ARDUINO_ARCH_RP2040
+	ina_task_handle.start(ina_task);
+	ina_task_handle.set_priority(osPriorityLow);
+#endif
+#if defined NRF52_SERIES || defined ESP32
+	if (!xTaskCreate(ina_task, "INA", 4096, NULL, TASK_PRIO_LOW, &ina_task_handle))
+	{
+		MYLOG("INA", "Failed to start sampler task");
+		return false;
+	}
+#endif
+	return true;
+}
+
+/**
+ * @brief Set the sampler rate
+ *     The ADC averaging is adjusted to the sample period
+ *
+ * @param new_rate rate in Hz, 0 disables the sampler, otherwise INA_RATE_MIN to INA_RATE_MAX
+ * @return true rate is valid
+ * @return false rate is not supported
+ */
+bool set_rate_rak16000(uint8_t new_rate)
+{
+	if ((new_rate != 0) && ((new_rate < INA_RATE_MIN) || (new_rate > INA_RATE_MAX)))
+	{
+		return false;
+	}
+	i2c_lock();
+	ina_lock();
+	adc_mode = (new_rate == 0) ? SAMPLE_MODE_128 : ina_adc_mode(new_rate);
+	ina219.setADCMode(adc_mode);
+	g_ina_rate = new_rate;
+	memset(&ina_accu, 0, sizeof(ina_accu_t));
+	sampler_started = false;
+	ina_unlock();
+	i2c_unlock();
+	return true;
+}
+
 /**
  * @brief Initialize current sensor
  *
@@ -89,14 +361,46 @@ bool init_rak16000(void)
 	   Correction factor = current delivered from calibrated equipment / current delivered by INA219
 	*/
 	ina219.setCorrectionFactor(0.99); // insert your correction factor if necessary
+
+#if defined NRF52_SERIES || defined ESP32
+	// Create the lock before the sampler task is started
+	if (ina_mutex == NULL)
+	{
+		ina_mutex = xSemaphoreCreateMutex();
+	}
+#endif
+	memset(&ina_accu, 0, sizeof(ina_accu_t));
 	return true;
 }
 
+/**
+ * @brief Limit a value to the range of a Cayenne LPP analog input
+ *
+ * @param value value to send
+ * @return float value limited to +/-327.67
+ */
+static float ina_lpp_limit(float value)
+{
+	if (value > 327.67)
+	{
+		return 327.67;
+	}
+	if (value < -327.67)
+	{
+		return -327.67;
+	}
+	return value;
+}
+
 /**
  * @brief Read value from current, voltage and power sensor
  *     Data is added to Cayenne LPP payload as channel
  *     LPP_CHANNEL_CURRENT_CURRENT, LPP_CHANNEL_CURRENT_VOLTAGE,
  *     and LPP_CHANNEL_CURRENT_POWER
+ *     If the sampler is running, charge, energy and peak current since
+ *     the last uplink are added as channel LPP_CHANNEL_CURRENT_CHARGE,
+ *     LPP_CHANNEL_CURRENT_ENERGY and LPP_CHANNEL_CURRENT_PEAK
+ *     The peak current is sent in 10 mA, 0.1 mA resolution covers the 3.2 A range
  *
  */
 void read_rak16000(void)
@@ -106,13 +410,17 @@ void read_rak16000(void)
 	float current_mA = 0.0;
 	float power_mW = 0.0;
 
+	// Don't interfere with the sampler task
+	i2c_lock();
 	shuntVoltage_mV = ina219.getShuntVoltage_mV();
 	busVoltage_V = ina219.getBusVoltage_V();
 	// here we use the I=U/R to calculate, here the Resistor is 100mΩ, accuracy can reach to 0.5%.
-	current_mA = shuntVoltage_mV / 0.1;
+	current_mA = shuntVoltage_mV / INA_SHUNT_OHM;
 	power_mW = ina219.getBusPower();
+	bool overflow = ina219.getOverflow();
+	i2c_unlock();
 
-	if (ina219.getOverflow())
+	if (overflow)
 	{
 		MYLOG("INA", "INA219 overflow");
 		g_solution_data.addAnalogInput(LPP_CHANNEL_CURRENT_CURRENT, 0.0);
@@ -125,4 +433,22 @@ void read_rak16000(void)
 		g_solution_data.addAnalogInput(LPP_CHANNEL_CURRENT_VOLTAGE, busVoltage_V);
 		g_solution_data.addAnalogInput(LPP_CHANNEL_CURRENT_POWER, power_mW);
 	}
+
+	if (g_ina_rate != 0)
+	{
+		// Take the integrals and start the next interval
+		ina_lock();
+		ina_accu_t accu = ina_accu;
+		memset(&ina_accu, 0, sizeof(ina_accu_t));
+		ina_unlock();
+
+		MYLOG("INA", "%ld samples in %ld ms", accu.samples, accu.duration_ms);
+		MYLOG("INA", "Charge %.3f mAh, energy %.3f mWh, peak %.2f mA", accu.charge_uah / 1000.0, accu.energy_uwh / 1000.0, accu.peak_ua / 1000.0);
+		if (accu.samples != 0)
+		{
+			g_solution_data.addAnalogInput(LPP_CHANNEL_CURRENT_CHARGE, ina_lpp_limit(accu.charge_uah / 1000.0));
+			g_solution_data.addAnalogInput(LPP_CHANNEL_CURRENT_ENERGY, ina_lpp_limit(accu.energy_uwh / 1000.0));
+			g_solution_data.addAnalogInput(LPP_CHANNEL_CURRENT_PEAK, ina_lpp_limit(accu.peak_ua / 10000.0));
+		}
+	}
 }
\ No newline at end of file
@@ -12,7 +12,28 @@
 #define RAK16000_H
 #include <Arduino.h>
 
+/** Sampler rate limits in Hz */
+#define INA_RATE_MIN 1
+#define INA_RATE_MAX 50
+#define INA_RATE_DEFAULT 0
+
+/** Charge and energy accumulators */
+typedef struct ina_accu_s
+{
+	int64_t charge_uah;	  // Charge in µAh
+	int64_t charge_rem;	  // Charge below 1 µAh in µA * µs
+	int64_t energy_uwh;	  // Energy in µWh
+	int64_t energy_rem;	  // Energy below 1 µWh in µW * µs
+	int32_t peak_ua;	  // Current with the largest magnitude in µA
+	uint32_t duration_ms; // Integrated time in ms
+	uint32_t duration_us; // Integrated time below 1 ms in µs
+	uint32_t samples;	  // Number of integrated samples
+} ina_accu_t;
+
 bool init_rak16000(void);
 void read_rak16000(void);
+bool start_rak16000(void);
+bool set_rate_rak16000(uint8_t new_rate);
+extern uint8_t g_ina_rate;
 
 #endif // RAK16000_H
\ No newline at end of file
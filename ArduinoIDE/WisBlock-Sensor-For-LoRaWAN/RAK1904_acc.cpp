@@ -35,6 +35,19 @@ TwoWire *usedWire;
 /** Interrupt pin, depends on slot */
 uint8_t acc_int_pin = ACC_INT_PIN;
 
+/** Output data rate in Hz for the FIFO bursts, 0 = vibration analysis disabled */
+uint16_t g_vib_odr = 0;
+
+/** Max samples per I2C burst read, 6 bytes per sample, keeps the read within the Wire buffer */
+#define RAK1904_BURST_SAMPLES 10
+
+/** LIS3DH FIFO control values */
+#define RAK1904_FIFO_EN 0x40	   // CTRL5 FIFO enable
+#define RAK1904_FIFO_BYPASS 0x00   // FIFO_CTRL bypass mode, clears the FIFO
+#define RAK1904_FIFO_STREAM 0x80   // FIFO_CTRL stream mode
+#define RAK1904_FIFO_OVRN 0x40	   // FIFO_SRC FIFO is full
+#define RAK1904_FIFO_FSS_MASK 0x1F // FIFO_SRC number of unread samples
+
 /**
  * @brief Read RAK1904 register
  *     Added here because Adafruit made that function private :-(
@@ -89,6 +102,34 @@ bool rak1904_readRegister(uint8_t *outputPointer, uint8_t chip_reg)
 	return true;
 }
 
+/**
+ * @brief Burst read of RAK1904 registers with address auto increment
+ *
+ * @param buffer buffer for the register values
+ * @param chip_reg start register address
+ * @param len number of bytes to read
+ * @return true read success
+ * @return false read failed
+ */
+bool rak1904_readBurst(uint8_t *buffer, uint8_t chip_reg, uint8_t len)
+{
+	usedWire->beginTransmission(LIS3DH_DEFAULT_ADDRESS);
+	usedWire->write(chip_reg | 0x80); // MSB set enables address auto increment
+	if (usedWire->endTransmission(false) != 0)
+	{
+		return false;
+	}
+	if (usedWire->requestFrom(LIS3DH_DEFAULT_ADDRESS, len) != len)
+	{
+		return false;
+	}
+	for (uint8_t idx = 0; idx < len; idx++)
+	{
+		buffer[idx] = usedWire->read();
+	}
+	return true;
+}
+
 /**
  * @brief Initialize LIS3DH 3-axis
  * acceleration sensor
@@ -210,3 +251,263 @@ void clear_int_rak1904(void)
 	acc_sensor.readAndClearInterrupt();
 	// attachInterrupt(acc_int_pin, int_callback_rak1904, RISING);
 }
+
+/**
+ * @brief Convert ODR in Hz into the LIS3DH CTRL1 ODR bits
+ *
+ * @param odr output data rate in Hz
+ * @return uint8_t ODR bits, 0 if the ODR is not supported
+ */
+static uint8_t odr_code_rak1904(uint16_t odr)
+{
+	switch (odr)
+	{
+	case 10:
+		return LIS3DH_DATARATE_10_HZ;
+	case 25:
+		return LIS3DH_DATARATE_25_HZ;
+	case 50:
+		return LIS3DH_DATARATE_50_HZ;
+	case 100:
+		return LIS3DH_DATARATE_100_HZ;
+	case 200:
+		return LIS3DH_DATARATE_200_HZ;
+	case 400:
+		return LIS3DH_DATARATE_400_HZ;
+	case 1344:
+		return 0x09; // 1.344 kHz in normal and HR mode
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief Set the output data rate used for the FIFO bursts
+ *
+ * @param new_odr ODR in Hz, 50, 100, 200, 400 or 1344, 0 disables the vibration analysis
+ * @return true ODR is valid
+ * @return false ODR is not supported or fills the FIFO too slow
+ */
+bool set_odr_rak1904(uint16_t new_odr)
+{
+	if ((new_odr != 0) && ((odr_code_rak1904(new_odr) == 0) || ((RAK1904_FIFO_SIZE * 1000UL) / new_odr > RAK1904_FILL_MAX)))
+	{
+		return false;
+	}
+	g_vib_odr = new_odr;
+	return true;
+}
+
+/** Timer to finish the FIFO burst after the fill time */
+#ifdef NRF52_SERIES
+SoftwareTimer vib_timer;
+/** Flag if the timer was created */
+static bool vib_timer_ready = false;
+#endif
+#ifdef ESP32
+Ticker vib_timer;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+mbed::Ticker vib_timer;
+#endif
+
+/** Flag if a FIFO burst is running */
+static bool vib_capture_active = false;
+/** Register values restored after the burst */
+static uint8_t vib_ctrl1 = 0;
+static uint8_t vib_ctrl4 = 0;
+static uint8_t vib_ctrl5 = 0;
+
+/** Features of the last finished burst */
+static vib_features_t vib_last;
+/** Flag if vib_last was not sent yet */
+static bool vib_has_features = false;
+
+/**
+ * @brief Timer callback, the FIFO is full
+ * Wakes up application with signal SENSOR_REQ
+ *
+ */
+#ifdef NRF52_SERIES
+void vib_wakeup(TimerHandle_t unused)
+{
+	api_wake_loop(SENSOR_REQ);
+}
+#endif
+#if defined ESP32 || defined ARDUINO_ARCH_RP2040
+void vib_wakeup(void)
+{
+	vib_timer.detach();
+	api_wake_loop(SENSOR_REQ);
+}
+#endif
+
+/**
+ * @brief Start one FIFO burst in stream mode
+ *     The sensor is switched temporary to high resolution mode
+ *     with the selected ODR. The burst is finished by fetch_rak1904()
+ *     when the timer wakes up the loop after the fill time.
+ *
+ */
+static void start_capture_rak1904(void)
+{
+	// Reconfiguring the sensor can trigger the motion interrupt
+	detachInterrupt(acc_int_pin);
+
+	rak1904_readRegister(&vib_ctrl1, LIS3DH_REG_CTRL1);
+	rak1904_readRegister(&vib_ctrl4, LIS3DH_REG_CTRL4);
+	rak1904_readRegister(&vib_ctrl5, LIS3DH_REG_CTRL5);
+
+	// Normal mode with selected ODR, all axes enabled
+	rak1904_writeRegister(LIS3DH_REG_CTRL1, (odr_code_rak1904(g_vib_odr) << 4) | 0x07);
+	// High resolution mode, keep range and BDU
+	rak1904_writeRegister(LIS3DH_REG_CTRL4, vib_ctrl4 | 0x08);
+	// Clear FIFO with bypass mode, then start stream mode
+	rak1904_writeRegister(LIS3DH_REG_FIFOCTRL, RAK1904_FIFO_BYPASS);
+	rak1904_writeRegister(LIS3DH_REG_CTRL5, vib_ctrl5 | RAK1904_FIFO_EN);
+	rak1904_writeRegister(LIS3DH_REG_FIFOCTRL, RAK1904_FIFO_STREAM);
+	vib_capture_active = true;
+
+	// Finish when the FIFO is full, set_odr_rak1904() keeps the fill time below RAK1904_FILL_MAX
+	uint32_t fill_time = (RAK1904_FIFO_SIZE * 1000UL) / g_vib_odr + 2;
+#ifdef NRF52_SERIES
+	if (!vib_timer_ready)
+	{
+		vib_timer.begin(fill_time, vib_wakeup, NULL, false);
+		vib_timer_ready = true;
+	}
+	vib_timer.stop();
+	vib_timer.setPeriod(fill_time);
+	vib_timer.start();
+#endif
+#ifdef ESP32
+	vib_timer.detach();
+	vib_timer.attach_ms(fill_time, vib_wakeup);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	vib_timer.detach();
+	vib_timer.attach(vib_wakeup, (microseconds)(fill_time * 1000));
+#endif
+}
+
+/**
+ * @brief Finish the running FIFO burst, called on SENSOR_REQ
+ *     The samples are added to the inertial pipeline and the vibration
+ *     features are kept for the next uplink. The motion interrupt settings
+ *     are restored. Only the samples of this burst are analyzed, a burst
+ *     shorter than the FFT window is skipped.
+ *
+ * @return true features of a new burst are available
+ * @return false no burst running or analysis failed
+ */
+bool fetch_rak1904(void)
+{
+	if (!vib_capture_active)
+	{
+		return false;
+	}
+	vib_capture_active = false;
+
+	uint8_t fifo_src = 0;
+	rak1904_readRegister(&fifo_src, LIS3DH_REG_FIFOSRC);
+	uint8_t num_samples = (fifo_src & RAK1904_FIFO_OVRN) ? RAK1904_FIFO_SIZE : (fifo_src & RAK1904_FIFO_FSS_MASK);
+
+	uint32_t last_timestamp = micros();
+
+	// Sensitivity in HR mode depends on the range, Q8 micro g per digit
+	const int32_t ug_per_digit[4] = {1000 << IMU_SCALE_SHIFT, 2000 << IMU_SCALE_SHIFT, 4000 << IMU_SCALE_SHIFT, 12000 << IMU_SCALE_SHIFT};
+	int32_t scale = ug_per_digit[(vib_ctrl4 >> 4) & 0x03];
+
+	// Burst read, the register address rolls back from OUT_Z_H to OUT_X_L while the FIFO is enabled
+	uint8_t raw[RAK1904_BURST_SAMPLES * 6];
+	int16_t values[RAK1904_FIFO_SIZE * 3];
+	uint8_t sample_idx = 0;
+	while (sample_idx < num_samples)
+	{
+		uint8_t chunk = num_samples - sample_idx;
+		if (chunk > RAK1904_BURST_SAMPLES)
+		{
+			chunk = RAK1904_BURST_SAMPLES;
+		}
+		if (!rak1904_readBurst(raw, LIS3DH_REG_OUT_X_L, chunk * 6))
+		{
+			MYLOG("ACC", "FIFO burst read failed");
+			break;
+		}
+		for (uint8_t idx = 0; idx < chunk * 3; idx++)
+		{
+			// 12 bit left aligned values
+			values[sample_idx * 3 + idx] = (int16_t)(raw[idx * 2] | (raw[idx * 2 + 1] << 8)) >> 4;
+		}
+		sample_idx += chunk;
+	}
+	imu_push_block(IMU_SRC_RAK1904, IMU_TYPE_ACC, values, sample_idx, scale, g_vib_odr, last_timestamp);
+
+	// Restore the motion interrupt settings
+	rak1904_writeRegister(LIS3DH_REG_FIFOCTRL, RAK1904_FIFO_BYPASS);
+	rak1904_writeRegister(LIS3DH_REG_CTRL5, vib_ctrl5);
+	rak1904_writeRegister(LIS3DH_REG_CTRL4, vib_ctrl4);
+	rak1904_writeRegister(LIS3DH_REG_CTRL1, vib_ctrl1);
+	delay(10);
+
+	// Reading REFERENCE resets the high pass filter, then clear a latched interrupt
+	uint8_t dummy;
+	rak1904_readRegister(&dummy, LIS3DH_REG_REFERENCE);
+	clear_int_rak1904();
+	attachInterrupt(acc_int_pin, int_callback_rak1904, RISING);
+
+	if (sample_idx < VIB_FFT_SIZE)
+	{
+		MYLOG("ACC", "Burst too short, got %d of %d samples", sample_idx, VIB_FFT_SIZE);
+		return false;
+	}
+	if (!imu_vib_features(IMU_SRC_RAK1904, sample_idx, &vib_last))
+	{
+		MYLOG("ACC", "Vibration analysis failed");
+		return false;
+	}
+	MYLOG("ACC", "RMS %.3f Peak %.3f Crest %.2f Freq %.1fHz", vib_last.rms, vib_last.peak, vib_last.crest, vib_last.dom_freq);
+	vib_has_features = true;
+	return true;
+}
+
+/**
+ * @brief Add the vibration features and start the next FIFO burst
+ *     The burst runs in the background, the features of a burst are sent
+ *     with the next uplink. The first uplink after enabling has none.
+ *     Data is added to Cayenne LPP payload as channels
+ *     LPP_CHANNEL_VIB_RMS, LPP_CHANNEL_VIB_PEAK,
+ *     LPP_CHANNEL_VIB_CREST and LPP_CHANNEL_VIB_FREQ, the frequency in 10 Hz
+ *
+ * @return true features were added to the payload
+ * @return false vibration analysis disabled or no features available
+ */
+bool read_rak1904(void)
+{
+	if (g_vib_odr == 0)
+	{
+		vib_has_features = false;
+		return false;
+	}
+
+	bool added = vib_has_features;
+	if (vib_has_features)
+	{
+		g_solution_data.addAnalogInput(LPP_CHANNEL_VIB_RMS, vib_last.rms);
+		g_solution_data.addAnalogInput(LPP_CHANNEL_VIB_PEAK, vib_last.peak);
+		g_solution_data.addAnalogInput(LPP_CHANNEL_VIB_CREST, vib_last.crest);
+		// Up to 672 Hz, analog inputs are limited to 327.67, send in 10 Hz with 0.1 Hz resolution
+		g_solution_data.addAnalogInput(LPP_CHANNEL_VIB_FREQ, vib_last.dom_freq / 10.0f);
+		vib_has_features = false;
+	}
+	else
+	{
+		MYLOG("ACC", "No vibration features yet");
+	}
+
+	if (!vib_capture_active)
+	{
+		start_capture_rak1904();
+	}
+	return added;
+}
@@ -30,8 +30,19 @@
 #define ACC_INT_PIN WB_IO5
 #endif
 
+/** Number of samples the LIS3DH FIFO can hold */
+#define RAK1904_FIFO_SIZE 32
+
+/** Longest accepted FIFO fill time in ms, the motion interrupt is off during the burst. Limits the ODR to 50 Hz and more */
+#define RAK1904_FILL_MAX 700
+
 bool init_rak1904(void);
 void int_assign_rak1904(uint8_t new_irq_pin);
 void clear_int_rak1904(void);
+bool set_odr_rak1904(uint16_t new_odr);
+bool read_rak1904(void);
+bool fetch_rak1904(void);
+
+extern uint16_t g_vib_odr;
 
 #endif // RAK1904_H
\ No newline at end of file
@@ -32,6 +32,95 @@ MPU9250_WE mpu_sensor = MPU9250_WE();
 /** Interrupt pin, depends on slot */
 uint8_t mpu_int_pin = ACC_INT_PIN;
 
+/** Output data rate in Hz, 1 kHz internal rate with sample rate divider 5 */
+#define RAK1905_ODR 166
+
+/** MPU9250 FIFO registers and values */
+#define RAK1905_REG_CONFIG 0x1A
+#define RAK1905_REG_FIFO_EN 0x23
+#define RAK1905_REG_USER_CTRL 0x6A
+#define RAK1905_REG_FIFO_COUNT 0x72
+#define RAK1905_REG_FIFO_R_W 0x74
+#define RAK1905_FIFO_MODE_STOP 0x40 // CONFIG do not overwrite when full, keeps the frames aligned
+#define RAK1905_FIFO_ACC_GYR 0x78	// FIFO_EN accelerometer and gyroscope x/y/z
+#define RAK1905_FIFO_ENABLE 0x40	// USER_CTRL FIFO enable
+#define RAK1905_FIFO_RESET 0x04		// USER_CTRL FIFO reset
+
+/** FIFO frame, accelerometer x/y/z followed by gyroscope x/y/z, big endian */
+#define RAK1905_FRAME_SIZE 12
+
+/** Frames that fit completely into the 512 byte FIFO */
+#define RAK1905_FIFO_FRAMES (512 / RAK1905_FRAME_SIZE)
+
+/** Frames per I2C burst read, keeps the read within the Wire buffer */
+#define RAK1905_BURST_FRAMES 4
+
+/** Q8 scale for 2g range, 16384 LSB/g => micro g */
+#define RAK1905_ACC_SCALE 15625
+/** Q8 scale for 250dps range, 131 LSB/dps => milli dps */
+#define RAK1905_GYRO_SCALE 1954
+/** Q8 scale for magnetometer values in 0.1 uT => nano Tesla */
+#define RAK1905_MAG_SCALE 25600
+
+/** Flag if the magnetometer is initialized, it is only started for the fusion */
+bool mpu_mag_ready = false;
+
+/**
+ * @brief Write RAK1905 register
+ *
+ * @param chip_reg register address
+ * @param dataToWrite data to write
+ * @return true write success
+ * @return false write failed
+ */
+static bool rak1905_writeRegister(uint8_t chip_reg, uint8_t dataToWrite)
+{
+	Wire.beginTransmission(found_sensors[MPU_ID].i2c_addr);
+	Wire.write(chip_reg);
+	Wire.write(dataToWrite);
+	return (Wire.endTransmission() == 0);
+}
+
+/**
+ * @brief Burst read of RAK1905 registers
+ *     Reading FIFO_R_W repeatedly returns the next FIFO bytes
+ *
+ * @param buffer buffer for the register values
+ * @param chip_reg start register address
+ * @param len number of bytes to read
+ * @return true read success
+ * @return false read failed
+ */
+static bool rak1905_readBurst(uint8_t *buffer, uint8_t chip_reg, uint8_t len)
+{
+	Wire.beginTransmission(found_sensors[MPU_ID].i2c_addr);
+	Wire.write(chip_reg);
+	if (Wire.endTransmission(false) != 0)
+	{
+		return false;
+	}
+	if (Wire.requestFrom(found_sensors[MPU_ID].i2c_addr, len) != len)
+	{
+		return false;
+	}
+	for (uint8_t idx = 0; idx < len; idx++)
+	{
+		buffer[idx] = Wire.read();
+	}
+	return true;
+}
+
+/**
+ * @brief Empty the FIFO, the next frame starts at the beginning again
+ *
+ */
+static void rak1905_reset_fifo(void)
+{
+	uint8_t user_ctrl = 0;
+	rak1905_readBurst(&user_ctrl, RAK1905_REG_USER_CTRL, 1);
+	rak1905_writeRegister(RAK1905_REG_USER_CTRL, user_ctrl | RAK1905_FIFO_RESET);
+}
+
 /**
  * @brief Initialize MPU9250 9-axis
  * acceleration sensor
@@ -91,6 +180,11 @@ bool init_rak1905(void)
 	 */
 	mpu_sensor.setAccDLPF(MPU9250_DLPF_6);
 
+	/*  The sample rate divider is only applied if the gyroscope DLPF is enabled as well
+	 */
+	mpu_sensor.enableGyrDLPF();
+	mpu_sensor.setGyrDLPF(MPU9250_DLPF_3);
+
 	/*  Set accelerometer output data rate in low power mode (cycle enabled)
 	 *   MPU9250_LP_ACC_ODR_0_24          0.24 Hz
 	 *   MPU9250_LP_ACC_ODR_0_49          0.49 Hz
@@ -165,6 +259,15 @@ bool init_rak1905(void)
 	 * MPU9250_ENABLE_000  // all axes disabled
 	 */
 	// myMPU9250.enableAccAxes(MPU9250_ENABLE_XYZ);
+
+	// Collect accelerometer and gyroscope data in the FIFO
+	uint8_t reg_value = 0;
+	rak1905_readBurst(&reg_value, RAK1905_REG_CONFIG, 1);
+	rak1905_writeRegister(RAK1905_REG_CONFIG, reg_value | RAK1905_FIFO_MODE_STOP);
+	rak1905_writeRegister(RAK1905_REG_FIFO_EN, RAK1905_FIFO_ACC_GYR);
+	rak1905_readBurst(&reg_value, RAK1905_REG_USER_CTRL, 1);
+	rak1905_writeRegister(RAK1905_REG_USER_CTRL, reg_value | RAK1905_FIFO_ENABLE | RAK1905_FIFO_RESET);
+
 	//  Set the interrupt callback function
 	attachInterrupt(mpu_int_pin, int_callback_rak1905, RISING);
 
@@ -204,4 +307,108 @@ void clear_int_rak1905(void)
 	{
 		MYLOG("9DOF", "Interrupt Type: Motion");
 	}
+	// While the fusion is running, the fusion task drains the FIFO
+	if (g_fusion_rate == 0)
+	{
+		// Take what the FIFO holds, a FIFO that stopped full long ago is dropped and restarts
+		read_fifo_rak1905();
+	}
+}
+
+/**
+ * @brief Drain the FIFO into the inertial pipeline
+ *
+ * @return uint16_t number of frames read
+ */
+uint16_t read_fifo_rak1905(void)
+{
+	uint8_t raw[RAK1905_BURST_FRAMES * RAK1905_FRAME_SIZE];
+	int16_t acc[RAK1905_BURST_FRAMES * 3];
+	int16_t gyro[RAK1905_BURST_FRAMES * 3];
+
+	if (!rak1905_readBurst(raw, RAK1905_REG_FIFO_COUNT, 2))
+	{
+		MYLOG("9DOF", "FIFO count read failed");
+		return 0;
+	}
+	uint16_t num_frames = (((raw[0] & 0x1F) << 8) | raw[1]) / RAK1905_FRAME_SIZE;
+	if (num_frames >= RAK1905_FIFO_FRAMES)
+	{
+		// The FIFO stopped when it got full, the time of its frames is unknown. Drop them instead of giving them recent timestamps
+		MYLOG("9DOF", "FIFO full, frames dropped");
+		rak1905_reset_fifo();
+		return 0;
+	}
+	bool read_failed = false;
+	uint32_t now = micros();
+	uint32_t period = 1000000UL / RAK1905_ODR;
+
+	uint16_t frame_idx = 0;
+	while (frame_idx < num_frames)
+	{
+		uint8_t chunk = num_frames - frame_idx;
+		if (chunk > RAK1905_BURST_FRAMES)
+		{
+			chunk = RAK1905_BURST_FRAMES;
+		}
+		if (!rak1905_readBurst(raw, RAK1905_REG_FIFO_R_W, chunk * RAK1905_FRAME_SIZE))
+		{
+			MYLOG("9DOF", "FIFO burst read failed");
+			read_failed = true;
+			break;
+		}
+		for (uint8_t idx = 0; idx < chunk; idx++)
+		{
+			uint8_t *frame = &raw[idx * RAK1905_FRAME_SIZE];
+			for (uint8_t axis = 0; axis < 3; axis++)
+			{
+				acc[idx * 3 + axis] = (int16_t)((frame[axis * 2] << 8) | frame[axis * 2 + 1]);
+				gyro[idx * 3 + axis] = (int16_t)((frame[6 + axis * 2] << 8) | frame[6 + axis * 2 + 1]);
+			}
+		}
+		frame_idx += chunk;
+		uint32_t last_timestamp = now - (uint32_t)(num_frames - frame_idx) * period;
+		imu_push_block(IMU_SRC_RAK1905, IMU_TYPE_ACC, acc, chunk, RAK1905_ACC_SCALE, RAK1905_ODR, last_timestamp);
+		imu_push_block(IMU_SRC_RAK1905, IMU_TYPE_GYRO, gyro, chunk, RAK1905_GYRO_SCALE, RAK1905_ODR, last_timestamp);
+	}
+
+	if (read_failed)
+	{
+		// Restart with an empty FIFO to get the frames aligned again
+		rak1905_reset_fifo();
+	}
+	return frame_idx;
+}
+
+/**
+ * @brief Read the magnetometer into the inertial pipeline
+ *     The AK8963 axes are aligned to the accelerometer axes
+ *
+ * @return true value added
+ * @return false magnetometer not available
+ */
+bool read_mag_rak1905(void)
+{
+	if (!mpu_mag_ready)
+	{
+		if (!mpu_sensor.initMagnetometer())
+		{
+			MYLOG("9DOF", "Magnetometer initialization failed");
+			return false;
+		}
+		mpu_sensor.setMagOpMode(AK8963_CONT_MODE_100HZ);
+		// The magnetometer setup changes USER_CTRL, keep the FIFO enabled
+		uint8_t user_ctrl = 0;
+		rak1905_readBurst(&user_ctrl, RAK1905_REG_USER_CTRL, 1);
+		rak1905_writeRegister(RAK1905_REG_USER_CTRL, user_ctrl | RAK1905_FIFO_ENABLE);
+		mpu_mag_ready = true;
+	}
+
+	xyzFloat mag = mpu_sensor.getMagValues();
+	int16_t values[3];
+	values[0] = (int16_t)(mag.y * 10.0f);
+	values[1] = (int16_t)(mag.x * 10.0f);
+	values[2] = (int16_t)(-mag.z * 10.0f);
+	imu_push_block(IMU_SRC_RAK1905, IMU_TYPE_MAG, values, 1, RAK1905_MAG_SCALE, 1, micros());
+	return true;
 }
@@ -17,5 +17,13 @@
 // void get_rak1906_bsec_values(float *values);
 // bool do_read_rak1906_bsec(void);
 // uint16_t get_alt_rak1906_bsec(void);
+// void check_save_rak1906_bsec(void);
+// uint8_t get_accuracy_rak1906_bsec(void);
+// int32_t get_save_age_rak1906_bsec(void);
+
+// /** Limits for the BSEC state save interval in hours */
+// #define BSEC_SAVE_MAX 168
+// #define BSEC_SAVE_DEFAULT 6
+// extern uint16_t g_bsec_save_hours;
 
 // #endif // RAK1906_BSEC_H
\ No newline at end of file
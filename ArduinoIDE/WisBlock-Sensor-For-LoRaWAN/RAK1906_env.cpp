@@ -114,6 +114,10 @@ bool read_rak1906()
 	_last_pressure_rak1906 = (float)(bme.pressure) / 100.0;
 	float _current_gas_rak1906 = bme.gas_resistance;
 
+	// Share the values for compensation of other sensors
+	env_publish_th(_last_temp_rak1906, _last_humid_rak1906, ENV_SRC_RAK1906);
+	env_publish_p(_last_pressure_rak1906, ENV_SRC_RAK1906);
+
 	humidity_score = GetHumidityScore(_last_humid_rak1906);
 	gas_score = GetGasScore(_current_gas_rak1906);
 
@@ -583,8 +583,10 @@ void gnss_task(void *pvParameters)
 		{
 			if (!g_is_helium && !g_is_tester)
 			{
-				// Startup GNSS module
+				// Startup GNSS module, RAK12500 shares the I2C bus
+				i2c_lock();
 				init_gnss();
+				i2c_unlock();
 			}
 
 			if (g_is_helium || g_is_tester)
@@ -654,8 +656,10 @@ void gnss_task(void *pvParameters)
 					{
 						digitalWrite(LED_BLUE, HIGH);
 						MYLOG("GNSS", "GNSS polling");
-						// Get location
+						// Get location, RAK12500 shares the I2C bus
+						i2c_lock();
 						got_location = poll_gnss();
+						i2c_unlock();
 
 						digitalWrite(LED_BLUE, LOW);
 						if (got_location)
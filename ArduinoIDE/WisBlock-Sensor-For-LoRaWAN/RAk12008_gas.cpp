@@ -59,45 +59,21 @@ void read_rak12008(void)
 {
 	// Set binary gas, just to be sure.
 	stc31_sensor.setBinaryGas(STC3X_BINARY_GAS_CO2_AIR_25);
-	float t_h_values[3] = {0.0}; // temperature [0] & humidity [1] % pressure [2] value from T&H sensor
+	float temperature;
+	float humidity;
+	float pressure;
 
-	if (found_sensors[ENV_ID].found_sensor)
+	// Compensation values from the environment sensors
+	if (env_get_th(&temperature, &humidity, env_max_age()))
 	{
-// #if USE_BSEC == 0
-		get_rak1906_values(t_h_values);
-// #else
-// 		get_rak1906_bsec_values(t_h_values);
-// #endif
-		MYLOG("CO2", "Rh: %.2f T: %.2f P: %.2f", t_h_values[1], t_h_values[0], t_h_values[2]);
-
-		if ((t_h_values[0] != 0.0) && (t_h_values[1] != 0.0))
-		{
-			stc31_sensor.setTemperature(t_h_values[0]);
-			stc31_sensor.setRelativeHumidity(t_h_values[1]);
-			stc31_sensor.setPressure((uint16_t)t_h_values[2]);
-		}
+		MYLOG("CO2", "Rh: %.2f T: %.2f", humidity, temperature);
+		stc31_sensor.setTemperature(temperature);
+		stc31_sensor.setRelativeHumidity(humidity);
 	}
-	else
+	if (env_get_p(&pressure, env_max_age()))
 	{
-		if (found_sensors[TEMP_ID].found_sensor)
-		{
-			get_rak1901_values(t_h_values);
-			MYLOG("CO2", "Rh: %.2f T: %.2f", t_h_values[1], t_h_values[0]);
-
-			if ((t_h_values[0] != 0.0) && (t_h_values[1] != 0.0))
-			{
-				stc31_sensor.setTemperature(t_h_values[0]);
-				stc31_sensor.setRelativeHumidity(t_h_values[1]);
-			}
-		}
-		if (found_sensors[PRESS_ID].found_sensor)
-		{
-			start_rak1902();
-			delay(100);
-			float pressure = get_rak1902();
-			MYLOG("CO2", "P: %.2f", pressure);
-			stc31_sensor.setPressure((uint16_t)pressure);
-		}
+		MYLOG("CO2", "P: %.2f", pressure);
+		stc31_sensor.setPressure((uint16_t)pressure);
 	}
 	if (stc31_sensor.measureGasConcentration()) // measureGasConcentration will return true when fresh data is available
 	{
@@ -0,0 +1,290 @@
+/**
+ * @file clock_sync.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Network time for the RTC or a software clock
+ *        Uses the LoRaWAN application layer clock synchronization on fPort 202.
+ *        The device sends its time (AppTimeReq), the server answers with the
+ *        correction (AppTimeAns). The correction is written into the RAK12002,
+ *        without RTC a software clock based on millis() is used.
+ *        The drift between two syncs is used to adapt the sync interval.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Last correction in seconds */
+int32_t g_clock_offset = 0;
+/** Estimated clock drift in ppm, positive if the clock runs fast */
+float g_clock_drift = 0.0;
+/** Sync interval in seconds */
+uint32_t g_clock_interval = CLOCK_SYNC_DEFAULT;
+/** Flag if sync requests are sent on their own, off by default to save airtime */
+bool g_clock_auto = false;
+
+/** Command IDs of the clock synchronization package */
+#define CLOCK_PACKAGE_VERSION 0x00
+#define CLOCK_APP_TIME 0x01
+#define CLOCK_PERIODICITY 0x02
+#define CLOCK_FORCE_RESYNC 0x03
+
+/** Software clock, seconds since 2000 at clock_soft_time */
+static uint32_t clock_soft_epoch = 0;
+/** millis() of the software clock base */
+static time_t clock_soft_time = 0;
+/** Flag if the clock was synced since power up */
+static bool clock_synced = false;
+/** Flag if the drift estimation has a value */
+static bool clock_drift_valid = false;
+/** Flag if the server set the sync interval */
+static bool clock_fixed_interval = false;
+
+/** Epoch after the last sync */
+static uint32_t clock_last_sync_epoch = 0;
+/** millis() of the last sync */
+static time_t clock_last_sync = 0;
+/** millis() of the last request */
+static time_t clock_last_request = 0;
+/** Flag if a request was sent */
+static bool clock_requested = false;
+/** Token of the last request */
+static uint8_t clock_token = 0;
+/** Number of forced requests still to send */
+static uint8_t clock_force_count = 0;
+
+/** Pending answers to the server */
+static uint8_t clock_answer[CLOCK_ANSWER_SIZE];
+static uint8_t clock_answer_size = 0;
+
+/**
+ * @brief Check if the time is valid
+ *
+ * @return true RTC present or software clock synced
+ * @return false no time available
+ */
+bool clock_valid(void)
+{
+	return found_sensors[RTC_ID].found_sensor || clock_synced;
+}
+
+/**
+ * @brief Get the time
+ *
+ * @return uint32_t seconds since 2000-01-01 00:00:00, 0 if no time available
+ */
+uint32_t clock_get_epoch(void)
+{
+	if (found_sensors[RTC_ID].found_sensor)
+	{
+		return get_epoch_rak12002();
+	}
+	if (clock_synced)
+	{
+		return clock_soft_epoch + (uint32_t)(millis() - clock_soft_time) / 1000;
+	}
+	return 0;
+}
+
+/**
+ * @brief Get the time as Unix time
+ *
+ * @return uint32_t seconds since 1970-01-01 00:00:00
+ */
+uint32_t clock_get_unix(void)
+{
+	return clock_get_epoch() + RTC_UNIX_OFFSET;
+}
+
+/**
+ * @brief Write a 32 bit value little endian
+ *
+ * @param buffer target
+ * @param value value to write
+ */
+static void put_uint32(uint8_t *buffer, uint32_t value)
+{
+	buffer[0] = (uint8_t)(value);
+	buffer[1] = (uint8_t)(value >> 8);
+	buffer[2] = (uint8_t)(value >> 16);
+	buffer[3] = (uint8_t)(value >> 24);
+}
+
+/**
+ * @brief Apply a correction from the server
+ *     Updates the drift estimation and the sync interval
+ *
+ * @param correction correction in seconds
+ */
+static void clock_correct(int32_t correction)
+{
+	uint32_t now = clock_get_epoch() + correction;
+	if (found_sensors[RTC_ID].found_sensor)
+	{
+		set_epoch_rak12002(now);
+	}
+	clock_soft_epoch = now;
+	clock_soft_time = millis();
+
+	// Drift since the last sync, large steps are clock settings, not drift
+	if (clock_synced && (abs(correction) <= CLOCK_STEP_LIMIT))
+	{
+		uint32_t elapsed = now - clock_last_sync_epoch;
+		if (elapsed >= CLOCK_SYNC_MIN / 2)
+		{
+			float drift = -(float)correction * 1000000.0 / elapsed;
+			g_clock_drift = clock_drift_valid ? (g_clock_drift * 3.0 + drift) / 4.0 : drift;
+			clock_drift_valid = true;
+		}
+	}
+
+	// Sync often enough to stay within CLOCK_MAX_ERROR
+	if (clock_drift_valid && !clock_fixed_interval)
+	{
+		float abs_drift = fabs(g_clock_drift);
+		uint32_t interval = abs_drift < 0.1 ? CLOCK_SYNC_MAX : (uint32_t)(CLOCK_MAX_ERROR * 1000000.0 / abs_drift);
+		g_clock_interval = interval < CLOCK_SYNC_MIN ? CLOCK_SYNC_MIN : (interval > CLOCK_SYNC_MAX ? CLOCK_SYNC_MAX : interval);
+	}
+
+	g_clock_offset = correction;
+	clock_last_sync_epoch = now;
+	clock_last_sync = millis();
+	clock_synced = true;
+	MYLOG("CLK", "Corrected by %ld s, drift %.2f ppm, next sync in %ld s", correction, g_clock_drift, g_clock_interval);
+}
+
+/**
+ * @brief Send a pending answer or a sync request if one is due
+ *     Called after a finished TX cycle, sends at most one packet
+ *
+ */
+void clock_sync_send(void)
+{
+	uint8_t request[6];
+	uint8_t *packet = request;
+	uint8_t size = 0;
+
+	if (clock_answer_size != 0)
+	{
+		packet = clock_answer;
+		size = clock_answer_size;
+	}
+	else
+	{
+		time_t now = millis();
+		bool retry_ok = !clock_requested || ((uint32_t)(now - clock_last_request) >= CLOCK_RETRY);
+		// Without AT+TSYNC=1 only requests forced by AT+TSYNC or by the server are sent
+		bool due = g_clock_auto && (!clock_synced || ((uint32_t)(now - clock_last_sync) >= g_clock_interval * 1000));
+		if (!((due && retry_ok) || (clock_force_count != 0)))
+		{
+			return;
+		}
+		clock_token = (clock_token + 1) & 0x0F;
+		request[0] = CLOCK_APP_TIME;
+		put_uint32(&request[1], clock_get_epoch() + CLOCK_GPS_OFFSET);
+		// AnsRequired is set, the server answers even if the clock is correct
+		request[5] = 0x10 | clock_token;
+		size = 6;
+	}
+
+	if (send_lora_packet(packet, size, CLOCK_SYNC_FPORT) == LMH_SUCCESS)
+	{
+		if (packet == clock_answer)
+		{
+			clock_answer_size = 0;
+		}
+		else
+		{
+			clock_requested = true;
+			clock_last_request = millis();
+			if (clock_force_count != 0)
+			{
+				clock_force_count--;
+			}
+			MYLOG("CLK", "Time request %d sent", clock_token);
+		}
+	}
+}
+
+/**
+ * @brief Handle a downlink on CLOCK_SYNC_FPORT
+ *
+ * @param data downlink payload
+ * @param size payload size
+ */
+void clock_sync_handle(uint8_t *data, uint16_t size)
+{
+	uint16_t pos = 0;
+	while (pos < size)
+	{
+		switch (data[pos])
+		{
+		case CLOCK_PACKAGE_VERSION:
+			// Package identifier 1, version 1
+			if (clock_answer_size + 3 <= CLOCK_ANSWER_SIZE)
+			{
+				clock_answer[clock_answer_size++] = CLOCK_PACKAGE_VERSION;
+				clock_answer[clock_answer_size++] = 1;
+				clock_answer[clock_answer_size++] = 1;
+			}
+			pos += 1;
+			break;
+		case CLOCK_APP_TIME:
+			if (pos + 6 > size)
+			{
+				return;
+			}
+			if ((data[pos + 5] & 0x0F) == clock_token)
+			{
+				int32_t correction = (int32_t)((uint32_t)data[pos + 1] | ((uint32_t)data[pos + 2] << 8) | ((uint32_t)data[pos + 3] << 16) | ((uint32_t)data[pos + 4] << 24));
+				clock_correct(correction);
+				clock_requested = false;
+			}
+			else
+			{
+				MYLOG("CLK", "Answer with wrong token");
+			}
+			pos += 6;
+			break;
+		case CLOCK_PERIODICITY:
+			if (pos + 2 > size)
+			{
+				return;
+			}
+			// Period is 128 * 2^n seconds, the answer includes the current time
+			g_clock_interval = 128UL << (data[pos + 1] & 0x0F);
+			g_clock_interval = g_clock_interval < CLOCK_SYNC_MIN ? CLOCK_SYNC_MIN : g_clock_interval;
+			clock_fixed_interval = true;
+			if (clock_answer_size + 6 <= CLOCK_ANSWER_SIZE)
+			{
+				clock_answer[clock_answer_size++] = CLOCK_PERIODICITY;
+				clock_answer[clock_answer_size++] = 0;
+				put_uint32(&clock_answer[clock_answer_size], clock_get_epoch() + CLOCK_GPS_OFFSET);
+				clock_answer_size += 4;
+			}
+			pos += 2;
+			break;
+		case CLOCK_FORCE_RESYNC:
+			if (pos + 2 > size)
+			{
+				return;
+			}
+			clock_force_count = data[pos + 1] & 0x07;
+			pos += 2;
+			break;
+		default:
+			MYLOG("CLK", "Unknown command %02X", data[pos]);
+			return;
+		}
+	}
+}
+
+/**
+ * @brief Request a sync with the next finished TX cycle
+ *
+ */
+void clock_sync_force(void)
+{
+	clock_force_count = 1;
+}
@@ -0,0 +1,188 @@
+/**
+ * @file env_context.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Shared environment context
+ *        Temperature, humidity and pressure sensors publish their readings
+ *        once per cycle, compensating sensors (STC31, SGP40, SCD30) take
+ *        them from here instead of triggering own conversions.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Last temperature in degree C */
+static float env_temperature = 0.0;
+/** Last humidity in %RH */
+static float env_humidity = 0.0;
+/** Last pressure in hPa */
+static float env_pressure = 0.0;
+
+/** millis() of the last T/RH and pressure update */
+static time_t env_th_time = 0;
+static time_t env_p_time = 0;
+
+/** Source of the current T/RH and pressure values */
+static uint8_t env_th_source = ENV_SRC_NONE;
+static uint8_t env_p_source = ENV_SRC_NONE;
+
+#if defined NRF52_SERIES || defined ESP32
+/** Context access from the app loop and the sensor tasks */
+static SemaphoreHandle_t env_mutex = NULL;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** Context access from the app loop and the sensor threads */
+static Mutex env_mutex;
+#endif
+
+/**
+ * @brief Create the context lock, must be called before any sensor task starts
+ *
+ */
+void init_env_context(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	env_mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+/**
+ * @brief Lock the context
+ *
+ */
+static void env_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreTake(env_mutex, portMAX_DELAY);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	env_mutex.lock();
+#endif
+}
+
+/**
+ * @brief Unlock the context
+ *
+ */
+static void env_unlock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGive(env_mutex);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	env_mutex.unlock();
+#endif
+}
+
+/**
+ * @brief Get the maximum age of values for compensation
+ *     Sensors publish once per send interval, allow one missed cycle
+ *
+ * @return uint32_t maximum age in ms
+ */
+uint32_t env_max_age(void)
+{
+	if (g_lorawan_settings.send_repeat_time == 0)
+	{
+		return ENV_MAX_AGE_DEFAULT;
+	}
+	return g_lorawan_settings.send_repeat_time * 2;
+}
+
+/**
+ * @brief Check if a value is still valid
+ *
+ * @param timestamp millis() of the update
+ * @param source source of the value
+ * @param max_age maximum age in ms
+ * @return true value is valid
+ * @return false no value or too old
+ */
+static bool env_is_fresh(time_t timestamp, uint8_t source, uint32_t max_age)
+{
+	return (source != ENV_SRC_NONE) && ((uint32_t)(millis() - timestamp) <= max_age);
+}
+
+/**
+ * @brief Publish temperature and humidity
+ *     A fresh value from a source with higher priority is not overwritten
+ *
+ * @param temperature temperature in degree C
+ * @param humidity humidity in %RH
+ * @param source ENV_SRC_xxx
+ */
+void env_publish_th(float temperature, float humidity, uint8_t source)
+{
+	env_lock();
+	if (!((source < env_th_source) && env_is_fresh(env_th_time, env_th_source, env_max_age())))
+	{
+		env_temperature = temperature;
+		env_humidity = humidity;
+		env_th_time = millis();
+		env_th_source = source;
+	}
+	env_unlock();
+}
+
+/**
+ * @brief Publish pressure
+ *     A fresh value from a source with higher priority is not overwritten
+ *
+ * @param pressure pressure in hPa
+ * @param source ENV_SRC_xxx
+ */
+void env_publish_p(float pressure, uint8_t source)
+{
+	env_lock();
+	if (!((source < env_p_source) && env_is_fresh(env_p_time, env_p_source, env_max_age())))
+	{
+		env_pressure = pressure;
+		env_p_time = millis();
+		env_p_source = source;
+	}
+	env_unlock();
+}
+
+/**
+ * @brief Get temperature and humidity
+ *
+ * @param temperature pointer for temperature in degree C
+ * @param humidity pointer for humidity in %RH
+ * @param max_age maximum accepted age in ms
+ * @return true values are valid
+ * @return false no values or too old, compensation should use defaults
+ */
+bool env_get_th(float *temperature, float *humidity, uint32_t max_age)
+{
+	env_lock();
+	bool valid = env_is_fresh(env_th_time, env_th_source, max_age);
+	if (valid)
+	{
+		*temperature = env_temperature;
+		*humidity = env_humidity;
+	}
+	env_unlock();
+	return valid;
+}
+
+/**
+ * @brief Get pressure
+ *
+ * @param pressure pointer for pressure in hPa
+ * @param max_age maximum accepted age in ms
+ * @return true value is valid
+ * @return false no value or too old, compensation should use defaults
+ */
+bool env_get_p(float *pressure, uint32_t max_age)
+{
+	env_lock();
+	bool valid = env_is_fresh(env_p_time, env_p_source, max_age);
+	if (valid)
+	{
+		*pressure = env_pressure;
+	}
+	env_unlock();
+	return valid;
+}
@@ -0,0 +1,42 @@
+/**
+ * @file frag_transport.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the fragmented uplink transport
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef FRAG_TRANSPORT_H
+#define FRAG_TRANSPORT_H
+#include <Arduino.h>
+
+/** Largest object that can be sent */
+#define FRAG_MAX_OBJECT 1024
+/** Fragment header size */
+#define FRAG_HEADER_SIZE 5
+/** fPort used for fragments */
+#define FRAG_FPORT 13
+/** Smallest payload of all regions and data rates (US915 DR0), used if the MAC can not be queried */
+#define FRAG_MIN_PAYLOAD 11
+/** Maximum number of data fragments per object */
+#define FRAG_MAX_FRAGMENTS 127
+/** Parity group size limits, 0 = no parity fragments */
+#define FRAG_GROUP_MAX 15
+#define FRAG_GROUP_DEFAULT 4
+/** Gap between two fragments in seconds */
+#define FRAG_GAP_MIN 1
+#define FRAG_GAP_MAX 3600
+#define FRAG_GAP_DEFAULT 5
+
+uint8_t frag_max_payload(void);
+bool frag_send(const uint8_t *data, uint16_t size, uint8_t fport);
+void frag_next(void);
+void frag_tx_finished(void);
+bool frag_busy(void);
+bool set_frag(uint8_t new_group, uint16_t new_gap);
+extern uint8_t g_frag_group;
+extern uint16_t g_frag_gap;
+
+#endif // FRAG_TRANSPORT_H
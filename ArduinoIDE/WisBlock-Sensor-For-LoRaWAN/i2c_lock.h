@@ -0,0 +1,18 @@
+/**
+ * @file i2c_lock.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the shared I2C bus lock
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef I2C_LOCK_H
+#define I2C_LOCK_H
+#include <Arduino.h>
+
+void i2c_lock(void);
+void i2c_unlock(void);
+
+#endif // I2C_LOCK_H
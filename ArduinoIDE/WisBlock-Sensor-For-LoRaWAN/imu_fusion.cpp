@@ -0,0 +1,552 @@
+/**
+ * @file imu_fusion.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Orientation sensor fusion for the 9DOF modules RAK1905 and RAK12034
+ *        Mahony filter in single precision, fed from the inertial pipeline.
+ *        Runs in its own low priority task with a fixed rate, each cycle
+ *        drains the FIFO of the module and processes all new samples.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Fusion rate in Hz, 0 = fusion disabled */
+uint8_t g_fusion_rate = 0;
+
+/** Flag if the magnetometer is used, without it only roll and pitch are valid */
+bool g_fusion_use_mag = false;
+
+/** Mahony filter gains, proportional and integral (gyro bias) */
+#define FUSION_TWO_KP (2.0f * 0.5f)
+#define FUSION_TWO_KI (2.0f * 0.05f)
+
+/** Max sample pairs handled per cycle, the ring holds not more */
+#define FUSION_MAX_SAMPLES (IMU_RING_SIZE / 2)
+
+/** Gaps longer than this are skipped instead of integrated, in micro seconds */
+#define FUSION_MAX_GAP 100000
+
+/** Span every magnetometer axis must have seen before the hard-iron offset is used, in nT
+ *  The earth magnetic field is 25 to 65 uT, a full turn around an axis covers twice of it */
+#define FUSION_MAG_MIN_SPAN 40000
+
+/** mdps to rad/s */
+#define FUSION_MDPS_TO_RAD (0.001f * (float)M_PI / 180.0f)
+/** rad to degree */
+#define FUSION_RAD_TO_DEG (180.0f / (float)M_PI)
+
+/** Orientation quaternion */
+static float q0 = 1.0f;
+static float q1 = 0.0f;
+static float q2 = 0.0f;
+static float q3 = 0.0f;
+
+/** Integral error terms (gyro bias estimation) */
+static float integral_x = 0.0f;
+static float integral_y = 0.0f;
+static float integral_z = 0.0f;
+
+/** Timestamp of the last processed sample */
+static uint32_t last_sample_time = 0;
+
+/** Flag if the quaternion was initialized from the accelerometer */
+static bool fusion_started = false;
+
+/** Module used for the fusion, IMU_SRC_RAK1905 or IMU_SRC_RAK12034 */
+static uint8_t fusion_source = IMU_SRC_RAK1905;
+
+/** Last calculated orientation */
+static fusion_angles_t fusion_angles = {0.0f, 0.0f, 0.0f};
+/** Flag if fusion_angles holds a result, read by the app loop */
+static bool fusion_valid = false;
+/** Flag if the fusion task and its mutex were created */
+static bool fusion_running = false;
+
+/** Magnetometer extremes seen since start, used for the hard-iron offset */
+static float mag_min[3] = {0.0f, 0.0f, 0.0f};
+static float mag_max[3] = {0.0f, 0.0f, 0.0f};
+static bool mag_seen = false;
+
+/** Flag if the hard-iron offset is known, only then the heading is valid */
+static bool mag_calibrated = false;
+/** Flag if the heading of fusion_angles is valid, read by the app loop */
+static bool fusion_yaw_valid = false;
+
+/** Sample buffers, only used by the fusion task */
+static imu_sample_t acc_samples[FUSION_MAX_SAMPLES];
+static imu_sample_t gyro_samples[FUSION_MAX_SAMPLES];
+
+#if defined NRF52_SERIES || defined ESP32
+/** Task handle */
+TaskHandle_t fusion_task_handle;
+
+/** Task declaration */
+void fusion_task(void *pvParameters);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** The fusion thread */
+Thread fusion_task_handle(osPriorityLow, 4096);
+
+/** Task declaration */
+void fusion_task(void);
+#endif
+
+/** Result access from the app loop and the fusion task */
+#if defined NRF52_SERIES || defined ESP32
+static SemaphoreHandle_t fusion_mutex = NULL;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+static Mutex fusion_mutex;
+#endif
+
+/**
+ * @brief Lock the fusion result
+ *
+ */
+static void fusion_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreTake(fusion_mutex, portMAX_DELAY);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	fusion_mutex.lock();
+#endif
+}
+
+/**
+ * @brief Unlock the fusion result
+ *
+ */
+static void fusion_unlock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGive(fusion_mutex);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	fusion_mutex.unlock();
+#endif
+}
+
+/**
+ * @brief Start the quaternion from the direction of gravity, yaw is 0
+ *
+ * @param ax acceleration x
+ * @param ay acceleration y
+ * @param az acceleration z
+ */
+static void fusion_start(float ax, float ay, float az)
+{
+	float roll = atan2f(ay, az);
+	float pitch = atan2f(-ax, sqrtf(ay * ay + az * az));
+
+	float cr = cosf(roll * 0.5f);
+	float sr = sinf(roll * 0.5f);
+	float cp = cosf(pitch * 0.5f);
+	float sp = sinf(pitch * 0.5f);
+
+	q0 = cr * cp;
+	q1 = sr * cp;
+	q2 = cr * sp;
+	q3 = -sr * sp;
+
+	integral_x = 0.0f;
+	integral_y = 0.0f;
+	integral_z = 0.0f;
+	fusion_started = true;
+}
+
+/**
+ * @brief Remove the hard-iron offset from a magnetometer sample
+ *     The offset is the center of the extremes seen on each axis. It is
+ *     learned while the device is turned and only used once every axis
+ *     covered FUSION_MAG_MIN_SPAN. Soft-iron distortion is not corrected.
+ *
+ * @param mag magnetometer x/y/z in nT, offset is removed in place
+ * @return true offset is known and was removed
+ * @return false not turned enough yet, sample must not be used
+ */
+static bool mag_hard_iron(float *mag)
+{
+	bool all_spans = true;
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		if (!mag_seen || (mag[axis] < mag_min[axis]))
+		{
+			mag_min[axis] = mag[axis];
+		}
+		if (!mag_seen || (mag[axis] > mag_max[axis]))
+		{
+			mag_max[axis] = mag[axis];
+		}
+		if ((mag_max[axis] - mag_min[axis]) < FUSION_MAG_MIN_SPAN)
+		{
+			all_spans = false;
+		}
+	}
+	mag_seen = true;
+
+	if (!all_spans)
+	{
+		return false;
+	}
+	if (!mag_calibrated)
+	{
+		// Center of the extremes, nT => uT
+		MYLOG("FUSION", "Hard-iron offset %.1f %.1f %.1f uT", (mag_max[0] + mag_min[0]) * 0.0005f,
+			  (mag_max[1] + mag_min[1]) * 0.0005f, (mag_max[2] + mag_min[2]) * 0.0005f);
+		mag_calibrated = true;
+	}
+	for (uint8_t axis = 0; axis < 3; axis++)
+	{
+		mag[axis] -= (mag_max[axis] + mag_min[axis]) * 0.5f;
+	}
+	return true;
+}
+
+/**
+ * @brief Mahony filter update
+ *
+ * @param gx gyroscope x in rad/s
+ * @param gy gyroscope y in rad/s
+ * @param gz gyroscope z in rad/s
+ * @param ax acceleration x, any unit
+ * @param ay acceleration y, any unit
+ * @param az acceleration z, any unit
+ * @param mag magnetometer x/y/z in any unit, NULL if not used
+ * @param dt time since the last update in seconds
+ */
+static void mahony_update(float gx, float gy, float gz, float ax, float ay, float az, const float *mag, float dt)
+{
+	// Only use the accelerometer if it has a valid measurement
+	if (!((ax == 0.0f) && (ay == 0.0f) && (az == 0.0f)))
+	{
+		float recip_norm = 1.0f / sqrtf(ax * ax + ay * ay + az * az);
+		ax *= recip_norm;
+		ay *= recip_norm;
+		az *= recip_norm;
+
+		// Estimated direction of gravity
+		float half_vx = q1 * q3 - q0 * q2;
+		float half_vy = q0 * q1 + q2 * q3;
+		float half_vz = q0 * q0 - 0.5f + q3 * q3;
+
+		// Error is the cross product between estimated and measured direction of gravity
+		float half_ex = ay * half_vz - az * half_vy;
+		float half_ey = az * half_vx - ax * half_vz;
+		float half_ez = ax * half_vy - ay * half_vx;
+
+		if ((mag != NULL) && !((mag[0] == 0.0f) && (mag[1] == 0.0f) && (mag[2] == 0.0f)))
+		{
+			recip_norm = 1.0f / sqrtf(mag[0] * mag[0] + mag[1] * mag[1] + mag[2] * mag[2]);
+			float mx = mag[0] * recip_norm;
+			float my = mag[1] * recip_norm;
+			float mz = mag[2] * recip_norm;
+
+			float q0q1 = q0 * q1;
+			float q0q2 = q0 * q2;
+			float q0q3 = q0 * q3;
+			float q1q1 = q1 * q1;
+			float q1q2 = q1 * q2;
+			float q1q3 = q1 * q3;
+			float q2q2 = q2 * q2;
+			float q2q3 = q2 * q3;
+			float q3q3 = q3 * q3;
+
+			// Reference direction of the earth magnetic field
+			float hx = 2.0f * (mx * (0.5f - q2q2 - q3q3) + my * (q1q2 - q0q3) + mz * (q1q3 + q0q2));
+			float hy = 2.0f * (mx * (q1q2 + q0q3) + my * (0.5f - q1q1 - q3q3) + mz * (q2q3 - q0q1));
+			float bx = sqrtf(hx * hx + hy * hy);
+			float bz = 2.0f * (mx * (q1q3 - q0q2) + my * (q2q3 + q0q1) + mz * (0.5f - q1q1 - q2q2));
+
+			// Estimated direction of the magnetic field
+			float half_wx = bx * (0.5f - q2q2 - q3q3) + bz * (q1q3 - q0q2);
+			float half_wy = bx * (q1q2 - q0q3) + bz * (q0q1 + q2q3);
+			float half_wz = bx * (q0q2 + q1q3) + bz * (0.5f - q1q1 - q2q2);
+
+			half_ex += my * half_wz - mz * half_wy;
+			half_ey += mz * half_wx - mx * half_wz;
+			half_ez += mx * half_wy - my * half_wx;
+		}
+
+		// Integral feedback estimates the gyro bias
+		integral_x += FUSION_TWO_KI * half_ex * dt;
+		integral_y += FUSION_TWO_KI * half_ey * dt;
+		integral_z += FUSION_TWO_KI * half_ez * dt;
+		gx += integral_x + FUSION_TWO_KP * half_ex;
+		gy += integral_y + FUSION_TWO_KP * half_ey;
+		gz += integral_z + FUSION_TWO_KP * half_ez;
+	}
+
+	// Integrate the rate of change of the quaternion
+	gx *= 0.5f * dt;
+	gy *= 0.5f * dt;
+	gz *= 0.5f * dt;
+	float qa = q0;
+	float qb = q1;
+	float qc = q2;
+	q0 += -qb * gx - qc * gy - q3 * gz;
+	q1 += qa * gx + qc * gz - q3 * gy;
+	q2 += qa * gy - qb * gz + q3 * gx;
+	q3 += qa * gz + qb * gy - qc * gx;
+
+	float recip_norm = 1.0f / sqrtf(q0 * q0 + q1 * q1 + q2 * q2 + q3 * q3);
+	q0 *= recip_norm;
+	q1 *= recip_norm;
+	q2 *= recip_norm;
+	q3 *= recip_norm;
+}
+
+/**
+ * @brief One fusion cycle, drain the FIFO and process all new samples
+ *
+ */
+static void fusion_cycle(void)
+{
+	float mag[3] = {0.0f, 0.0f, 0.0f};
+	bool has_mag = false;
+
+	i2c_lock();
+	if (fusion_source == IMU_SRC_RAK1905)
+	{
+		read_fifo_rak1905();
+		if (g_fusion_use_mag)
+		{
+			read_mag_rak1905();
+		}
+	}
+	else
+	{
+		read_fifo_rak12034();
+		if (g_fusion_use_mag)
+		{
+			read_mag_rak12034();
+		}
+	}
+	i2c_unlock();
+
+	if (g_fusion_use_mag)
+	{
+		imu_sample_t mag_sample;
+		if (imu_get_samples(fusion_source, IMU_TYPE_MAG, &mag_sample, 1) == 1)
+		{
+			mag[0] = (float)mag_sample.x;
+			mag[1] = (float)mag_sample.y;
+			mag[2] = (float)mag_sample.z;
+			// Without the hard-iron offset the heading would be wrong, keep the gyro heading
+			has_mag = mag_hard_iron(mag);
+		}
+	}
+
+	uint16_t num_acc = imu_get_samples(fusion_source, IMU_TYPE_ACC, acc_samples, FUSION_MAX_SAMPLES);
+	uint16_t num_gyro = imu_get_samples(fusion_source, IMU_TYPE_GYRO, gyro_samples, FUSION_MAX_SAMPLES);
+
+	// Accelerometer and gyroscope samples come from the same FIFO frames and share the timestamps
+	uint16_t acc_idx = 0;
+	for (uint16_t gyro_idx = 0; gyro_idx < num_gyro; gyro_idx++)
+	{
+		imu_sample_t *gyro = &gyro_samples[gyro_idx];
+		int32_t age = (int32_t)(gyro->timestamp - last_sample_time);
+		if (fusion_started && (age <= 0))
+		{
+			// Already processed
+			continue;
+		}
+		while ((acc_idx < num_acc) && ((int32_t)(acc_samples[acc_idx].timestamp - gyro->timestamp) < 0))
+		{
+			acc_idx++;
+		}
+		if ((acc_idx >= num_acc) || (acc_samples[acc_idx].timestamp != gyro->timestamp))
+		{
+			continue;
+		}
+		imu_sample_t *acc = &acc_samples[acc_idx];
+
+		if (!fusion_started)
+		{
+			// First sample, start from gravity
+			fusion_start((float)acc->x, (float)acc->y, (float)acc->z);
+		}
+		else if (age > FUSION_MAX_GAP)
+		{
+			// Samples were lost while the bus was busy, keep the orientation.
+			// The rotation during the gap is unknown, the accelerometer corrects
+			// roll and pitch within a few seconds, the heading keeps its value.
+			MYLOG("FUSION", "Gap of %ld ms skipped", age / 1000);
+		}
+		else
+		{
+			mahony_update((float)gyro->x * FUSION_MDPS_TO_RAD, (float)gyro->y * FUSION_MDPS_TO_RAD, (float)gyro->z * FUSION_MDPS_TO_RAD,
+						  (float)acc->x, (float)acc->y, (float)acc->z,
+						  has_mag ? mag : NULL, (float)age * 1.0e-6f);
+		}
+		last_sample_time = gyro->timestamp;
+	}
+
+	if (!fusion_started)
+	{
+		return;
+	}
+
+	float sin_pitch = -2.0f * (q1 * q3 - q0 * q2);
+	if (sin_pitch > 1.0f)
+	{
+		sin_pitch = 1.0f;
+	}
+	else if (sin_pitch < -1.0f)
+	{
+		sin_pitch = -1.0f;
+	}
+	fusion_angles_t angles;
+	angles.roll = atan2f(q0 * q1 + q2 * q3, 0.5f - q1 * q1 - q2 * q2) * FUSION_RAD_TO_DEG;
+	angles.pitch = asinf(sin_pitch) * FUSION_RAD_TO_DEG;
+	angles.yaw = atan2f(q1 * q2 + q0 * q3, 0.5f - q2 * q2 - q3 * q3) * FUSION_RAD_TO_DEG;
+
+	fusion_lock();
+	fusion_angles = angles;
+	fusion_valid = true;
+	fusion_yaw_valid = has_mag;
+	fusion_unlock();
+}
+
+/**
+ * @brief Fusion task, runs the fusion cycle with the selected rate
+ *
+ */
+#if defined NRF52_SERIES || defined ESP32
+void fusion_task(void *pvParameters)
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	void fusion_task(void)
+#endif
+{
+	MYLOG("FUSION", "Fusion task started");
+#if defined NRF52_SERIES || defined ESP32
+	TickType_t last_wake = xTaskGetTickCount();
+#endif
+	while (1)
+	{
+		if (g_fusion_rate == 0)
+		{
+			// Fusion is disabled, check again later
+			fusion_started = false;
+			fusion_lock();
+			fusion_valid = false;
+			fusion_unlock();
+			delay(1000);
+#if defined NRF52_SERIES || defined ESP32
+			last_wake = xTaskGetTickCount();
+#endif
+			continue;
+		}
+
+		fusion_cycle();
+
+#if defined NRF52_SERIES || defined ESP32
+		vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(1000 / g_fusion_rate));
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+		delay(1000 / g_fusion_rate);
+#endif
+	}
+}
+
+/**
+ * @brief Start the fusion task
+ *     RAK1905 is used if available, otherwise RAK12034
+ *
+ * @return true task started
+ * @return false no 9DOF module or task could not be started
+ */
+bool init_fusion(void)
+{
+	if (found_sensors[MPU_ID].found_sensor)
+	{
+		fusion_source = IMU_SRC_RAK1905;
+	}
+	else if (found_sensors[DOF_ID].found_sensor)
+	{
+		fusion_source = IMU_SRC_RAK12034;
+	}
+	else
+	{
+		return false;
+	}
+
+#if defined NRF52_SERIES || defined ESP32
+	// Created before the task starts, the app loop and the task use it
+	fusion_mutex = xSemaphoreCreateMutex();
+	if (fusion_mutex == NULL)
+	{
+		MYLOG("FUSION", "Failed to create the mutex");
+		return false;
+	}
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	fusion_task_handle.start(fusion_task);
+	fusion_task_handle.set_priority(osPriorityLow);
+#endif
+#if defined NRF52_SERIES || defined ESP32
+	if (!xTaskCreate(fusion_task, "FUSION", 4096, NULL, TASK_PRIO_LOW, &fusion_task_handle))
+	{
+		MYLOG("FUSION", "Failed to start fusion task");
+		return false;
+	}
+#endif
+	fusion_running = true;
+	return true;
+}
+
+/**
+ * @brief Set the fusion rate and the magnetometer usage
+ *
+ * @param new_rate rate in Hz, 0 disables the fusion, otherwise FUSION_RATE_MIN to FUSION_RATE_MAX
+ * @param use_mag true to use the magnetometer for the heading
+ * @return true settings are valid
+ * @return false rate is not supported
+ */
+bool set_fusion(uint8_t new_rate, bool use_mag)
+{
+	if ((new_rate != 0) && ((new_rate < FUSION_RATE_MIN) || (new_rate > FUSION_RATE_MAX)))
+	{
+		return false;
+	}
+	g_fusion_use_mag = use_mag;
+	g_fusion_rate = new_rate;
+	return true;
+}
+
+/**
+ * @brief Add the orientation to the payload
+ *     Data is added to Cayenne LPP payload as channels
+ *     LPP_CHANNEL_ROLL, LPP_CHANNEL_PITCH and if the magnetometer
+ *     is used and its hard-iron offset is known LPP_CHANNEL_YAW
+ *
+ */
+void read_fusion(void)
+{
+	if ((g_fusion_rate == 0) || !fusion_running)
+	{
+		return;
+	}
+
+	fusion_lock();
+	fusion_angles_t angles = fusion_angles;
+	bool valid = fusion_valid;
+	bool yaw_valid = fusion_yaw_valid;
+	fusion_unlock();
+	if (!valid)
+	{
+		return;
+	}
+	MYLOG("FUSION", "Roll %.2f Pitch %.2f Yaw %.2f", angles.roll, angles.pitch, angles.yaw);
+
+	g_solution_data.addAnalogInput(LPP_CHANNEL_ROLL, angles.roll);
+	g_solution_data.addAnalogInput(LPP_CHANNEL_PITCH, angles.pitch);
+	if (g_fusion_use_mag && yaw_valid)
+	{
+		g_solution_data.addAnalogInput(LPP_CHANNEL_YAW, angles.yaw);
+	}
+}
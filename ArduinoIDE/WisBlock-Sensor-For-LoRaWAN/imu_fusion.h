@@ -0,0 +1,33 @@
+/**
+ * @file imu_fusion.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the orientation sensor fusion
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef IMU_FUSION_H
+#define IMU_FUSION_H
+#include <Arduino.h>
+
+/** Fusion rate limits in Hz, below the minimum the 9DOF FIFO's overflow */
+#define FUSION_RATE_MIN 5
+#define FUSION_RATE_MAX 100
+
+/** Orientation in degrees */
+typedef struct fusion_angles_s
+{
+	float roll;
+	float pitch;
+	float yaw; // Only valid if the magnetometer is used and its hard-iron offset is known
+} fusion_angles_t;
+
+bool init_fusion(void);
+bool set_fusion(uint8_t new_rate, bool use_mag);
+void read_fusion(void);
+extern uint8_t g_fusion_rate;
+extern bool g_fusion_use_mag;
+
+#endif // IMU_FUSION_H
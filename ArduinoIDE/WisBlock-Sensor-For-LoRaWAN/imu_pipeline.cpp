@@ -0,0 +1,203 @@
+/**
+ * @file imu_pipeline.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Shared inertial sample pipeline
+ *        All IMU modules drain their FIFO's into one fixed size ring.
+ *        Samples are timestamped and scaled into fixed point units
+ *        once when they are added, analysis functions work on the ring
+ *        independent of the module that delivered the data.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Sample ring */
+static imu_sample_t imu_ring[IMU_RING_SIZE];
+/** Index where the next sample will be written */
+static uint16_t imu_ring_head = 0;
+/** Number of valid samples in the ring */
+static uint16_t imu_ring_count = 0;
+
+#if defined NRF52_SERIES || defined ESP32
+/** Ring access from the app loop and the fusion task */
+static SemaphoreHandle_t imu_ring_mutex = NULL;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** Ring access from the app loop and the fusion thread */
+static Mutex imu_ring_mutex;
+#endif
+
+/**
+ * @brief Create the sample ring lock, must be called before any sensor task starts
+ *
+ */
+void init_imu_pipeline(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	imu_ring_mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+/**
+ * @brief Lock the sample ring
+ *
+ */
+static void imu_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreTake(imu_ring_mutex, portMAX_DELAY);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	imu_ring_mutex.lock();
+#endif
+}
+
+/**
+ * @brief Unlock the sample ring
+ *
+ */
+static void imu_unlock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGive(imu_ring_mutex);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	imu_ring_mutex.unlock();
+#endif
+}
+
+/**
+ * @brief Add a block of raw samples drained from a FIFO
+ *
+ * @param source module that delivered the samples (IMU_SRC_xxx)
+ * @param type sample type (IMU_TYPE_xxx)
+ * @param raw raw values, interleaved x, y, z
+ * @param num_samples number of x/y/z samples
+ * @param scale Q8 scale factor from raw value to the unit of the sample type
+ * @param odr output data rate in Hz, used to timestamp the samples
+ * @param last_timestamp micros() of the last (newest) sample in the block
+ * @return uint16_t number of samples added
+ */
+uint16_t imu_push_block(uint8_t source, uint8_t type, const int16_t *raw, uint16_t num_samples, int32_t scale, uint16_t odr, uint32_t last_timestamp)
+{
+	if ((num_samples == 0) || (odr == 0))
+	{
+		return 0;
+	}
+
+	uint32_t period = 1000000UL / odr;
+	imu_lock();
+	for (uint16_t idx = 0; idx < num_samples; idx++)
+	{
+		imu_sample_t *sample = &imu_ring[imu_ring_head];
+		sample->timestamp = last_timestamp - (uint32_t)(num_samples - 1 - idx) * period;
+		sample->x = (int32_t)(((int64_t)raw[idx * 3] * scale) >> IMU_SCALE_SHIFT);
+		sample->y = (int32_t)(((int64_t)raw[idx * 3 + 1] * scale) >> IMU_SCALE_SHIFT);
+		sample->z = (int32_t)(((int64_t)raw[idx * 3 + 2] * scale) >> IMU_SCALE_SHIFT);
+		sample->source = source;
+		sample->type = type;
+
+		imu_ring_head = (imu_ring_head + 1) % IMU_RING_SIZE;
+		if (imu_ring_count < IMU_RING_SIZE)
+		{
+			imu_ring_count++;
+		}
+	}
+	imu_unlock();
+	return num_samples;
+}
+
+/**
+ * @brief Get the newest samples of a module and type
+ *
+ * @param source module (IMU_SRC_xxx)
+ * @param type sample type (IMU_TYPE_xxx)
+ * @param samples buffer for the samples, oldest sample first
+ * @param max_samples size of the buffer
+ * @return uint16_t number of samples copied
+ */
+uint16_t imu_get_samples(uint8_t source, uint8_t type, imu_sample_t *samples, uint16_t max_samples)
+{
+	imu_lock();
+	// Count matching samples from the newest backwards
+	uint16_t found = 0;
+	uint16_t oldest_idx = imu_ring_head;
+	for (uint16_t count = 0; (count < imu_ring_count) && (found < max_samples); count++)
+	{
+		uint16_t idx = (imu_ring_head + IMU_RING_SIZE - 1 - count) % IMU_RING_SIZE;
+		if ((imu_ring[idx].source == source) && (imu_ring[idx].type == type))
+		{
+			found++;
+			oldest_idx = idx;
+		}
+	}
+
+	// Copy them in chronological order
+	uint16_t copied = 0;
+	for (uint16_t idx = oldest_idx; copied < found; idx = (idx + 1) % IMU_RING_SIZE)
+	{
+		if ((imu_ring[idx].source == source) && (imu_ring[idx].type == type))
+		{
+			samples[copied++] = imu_ring[idx];
+		}
+	}
+	imu_unlock();
+	return copied;
+}
+
+/**
+ * @brief Discard all samples
+ *
+ */
+void imu_clear(void)
+{
+	imu_lock();
+	imu_ring_head = 0;
+	imu_ring_count = 0;
+	imu_unlock();
+}
+
+/**
+ * @brief Calculate vibration features from the newest acceleration samples of a module
+ *
+ * @param source module (IMU_SRC_xxx)
+ * @param num_samples number of newest samples to use, e.g. the last burst, at most VIB_FFT_SIZE
+ * @param features pointer to the result structure
+ * @return true features calculated
+ * @return false not enough samples
+ */
+bool imu_vib_features(uint8_t source, uint16_t num_samples, vib_features_t *features)
+{
+	imu_sample_t samples[VIB_FFT_SIZE];
+	if (num_samples > VIB_FFT_SIZE)
+	{
+		num_samples = VIB_FFT_SIZE;
+	}
+	num_samples = imu_get_samples(source, IMU_TYPE_ACC, samples, num_samples);
+	if (num_samples < 2)
+	{
+		return false;
+	}
+
+	// Magnitude in m/s^2
+	float magnitude[VIB_FFT_SIZE];
+	for (uint16_t idx = 0; idx < num_samples; idx++)
+	{
+		float x = (float)samples[idx].x;
+		float y = (float)samples[idx].y;
+		float z = (float)samples[idx].z;
+		magnitude[idx] = sqrtf(x * x + y * y + z * z) * 9.80665e-6f;
+	}
+
+	uint32_t duration = samples[num_samples - 1].timestamp - samples[0].timestamp;
+	if (duration == 0)
+	{
+		return false;
+	}
+	float sample_rate = (float)(num_samples - 1) * 1000000.0f / (float)duration;
+
+	return calc_vib_features(magnitude, num_samples, sample_rate, features);
+}
@@ -0,0 +1,50 @@
+/**
+ * @file imu_pipeline.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the shared inertial sample pipeline
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef IMU_PIPELINE_H
+#define IMU_PIPELINE_H
+#include <Arduino.h>
+
+/** Modules feeding the pipeline */
+#define IMU_SRC_RAK1904 0
+#define IMU_SRC_RAK1905 1
+#define IMU_SRC_RAK12025 2
+#define IMU_SRC_RAK12032 3
+#define IMU_SRC_RAK12034 4
+
+/** Sample types and their fixed point units */
+#define IMU_TYPE_ACC 0	// micro g
+#define IMU_TYPE_GYRO 1 // milli degree per second
+#define IMU_TYPE_MAG 2	// nano Tesla
+
+/** Number of samples the ring can hold, shared by all modules */
+#define IMU_RING_SIZE 256
+
+/** Scale factors are Q8 fixed point, unit value = (raw * scale) >> IMU_SCALE_SHIFT */
+#define IMU_SCALE_SHIFT 8
+
+/** One inertial sample, already scaled to the unit of its type */
+typedef struct imu_sample_s
+{
+	uint32_t timestamp; // micros() when the sample was taken
+	int32_t x;
+	int32_t y;
+	int32_t z;
+	uint8_t source; // IMU_SRC_xxx
+	uint8_t type;	// IMU_TYPE_xxx
+} imu_sample_t;
+
+void init_imu_pipeline(void);
+uint16_t imu_push_block(uint8_t source, uint8_t type, const int16_t *raw, uint16_t num_samples, int32_t scale, uint16_t odr, uint32_t last_timestamp);
+uint16_t imu_get_samples(uint8_t source, uint8_t type, imu_sample_t *samples, uint16_t max_samples);
+void imu_clear(void);
+bool imu_vib_features(uint8_t source, uint16_t num_samples, vib_features_t *features);
+
+#endif // IMU_PIPELINE_H
@@ -484,6 +484,17 @@ void find_modules(void)
 		}
 	}
 
+	if (found_sensors[VOC_ID].found_sensor)
+	{
+		// 0x59 is shared with the RAK5814, check for the ATECC608 first
+		if (init_rak5814())
+		{
+			MYLOG("APP", "RAK5814 init success");
+			found_sensors[ECC_ID].found_sensor = true;
+			found_sensors[VOC_ID].found_sensor = false;
+		}
+	}
+
 	if (found_sensors[VOC_ID].found_sensor)
 	{
 		MYLOG("APP", "Initialize RAK12047");
@@ -926,6 +937,29 @@ void get_sensor_values(void)
 		// Read environment data
 		read_rak1903();
 	}
+	if (found_sensors[ACC_ID].found_sensor)
+	{
+		// Get the vibration analysis, does nothing if it is not enabled
+		read_rak1904();
+	}
+	// Drain the IMU FIFO's into the inertial pipeline, while the fusion is running the fusion task drains the 9DOF FIFO's
+	if (found_sensors[MPU_ID].found_sensor && (g_fusion_rate == 0))
+	{
+		read_fifo_rak1905();
+	}
+	if (found_sensors[ACC2_ID].found_sensor)
+	{
+		read_fifo_rak12032();
+	}
+	if (found_sensors[DOF_ID].found_sensor && (g_fusion_rate == 0))
+	{
+		read_fifo_rak12034();
+	}
+	if (found_sensors[MPU_ID].found_sensor || found_sensors[DOF_ID].found_sensor)
+	{
+		// Get the orientation, does nothing if the fusion is not enabled
+		read_fusion();
+	}
 	/*********************************************/
 	/** Select between Bosch BSEC algorithm for  */
 	/** IAQ index or simple T/H/P readings       */
@@ -954,12 +988,11 @@ void get_sensor_values(void)
 		// Get the MQ2 sensor values
 		read_rak12004();
 	}
-	// RAK12008 needs readings from temperature/humidity/pressure sensors. Readings will be gotten in app.cpp
-	// if (found_sensors[SCT31_ID].found_sensor)
-	// {
-	// 	// Get the SCT31 sensor values
-	// 	read_rak12008();
-	// }
+	if (found_sensors[SCT31_ID].found_sensor)
+	{
+		// Get the SCT31 sensor values, compensation values are taken from the environment context
+		read_rak12008();
+	}
 	if (found_sensors[MQ3_ID].found_sensor)
 	{
 		// Get the MQ3 sensor values
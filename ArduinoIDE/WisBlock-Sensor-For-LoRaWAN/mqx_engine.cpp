@@ -0,0 +1,390 @@
+/**
+ * @file mqx_engine.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Measurement engine for the MQx gas sensors RAK12004 and RAK12009
+ *        The heater is switched on a pre-heat time before each uplink.
+ *        After the pre-heat the ADC is oversampled, the highest and lowest
+ *        samples are discarded and the rest is averaged. The heater is
+ *        switched off until the next measurement.
+ *        RAK12004 and RAK12009 share the heater enable pin, one task
+ *        measures all modules that were found, each with its own ADC and R0.
+ *        R0 is calibrated once after the first pre-heat and saved.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+#include <ADC121C021.h>
+
+/** Heater pre-heat time in seconds */
+uint16_t g_mqx_preheat = MQX_PREHEAT_DEFAULT;
+/** Number of ADC samples per measurement */
+uint8_t g_mqx_samples = MQX_SAMPLES_DEFAULT;
+/** Sensor resistance in clean air per sensor, 0 if not calibrated */
+float g_mqx_r0[MQX_NUM] = {0.0, 0.0};
+
+/** Measurement context of one sensor */
+typedef struct mqx_context_s
+{
+	ADC121C021 *sensor; // ADC of the module, NULL if not found
+	float ppm;			// Result of the last measurement
+	bool valid;			// Flag if the last measurement is valid
+	bool taken;			// Flag if the uplink took the result
+} mqx_context_t;
+
+/** Contexts of MQ2 and MQ3 */
+static mqx_context_t mqx_ctx[MQX_NUM];
+
+/** Engine states */
+#define MQX_SLEEP 0	   // Heater off, waiting for the pre-heat before the next uplink
+#define MQX_MEASURING 1 // Heater on, pre-heating and sampling
+#define MQX_DONE 2	   // Result ready, waiting for the uplink
+static volatile uint8_t mqx_state = MQX_DONE;
+
+/** Heater status, starts as off to force a full pre-heat before the first measurement */
+static bool mqx_heater_on = false;
+
+/** Flag set by the uplink when the results of all sensors were sent */
+static volatile bool mqx_uplink_done = false;
+/** Flag if the task is running */
+static bool mqx_started = false;
+/** Flag set by AT+MQXCAL to calibrate R0 with the next measurement */
+static volatile bool mqx_calibrate = false;
+/** millis() of the last uplink that consumed the result */
+static time_t mqx_last_uplink = 0;
+
+#if defined NRF52_SERIES || defined ESP32
+/** Task handle */
+TaskHandle_t mqx_task_handle;
+
+/** Task declaration */
+void mqx_task(void *pvParameters);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** The engine thread */
+Thread mqx_task_handle(osPriorityLow, 4096);
+
+/** Task declaration */
+void mqx_task(void);
+#endif
+
+/**
+ * @brief Get the time from heater on to the end of the measurement
+ *
+ * @return uint32_t time in ms
+ */
+static uint32_t mqx_lead_time(void)
+{
+	return ((uint32_t)g_mqx_preheat + MQX_MARGIN) * 1000 + (uint32_t)g_mqx_samples * MQX_SAMPLE_INTERVAL;
+}
+
+/**
+ * @brief Check if the heater has to stay on permanently
+ *     If the pre-heat does not fit into the send interval, the heater is never switched off
+ *
+ * @return true heater stays on
+ * @return false heater is switched off between uplinks
+ */
+static bool mqx_always_on(void)
+{
+	return (g_lorawan_settings.send_repeat_time == 0) || (g_lorawan_settings.send_repeat_time <= mqx_lead_time());
+}
+
+/**
+ * @brief Switch the heater and the ADC on or off
+ *
+ * @param on true to switch the heater on
+ */
+static void mqx_heater(bool on)
+{
+	digitalWrite(EN_PIN, on ? HIGH : LOW);
+	mqx_heater_on = on;
+}
+
+/**
+ * @brief Check if R0 of a sensor that was found is missing
+ *
+ * @return true at least one sensor needs a calibration
+ * @return false all sensors are calibrated
+ */
+static bool mqx_r0_missing(void)
+{
+	for (uint8_t idx = 0; idx < MQX_NUM; idx++)
+	{
+		if ((mqx_ctx[idx].sensor != NULL) && (g_mqx_r0[idx] == 0.0))
+		{
+			return true;
+		}
+	}
+	return false;
+}
+
+/**
+ * @brief Oversample a value with outlier rejection
+ *     Invalid samples are dropped, from the remaining samples
+ *     the highest and lowest quarter are discarded and the rest is averaged
+ *
+ * @param sensor ADC of the sensor
+ * @param calibrate true to sample R0, false to sample the PPM value
+ * @param result pointer to the averaged value
+ * @return true enough valid samples
+ * @return false too many invalid samples
+ */
+static bool mqx_oversample(ADC121C021 *sensor, bool calibrate, float *result)
+{
+	float samples[MQX_SAMPLES_MAX];
+	uint8_t num_samples = 0;
+
+	for (uint8_t idx = 0; idx < g_mqx_samples; idx++)
+	{
+		// The ADC shares the I2C bus with the app loop, lock only the conversion, not the sample interval
+		i2c_lock();
+		float value = calibrate ? sensor->calibrateR0(RatioGasCleanAir) : sensor->readSensor();
+		i2c_unlock();
+		if (!isinf(value) && !isnan(value))
+		{
+			// Insert sorted
+			uint8_t pos = num_samples;
+			while ((pos > 0) && (samples[pos - 1] > value))
+			{
+				samples[pos] = samples[pos - 1];
+				pos--;
+			}
+			samples[pos] = value;
+			num_samples++;
+		}
+		delay(MQX_SAMPLE_INTERVAL);
+	}
+
+	if (num_samples < (g_mqx_samples / 2))
+	{
+		MYLOG("MQX", "Only %d of %d samples valid", num_samples, g_mqx_samples);
+		return false;
+	}
+
+	uint8_t trim = num_samples / 4;
+	float sum = 0.0;
+	for (uint8_t idx = trim; idx < num_samples - trim; idx++)
+	{
+		sum += samples[idx];
+	}
+	*result = sum / (num_samples - 2 * trim);
+	return true;
+}
+
+/**
+ * @brief Engine task
+ *     Switches the heater on the pre-heat time before the next uplink,
+ *     oversamples each sensor and switches the heater off again
+ *
+ */
+#if defined NRF52_SERIES || defined ESP32
+void mqx_task(void *pvParameters)
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	void mqx_task(void)
+#endif
+{
+	MYLOG("MQX", "Engine task started");
+	mqx_last_uplink = millis();
+	while (1)
+	{
+		// Wait until the pre-heat time before the next uplink
+		mqx_state = MQX_SLEEP;
+		if (!mqx_always_on() && !mqx_calibrate && !mqx_r0_missing())
+		{
+			mqx_heater(false);
+			uint32_t sleep_time = g_lorawan_settings.send_repeat_time - mqx_lead_time();
+			// Check once a second for a calibration request
+			while (((millis() - mqx_last_uplink) < sleep_time) && !mqx_calibrate)
+			{
+				delay(1000);
+			}
+		}
+
+		// Pre-heat, the ADC is powered together with the heater
+		mqx_state = MQX_MEASURING;
+		if (!mqx_heater_on)
+		{
+			mqx_heater(true);
+			delay(g_mqx_preheat * 1000);
+		}
+
+		bool calibrate = mqx_calibrate;
+		mqx_calibrate = false;
+		for (uint8_t idx = 0; idx < MQX_NUM; idx++)
+		{
+			mqx_context_t *ctx = &mqx_ctx[idx];
+			if (ctx->sensor == NULL)
+			{
+				continue;
+			}
+
+			// Calibrate R0 if never done or requested
+			if ((g_mqx_r0[idx] == 0.0) || calibrate)
+			{
+				float new_r0;
+				if (mqx_oversample(ctx->sensor, true, &new_r0) && (new_r0 != 0.0))
+				{
+					mqx_set_r0(idx, new_r0);
+					save_mqx_settings();
+					MYLOG("MQX", "R0 of MQ%d calibrated to %.2f", idx == MQX_MQ2 ? 2 : 3, g_mqx_r0[idx]);
+				}
+				else
+				{
+					MYLOG("MQX", "R0 calibration of MQ%d failed, check the sensor", idx == MQX_MQ2 ? 2 : 3);
+				}
+			}
+
+			ctx->valid = false;
+			if (g_mqx_r0[idx] != 0.0)
+			{
+				ctx->valid = mqx_oversample(ctx->sensor, false, &ctx->ppm);
+			}
+			ctx->taken = false;
+		}
+		if (!mqx_always_on())
+		{
+			mqx_heater(false);
+		}
+
+		// Wait for the uplink to take the result
+		mqx_uplink_done = false;
+		mqx_state = MQX_DONE;
+		while (!mqx_uplink_done && !mqx_calibrate)
+		{
+			delay(100);
+		}
+	}
+}
+
+/**
+ * @brief Add a sensor to the measurement engine, starts the engine with the first sensor
+ *     All sensors have to be added before the first uplink
+ *
+ * @param idx MQX_MQ2 or MQX_MQ3
+ * @param sensor instance of the sensor that was found
+ * @return true sensor added
+ * @return false task could not be started
+ */
+bool start_mqx(uint8_t idx, ADC121C021 *sensor)
+{
+	if (idx >= MQX_NUM)
+	{
+		return false;
+	}
+	mqx_ctx[idx].sensor = sensor;
+	if (g_mqx_r0[idx] != 0.0)
+	{
+		sensor->setR0(g_mqx_r0[idx]);
+	}
+	if (mqx_started)
+	{
+		return true;
+	}
+	mqx_started = true;
+#ifdef ARDUINO_ARCH_RP2040
+	mqx_task_handle.start(mqx_task);
+	mqx_task_handle.set_priority(osPriorityLow);
+#endif
+#if defined NRF52_SERIES || defined ESP32
+	if (!xTaskCreate(mqx_task, "MQX", 4096, NULL, TASK_PRIO_LOW, &mqx_task_handle))
+	{
+		MYLOG("MQX", "Failed to start engine task");
+		return false;
+	}
+#endif
+	return true;
+}
+
+/**
+ * @brief Set the pre-heat time and the number of samples
+ *
+ * @param new_preheat pre-heat time in seconds
+ * @param new_samples number of ADC samples
+ * @return true settings are valid
+ * @return false settings are out of range
+ */
+bool set_mqx(uint16_t new_preheat, uint8_t new_samples)
+{
+	if ((new_preheat < MQX_PREHEAT_MIN) || (new_preheat > MQX_PREHEAT_MAX) || (new_samples < MQX_SAMPLES_MIN) || (new_samples > MQX_SAMPLES_MAX))
+	{
+		return false;
+	}
+	g_mqx_preheat = new_preheat;
+	g_mqx_samples = new_samples;
+	return true;
+}
+
+/**
+ * @brief Set R0 of a sensor
+ *
+ * @param idx MQX_MQ2 or MQX_MQ3
+ * @param new_r0 sensor resistance in clean air, 0 to recalibrate
+ * @return true R0 is valid
+ * @return false R0 is negative or infinite
+ */
+bool mqx_set_r0(uint8_t idx, float new_r0)
+{
+	if ((idx >= MQX_NUM) || (new_r0 < 0.0) || isinf(new_r0) || isnan(new_r0))
+	{
+		return false;
+	}
+	g_mqx_r0[idx] = new_r0;
+	if ((mqx_ctx[idx].sensor != NULL) && (new_r0 != 0.0))
+	{
+		mqx_ctx[idx].sensor->setR0(new_r0);
+	}
+	return true;
+}
+
+/**
+ * @brief Request a new R0 calibration of all sensors
+ *     The sensors have to be in clean air. Calibration is done
+ *     after the pre-heat, the heater is switched on immediately
+ *
+ */
+void mqx_request_calibration(void)
+{
+	mqx_calibrate = true;
+}
+
+/**
+ * @brief Get the result of the last measurement of a sensor
+ *     Starts the next measurement cycle when the results of all sensors were taken
+ *
+ * @param idx MQX_MQ2 or MQX_MQ3
+ * @param ppm pointer to the gas concentration in PPM
+ * @return true result is valid
+ * @return false measurement still running or failed
+ */
+bool mqx_get_ppm(uint8_t idx, float *ppm)
+{
+	if ((idx >= MQX_NUM) || (mqx_ctx[idx].sensor == NULL))
+	{
+		return false;
+	}
+	if ((mqx_state != MQX_DONE) || mqx_ctx[idx].taken)
+	{
+		MYLOG("MQX", "Measurement still running");
+		return false;
+	}
+
+	bool valid = mqx_ctx[idx].valid;
+	*ppm = mqx_ctx[idx].ppm;
+	mqx_ctx[idx].taken = true;
+
+	// Start the next cycle after all sensors were read
+	for (uint8_t sensor = 0; sensor < MQX_NUM; sensor++)
+	{
+		if ((mqx_ctx[sensor].sensor != NULL) && !mqx_ctx[sensor].taken)
+		{
+			return valid;
+		}
+	}
+	mqx_last_uplink = millis();
+	mqx_uplink_done = true;
+	return valid;
+}
@@ -0,0 +1,44 @@
+/**
+ * @file mqx_engine.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the MQx gas sensor measurement engine
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef MQX_ENGINE_H
+#define MQX_ENGINE_H
+#include <Arduino.h>
+
+class ADC121C021;
+
+/** Heater pre-heat time limits in seconds */
+#define MQX_PREHEAT_MIN 10
+#define MQX_PREHEAT_MAX 600
+#define MQX_PREHEAT_DEFAULT 60
+/** Limits for the number of ADC samples per measurement */
+#define MQX_SAMPLES_MIN 8
+#define MQX_SAMPLES_MAX 64
+#define MQX_SAMPLES_DEFAULT 32
+/** Time between two ADC samples in ms */
+#define MQX_SAMPLE_INTERVAL 50
+/** Margin between the end of the measurement and the uplink in seconds */
+#define MQX_MARGIN 2
+
+/** Sensors of the engine, both modules share the heater enable pin */
+#define MQX_MQ2 0
+#define MQX_MQ3 1
+#define MQX_NUM 2
+
+bool start_mqx(uint8_t idx, ADC121C021 *sensor);
+bool set_mqx(uint16_t new_preheat, uint8_t new_samples);
+bool mqx_get_ppm(uint8_t idx, float *ppm);
+void mqx_request_calibration(void);
+bool mqx_set_r0(uint8_t idx, float new_r0);
+extern uint16_t g_mqx_preheat;
+extern uint8_t g_mqx_samples;
+extern float g_mqx_r0[MQX_NUM];
+
+#endif // MQX_ENGINE_H
@@ -0,0 +1,361 @@
+/**
+ * @file payload_auth.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief End-to-end authentication of the uplink payload
+ *        A truncated HMAC-SHA256 over the fPort, the uplink frame counter and
+ *        the payload is appended to the uplink. The frame counter makes a
+ *        replayed uplink fail the check. With a RAK5814 the SHA256 is
+ *        calculated by the ATECC608, otherwise in software.
+ *        The key is stored in flash and is sent in plain text to the ATECC608
+ *        for each hash, it is not protected by the hardware.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Length of the appended MAC, 0 = off */
+uint8_t g_auth_mac_len = 0;
+/** HMAC key */
+uint8_t g_auth_key[AUTH_KEY_MAX];
+/** Length of the HMAC key, 0 = no key set */
+uint8_t g_auth_key_len = 0;
+
+/** HMAC padding bytes */
+#define AUTH_IPAD 0x36
+#define AUTH_OPAD 0x5C
+
+/** SHA256 round constants */
+static const uint32_t sha256_k[64] = {
+	0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1, 0x923f82a4, 0xab1c5ed5,
+	0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3, 0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174,
+	0xe49b69c1, 0xefbe4786, 0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+	0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147, 0x06ca6351, 0x14292967,
+	0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13, 0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85,
+	0xa2bfe8a1, 0xa81a664b, 0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+	0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a, 0x5b9cca4f, 0x682e6ff3,
+	0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208, 0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2};
+
+#define SHA_ROTR(x, n) (((x) >> (n)) | ((x) << (32 - (n))))
+
+/**
+ * @brief Process one 64 byte block
+ *
+ * @param ctx SHA256 context
+ * @param block 64 bytes of data
+ */
+static void sha256_soft_block(sha256_ctx_t *ctx, const uint8_t *block)
+{
+	uint32_t w[64];
+	for (uint8_t idx = 0; idx < 16; idx++)
+	{
+		w[idx] = ((uint32_t)block[idx * 4] << 24) | ((uint32_t)block[idx * 4 + 1] << 16) | ((uint32_t)block[idx * 4 + 2] << 8) | block[idx * 4 + 3];
+	}
+	for (uint8_t idx = 16; idx < 64; idx++)
+	{
+		uint32_t s0 = SHA_ROTR(w[idx - 15], 7) ^ SHA_ROTR(w[idx - 15], 18) ^ (w[idx - 15] >> 3);
+		uint32_t s1 = SHA_ROTR(w[idx - 2], 17) ^ SHA_ROTR(w[idx - 2], 19) ^ (w[idx - 2] >> 10);
+		w[idx] = w[idx - 16] + s0 + w[idx - 7] + s1;
+	}
+
+	uint32_t a = ctx->state[0];
+	uint32_t b = ctx->state[1];
+	uint32_t c = ctx->state[2];
+	uint32_t d = ctx->state[3];
+	uint32_t e = ctx->state[4];
+	uint32_t f = ctx->state[5];
+	uint32_t g = ctx->state[6];
+	uint32_t h = ctx->state[7];
+	for (uint8_t idx = 0; idx < 64; idx++)
+	{
+		uint32_t t1 = h + (SHA_ROTR(e, 6) ^ SHA_ROTR(e, 11) ^ SHA_ROTR(e, 25)) + ((e & f) ^ (~e & g)) + sha256_k[idx] + w[idx];
+		uint32_t t2 = (SHA_ROTR(a, 2) ^ SHA_ROTR(a, 13) ^ SHA_ROTR(a, 22)) + ((a & b) ^ (a & c) ^ (b & c));
+		h = g;
+		g = f;
+		f = e;
+		e = d + t1;
+		d = c;
+		c = b;
+		b = a;
+		a = t1 + t2;
+	}
+	ctx->state[0] += a;
+	ctx->state[1] += b;
+	ctx->state[2] += c;
+	ctx->state[3] += d;
+	ctx->state[4] += e;
+	ctx->state[5] += f;
+	ctx->state[6] += g;
+	ctx->state[7] += h;
+}
+
+/**
+ * @brief Start a software SHA256 calculation
+ *
+ * @param ctx SHA256 context
+ */
+void sha256_soft_begin(sha256_ctx_t *ctx)
+{
+	static const uint32_t init[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372, 0xa54ff53a, 0x510e527f, 0x9b05688c, 0x1f83d9ab, 0x5be0cd19};
+	memcpy(ctx->state, init, sizeof(init));
+	ctx->count = 0;
+	ctx->fill = 0;
+}
+
+/**
+ * @brief Add data to a software SHA256 calculation
+ *
+ * @param ctx SHA256 context
+ * @param data buffer with the data
+ * @param length length of the buffer
+ */
+void sha256_soft_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t length)
+{
+	ctx->count += length;
+	while (length != 0)
+	{
+		uint32_t copy = 64 - ctx->fill;
+		copy = copy > length ? length : copy;
+		memcpy(&ctx->block[ctx->fill], data, copy);
+		ctx->fill += copy;
+		data += copy;
+		length -= copy;
+		if (ctx->fill == 64)
+		{
+			sha256_soft_block(ctx, ctx->block);
+			ctx->fill = 0;
+		}
+	}
+}
+
+/**
+ * @brief Finish a software SHA256 calculation
+ *
+ * @param ctx SHA256 context
+ * @param result buffer for the 32 byte SHA256
+ */
+void sha256_soft_end(sha256_ctx_t *ctx, uint8_t *result)
+{
+	uint64_t bits = ctx->count * 8;
+	ctx->block[ctx->fill++] = 0x80;
+	if (ctx->fill > 56)
+	{
+		memset(&ctx->block[ctx->fill], 0, 64 - ctx->fill);
+		sha256_soft_block(ctx, ctx->block);
+		ctx->fill = 0;
+	}
+	memset(&ctx->block[ctx->fill], 0, 56 - ctx->fill);
+	for (uint8_t idx = 0; idx < 8; idx++)
+	{
+		ctx->block[63 - idx] = (uint8_t)(bits >> (idx * 8));
+	}
+	sha256_soft_block(ctx, ctx->block);
+	for (uint8_t idx = 0; idx < 8; idx++)
+	{
+		result[idx * 4] = (uint8_t)(ctx->state[idx] >> 24);
+		result[idx * 4 + 1] = (uint8_t)(ctx->state[idx] >> 16);
+		result[idx * 4 + 2] = (uint8_t)(ctx->state[idx] >> 8);
+		result[idx * 4 + 3] = (uint8_t)(ctx->state[idx]);
+	}
+}
+
+/**
+ * @brief SHA256 over a padded key block and data, in the ATECC608 or in software
+ *
+ * @param pad AUTH_IPAD or AUTH_OPAD
+ * @param prefix optional bytes before the data, NULL = none
+ * @param prefix_len number of bytes in prefix
+ * @param data buffer with the data
+ * @param length length of the buffer
+ * @param result buffer for the 32 byte SHA256
+ * @param use_hw true to use the ATECC608
+ * @return true calculation success
+ * @return false ATECC608 not answering
+ */
+static bool auth_hash(uint8_t pad, const uint8_t *prefix, uint8_t prefix_len, const uint8_t *data, uint16_t length, uint8_t *result, bool use_hw)
+{
+	uint8_t key_block[64];
+	memset(key_block, pad, sizeof(key_block));
+	for (uint8_t idx = 0; idx < g_auth_key_len; idx++)
+	{
+		key_block[idx] ^= g_auth_key[idx];
+	}
+	if (use_hw)
+	{
+		return sha256_begin_rak5814() && sha256_update_rak5814(key_block, sizeof(key_block)) && ((prefix_len == 0) || sha256_update_rak5814(prefix, prefix_len)) && sha256_update_rak5814(data, length) && sha256_end_rak5814(result);
+	}
+
+	sha256_ctx_t ctx;
+	sha256_soft_begin(&ctx);
+	sha256_soft_update(&ctx, key_block, sizeof(key_block));
+	if (prefix_len != 0)
+	{
+		sha256_soft_update(&ctx, prefix, prefix_len);
+	}
+	sha256_soft_update(&ctx, data, length);
+	sha256_soft_end(&ctx, result);
+	return true;
+}
+
+/**
+ * @brief Get the frame counter of the next uplink
+ *
+ * @return uint32_t FCntUp the MAC uses for the next uplink
+ */
+uint32_t auth_uplink_counter(void)
+{
+	MibRequestConfirm_t mib_req;
+	mib_req.Type = MIB_UPLINK_COUNTER;
+	if (LoRaMacMibGetRequestConfirm(&mib_req) != LORAMAC_STATUS_OK)
+	{
+		return 0;
+	}
+	return mib_req.Param.UpLinkCounter;
+}
+
+/**
+ * @brief Calculate the HMAC-SHA256 over the fPort, the frame counter and the data
+ *     The frame counter is added as 4 bytes, LSB first
+ *
+ * @param data buffer with the data
+ * @param length length of the buffer
+ * @param fport fPort the data is sent on
+ * @param counter FCntUp of the uplink
+ * @param result buffer for the 32 byte HMAC
+ * @param use_hw true to use the ATECC608
+ * @return true calculation success
+ * @return false ATECC608 not answering
+ */
+bool auth_hmac(const uint8_t *data, uint16_t length, uint8_t fport, uint32_t counter, uint8_t *result, bool use_hw)
+{
+	uint8_t prefix[5] = {fport, (uint8_t)counter, (uint8_t)(counter >> 8), (uint8_t)(counter >> 16), (uint8_t)(counter >> 24)};
+	uint8_t inner[ECC_SHA_SIZE];
+	if (!auth_hash(AUTH_IPAD, prefix, sizeof(prefix), data, length, inner, use_hw))
+	{
+		return false;
+	}
+	return auth_hash(AUTH_OPAD, NULL, 0, inner, sizeof(inner), result, use_hw);
+}
+
+/**
+ * @brief Append the truncated HMAC to an uplink
+ *     The MAC uses the frame counter of the next uplink, the packet must be
+ *     sent right away. For a fragmented packet it is the counter of the first
+ *     fragment. Falls back to software if the ATECC608 does not answer
+ *
+ * @param packet buffer with the payload, needs space for the MAC
+ * @param size size of the payload
+ * @param fport fPort the payload is sent on
+ * @param max_size size of the buffer
+ * @return uint8_t size with MAC, unchanged if the MAC is off or does not fit
+ */
+uint8_t auth_append_mac(uint8_t *packet, uint8_t size, uint8_t fport, uint8_t max_size)
+{
+	if ((g_auth_mac_len == 0) || (g_auth_key_len == 0) || ((uint16_t)size + g_auth_mac_len > max_size))
+	{
+		return size;
+	}
+	uint8_t mac[ECC_SHA_SIZE];
+	bool use_hw = found_sensors[ECC_ID].found_sensor;
+	uint32_t counter = auth_uplink_counter();
+	if (!auth_hmac(packet, size, fport, counter, mac, use_hw))
+	{
+		MYLOG("AUTH", "ATECC608 failed, using software");
+		auth_hmac(packet, size, fport, counter, mac, false);
+	}
+	memcpy(&packet[size], mac, g_auth_mac_len);
+	return size + g_auth_mac_len;
+}
+
+/**
+ * @brief Set the length of the appended MAC
+ *
+ * @param new_len MAC length in bytes, 0 = off
+ * @return true length is valid
+ * @return false length is out of range
+ */
+bool set_auth_mac(uint8_t new_len)
+{
+	if ((new_len != 0) && ((new_len < AUTH_MAC_MIN) || (new_len > AUTH_MAC_MAX)))
+	{
+		return false;
+	}
+	g_auth_mac_len = new_len;
+	return true;
+}
+
+/**
+ * @brief Set the HMAC key
+ *
+ * @param key buffer with the key
+ * @param key_len key length in bytes, 0 to remove the key
+ * @return true key is valid
+ * @return false key is too long
+ */
+bool set_auth_key(const uint8_t *key, uint8_t key_len)
+{
+	if (key_len > AUTH_KEY_MAX)
+	{
+		return false;
+	}
+	memset(g_auth_key, 0, AUTH_KEY_MAX);
+	memcpy(g_auth_key, key, key_len);
+	g_auth_key_len = key_len;
+	return true;
+}
+
+/**
+ * @brief Compare the SHA256 in the ATECC608 and in software
+ *     Prints the time for AUTH_BENCH_SIZE bytes and for one uplink HMAC.
+ *     The energy is the time multiplied with the current of the MCU,
+ *     for the ATECC608 plus the current of the chip.
+ *
+ */
+void auth_benchmark(void)
+{
+	static uint8_t bench_data[AUTH_BENCH_SIZE];
+	uint8_t soft_result[ECC_SHA_SIZE];
+	uint8_t hw_result[ECC_SHA_SIZE];
+	for (uint16_t idx = 0; idx < AUTH_BENCH_SIZE; idx++)
+	{
+		bench_data[idx] = (uint8_t)idx;
+	}
+
+	sha256_ctx_t ctx;
+	uint32_t start = micros();
+	sha256_soft_begin(&ctx);
+	sha256_soft_update(&ctx, bench_data, AUTH_BENCH_SIZE);
+	sha256_soft_end(&ctx, soft_result);
+	uint32_t soft_time = micros() - start;
+
+	start = micros();
+	auth_hmac(bench_data, 51, 2, 0, soft_result, false);
+	uint32_t soft_hmac = micros() - start;
+	AT_PRINTF("SW: %d bytes %ld us, %ld bytes/s, 51 byte HMAC %ld us\n", AUTH_BENCH_SIZE, soft_time, soft_time == 0 ? 0 : (uint32_t)((uint64_t)AUTH_BENCH_SIZE * 1000000 / soft_time), soft_hmac);
+
+	if (!found_sensors[ECC_ID].found_sensor)
+	{
+		AT_PRINTF("HW: no RAK5814\n");
+		return;
+	}
+
+	sha256_soft_begin(&ctx);
+	sha256_soft_update(&ctx, bench_data, AUTH_BENCH_SIZE);
+	sha256_soft_end(&ctx, soft_result);
+
+	start = micros();
+	bool hw_ok = sha256_rak5814(bench_data, AUTH_BENCH_SIZE, hw_result);
+	uint32_t hw_time = micros() - start;
+
+	start = micros();
+	hw_ok = hw_ok && (memcmp(hw_result, soft_result, ECC_SHA_SIZE) == 0) && auth_hmac(bench_data, 51, 2, 0, hw_result, true);
+	uint32_t hw_hmac = micros() - start;
+	if (!hw_ok)
+	{
+		AT_PRINTF("HW: ATECC608 failed or result mismatch\n");
+		return;
+	}
+	AT_PRINTF("HW: %d bytes %ld us, %ld bytes/s, 51 byte HMAC %ld us\n", AUTH_BENCH_SIZE, hw_time, hw_time == 0 ? 0 : (uint32_t)((uint64_t)AUTH_BENCH_SIZE * 1000000 / hw_time), hw_hmac);
+}
@@ -0,0 +1,45 @@
+/**
+ * @file payload_auth.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the uplink payload authentication
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef PAYLOAD_AUTH_H
+#define PAYLOAD_AUTH_H
+#include <Arduino.h>
+
+/** Limits of the truncated MAC in bytes, 0 = no MAC */
+#define AUTH_MAC_MIN 4
+#define AUTH_MAC_MAX 16
+/** Largest HMAC key in bytes */
+#define AUTH_KEY_MAX 32
+/** Size of the data used for the benchmark */
+#define AUTH_BENCH_SIZE 1024
+
+/** Software SHA256 context */
+typedef struct sha256_ctx_s
+{
+	uint32_t state[8];
+	uint64_t count;
+	uint8_t block[64];
+	uint8_t fill;
+} sha256_ctx_t;
+
+void sha256_soft_begin(sha256_ctx_t *ctx);
+void sha256_soft_update(sha256_ctx_t *ctx, const uint8_t *data, uint32_t length);
+void sha256_soft_end(sha256_ctx_t *ctx, uint8_t *result);
+uint32_t auth_uplink_counter(void);
+bool auth_hmac(const uint8_t *data, uint16_t length, uint8_t fport, uint32_t counter, uint8_t *result, bool use_hw);
+uint8_t auth_append_mac(uint8_t *packet, uint8_t size, uint8_t fport, uint8_t max_size);
+bool set_auth_mac(uint8_t new_len);
+bool set_auth_key(const uint8_t *key, uint8_t key_len);
+void auth_benchmark(void);
+extern uint8_t g_auth_mac_len;
+extern uint8_t g_auth_key[];
+extern uint8_t g_auth_key_len;
+
+#endif // PAYLOAD_AUTH_H
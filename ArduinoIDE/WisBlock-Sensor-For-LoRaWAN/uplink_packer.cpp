@@ -0,0 +1,333 @@
+/**
+ * @file uplink_packer.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Fit a Cayenne LPP packet into the maximum payload of the current data rate
+ *        The packet is split into its channel records, the records are sorted
+ *        by channel priority and added as long as they fit. Records that were
+ *        left out are kept and sent with the next uplink, unless it has a newer
+ *        value of the channel. A channel that was left out gains one priority
+ *        level per PACK_AGING deferred uplinks, so every channel is sent
+ *        eventually (round robin between channels of the same priority).
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Packer mode */
+uint8_t g_pack_mode = PACK_MODE_DEFAULT;
+/** Priority per LPP channel, 0 = PACK_PRIO_DEFAULT */
+uint8_t g_pack_prio[PACK_MAX_CHANNEL + 1] = {0};
+
+/** Number of uplinks each channel was left out */
+static uint8_t pack_deferred[PACK_MAX_CHANNEL + 1] = {0};
+
+/** Largest packet, size of the Cayenne LPP buffer */
+#define PACK_MAX_SIZE 255
+/** Space for records that did not fit, they are sent with the next uplink */
+#define PACK_CARRY_SIZE 64
+/** Maximum number of records in a packet and the deferred records, the smallest record has 3 bytes */
+#define PACK_MAX_RECORDS ((PACK_MAX_SIZE + PACK_CARRY_SIZE) / 3)
+
+/** Records that did not fit into the last uplink */
+static uint8_t pack_carry[PACK_CARRY_SIZE];
+static uint8_t pack_carry_size = 0;
+
+/** Record of a packet */
+typedef struct pack_record_s
+{
+	uint16_t start;
+	uint8_t size;
+	uint8_t channel;
+	uint16_t rank;
+} pack_record_t;
+
+/**
+ * @brief Get the priority of a channel
+ *
+ * @param channel LPP channel
+ * @return uint8_t priority
+ */
+static uint8_t pack_get_prio(uint8_t channel)
+{
+	return g_pack_prio[channel] == 0 ? PACK_PRIO_DEFAULT : g_pack_prio[channel];
+}
+
+/**
+ * @brief Get the data size of an LPP type
+ *
+ * @param type LPP data type
+ * @return uint8_t data size, 0 if the type is unknown
+ */
+static uint8_t pack_type_size(uint8_t type)
+{
+	switch (type)
+	{
+	case 0:	  // Digital input
+	case 1:	  // Digital output
+	case 102: // Presence
+	case 104: // Relative humidity
+	case 120: // Percentage
+	case 142: // Switch
+		return 1;
+	case 2:	  // Analog input
+	case 3:	  // Analog output
+	case 101: // Luminosity
+	case 103: // Temperature
+	case 115: // Barometric pressure
+	case 116: // Voltage
+	case 117: // Current
+	case 121: // Altitude
+	case 125: // Concentration
+	case 128: // Power
+	case 132: // Direction
+	case 138: // VOC index
+	case 190: // Wind speed
+	case 191: // Wind direction
+		return 2;
+	case 135: // Colour
+		return 3;
+	case 136: // GNSS, 0.0001 degree lat/lon, 0.01 m altitude (addGNSS_4)
+		return 9;
+	case 137: // GNSS, 0.000001 degree lat/lon, 0.01 m altitude (addGNSS_6)
+		return 11;
+	case 100: // Generic sensor
+	case 118: // Frequency
+	case 130: // Distance
+	case 131: // Energy
+	case 133: // Unix time
+		return 4;
+	case 113: // Accelerometer
+	case 134: // Gyrometer
+		return 6;
+	default:
+		return 0;
+	}
+}
+
+/**
+ * @brief Add a record to the list, sorted by rank
+ *     Records with the same rank keep their order
+ *
+ * @param packet packet buffer
+ * @param pos start of the record
+ * @param end end of the valid data in the buffer
+ * @param records record list
+ * @param num_records number of records in the list, incremented
+ * @return uint8_t size of the record, 0 if the type is unknown or the record is cut off
+ */
+static uint8_t pack_add_record(const uint8_t *packet, uint16_t pos, uint16_t end, pack_record_t *records, uint8_t *num_records)
+{
+	uint8_t data_size = (pos + 1 < end) ? pack_type_size(packet[pos + 1]) : 0;
+	if ((data_size == 0) || (pos + 2 + data_size > end) || (*num_records == PACK_MAX_RECORDS))
+	{
+		return 0;
+	}
+	uint8_t channel = packet[pos] > PACK_MAX_CHANNEL ? PACK_MAX_CHANNEL : packet[pos];
+	uint16_t rank = (uint16_t)pack_get_prio(channel) * PACK_AGING + pack_deferred[channel];
+	uint8_t idx = *num_records;
+	while ((idx > 0) && (records[idx - 1].rank < rank))
+	{
+		records[idx] = records[idx - 1];
+		idx--;
+	}
+	records[idx].start = pos;
+	records[idx].size = 2 + data_size;
+	records[idx].channel = channel;
+	records[idx].rank = rank;
+	*num_records = *num_records + 1;
+	return 2 + data_size;
+}
+
+/**
+ * @brief Pack the records of a packet by priority into the maximum payload
+ *     Records deferred from the last uplink are added, unless the packet
+ *     has a newer value with the same channel and type. If everything
+ *     fits it is copied unchanged. Records that do not fit are kept for
+ *     the next uplink.
+ *
+ * @param packet Cayenne LPP packet
+ * @param size packet size
+ * @param max_size maximum payload of the current data rate
+ * @param out buffer for the packed packet, at least max_size bytes
+ * @return uint8_t size of the packed packet, 0 if the packet has an unknown record type
+ */
+uint8_t pack_uplink(const uint8_t *packet, uint8_t size, uint8_t max_size, uint8_t *out)
+{
+	if ((size <= max_size) && (pack_carry_size == 0))
+	{
+		memset(pack_deferred, 0, sizeof(pack_deferred));
+		memcpy(out, packet, size);
+		return size;
+	}
+
+	// Split into records
+	uint8_t merged[PACK_MAX_SIZE + PACK_CARRY_SIZE];
+	memcpy(merged, packet, size);
+	pack_record_t records[PACK_MAX_RECORDS];
+	uint8_t num_records = 0;
+	uint16_t pos = 0;
+	while (pos < size)
+	{
+		uint8_t record_size = pack_add_record(merged, pos, size, records, &num_records);
+		if (record_size == 0)
+		{
+			// A record type missing in pack_type_size(), the packet is sent unchanged
+			MYLOG("PACK", "Unknown record type %d at %d", (pos + 1 < size) ? packet[pos + 1] : 0, pos);
+			AT_PRINTF("+EVT:PACK_ERROR %d\n", (pos + 1 < size) ? packet[pos + 1] : 0);
+			return 0;
+		}
+		pos += record_size;
+	}
+
+	// Add the deferred records, a newer value of the same channel replaces them
+	uint8_t num_new = num_records;
+	uint16_t merged_size = size;
+	for (pos = 0; pos < pack_carry_size; pos += 2 + pack_type_size(pack_carry[pos + 1]))
+	{
+		bool has_newer = false;
+		for (uint8_t idx = 0; idx < num_new; idx++)
+		{
+			if ((merged[records[idx].start] == pack_carry[pos]) && (merged[records[idx].start + 1] == pack_carry[pos + 1]))
+			{
+				has_newer = true;
+				break;
+			}
+		}
+		if (has_newer)
+		{
+			continue;
+		}
+		uint8_t record_size = 2 + pack_type_size(pack_carry[pos + 1]);
+		memcpy(&merged[merged_size], &pack_carry[pos], record_size);
+		pack_add_record(merged, merged_size, merged_size + record_size, records, &num_records);
+		merged_size += record_size;
+	}
+	pack_carry_size = 0;
+
+	if (merged_size <= max_size)
+	{
+		memset(pack_deferred, 0, sizeof(pack_deferred));
+		memcpy(out, merged, merged_size);
+		MYLOG("PACK", "Added %d deferred bytes", merged_size - size);
+		return merged_size;
+	}
+
+	// Fill by rank, smaller records are still added after a large one did not fit
+	uint8_t out_size = 0;
+	for (uint8_t idx = 0; idx < num_records; idx++)
+	{
+		pack_record_t *record = &records[idx];
+		if (out_size + record->size <= max_size)
+		{
+			memcpy(&out[out_size], &merged[record->start], record->size);
+			out_size += record->size;
+			pack_deferred[record->channel] = 0;
+			continue;
+		}
+		if (pack_deferred[record->channel] < 0xFF)
+		{
+			pack_deferred[record->channel]++;
+		}
+		if (pack_carry_size + record->size <= PACK_CARRY_SIZE)
+		{
+			// Send it with the next uplink
+			memcpy(&pack_carry[pack_carry_size], &merged[record->start], record->size);
+			pack_carry_size += record->size;
+			MYLOG("PACK", "Channel %d deferred %d times", record->channel, pack_deferred[record->channel]);
+		}
+		else
+		{
+			MYLOG("PACK", "Channel %d dropped, no space for deferred records", record->channel);
+		}
+	}
+	MYLOG("PACK", "Packed %d of %d bytes into %d, %d bytes deferred", out_size, merged_size, max_size, pack_carry_size);
+	return out_size;
+}
+
+/**
+ * @brief Check that the packer knows every record type the firmware sends
+ *     The records are created with the same functions as the sensor readings,
+ *     a type missing in pack_type_size() or with a different size is found
+ *     at startup instead of at the first oversized uplink.
+ *
+ * @return true all record types are known
+ * @return false a record type is unknown, the packer must not be used
+ */
+bool pack_check_types(void)
+{
+	WisCayenne check_data(128);
+	check_data.addDigitalInput(1, 0);
+	check_data.addAnalogInput(1, 0.0);
+	check_data.addLuminosity(1, 0);
+	check_data.addPresence(1, 0);
+	check_data.addTemperature(1, 0.0);
+	check_data.addRelativeHumidity(1, 0.0);
+	check_data.addBarometricPressure(1, 0.0);
+	check_data.addVoltage(1, 0.0);
+	check_data.addPercentage(1, 0);
+	check_data.addConcentration(1, 0);
+	check_data.addGenericSensor(1, 0.0);
+	check_data.addUnixTime(1, 0);
+	check_data.addGyrometer(1, 0.0, 0.0, 0.0);
+	check_data.addGNSS_4(1, 0, 0, 0);
+	check_data.addGNSS_6(1, 0, 0, 0);
+	check_data.addVoc_index(1, 0);
+
+	uint8_t *buffer = check_data.getBuffer();
+	uint8_t size = check_data.getSize();
+	uint16_t pos = 0;
+	while (pos < size)
+	{
+		uint8_t data_size = (pos + 1 < size) ? pack_type_size(buffer[pos + 1]) : 0;
+		if (data_size == 0)
+		{
+			MYLOG("PACK", "Record type %d unknown", (pos + 1 < size) ? buffer[pos + 1] : 0);
+			return false;
+		}
+		pos += 2 + data_size;
+	}
+	if (pos != size)
+	{
+		MYLOG("PACK", "Record sizes differ from the library");
+		return false;
+	}
+	return true;
+}
+
+/**
+ * @brief Set the packer mode
+ *
+ * @param new_mode PACK_MODE_OFF or PACK_MODE_FILL
+ * @return true mode is valid
+ * @return false mode is unknown
+ */
+bool set_pack_mode(uint8_t new_mode)
+{
+	if (new_mode > PACK_MODE_FILL)
+	{
+		return false;
+	}
+	g_pack_mode = new_mode;
+	return true;
+}
+
+/**
+ * @brief Set the priority of a channel
+ *
+ * @param channel LPP channel
+ * @param prio priority, higher values are sent first, 0 = PACK_PRIO_DEFAULT
+ * @return true priority is valid
+ * @return false channel or priority out of range
+ */
+bool set_pack_prio(uint8_t channel, uint8_t prio)
+{
+	if ((channel > PACK_MAX_CHANNEL) || (prio > PACK_PRIO_MAX))
+	{
+		return false;
+	}
+	g_pack_prio[channel] = prio;
+	return true;
+}
@@ -0,0 +1,34 @@
+/**
+ * @file uplink_packer.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the data rate aware uplink packer
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef UPLINK_PACKER_H
+#define UPLINK_PACKER_H
+#include <Arduino.h>
+
+/** Highest LPP channel that can get a priority */
+#define PACK_MAX_CHANNEL 127
+/** Channel priority limits, a higher value is sent first */
+#define PACK_PRIO_MAX 7
+#define PACK_PRIO_DEFAULT 4
+/** Number of deferred uplinks that raise a channel by one priority level */
+#define PACK_AGING 4
+/** Packer modes */
+#define PACK_MODE_OFF 0	 // Oversized packets are sent in fragments
+#define PACK_MODE_FILL 1 // Oversized packets are cut to the current DR, the rest is deferred
+#define PACK_MODE_DEFAULT PACK_MODE_FILL
+
+uint8_t pack_uplink(const uint8_t *packet, uint8_t size, uint8_t max_size, uint8_t *out);
+bool pack_check_types(void);
+bool set_pack_mode(uint8_t new_mode);
+bool set_pack_prio(uint8_t channel, uint8_t prio);
+extern uint8_t g_pack_mode;
+extern uint8_t g_pack_prio[];
+
+#endif // UPLINK_PACKER_H
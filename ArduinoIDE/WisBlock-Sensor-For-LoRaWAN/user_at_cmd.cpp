@@ -27,6 +27,51 @@ static const char batt_name[] = "BATT";
 /** File name to save Water Level calibration values */
 static const char wl_name[] = "WLCS";
 
+/** File name to save vibration analysis ODR */
+static const char vib_name[] = "VIB";
+
+/** File name to save orientation fusion settings */
+static const char fusion_name[] = "FUSION";
+
+/** File name to save ToF timing budget */
+static const char tof_name[] = "TOF";
+
+/** File name to save current sensor sampler rate */
+static const char ina_name[] = "INA";
+
+/** File name to save particle matter power schedule */
+static const char pms_name[] = "PMS";
+
+/** File name to save gas sensor heater schedule and R0 */
+static const char mqx_name[] = "MQX";
+
+/** File name to save thermal frame blob interval */
+static const char tblob_name[] = "TBLOB";
+
+/** File name to save VOC algorithm state */
+static const char voc_name[] = "VOC";
+
+/** File name to save fragmented uplink settings */
+static const char frag_name[] = "FRAG";
+
+/** File name to save uplink packer settings */
+static const char pack_name[] = "PACK";
+
+/** File name to save the wall clock alignment */
+static const char align_name[] = "TALIGN";
+
+/** File name to save payload authentication settings */
+static const char auth_name[] = "AUTH";
+
+/** File name to save the time sync setting */
+static const char tsync_name[] = "TSYNC";
+
+// /** File name to save BSEC state save interval */
+// static const char bsec_name[] = "BSEC";
+
+// /** File name to save BSEC state */
+// static const char bsec_state_name[] = "BSEC_ST";
+
 /** File to save GPS precision setting */
 File gps_file(InternalFS);
 
@@ -35,6 +80,48 @@ File batt_check(InternalFS);
 
 /** File to save Water Level calibration values */
 File wl_file(InternalFS);
+
+/** File to save vibration analysis ODR */
+File vib_file(InternalFS);
+
+/** File to save orientation fusion settings */
+File fusion_file(InternalFS);
+
+/** File to save ToF timing budget */
+File tof_file(InternalFS);
+
+/** File to save current sensor sampler rate */
+File ina_file(InternalFS);
+
+/** File to save particle matter power schedule */
+File pms_file(InternalFS);
+
+/** File to save gas sensor heater schedule and R0 */
+File mqx_file(InternalFS);
+
+/** File to save thermal frame blob interval */
+File tblob_file(InternalFS);
+
+/** File to save VOC algorithm state */
+File voc_file(InternalFS);
+
+/** File to save fragmented uplink settings */
+File frag_file(InternalFS);
+
+/** File to save uplink packer settings */
+File pack_file(InternalFS);
+
+/** File to save the wall clock alignment */
+File align_file(InternalFS);
+
+/** File to save payload authentication settings */
+File auth_file(InternalFS);
+
+/** File to save the time sync setting */
+File tsync_file(InternalFS);
+
+// /** File to save BSEC settings and state */
+// File bsec_file(InternalFS);
 #endif
 #ifdef ESP32
 #include <Preferences.h>
@@ -42,6 +129,69 @@ File wl_file(InternalFS);
 Preferences esp32_prefs;
 #endif
 
+#if defined NRF52_SERIES || defined ESP32
+/** Settings access from the app loop and the sensor tasks
+ *  On ESP32 there is only one preferences handle, on nRF52 the File instances are shared */
+static SemaphoreHandle_t settings_mutex = NULL;
+#endif
+
+/**
+ * @brief Create the settings lock, must be called before any sensor task starts
+ *
+ */
+void init_settings_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	settings_mutex = xSemaphoreCreateMutex();
+#endif
+}
+
+/**
+ * @brief Lock the settings storage
+ *
+ */
+static void settings_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreTake(settings_mutex, portMAX_DELAY);
+#endif
+}
+
+/**
+ * @brief Unlock the settings storage
+ *
+ */
+static void settings_unlock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGive(settings_mutex);
+#endif
+}
+
+#ifdef ESP32
+/**
+ * @brief Lock the settings and open a preferences namespace
+ *
+ * @param name namespace
+ * @param read_only true to open read only
+ */
+static void prefs_begin(const char *name, bool read_only)
+{
+	settings_lock();
+	esp32_prefs.begin(name, read_only);
+}
+
+/**
+ * @brief Close the preferences namespace and unlock the settings
+ *
+ */
+static void prefs_end(void)
+{
+	esp32_prefs.end();
+	settings_unlock();
+}
+#endif
+
 /** Flag for sleep activated */
 bool g_device_sleep = false;
 
@@ -181,9 +331,9 @@ void read_gps_settings(uint8_t settings) // Read saved setting for precision and
 		}
 #endif
 #ifdef ESP32
-		esp32_prefs.begin("gnss", false);
+		prefs_begin("gnss", false);
 		data[0] = esp32_prefs.getShort("fmt", 0);
-		esp32_prefs.end();
+		prefs_end();
 #endif
 		if (found_prefs)
 		{
@@ -223,9 +373,9 @@ void read_gps_settings(uint8_t settings) // Read saved setting for precision and
 		}
 #endif
 #ifdef ESP32
-		esp32_prefs.begin("gnss", false);
+		prefs_begin("gnss", false);
 		data[0] = esp32_prefs.getShort("pwr", 0);
-		esp32_prefs.end();
+		prefs_end();
 #endif
 		if (found_prefs)
 		{
@@ -283,7 +433,7 @@ void save_gps_settings(uint8_t settings)
 		gps_file.close();
 #endif
 #ifdef ESP32
-		esp32_prefs.begin("gnss", false);
+		prefs_begin("gnss", false);
 		if (g_gps_prec_6)
 		{
 			MYLOG("USR_AT", "Saved high precision");
@@ -304,7 +454,7 @@ void save_gps_settings(uint8_t settings)
 			MYLOG("USR_AT", "Saved low precision");
 			esp32_prefs.putShort("fmt", 0);
 		}
-		esp32_prefs.end();
+		prefs_end();
 #endif
 	}
 	else if (settings == 1)
@@ -325,7 +475,7 @@ void save_gps_settings(uint8_t settings)
 		gps_file.close();
 #endif
 #ifdef ESP32
-		esp32_prefs.begin("gnss", false);
+		prefs_begin("gnss", false);
 		if (g_gnss_power_off)
 		{
 			MYLOG("USR_AT", "Saved power off enabled");
@@ -336,7 +486,7 @@ void save_gps_settings(uint8_t settings)
 			MYLOG("USR_AT", "Saved power off disabled");
 			esp32_prefs.putShort("pwr", 1);
 		}
-		esp32_prefs.end();
+		prefs_end();
 #endif
 	}
 }
@@ -443,7 +593,9 @@ static int at_exec_dry()
 {
 	// Dry calibration requested
 	AT_PRINTF("Start Dry Calibration\n");
+	i2c_lock();
 	uint16_t new_val = start_calib_rak12035(true);
+	i2c_unlock();
 	if (new_val == 0xFFFF)
 	{
 		AT_PRINTF("Calibration failed, please try again");
@@ -462,7 +614,9 @@ static int at_set_dry(char *str)
 	{
 		return AT_ERRNO_PARA_VAL;
 	}
+	i2c_lock();
 	set_calib_rak12035(true, dry_val);
+	i2c_unlock();
 	return 0;
 }
 
@@ -475,7 +629,10 @@ static int at_query_dry()
 {
 	// Dry calibration value query
 	// AT_PRINTF("Dry Calibration Value: %d", get_calib_rak12035(true));
-	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", get_calib_rak12035(true));
+	i2c_lock();
+	uint16_t dry_val = get_calib_rak12035(true);
+	i2c_unlock();
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", dry_val);
 	return 0;
 }
 
@@ -488,7 +645,9 @@ static int at_exec_wet()
 {
 	// Dry calibration requested
 	AT_PRINTF("Start Wet Calibration\n");
+	i2c_lock();
 	uint16_t new_val = start_calib_rak12035(false);
+	i2c_unlock();
 	if (new_val == 0xFFFF)
 	{
 		AT_PRINTF("Calibration failed, please try again");
@@ -507,7 +666,9 @@ static int at_set_wet(char *str)
 	{
 		return AT_ERRNO_PARA_VAL;
 	}
+	i2c_lock();
 	set_calib_rak12035(false, wet_val);
+	i2c_unlock();
 	return 0;
 }
 
@@ -520,7 +681,10 @@ static int at_query_wet(void)
 {
 	// Wet calibration value query
 	// AT_PRINTF("Wet Calibration Value: %d", get_calib_rak12035(false));
-	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", get_calib_rak12035(false));
+	i2c_lock();
+	uint16_t wet_val = get_calib_rak12035(false);
+	i2c_unlock();
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", wet_val);
 	return 0;
 }
 
@@ -609,7 +773,9 @@ static int at_set_rtc(char *str)
 							return AT_ERRNO_PARA_VAL;
 						}
 
+						i2c_lock();
 						set_rak12002(year, month, date, hour, minute);
+						i2c_unlock();
 
 						return 0;
 					}
@@ -628,17 +794,94 @@ static int at_set_rtc(char *str)
 static int at_query_rtc(void)
 {
 	// Get date/time from the RTC
+	i2c_lock();
 	read_rak12002();
+	i2c_unlock();
 	// AT_PRINTF("%d.%02d.%02d %d:%02d:%02d", g_date_time.year, g_date_time.month, g_date_time.date, g_date_time.hour, g_date_time.minute, g_date_time.second);
 	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d.%02d.%02d %d:%02d:%02d", g_date_time.year, g_date_time.month, g_date_time.date, g_date_time.hour, g_date_time.minute, g_date_time.second);
 
 	return 0;
 }
 
+/**
+ * @brief Query the wall clock alignment
+ *
+ * @return int 0
+ */
+static int at_query_align(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_rtc_align ? 1 : 0);
+	return 0;
+}
+
+/**
+ * @brief Enable or disable the wall clock alignment
+ *
+ * @param str 0 = send interval starts at power up, 1 = send at full multiples of the send interval
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_align(char *str)
+{
+	if (str[0] == '0')
+	{
+		g_rtc_align = false;
+	}
+	else if (str[0] == '1')
+	{
+		g_rtc_align = true;
+	}
+	else
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_align_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved wall clock alignment
+ *
+ */
+void read_align_settings(void)
+{
+#ifdef NRF52_SERIES
+	g_rtc_align = InternalFS.exists(align_name);
+#endif
+#ifdef ESP32
+	prefs_begin("talign", false);
+	g_rtc_align = esp32_prefs.getBool("align", false);
+	prefs_end();
+#endif
+	MYLOG("USR_AT", "Wall clock alignment %s", g_rtc_align ? "on" : "off");
+}
+
+/**
+ * @brief Save the wall clock alignment
+ *
+ */
+void save_align_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(align_name);
+	if (g_rtc_align)
+	{
+		align_file.open(align_name, FILE_O_WRITE);
+		align_file.write("1");
+		align_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("talign", false);
+	esp32_prefs.putBool("align", g_rtc_align);
+	prefs_end();
+#endif
+}
+
 atcmd_t g_user_at_cmd_list_rtc[] = {
 	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
 	// RTC commands
 	{"+RTC", "Get/Set RTC time and date", at_query_rtc, at_set_rtc, at_query_rtc, "RW"},
+	{"+TALIGN", "Get/Set send interval alignment to the wall clock, 0 = off, 1 = on", at_query_align, at_set_align, at_query_align, "RW"},
 };
 
 /*****************************************
@@ -656,7 +899,9 @@ static int at_query_alt()
 	uint16_t result;
 	if (found_sensors[PRESS_ID].found_sensor)
 	{
+		i2c_lock();
 		result = get_alt_rak1902();
+		i2c_unlock();
 		if (result == 0xFFFF)
 		{
 			return AT_ERRNO_EXEC_FAIL;
@@ -666,11 +911,13 @@ static int at_query_alt()
 	}
 	if (found_sensors[ENV_ID].found_sensor)
 	{
+		i2c_lock();
 // #if USE_BSEC == 0
 		result = get_alt_rak1906();
 // #else
 // 		result = get_alt_rak1906_bsec();
 // #endif
+		i2c_unlock();
 		if (result == 0xFFFF)
 		{
 			return AT_ERRNO_EXEC_FAIL;
@@ -788,9 +1035,9 @@ void read_batt_settings(void)
 	}
 #endif
 #ifdef ESP32
-	esp32_prefs.begin("bat", false);
+	prefs_begin("bat", false);
 	battery_check_enabled = esp32_prefs.getBool("bat", false);
-	esp32_prefs.end();
+	prefs_end();
 #endif
 
 	save_batt_settings(battery_check_enabled);
@@ -817,9 +1064,9 @@ void save_batt_settings(bool check_batt_enables)
 	}
 #endif
 #ifdef ESP32
-	esp32_prefs.begin("bat", false);
+	prefs_begin("bat", false);
 	esp32_prefs.putBool("bat", battery_check_enabled);
-	esp32_prefs.end();
+	prefs_end();
 #endif
 }
 
@@ -842,11 +1089,15 @@ static int at_exec_low()
 {
 	// Low calibration requested
 	AT_PRINTF("Start Low Calibration\n");
+	i2c_lock();
 	start_calib_rak12059(true);
+	i2c_unlock();
 
 	AT_PRINTF("New Low Calibration Value: %.4f\n", g_v_low);
 	// Save value
+	i2c_lock();
 	set_threshold_rak12059();
+	i2c_unlock();
 	save_wl_calibration();
 
 	return 0;
@@ -867,7 +1118,9 @@ static int at_set_low(char *str)
 	}
 	g_low_level = new_val;
 	// Save value
+	i2c_lock();
 	set_threshold_rak12059();
+	i2c_unlock();
 	save_wl_calibration();
 	return 0;
 }
@@ -892,11 +1145,15 @@ static int at_query_low()
 static int at_exec_high()
 {
 	AT_PRINTF("Start High Calibration\n");
+	i2c_lock();
 	start_calib_rak12059(false);
+	i2c_unlock();
 
 	AT_PRINTF("New High Calibration Value: %.4f\n", g_v_high);
 	// Save value
+	i2c_lock();
 	set_threshold_rak12059();
+	i2c_unlock();
 	save_wl_calibration();
 
 	return 0;
@@ -918,7 +1175,9 @@ static int at_set_high(char *str)
 	g_v_high = (float)new_val / 10000.0;
 
 	// Save value
+	i2c_lock();
 	set_threshold_rak12059();
+	i2c_unlock();
 	save_wl_calibration();
 	return 0;
 }
@@ -965,7 +1224,9 @@ static int at_set_th_low(char *str)
 	g_low_level = calc_thres_rak12059(new_val);
 
 	// Save value
+	i2c_lock();
 	set_threshold_rak12059();
+	i2c_unlock();
 	save_wl_calibration();
 	return 0;
 }
@@ -999,7 +1260,9 @@ static int at_set_th_high(char *str)
 	g_high_level = calc_thres_rak12059(new_val);
 
 	// Save value
+	i2c_lock();
 	set_threshold_rak12059();
+	i2c_unlock();
 	save_wl_calibration();
 	return 0;
 }
@@ -1064,7 +1327,7 @@ void read_wl_calibration(void)
 	}
 #endif
 #ifdef ESP32
-	esp32_prefs.begin("wl", false);
+	prefs_begin("wl", false);
 	g_v_low = esp32_prefs.getFloat("v_low", 1.4739);
 	g_v_high = esp32_prefs.getFloat("v_high", 2.1997);
 	// g_low_level = esp32_prefs.getShort("v_th_low", calc_thres_rak12059(254));
@@ -1073,7 +1336,7 @@ void read_wl_calibration(void)
 	MYLOG("AT", "Got water calib high %.4f", g_v_high);
 	// MYLOG("USR_AT", "Got water low threshold %04X", g_low_level);
 	// MYLOG("USR_AT", "Got water high threshold %04X", g_high_level);
-	esp32_prefs.end();
+	prefs_end();
 #endif
 }
 
@@ -1095,121 +1358,1659 @@ void save_wl_calibration(void)
 	wl_file.close();
 #endif
 #ifdef ESP32
-	esp32_prefs.begin("wl", false);
+	prefs_begin("wl", false);
 	esp32_prefs.putFloat("v_low", g_v_low);
 	esp32_prefs.putFloat("v_high", g_v_high);
 	esp32_prefs.putShort("v_th_low", g_low_level);
 	esp32_prefs.putShort("v_th_high", g_high_level);
-	esp32_prefs.end();
+	prefs_end();
 #endif
 }
 
-/** Number of user defined AT commands */
-uint8_t g_user_at_cmd_num = 0;
-
-/** Pointer to the combined user AT command structure */
-atcmd_t *g_user_at_cmd_list;
-
-#define TEST_ALL_CMDS 0
+/*****************************************
+ * Vibration analysis AT commands
+ *****************************************/
 
 /**
- * @brief Initialize the user defined AT command list
+ * @brief Query the ODR used for the vibration analysis
  *
+ * @return int 0
  */
-void init_user_at(void)
+static int at_query_vib(void)
 {
-#if TEST_ALL_CMDS == 1
-	bool _has_rak12035 = found_sensors[SOIL_ID].found_sensor;
-	bool _has_rak1910_rak12500 = found_sensors[GNSS_ID].found_sensor;
-	bool _has_rak12002 = found_sensors[RTC_ID].found_sensor;
-	found_sensors[SOIL_ID].found_sensor = true;
-	found_sensors[GNSS_ID].found_sensor = true;
-	found_sensors[RTC_ID].found_sensor = true;
-#endif
-
-	uint16_t index_next_cmds = 0;
-	uint16_t required_structure_size = sizeof(g_user_at_cmd_list_batt);
-	MYLOG("USR_AT", "Structure size %d Battery", required_structure_size);
-	required_structure_size += sizeof(g_user_at_cmd_list_modules);
-	MYLOG("USR_AT", "Structure size %d Modules", required_structure_size);
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_vib_odr);
+	return 0;
+}
 
-	// Get required size of structure
-	if (found_sensors[SOIL_ID].found_sensor)
+/**
+ * @brief Set the ODR used for the vibration analysis
+ *
+ * @param str ODR in Hz, 0 disables the vibration analysis
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_vib(char *str)
+{
+	long new_odr = strtol(str, NULL, 0);
+	if ((new_odr < 0) || (new_odr > 0xFFFF))
 	{
-		required_structure_size += sizeof(g_user_at_cmd_list_soil);
-
-		MYLOG("USR_AT", "Structure size %d Soil", required_structure_size);
+		return AT_ERRNO_PARA_VAL;
 	}
-	if (found_sensors[GNSS_ID].found_sensor)
+	if (!set_odr_rak1904((uint16_t)new_odr))
 	{
-		required_structure_size += sizeof(g_user_at_cmd_list_gps);
-
-		MYLOG("USR_AT", "Structure size %d GNSS", required_structure_size);
+		return AT_ERRNO_PARA_VAL;
 	}
-	if (found_sensors[RTC_ID].found_sensor)
-	{
-		required_structure_size += sizeof(g_user_at_cmd_list_rtc);
+	save_vib_settings();
+	return 0;
+}
 
-		MYLOG("USR_AT", "Structure size %d RTC", required_structure_size);
+/**
+ * @brief Read saved vibration analysis ODR
+ *
+ */
+void read_vib_settings(void)
+{
+	uint16_t saved_odr = 0;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(vib_name))
+	{
+		vib_file.open(vib_name, FILE_O_READ);
+		vib_file.read((void *)&saved_odr, sizeof(saved_odr));
+		vib_file.close();
+		MYLOG("USR_AT", "File found, vibration ODR %d", saved_odr);
 	}
-	if ((found_sensors[ENV_ID].found_sensor) || (found_sensors[PRESS_ID].found_sensor))
+#endif
+#ifdef ESP32
+	prefs_begin("vib", false);
+	saved_odr = esp32_prefs.getUShort("odr", 0);
+	prefs_end();
+#endif
+	if (!set_odr_rak1904(saved_odr))
 	{
-		required_structure_size += sizeof(g_user_at_cmd_list_env);
-		MYLOG("USR_AT", "Structure size %d ENV/Pressure", required_structure_size);
+		set_odr_rak1904(0);
 	}
-	if (found_sensors[WATER_LEVEL_ID].found_sensor)
+}
+
+/**
+ * @brief Save the vibration analysis ODR
+ *
+ */
+void save_vib_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(vib_name);
+	if (g_vib_odr != 0)
 	{
-		required_structure_size += sizeof(g_user_at_cmd_list_wl);
-		MYLOG("USR_AT", "Structure size %d Water Level", required_structure_size);
+		vib_file.open(vib_name, FILE_O_WRITE);
+		vib_file.write((const char *)&g_vib_odr, sizeof(g_vib_odr));
+		vib_file.close();
 	}
+#endif
+#ifdef ESP32
+	prefs_begin("vib", false);
+	esp32_prefs.putUShort("odr", g_vib_odr);
+	prefs_end();
+#endif
+}
 
-	// Reserve memory for the structure
-	g_user_at_cmd_list = (atcmd_t *)malloc(required_structure_size);
+atcmd_t g_user_at_cmd_list_vib[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Vibration analysis commands
+	{"+VIB", "Get/Set vibration analysis ODR 0 = off, 50, 100, 200, 400 or 1344 Hz", at_query_vib, at_set_vib, at_query_vib, "RW"},
+};
 
-	// Add AT commands to structure
-	MYLOG("USR_AT", "Adding battery check AT commands");
-	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_batt) / sizeof(atcmd_t);
-	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_batt, sizeof(g_user_at_cmd_list_batt));
-	index_next_cmds += sizeof(g_user_at_cmd_list_batt) / sizeof(atcmd_t);
-	MYLOG("USR_AT", "Index after adding battery check %d", index_next_cmds);
+/*****************************************
+ * Orientation fusion AT commands
+ *****************************************/
 
-	MYLOG("USR_AT", "Adding module AT commands");
-	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_modules) / sizeof(atcmd_t);
-	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_modules, sizeof(g_user_at_cmd_list_modules));
-	index_next_cmds += sizeof(g_user_at_cmd_list_modules) / sizeof(atcmd_t);
-	MYLOG("USR_AT", "Index after adding modules %d", index_next_cmds);
+/**
+ * @brief Query the orientation fusion rate and magnetometer usage
+ *
+ * @return int 0
+ */
+static int at_query_fusion(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d:%d", g_fusion_rate, g_fusion_use_mag ? 1 : 0);
+	return 0;
+}
 
-	if (found_sensors[SOIL_ID].found_sensor)
+/**
+ * @brief Set the orientation fusion rate and magnetometer usage
+ *
+ * @param str <rate>:<mag> rate in Hz, 0 disables the fusion, mag 1 uses the magnetometer
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_fusion(char *str)
+{
+	char *param;
+
+	param = strtok(str, ":");
+	if (param == NULL)
 	{
-		MYLOG("USR_AT", "Adding Soil Sensor user AT commands");
-		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_soil) / sizeof(atcmd_t);
-		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_soil, sizeof(g_user_at_cmd_list_soil));
-		index_next_cmds += sizeof(g_user_at_cmd_list_soil) / sizeof(atcmd_t);
-		MYLOG("USR_AT", "Index after adding soil %d", index_next_cmds);
+		return AT_ERRNO_PARA_NUM;
 	}
-	if (found_sensors[GNSS_ID].found_sensor)
+	long new_rate = strtol(param, NULL, 0);
+
+	long use_mag = 0;
+	param = strtok(NULL, ":");
+	if (param != NULL)
 	{
-		MYLOG("USR_AT", "Adding GNSS user AT commands");
-		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_gps) / sizeof(atcmd_t);
-		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_gps, sizeof(g_user_at_cmd_list_gps));
-		index_next_cmds += sizeof(g_user_at_cmd_list_gps) / sizeof(atcmd_t);
-		MYLOG("USR_AT", "Index after adding GNSS %d", index_next_cmds);
+		use_mag = strtol(param, NULL, 0);
 	}
-	if (found_sensors[RTC_ID].found_sensor)
+
+	if ((new_rate < 0) || (new_rate > 0xFF) || (use_mag < 0) || (use_mag > 1))
 	{
-		MYLOG("USR_AT", "Adding RTC user AT commands");
-		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_rtc) / sizeof(atcmd_t);
-		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_rtc, sizeof(g_user_at_cmd_list_rtc));
-		index_next_cmds += sizeof(g_user_at_cmd_list_rtc) / sizeof(atcmd_t);
-		MYLOG("USR_AT", "Index after adding RTC %d", index_next_cmds);
+		return AT_ERRNO_PARA_VAL;
 	}
-	if ((found_sensors[ENV_ID].found_sensor) || (found_sensors[PRESS_ID].found_sensor))
+	if (!set_fusion((uint8_t)new_rate, use_mag == 1))
 	{
-		MYLOG("USR_AT", "Adding ENV user AT commands");
-		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_env) / sizeof(atcmd_t);
-		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_env, sizeof(g_user_at_cmd_list_env));
-		index_next_cmds += sizeof(g_user_at_cmd_list_env) / sizeof(atcmd_t);
-		MYLOG("USR_AT", "Index after adding env %d", index_next_cmds);
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_fusion_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved orientation fusion settings
+ *
+ */
+void read_fusion_settings(void)
+{
+	uint8_t saved_settings[2] = {0, 0};
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(fusion_name))
+	{
+		fusion_file.open(fusion_name, FILE_O_READ);
+		fusion_file.read((void *)saved_settings, sizeof(saved_settings));
+		fusion_file.close();
+		MYLOG("USR_AT", "File found, fusion rate %d mag %d", saved_settings[0], saved_settings[1]);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("fusion", false);
+	saved_settings[0] = esp32_prefs.getUChar("rate", 0);
+	saved_settings[1] = esp32_prefs.getUChar("mag", 0);
+	prefs_end();
+#endif
+	if (!set_fusion(saved_settings[0], saved_settings[1] == 1))
+	{
+		set_fusion(0, false);
+	}
+}
+
+/**
+ * @brief Save the orientation fusion settings
+ *
+ */
+void save_fusion_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(fusion_name);
+	if (g_fusion_rate != 0)
+	{
+		uint8_t settings[2] = {g_fusion_rate, (uint8_t)(g_fusion_use_mag ? 1 : 0)};
+		fusion_file.open(fusion_name, FILE_O_WRITE);
+		fusion_file.write((const char *)settings, sizeof(settings));
+		fusion_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("fusion", false);
+	esp32_prefs.putUChar("rate", g_fusion_rate);
+	esp32_prefs.putUChar("mag", g_fusion_use_mag ? 1 : 0);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_fusion[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Orientation fusion commands
+	{"+FUSION", "Get/Set orientation fusion rate 0 = off or 5 to 100 Hz and magnetometer usage 0 or 1", at_query_fusion, at_set_fusion, at_query_fusion, "RW"},
+};
+
+/*****************************************
+ * ToF sensor AT commands
+ *****************************************/
+
+/**
+ * @brief Query the ToF timing budget
+ *
+ * @return int 0
+ */
+static int at_query_tof(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_tof_budget);
+	return 0;
+}
+
+/**
+ * @brief Set the ToF timing budget
+ *
+ * @param str budget in ms
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_tof(char *str)
+{
+	long new_budget = strtol(str, NULL, 0);
+	if ((new_budget < 0) || (new_budget > 0xFFFF))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	if (!set_budget_rak12014((uint16_t)new_budget))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_tof_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved ToF timing budget
+ *
+ */
+void read_tof_settings(void)
+{
+	uint16_t saved_budget = RAK12014_BUDGET_DEFAULT;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(tof_name))
+	{
+		tof_file.open(tof_name, FILE_O_READ);
+		tof_file.read((void *)&saved_budget, sizeof(saved_budget));
+		tof_file.close();
+		MYLOG("USR_AT", "File found, ToF budget %d", saved_budget);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("tof", false);
+	saved_budget = esp32_prefs.getUShort("budget", RAK12014_BUDGET_DEFAULT);
+	prefs_end();
+#endif
+	if (!set_budget_rak12014(saved_budget))
+	{
+		set_budget_rak12014(RAK12014_BUDGET_DEFAULT);
+	}
+}
+
+/**
+ * @brief Save the ToF timing budget
+ *
+ */
+void save_tof_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(tof_name);
+	if (g_tof_budget != RAK12014_BUDGET_DEFAULT)
+	{
+		tof_file.open(tof_name, FILE_O_WRITE);
+		tof_file.write((const char *)&g_tof_budget, sizeof(g_tof_budget));
+		tof_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("tof", false);
+	esp32_prefs.putUShort("budget", g_tof_budget);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_tof[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// ToF sensor commands
+	{"+TOF", "Get/Set ToF timing budget per ranging 20 to 500 ms", at_query_tof, at_set_tof, at_query_tof, "RW"},
+};
+
+/*****************************************
+ * Current sensor AT commands
+ *****************************************/
+
+/**
+ * @brief Query the current sensor sampler rate
+ *
+ * @return int 0
+ */
+static int at_query_ina(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_ina_rate);
+	return 0;
+}
+
+/**
+ * @brief Set the current sensor sampler rate
+ *
+ * @param str rate in Hz, 0 disables the sampler
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_ina(char *str)
+{
+	long new_rate = strtol(str, NULL, 0);
+	if ((new_rate < 0) || (new_rate > 0xFF))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	if (!set_rate_rak16000((uint8_t)new_rate))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_ina_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved current sensor sampler rate
+ *
+ */
+void read_ina_settings(void)
+{
+	uint8_t saved_rate = INA_RATE_DEFAULT;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(ina_name))
+	{
+		ina_file.open(ina_name, FILE_O_READ);
+		ina_file.read((void *)&saved_rate, sizeof(saved_rate));
+		ina_file.close();
+		MYLOG("USR_AT", "File found, current sampler rate %d", saved_rate);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("ina", false);
+	saved_rate = esp32_prefs.getUChar("rate", INA_RATE_DEFAULT);
+	prefs_end();
+#endif
+	if (!set_rate_rak16000(saved_rate))
+	{
+		set_rate_rak16000(INA_RATE_DEFAULT);
+	}
+}
+
+/**
+ * @brief Save the current sensor sampler rate
+ *
+ */
+void save_ina_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(ina_name);
+	if (g_ina_rate != INA_RATE_DEFAULT)
+	{
+		ina_file.open(ina_name, FILE_O_WRITE);
+		ina_file.write((const char *)&g_ina_rate, sizeof(g_ina_rate));
+		ina_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("ina", false);
+	esp32_prefs.putUChar("rate", g_ina_rate);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_ina[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Current sensor commands
+	{"+INA", "Get/Set current sensor sampler rate 0 = off or 1 to 50 Hz", at_query_ina, at_set_ina, at_query_ina, "RW"},
+};
+
+/**
+ * @brief Query the particle matter power schedule
+ *
+ * @return int 0
+ */
+static int at_query_pms(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d:%d", g_pms_lead, g_pms_frames);
+	return 0;
+}
+
+/**
+ * @brief Set the particle matter power schedule
+ *
+ * @param str lead time in seconds and number of frames, e.g. 40:5
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_pms(char *str)
+{
+	char *param = strtok(str, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long new_lead = strtol(param, NULL, 0);
+	param = strtok(NULL, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long new_frames = strtol(param, NULL, 0);
+	if ((new_lead < 0) || (new_lead > 0xFFFF) || (new_frames < 0) || (new_frames > 0xFF))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	if (!set_rak12039((uint16_t)new_lead, (uint8_t)new_frames))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_pms_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved particle matter power schedule
+ *
+ */
+void read_pms_settings(void)
+{
+	uint16_t saved_lead = PMS_LEAD_DEFAULT;
+	uint8_t saved_frames = PMS_FRAMES_DEFAULT;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(pms_name))
+	{
+		pms_file.open(pms_name, FILE_O_READ);
+		pms_file.read((void *)&saved_lead, sizeof(saved_lead));
+		pms_file.read((void *)&saved_frames, sizeof(saved_frames));
+		pms_file.close();
+		MYLOG("USR_AT", "File found, lead time %d s, %d frames", saved_lead, saved_frames);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("pms", false);
+	saved_lead = esp32_prefs.getUShort("lead", PMS_LEAD_DEFAULT);
+	saved_frames = esp32_prefs.getUChar("frames", PMS_FRAMES_DEFAULT);
+	prefs_end();
+#endif
+	if (!set_rak12039(saved_lead, saved_frames))
+	{
+		set_rak12039(PMS_LEAD_DEFAULT, PMS_FRAMES_DEFAULT);
+	}
+}
+
+/**
+ * @brief Save the particle matter power schedule
+ *
+ */
+void save_pms_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(pms_name);
+	if ((g_pms_lead != PMS_LEAD_DEFAULT) || (g_pms_frames != PMS_FRAMES_DEFAULT))
+	{
+		pms_file.open(pms_name, FILE_O_WRITE);
+		pms_file.write((const char *)&g_pms_lead, sizeof(g_pms_lead));
+		pms_file.write((const char *)&g_pms_frames, sizeof(g_pms_frames));
+		pms_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("pms", false);
+	esp32_prefs.putUShort("lead", g_pms_lead);
+	esp32_prefs.putUChar("frames", g_pms_frames);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_pms[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Particle matter sensor commands
+	{"+PMS", "Get/Set particle matter sensor lead time in s and number of averaged frames, e.g. 40:5", at_query_pms, at_set_pms, at_query_pms, "RW"},
+};
+
+/**
+ * @brief Query the thermal frame blob interval
+ *
+ * @return int 0
+ */
+static int at_query_tblob(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_mlx_blob_interval);
+	return 0;
+}
+
+/**
+ * @brief Set the thermal frame blob interval
+ *
+ * @param str sensor uplinks between two blobs, 0 = off
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_tblob(char *str)
+{
+	long new_interval = strtol(str, NULL, 0);
+	if ((new_interval < 0) || (new_interval > MLX_BLOB_INTERVAL_MAX))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	set_blob_rak12052((uint8_t)new_interval);
+	save_tblob_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved thermal frame blob interval
+ *
+ */
+void read_tblob_settings(void)
+{
+	uint8_t saved_interval = MLX_BLOB_INTERVAL_DEFAULT;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(tblob_name))
+	{
+		tblob_file.open(tblob_name, FILE_O_READ);
+		tblob_file.read((void *)&saved_interval, sizeof(saved_interval));
+		tblob_file.close();
+		MYLOG("USR_AT", "File found, thermal blob every %d uplinks", saved_interval);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("tblob", false);
+	saved_interval = esp32_prefs.getUChar("interval", MLX_BLOB_INTERVAL_DEFAULT);
+	prefs_end();
+#endif
+	if (!set_blob_rak12052(saved_interval))
+	{
+		set_blob_rak12052(MLX_BLOB_INTERVAL_DEFAULT);
+	}
+}
+
+/**
+ * @brief Save the thermal frame blob interval
+ *
+ */
+void save_tblob_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(tblob_name);
+	if (g_mlx_blob_interval != MLX_BLOB_INTERVAL_DEFAULT)
+	{
+		tblob_file.open(tblob_name, FILE_O_WRITE);
+		tblob_file.write((const char *)&g_mlx_blob_interval, sizeof(g_mlx_blob_interval));
+		tblob_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("tblob", false);
+	esp32_prefs.putUChar("interval", g_mlx_blob_interval);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_tblob[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Thermal array commands
+	{"+TBLOB", "Get/Set thermal frame blob interval in sensor uplinks 0 = off or 1 to 100", at_query_tblob, at_set_tblob, at_query_tblob, "RW"},
+};
+
+/**
+ * @brief Query the gas sensor heater schedule
+ *
+ * @return int 0
+ */
+static int at_query_mqx(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d:%d", g_mqx_preheat, g_mqx_samples);
+	return 0;
+}
+
+/**
+ * @brief Set the gas sensor heater schedule
+ *
+ * @param str pre-heat time in seconds and number of samples, e.g. 60:32
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_mqx(char *str)
+{
+	char *param = strtok(str, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long new_preheat = strtol(param, NULL, 0);
+	param = strtok(NULL, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long new_samples = strtol(param, NULL, 0);
+	if ((new_preheat < 0) || (new_preheat > 0xFFFF) || (new_samples < 0) || (new_samples > 0xFF))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	if (!set_mqx((uint16_t)new_preheat, (uint8_t)new_samples))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_mqx_settings();
+	return 0;
+}
+
+/**
+ * @brief Query the R0 values of the MQ2 and the MQ3
+ *
+ * @return int 0
+ */
+static int at_query_mqx_r0(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%.3f:%.3f", g_mqx_r0[MQX_MQ2], g_mqx_r0[MQX_MQ3]);
+	return 0;
+}
+
+/**
+ * @brief Manually set the R0 values of the MQ2 and the MQ3
+ *
+ * @param str R0 of the MQ2 and of the MQ3, e.g. 12.5:8.3, 0 to recalibrate after the next pre-heat
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_mqx_r0(char *str)
+{
+	float new_r0[MQX_NUM];
+	char *param = strtok(str, ":");
+	for (uint8_t idx = 0; idx < MQX_NUM; idx++)
+	{
+		if (param == NULL)
+		{
+			return AT_ERRNO_PARA_NUM;
+		}
+		char *end_ptr;
+		new_r0[idx] = strtof(param, &end_ptr);
+		if ((end_ptr == param) || (new_r0[idx] < 0.0) || isinf(new_r0[idx]) || isnan(new_r0[idx]))
+		{
+			return AT_ERRNO_PARA_VAL;
+		}
+		param = strtok(NULL, ":");
+	}
+	for (uint8_t idx = 0; idx < MQX_NUM; idx++)
+	{
+		mqx_set_r0(idx, new_r0[idx]);
+	}
+	save_mqx_settings();
+	return 0;
+}
+
+/**
+ * @brief Start R0 calibration, the sensor must be in clean air
+ *
+ * @return int 0
+ */
+static int at_exec_mqx_r0(void)
+{
+	AT_PRINTF("R0 calibration starts after %d s pre-heat\n", g_mqx_preheat);
+	mqx_request_calibration();
+	return 0;
+}
+
+/**
+ * @brief Read saved gas sensor heater schedule and R0
+ *
+ */
+void read_mqx_settings(void)
+{
+	uint16_t saved_preheat = MQX_PREHEAT_DEFAULT;
+	uint8_t saved_samples = MQX_SAMPLES_DEFAULT;
+	// Files from older versions have only the R0 of the MQ2
+	float saved_r0[MQX_NUM] = {0.0, 0.0};
+#ifdef NRF52_SERIES
+	settings_lock();
+	if (InternalFS.exists(mqx_name))
+	{
+		mqx_file.open(mqx_name, FILE_O_READ);
+		mqx_file.read((void *)&saved_preheat, sizeof(saved_preheat));
+		mqx_file.read((void *)&saved_samples, sizeof(saved_samples));
+		mqx_file.read((void *)&saved_r0[MQX_MQ2], sizeof(float));
+		mqx_file.read((void *)&saved_r0[MQX_MQ3], sizeof(float));
+		mqx_file.close();
+		MYLOG("USR_AT", "File found, pre-heat %d s, %d samples, R0 %.3f/%.3f", saved_preheat, saved_samples, saved_r0[MQX_MQ2], saved_r0[MQX_MQ3]);
+	}
+	settings_unlock();
+#endif
+#ifdef ESP32
+	prefs_begin("mqx", false);
+	saved_preheat = esp32_prefs.getUShort("preheat", MQX_PREHEAT_DEFAULT);
+	saved_samples = esp32_prefs.getUChar("samples", MQX_SAMPLES_DEFAULT);
+	saved_r0[MQX_MQ2] = esp32_prefs.getFloat("r0", 0.0);
+	saved_r0[MQX_MQ3] = esp32_prefs.getFloat("r0_mq3", 0.0);
+	prefs_end();
+#endif
+	if (!set_mqx(saved_preheat, saved_samples))
+	{
+		set_mqx(MQX_PREHEAT_DEFAULT, MQX_SAMPLES_DEFAULT);
+	}
+	for (uint8_t idx = 0; idx < MQX_NUM; idx++)
+	{
+		if (!mqx_set_r0(idx, saved_r0[idx]))
+		{
+			mqx_set_r0(idx, 0.0);
+		}
+	}
+}
+
+/**
+ * @brief Save the gas sensor heater schedule and R0
+ *     Called from the app loop and from the gas sensor task
+ *
+ */
+void save_mqx_settings(void)
+{
+#ifdef NRF52_SERIES
+	settings_lock();
+	InternalFS.remove(mqx_name);
+	mqx_file.open(mqx_name, FILE_O_WRITE);
+	mqx_file.write((const char *)&g_mqx_preheat, sizeof(g_mqx_preheat));
+	mqx_file.write((const char *)&g_mqx_samples, sizeof(g_mqx_samples));
+	mqx_file.write((const char *)&g_mqx_r0[MQX_MQ2], sizeof(float));
+	mqx_file.write((const char *)&g_mqx_r0[MQX_MQ3], sizeof(float));
+	mqx_file.close();
+	settings_unlock();
+#endif
+#ifdef ESP32
+	prefs_begin("mqx", false);
+	esp32_prefs.putUShort("preheat", g_mqx_preheat);
+	esp32_prefs.putUChar("samples", g_mqx_samples);
+	esp32_prefs.putFloat("r0", g_mqx_r0[MQX_MQ2]);
+	esp32_prefs.putFloat("r0_mq3", g_mqx_r0[MQX_MQ3]);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_mqx[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Gas sensor commands
+	{"+MQX", "Get/Set gas sensor pre-heat time in s and number of samples, e.g. 60:32", at_query_mqx, at_set_mqx, at_query_mqx, "RW"},
+	{"+MQXCAL", "Get/Set gas sensor R0 of MQ2:MQ3, e.g. 12.5:8.3, or start R0 calibration in clean air", at_query_mqx_r0, at_set_mqx_r0, at_exec_mqx_r0, "XRW"},
+};
+
+/*****************************************
+ * Fragmented uplink AT commands
+ *****************************************/
+
+/**
+ * @brief Query the fragmented uplink settings
+ *
+ * @return int 0
+ */
+static int at_query_frag(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d:%d", g_frag_group, g_frag_gap);
+	return 0;
+}
+
+/**
+ * @brief Set the fragmented uplink settings
+ *
+ * @param str parity group size and gap between fragments in seconds, e.g. 4:5
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_frag(char *str)
+{
+	char *param = strtok(str, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long new_group = strtol(param, NULL, 0);
+	param = strtok(NULL, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long new_gap = strtol(param, NULL, 0);
+	if ((new_group < 0) || (new_group > 0xFF) || (new_gap < 0) || (new_gap > 0xFFFF))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	if (!set_frag((uint8_t)new_group, (uint16_t)new_gap))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_frag_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved fragmented uplink settings
+ *
+ */
+void read_frag_settings(void)
+{
+	uint8_t saved_group = FRAG_GROUP_DEFAULT;
+	uint16_t saved_gap = FRAG_GAP_DEFAULT;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(frag_name))
+	{
+		frag_file.open(frag_name, FILE_O_READ);
+		frag_file.read((void *)&saved_group, sizeof(saved_group));
+		frag_file.read((void *)&saved_gap, sizeof(saved_gap));
+		frag_file.close();
+		MYLOG("USR_AT", "File found, parity group %d, gap %d s", saved_group, saved_gap);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("frag", false);
+	saved_group = esp32_prefs.getUChar("group", FRAG_GROUP_DEFAULT);
+	saved_gap = esp32_prefs.getUShort("gap", FRAG_GAP_DEFAULT);
+	prefs_end();
+#endif
+	if (!set_frag(saved_group, saved_gap))
+	{
+		set_frag(FRAG_GROUP_DEFAULT, FRAG_GAP_DEFAULT);
+	}
+}
+
+/**
+ * @brief Save the fragmented uplink settings
+ *
+ */
+void save_frag_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(frag_name);
+	if ((g_frag_group != FRAG_GROUP_DEFAULT) || (g_frag_gap != FRAG_GAP_DEFAULT))
+	{
+		frag_file.open(frag_name, FILE_O_WRITE);
+		frag_file.write((const char *)&g_frag_group, sizeof(g_frag_group));
+		frag_file.write((const char *)&g_frag_gap, sizeof(g_frag_gap));
+		frag_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("frag", false);
+	esp32_prefs.putUChar("group", g_frag_group);
+	esp32_prefs.putUShort("gap", g_frag_gap);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_frag[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Fragmented uplink commands
+	{"+FRAG", "Get/Set data fragments per parity fragment (0 = off) and gap between fragments in s, e.g. 4:5", at_query_frag, at_set_frag, at_query_frag, "RW"},
+};
+
+/*****************************************
+ * Uplink packer AT commands
+ *****************************************/
+
+/**
+ * @brief Query the uplink packer mode
+ *
+ * @return int 0
+ */
+static int at_query_pack(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_pack_mode);
+	return 0;
+}
+
+/**
+ * @brief Set the uplink packer mode
+ *
+ * @param str 0 = send oversized packets in fragments, 1 = fill up to the current DR
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_pack(char *str)
+{
+	long new_mode = strtol(str, NULL, 0);
+	if ((new_mode < 0) || (new_mode > 0xFF) || !set_pack_mode((uint8_t)new_mode))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_pack_settings();
+	return 0;
+}
+
+/**
+ * @brief Query the channel priorities that differ from the default
+ *
+ * @return int 0
+ */
+static int at_query_prio(void)
+{
+	uint16_t len = snprintf(g_at_query_buf, ATQUERY_SIZE, "default %d", PACK_PRIO_DEFAULT);
+	for (uint8_t channel = 0; (channel <= PACK_MAX_CHANNEL) && (len < ATQUERY_SIZE); channel++)
+	{
+		if (g_pack_prio[channel] != 0)
+		{
+			len += snprintf(&g_at_query_buf[len], ATQUERY_SIZE - len, " %d:%d", channel, g_pack_prio[channel]);
+		}
+	}
+	return 0;
+}
+
+/**
+ * @brief Set the priority of a channel
+ *
+ * @param str channel and priority, e.g. 3:7, priority 0 restores the default
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_prio(char *str)
+{
+	char *param = strtok(str, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long channel = strtol(param, NULL, 0);
+	param = strtok(NULL, ":");
+	if (param == NULL)
+	{
+		return AT_ERRNO_PARA_NUM;
+	}
+	long prio = strtol(param, NULL, 0);
+	if ((channel < 0) || (channel > 0xFF) || (prio < 0) || (prio > 0xFF))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	if (!set_pack_prio((uint8_t)channel, (uint8_t)prio))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_pack_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved uplink packer settings
+ *
+ */
+void read_pack_settings(void)
+{
+	uint8_t saved_mode = PACK_MODE_DEFAULT;
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(pack_name))
+	{
+		pack_file.open(pack_name, FILE_O_READ);
+		pack_file.read((void *)&saved_mode, sizeof(saved_mode));
+		pack_file.read((void *)g_pack_prio, PACK_MAX_CHANNEL + 1);
+		pack_file.close();
+		MYLOG("USR_AT", "File found, packer mode %d", saved_mode);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("pack", false);
+	saved_mode = esp32_prefs.getUChar("mode", PACK_MODE_DEFAULT);
+	if (esp32_prefs.getBytesLength("prio") == PACK_MAX_CHANNEL + 1)
+	{
+		esp32_prefs.getBytes("prio", g_pack_prio, PACK_MAX_CHANNEL + 1);
+	}
+	prefs_end();
+#endif
+	if (!set_pack_mode(saved_mode))
+	{
+		set_pack_mode(PACK_MODE_DEFAULT);
+	}
+	for (uint8_t channel = 0; channel <= PACK_MAX_CHANNEL; channel++)
+	{
+		if (g_pack_prio[channel] > PACK_PRIO_MAX)
+		{
+			g_pack_prio[channel] = 0;
+		}
+	}
+}
+
+/**
+ * @brief Save the uplink packer settings
+ *
+ */
+void save_pack_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(pack_name);
+	pack_file.open(pack_name, FILE_O_WRITE);
+	pack_file.write((const char *)&g_pack_mode, sizeof(g_pack_mode));
+	pack_file.write((const char *)g_pack_prio, PACK_MAX_CHANNEL + 1);
+	pack_file.close();
+#endif
+#ifdef ESP32
+	prefs_begin("pack", false);
+	esp32_prefs.putUChar("mode", g_pack_mode);
+	esp32_prefs.putBytes("prio", g_pack_prio, PACK_MAX_CHANNEL + 1);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_pack[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Uplink packer commands
+	{"+PACK", "Get/Set oversized packet handling, 0 = fragments, 1 = fill up to the current DR by priority", at_query_pack, at_set_pack, at_query_pack, "RW"},
+	{"+PRIO", "Get/Set LPP channel priority 1 to 7 (0 = default), e.g. 3:7", at_query_prio, at_set_prio, at_query_prio, "RW"},
+};
+
+/*****************************************
+ * Time sync AT commands
+ *****************************************/
+
+/**
+ * @brief Query the last time correction, the clock drift, the sync interval and the periodic sync
+ *
+ * @return int 0
+ */
+static int at_query_tsync(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%ld:%.2f:%ld:%d:%d", g_clock_offset, g_clock_drift, g_clock_interval, clock_valid() ? 1 : 0, g_clock_auto ? 1 : 0);
+	return 0;
+}
+
+/**
+ * @brief Enable or disable the periodic time sync
+ *
+ * @param str 0 = sync only on request, 1 = sync after the first uplink and then periodically
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_tsync(char *str)
+{
+	if (str[0] == '0')
+	{
+		g_clock_auto = false;
+	}
+	else if (str[0] == '1')
+	{
+		g_clock_auto = true;
+	}
+	else
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_tsync_settings();
+	return 0;
+}
+
+/**
+ * @brief Read saved periodic time sync setting
+ *
+ */
+void read_tsync_settings(void)
+{
+#ifdef NRF52_SERIES
+	g_clock_auto = InternalFS.exists(tsync_name);
+#endif
+#ifdef ESP32
+	prefs_begin("tsync", false);
+	g_clock_auto = esp32_prefs.getBool("auto", false);
+	prefs_end();
+#endif
+	MYLOG("USR_AT", "Periodic time sync %s", g_clock_auto ? "on" : "off");
+}
+
+/**
+ * @brief Save the periodic time sync setting
+ *
+ */
+void save_tsync_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(tsync_name);
+	if (g_clock_auto)
+	{
+		tsync_file.open(tsync_name, FILE_O_WRITE);
+		tsync_file.write("1");
+		tsync_file.close();
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("tsync", false);
+	esp32_prefs.putBool("auto", g_clock_auto);
+	prefs_end();
+#endif
+}
+
+/**
+ * @brief Request a time sync with the next uplink
+ *
+ * @return int 0
+ */
+static int at_exec_tsync(void)
+{
+	AT_PRINTF("Time sync requested with the next uplink\n");
+	clock_sync_force();
+	return 0;
+}
+
+atcmd_t g_user_at_cmd_list_tsync[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Time sync commands
+	{"+TSYNC", "Get last time correction in s, drift in ppm, sync interval in s, time status and periodic sync/Set periodic sync 0 = off, 1 = on or request a time sync", at_query_tsync, at_set_tsync, at_exec_tsync, "RW"},
+};
+
+/*****************************************
+ * Payload authentication AT commands
+ *****************************************/
+
+/**
+ * @brief Query the MAC length
+ *
+ * @return int 0
+ */
+static int at_query_mac(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_auth_mac_len);
+	return 0;
+}
+
+/**
+ * @brief Set the MAC length
+ *
+ * @param str MAC length in bytes, 0 = off
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_mac(char *str)
+{
+	long new_len = strtol(str, NULL, 0);
+	if ((new_len < 0) || (new_len > 0xFF) || !set_auth_mac((uint8_t)new_len))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	save_auth_settings();
+	return 0;
+}
+
+/**
+ * @brief Query the HMAC key status, the key itself is never shown
+ *
+ * @return int 0
+ */
+static int at_query_mac_key(void)
+{
+	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d", g_auth_key_len);
+	return 0;
+}
+
+/**
+ * @brief Set the HMAC key
+ *
+ * @param str key as hex string, up to 32 bytes, 0 to remove the key
+ * @return int 0 if successful, otherwise error value
+ */
+static int at_set_mac_key(char *str)
+{
+	uint8_t new_key[AUTH_KEY_MAX];
+	size_t str_len = strlen(str);
+	if ((str_len == 1) && (str[0] == '0'))
+	{
+		str_len = 0;
+	}
+	if (((str_len % 2) != 0) || (str_len > AUTH_KEY_MAX * 2))
+	{
+		return AT_ERRNO_PARA_VAL;
+	}
+	for (size_t idx = 0; idx < str_len; idx += 2)
+	{
+		char hex_byte[3] = {str[idx], str[idx + 1], 0};
+		if (!isxdigit(hex_byte[0]) || !isxdigit(hex_byte[1]))
+		{
+			return AT_ERRNO_PARA_VAL;
+		}
+		new_key[idx / 2] = (uint8_t)strtoul(hex_byte, NULL, 16);
+	}
+	set_auth_key(new_key, str_len / 2);
+	save_auth_settings();
+	return 0;
+}
+
+/**
+ * @brief Run the SHA256 benchmark
+ *
+ * @return int 0
+ */
+static int at_exec_mac_bench(void)
+{
+	i2c_lock();
+	auth_benchmark();
+	i2c_unlock();
+	return 0;
+}
+
+/**
+ * @brief Read saved payload authentication settings
+ *
+ */
+void read_auth_settings(void)
+{
+	uint8_t saved_len = 0;
+	uint8_t saved_key_len = 0;
+	uint8_t saved_key[AUTH_KEY_MAX] = {0};
+#ifdef NRF52_SERIES
+	if (InternalFS.exists(auth_name))
+	{
+		auth_file.open(auth_name, FILE_O_READ);
+		auth_file.read((void *)&saved_len, sizeof(saved_len));
+		auth_file.read((void *)&saved_key_len, sizeof(saved_key_len));
+		auth_file.read((void *)saved_key, AUTH_KEY_MAX);
+		auth_file.close();
+		MYLOG("USR_AT", "File found, MAC length %d", saved_len);
+	}
+#endif
+#ifdef ESP32
+	prefs_begin("auth", false);
+	saved_len = esp32_prefs.getUChar("mac", 0);
+	if (esp32_prefs.getBytesLength("key") <= AUTH_KEY_MAX)
+	{
+		saved_key_len = esp32_prefs.getBytes("key", saved_key, AUTH_KEY_MAX);
+	}
+	prefs_end();
+#endif
+	if (!set_auth_mac(saved_len))
+	{
+		set_auth_mac(0);
+	}
+	if (!set_auth_key(saved_key, saved_key_len))
+	{
+		set_auth_key(saved_key, 0);
+	}
+}
+
+/**
+ * @brief Save the payload authentication settings
+ *
+ */
+void save_auth_settings(void)
+{
+#ifdef NRF52_SERIES
+	InternalFS.remove(auth_name);
+	auth_file.open(auth_name, FILE_O_WRITE);
+	auth_file.write((const char *)&g_auth_mac_len, sizeof(g_auth_mac_len));
+	auth_file.write((const char *)&g_auth_key_len, sizeof(g_auth_key_len));
+	auth_file.write((const char *)g_auth_key, AUTH_KEY_MAX);
+	auth_file.close();
+#endif
+#ifdef ESP32
+	prefs_begin("auth", false);
+	esp32_prefs.putUChar("mac", g_auth_mac_len);
+	esp32_prefs.putBytes("key", g_auth_key, g_auth_key_len);
+	prefs_end();
+#endif
+}
+
+atcmd_t g_user_at_cmd_list_auth[] = {
+	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+	// Payload authentication commands
+	{"+MAC", "Get/Set length of the HMAC appended to uplinks in bytes, 0 = off, 4 to 16", at_query_mac, at_set_mac, at_query_mac, "RW"},
+	{"+MACKEY", "Get HMAC key length/Set HMAC key as hex string, up to 32 bytes", at_query_mac_key, at_set_mac_key, at_query_mac_key, "RW"},
+	{"+MACBENCH", "Compare SHA256 speed of the RAK5814 and the MCU", NULL, NULL, at_exec_mac_bench, "X"},
+};
+
+/**
+ * @brief Read the VOC algorithm checkpoint
+ *
+ * @param state pointer to the state structure
+ * @return true checkpoint found
+ * @return false no checkpoint saved
+ */
+bool read_voc_state(voc_state_s *state)
+{
+	bool result = false;
+#ifdef NRF52_SERIES
+	settings_lock();
+	if (InternalFS.exists(voc_name))
+	{
+		voc_file.open(voc_name, FILE_O_READ);
+		if (voc_file.size() == sizeof(voc_state_s))
+		{
+			voc_file.read((void *)state, sizeof(voc_state_s));
+			result = true;
+		}
+		voc_file.close();
+	}
+	settings_unlock();
+#endif
+#ifdef ESP32
+	prefs_begin("voc", false);
+	if (esp32_prefs.getBytesLength("state") == sizeof(voc_state_s))
+	{
+		esp32_prefs.getBytes("state", (void *)state, sizeof(voc_state_s));
+		result = true;
+	}
+	prefs_end();
+#endif
+	return result;
+}
+
+/**
+ * @brief Save the VOC algorithm checkpoint
+ *     Called from the VOC task
+ *
+ * @param state pointer to the state structure
+ */
+void save_voc_state(voc_state_s *state)
+{
+#ifdef NRF52_SERIES
+	settings_lock();
+	InternalFS.remove(voc_name);
+	voc_file.open(voc_name, FILE_O_WRITE);
+	voc_file.write((const char *)state, sizeof(voc_state_s));
+	voc_file.close();
+	settings_unlock();
+#endif
+#ifdef ESP32
+	prefs_begin("voc", false);
+	esp32_prefs.putBytes("state", (const void *)state, sizeof(voc_state_s));
+	prefs_end();
+#endif
+}
+
+// #if USE_BSEC == 1
+// /**
+//  * @brief Query IAQ accuracy, state save interval and age of the saved state
+//  *
+//  * @return int 0
+//  */
+// static int at_query_bsec(void)
+// {
+// 	snprintf(g_at_query_buf, ATQUERY_SIZE, "%d:%d:%ld", get_accuracy_rak1906_bsec(), g_bsec_save_hours, get_save_age_rak1906_bsec());
+// 	return 0;
+// }
+//
+// /**
+//  * @brief Set the BSEC state save interval
+//  *
+//  * @param str interval in hours, 0 disables saving
+//  * @return int 0 if successful, otherwise error value
+//  */
+// static int at_set_bsec(char *str)
+// {
+// 	long new_hours = strtol(str, NULL, 0);
+// 	if ((new_hours < 0) || (new_hours > BSEC_SAVE_MAX))
+// 	{
+// 		return AT_ERRNO_PARA_VAL;
+// 	}
+// 	g_bsec_save_hours = new_hours;
+// 	save_bsec_settings();
+// 	return 0;
+// }
+//
+// /**
+//  * @brief Read saved BSEC state save interval
+//  *
+//  */
+// void read_bsec_settings(void)
+// {
+// 	uint16_t saved_hours = BSEC_SAVE_DEFAULT;
+// #ifdef NRF52_SERIES
+// 	if (InternalFS.exists(bsec_name))
+// 	{
+// 		bsec_file.open(bsec_name, FILE_O_READ);
+// 		bsec_file.read((void *)&saved_hours, sizeof(saved_hours));
+// 		bsec_file.close();
+// 		MYLOG("USR_AT", "File found, BSEC state save interval %d h", saved_hours);
+// 	}
+// #endif
+// #ifdef ESP32
+// 	prefs_begin("bsec", false);
+// 	saved_hours = esp32_prefs.getUShort("hours", BSEC_SAVE_DEFAULT);
+// 	prefs_end();
+// #endif
+// 	if (saved_hours > BSEC_SAVE_MAX)
+// 	{
+// 		saved_hours = BSEC_SAVE_DEFAULT;
+// 	}
+// 	g_bsec_save_hours = saved_hours;
+// }
+//
+// /**
+//  * @brief Save the BSEC state save interval
+//  *
+//  */
+// void save_bsec_settings(void)
+// {
+// #ifdef NRF52_SERIES
+// 	InternalFS.remove(bsec_name);
+// 	if (g_bsec_save_hours != BSEC_SAVE_DEFAULT)
+// 	{
+// 		bsec_file.open(bsec_name, FILE_O_WRITE);
+// 		bsec_file.write((const char *)&g_bsec_save_hours, sizeof(g_bsec_save_hours));
+// 		bsec_file.close();
+// 	}
+// #endif
+// #ifdef ESP32
+// 	prefs_begin("bsec", false);
+// 	esp32_prefs.putUShort("hours", g_bsec_save_hours);
+// 	prefs_end();
+// #endif
+// }
+//
+// /**
+//  * @brief Read the saved BSEC state
+//  *
+//  * @param state buffer for the state
+//  * @param size size of the state
+//  * @param accuracy pointer to the IAQ accuracy of the saved state
+//  * @return true state found
+//  * @return false no state saved or size mismatch
+//  */
+// bool read_bsec_state(uint8_t *state, uint16_t size, uint8_t *accuracy)
+// {
+// 	bool result = false;
+// #ifdef NRF52_SERIES
+// 	if (InternalFS.exists(bsec_state_name))
+// 	{
+// 		bsec_file.open(bsec_state_name, FILE_O_READ);
+// 		if (bsec_file.size() == (uint32_t)(size + 1))
+// 		{
+// 			bsec_file.read((void *)accuracy, 1);
+// 			bsec_file.read((void *)state, size);
+// 			result = true;
+// 		}
+// 		bsec_file.close();
+// 	}
+// #endif
+// #ifdef ESP32
+// 	prefs_begin("bsec", false);
+// 	if (esp32_prefs.getBytesLength("state") == size)
+// 	{
+// 		esp32_prefs.getBytes("state", state, size);
+// 		*accuracy = esp32_prefs.getUChar("acc", 0);
+// 		result = true;
+// 	}
+// 	prefs_end();
+// #endif
+// 	return result;
+// }
+//
+// /**
+//  * @brief Save the BSEC state
+//  *
+//  * @param state BSEC state
+//  * @param size size of the state
+//  * @param accuracy IAQ accuracy of the state
+//  */
+// void save_bsec_state(uint8_t *state, uint16_t size, uint8_t accuracy)
+// {
+// #ifdef NRF52_SERIES
+// 	InternalFS.remove(bsec_state_name);
+// 	bsec_file.open(bsec_state_name, FILE_O_WRITE);
+// 	bsec_file.write((const char *)&accuracy, 1);
+// 	bsec_file.write((const char *)state, size);
+// 	bsec_file.close();
+// #endif
+// #ifdef ESP32
+// 	prefs_begin("bsec", false);
+// 	esp32_prefs.putBytes("state", state, size);
+// 	esp32_prefs.putUChar("acc", accuracy);
+// 	prefs_end();
+// #endif
+// }
+//
+// atcmd_t g_user_at_cmd_list_bsec[] = {
+// 	/*|    CMD    |     AT+CMD?      |    AT+CMD=?    |  AT+CMD=value |  AT+CMD  | Permission |*/
+// 	// BSEC commands
+// 	{"+BSEC", "Get IAQ accuracy:save interval:s since last save, Set state save interval 0 = off or 1 to 168 h", at_query_bsec, at_set_bsec, at_query_bsec, "RW"},
+// };
+// #endif
+
+/** Number of user defined AT commands */
+uint8_t g_user_at_cmd_num = 0;
+
+/** Pointer to the combined user AT command structure */
+atcmd_t *g_user_at_cmd_list;
+
+#define TEST_ALL_CMDS 0
+
+/**
+ * @brief Initialize the user defined AT command list
+ *
+ */
+void init_user_at(void)
+{
+#if TEST_ALL_CMDS == 1
+	bool _has_rak12035 = found_sensors[SOIL_ID].found_sensor;
+	bool _has_rak1910_rak12500 = found_sensors[GNSS_ID].found_sensor;
+	bool _has_rak12002 = found_sensors[RTC_ID].found_sensor;
+	found_sensors[SOIL_ID].found_sensor = true;
+	found_sensors[GNSS_ID].found_sensor = true;
+	found_sensors[RTC_ID].found_sensor = true;
+#endif
+
+	uint16_t index_next_cmds = 0;
+	uint16_t required_structure_size = sizeof(g_user_at_cmd_list_batt);
+	MYLOG("USR_AT", "Structure size %d Battery", required_structure_size);
+	required_structure_size += sizeof(g_user_at_cmd_list_modules);
+	MYLOG("USR_AT", "Structure size %d Modules", required_structure_size);
+	required_structure_size += sizeof(g_user_at_cmd_list_frag);
+	MYLOG("USR_AT", "Structure size %d Fragmentation", required_structure_size);
+	required_structure_size += sizeof(g_user_at_cmd_list_pack);
+	MYLOG("USR_AT", "Structure size %d Packer", required_structure_size);
+	required_structure_size += sizeof(g_user_at_cmd_list_tsync);
+	MYLOG("USR_AT", "Structure size %d Time sync", required_structure_size);
+	required_structure_size += sizeof(g_user_at_cmd_list_auth);
+	MYLOG("USR_AT", "Structure size %d Authentication", required_structure_size);
+
+	// Get required size of structure
+	if (found_sensors[SOIL_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_soil);
+
+		MYLOG("USR_AT", "Structure size %d Soil", required_structure_size);
+	}
+	if (found_sensors[GNSS_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_gps);
+
+		MYLOG("USR_AT", "Structure size %d GNSS", required_structure_size);
+	}
+	if (found_sensors[RTC_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_rtc);
+
+		MYLOG("USR_AT", "Structure size %d RTC", required_structure_size);
+	}
+	if ((found_sensors[ENV_ID].found_sensor) || (found_sensors[PRESS_ID].found_sensor))
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_env);
+		MYLOG("USR_AT", "Structure size %d ENV/Pressure", required_structure_size);
+	}
+	if (found_sensors[WATER_LEVEL_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_wl);
+		MYLOG("USR_AT", "Structure size %d Water Level", required_structure_size);
+	}
+	if (found_sensors[ACC_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_vib);
+		MYLOG("USR_AT", "Structure size %d Vibration", required_structure_size);
+	}
+	if (found_sensors[MPU_ID].found_sensor || found_sensors[DOF_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_fusion);
+		MYLOG("USR_AT", "Structure size %d Fusion", required_structure_size);
+	}
+	if (found_sensors[TOF_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_tof);
+		MYLOG("USR_AT", "Structure size %d ToF", required_structure_size);
+	}
+	if (found_sensors[CURRENT_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_ina);
+		MYLOG("USR_AT", "Structure size %d Current", required_structure_size);
+	}
+	if (found_sensors[PM_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_pms);
+		MYLOG("USR_AT", "Structure size %d PM", required_structure_size);
+	}
+	if (found_sensors[TEMP_ARR_2_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_tblob);
+		MYLOG("USR_AT", "Structure size %d Thermal blob", required_structure_size);
+	}
+	if (found_sensors[MQ2_ID].found_sensor || found_sensors[MQ3_ID].found_sensor)
+	{
+		required_structure_size += sizeof(g_user_at_cmd_list_mqx);
+		MYLOG("USR_AT", "Structure size %d MQx", required_structure_size);
+	}
+// #if USE_BSEC == 1
+// 	if (found_sensors[ENV_ID].found_sensor)
+// 	{
+// 		required_structure_size += sizeof(g_user_at_cmd_list_bsec);
+// 		MYLOG("USR_AT", "Structure size %d BSEC", required_structure_size);
+// 	}
+// #endif
+
+	// Reserve memory for the structure
+	g_user_at_cmd_list = (atcmd_t *)malloc(required_structure_size);
+
+	// Add AT commands to structure
+	MYLOG("USR_AT", "Adding battery check AT commands");
+	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_batt) / sizeof(atcmd_t);
+	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_batt, sizeof(g_user_at_cmd_list_batt));
+	index_next_cmds += sizeof(g_user_at_cmd_list_batt) / sizeof(atcmd_t);
+	MYLOG("USR_AT", "Index after adding battery check %d", index_next_cmds);
+
+	MYLOG("USR_AT", "Adding module AT commands");
+	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_modules) / sizeof(atcmd_t);
+	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_modules, sizeof(g_user_at_cmd_list_modules));
+	index_next_cmds += sizeof(g_user_at_cmd_list_modules) / sizeof(atcmd_t);
+	MYLOG("USR_AT", "Index after adding modules %d", index_next_cmds);
+
+	MYLOG("USR_AT", "Adding fragmentation AT commands");
+	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_frag) / sizeof(atcmd_t);
+	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_frag, sizeof(g_user_at_cmd_list_frag));
+	index_next_cmds += sizeof(g_user_at_cmd_list_frag) / sizeof(atcmd_t);
+	MYLOG("USR_AT", "Index after adding fragmentation %d", index_next_cmds);
+
+	MYLOG("USR_AT", "Adding packer AT commands");
+	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_pack) / sizeof(atcmd_t);
+	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_pack, sizeof(g_user_at_cmd_list_pack));
+	index_next_cmds += sizeof(g_user_at_cmd_list_pack) / sizeof(atcmd_t);
+	MYLOG("USR_AT", "Index after adding packer %d", index_next_cmds);
+
+	MYLOG("USR_AT", "Adding time sync AT commands");
+	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_tsync) / sizeof(atcmd_t);
+	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_tsync, sizeof(g_user_at_cmd_list_tsync));
+	index_next_cmds += sizeof(g_user_at_cmd_list_tsync) / sizeof(atcmd_t);
+	MYLOG("USR_AT", "Index after adding time sync %d", index_next_cmds);
+
+	MYLOG("USR_AT", "Adding authentication AT commands");
+	g_user_at_cmd_num += sizeof(g_user_at_cmd_list_auth) / sizeof(atcmd_t);
+	memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_auth, sizeof(g_user_at_cmd_list_auth));
+	index_next_cmds += sizeof(g_user_at_cmd_list_auth) / sizeof(atcmd_t);
+	MYLOG("USR_AT", "Index after adding authentication %d", index_next_cmds);
+
+	if (found_sensors[SOIL_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding Soil Sensor user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_soil) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_soil, sizeof(g_user_at_cmd_list_soil));
+		index_next_cmds += sizeof(g_user_at_cmd_list_soil) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding soil %d", index_next_cmds);
+	}
+	if (found_sensors[GNSS_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding GNSS user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_gps) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_gps, sizeof(g_user_at_cmd_list_gps));
+		index_next_cmds += sizeof(g_user_at_cmd_list_gps) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding GNSS %d", index_next_cmds);
+	}
+	if (found_sensors[RTC_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding RTC user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_rtc) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_rtc, sizeof(g_user_at_cmd_list_rtc));
+		index_next_cmds += sizeof(g_user_at_cmd_list_rtc) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding RTC %d", index_next_cmds);
+	}
+	if ((found_sensors[ENV_ID].found_sensor) || (found_sensors[PRESS_ID].found_sensor))
+	{
+		MYLOG("USR_AT", "Adding ENV user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_env) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_env, sizeof(g_user_at_cmd_list_env));
+		index_next_cmds += sizeof(g_user_at_cmd_list_env) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding env %d", index_next_cmds);
 	}
 	if (found_sensors[WATER_LEVEL_ID].found_sensor)
 	{
@@ -1219,6 +3020,72 @@ void init_user_at(void)
 		index_next_cmds += sizeof(g_user_at_cmd_list_wl) / sizeof(atcmd_t);
 		MYLOG("USR_AT", "Index after adding Water Level %d", index_next_cmds);
 	}
+	if (found_sensors[ACC_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding Vibration user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_vib) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_vib, sizeof(g_user_at_cmd_list_vib));
+		index_next_cmds += sizeof(g_user_at_cmd_list_vib) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding Vibration %d", index_next_cmds);
+	}
+	if (found_sensors[MPU_ID].found_sensor || found_sensors[DOF_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding Fusion user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_fusion) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_fusion, sizeof(g_user_at_cmd_list_fusion));
+		index_next_cmds += sizeof(g_user_at_cmd_list_fusion) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding Fusion %d", index_next_cmds);
+	}
+	if (found_sensors[TOF_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding ToF user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_tof) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_tof, sizeof(g_user_at_cmd_list_tof));
+		index_next_cmds += sizeof(g_user_at_cmd_list_tof) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding ToF %d", index_next_cmds);
+	}
+	if (found_sensors[CURRENT_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding Current sensor user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_ina) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_ina, sizeof(g_user_at_cmd_list_ina));
+		index_next_cmds += sizeof(g_user_at_cmd_list_ina) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding Current %d", index_next_cmds);
+	}
+	if (found_sensors[PM_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding particle matter sensor user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_pms) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_pms, sizeof(g_user_at_cmd_list_pms));
+		index_next_cmds += sizeof(g_user_at_cmd_list_pms) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding PM %d", index_next_cmds);
+	}
+	if (found_sensors[TEMP_ARR_2_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding thermal array user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_tblob) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_tblob, sizeof(g_user_at_cmd_list_tblob));
+		index_next_cmds += sizeof(g_user_at_cmd_list_tblob) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding Thermal blob %d", index_next_cmds);
+	}
+	if (found_sensors[MQ2_ID].found_sensor || found_sensors[MQ3_ID].found_sensor)
+	{
+		MYLOG("USR_AT", "Adding gas sensor user AT commands");
+		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_mqx) / sizeof(atcmd_t);
+		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_mqx, sizeof(g_user_at_cmd_list_mqx));
+		index_next_cmds += sizeof(g_user_at_cmd_list_mqx) / sizeof(atcmd_t);
+		MYLOG("USR_AT", "Index after adding MQx %d", index_next_cmds);
+	}
+// #if USE_BSEC == 1
+// 	if (found_sensors[ENV_ID].found_sensor)
+// 	{
+// 		MYLOG("USR_AT", "Adding BSEC user AT commands");
+// 		g_user_at_cmd_num += sizeof(g_user_at_cmd_list_bsec) / sizeof(atcmd_t);
+// 		memcpy((void *)&g_user_at_cmd_list[index_next_cmds], (void *)g_user_at_cmd_list_bsec, sizeof(g_user_at_cmd_list_bsec));
+// 		index_next_cmds += sizeof(g_user_at_cmd_list_bsec) / sizeof(atcmd_t);
+// 		MYLOG("USR_AT", "Index after adding BSEC %d", index_next_cmds);
+// 	}
+// #endif
 
 #if TEST_ALL_CMDS == 1
 	found_sensors[SOIL_ID].found_sensor = _has_rak12035;
@@ -0,0 +1,199 @@
+/**
+ * @file vib_features.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Vibration feature extraction (RMS, peak, crest factor and
+ *        dominant frequency) for machine condition monitoring.
+ *        The dominant frequency is found with a fixed size real FFT,
+ *        calculated as a half size complex FFT on the packed samples.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Half size of the FFT, size of the complex FFT used for the real FFT */
+#define VIB_FFT_HALF (VIB_FFT_SIZE / 2)
+
+/** Twiddle factors W_N^k, real part */
+static float twiddle_re[VIB_FFT_HALF];
+/** Twiddle factors W_N^k, imaginary part */
+static float twiddle_im[VIB_FFT_HALF];
+/** Hann window */
+static float hann_window[VIB_FFT_SIZE];
+/** Flag if the tables are calculated */
+static bool tables_ready = false;
+
+/**
+ * @brief Calculate the twiddle factors and the window once
+ *
+ */
+static void init_tables(void)
+{
+	for (uint16_t k = 0; k < VIB_FFT_HALF; k++)
+	{
+		float angle = -2.0f * (float)M_PI * (float)k / (float)VIB_FFT_SIZE;
+		twiddle_re[k] = cosf(angle);
+		twiddle_im[k] = sinf(angle);
+	}
+	for (uint16_t n = 0; n < VIB_FFT_SIZE; n++)
+	{
+		hann_window[n] = 0.5f - 0.5f * cosf(2.0f * (float)M_PI * (float)n / (float)VIB_FFT_SIZE);
+	}
+	tables_ready = true;
+}
+
+/**
+ * @brief In place radix-2 complex FFT with VIB_FFT_HALF points
+ *
+ * @param re real parts
+ * @param im imaginary parts
+ */
+static void fft_half(float *re, float *im)
+{
+	// Bit reversal
+	for (uint16_t i = 1, j = 0; i < VIB_FFT_HALF; i++)
+	{
+		uint16_t bit = VIB_FFT_HALF >> 1;
+		for (; j & bit; bit >>= 1)
+		{
+			j ^= bit;
+		}
+		j ^= bit;
+		if (i < j)
+		{
+			float tmp = re[i];
+			re[i] = re[j];
+			re[j] = tmp;
+			tmp = im[i];
+			im[i] = im[j];
+			im[j] = tmp;
+		}
+	}
+
+	// Butterflies, W_len^k is W_N^(k * N / len)
+	for (uint16_t len = 2; len <= VIB_FFT_HALF; len <<= 1)
+	{
+		uint16_t step = VIB_FFT_SIZE / len;
+		for (uint16_t i = 0; i < VIB_FFT_HALF; i += len)
+		{
+			for (uint16_t k = 0; k < len / 2; k++)
+			{
+				uint16_t a = i + k;
+				uint16_t b = a + len / 2;
+				float w_re = twiddle_re[k * step];
+				float w_im = twiddle_im[k * step];
+				float t_re = re[b] * w_re - im[b] * w_im;
+				float t_im = re[b] * w_im + im[b] * w_re;
+				re[b] = re[a] - t_re;
+				im[b] = im[a] - t_im;
+				re[a] += t_re;
+				im[a] += t_im;
+			}
+		}
+	}
+}
+
+/**
+ * @brief Calculate vibration features from a block of samples
+ *
+ * @param samples acceleration samples, e.g. vector magnitude in m/s^2
+ * @param num_samples number of samples, if less than VIB_FFT_SIZE the FFT is zero padded,
+ *                    if more only the last VIB_FFT_SIZE samples are used for the FFT
+ * @param sample_rate sample rate in Hz
+ * @param features pointer to the result structure
+ * @return true features calculated
+ * @return false not enough samples
+ */
+bool calc_vib_features(const float *samples, uint16_t num_samples, float sample_rate, vib_features_t *features)
+{
+	if ((num_samples < 2) || (sample_rate <= 0.0f))
+	{
+		return false;
+	}
+
+	if (!tables_ready)
+	{
+		init_tables();
+	}
+
+	// Remove the DC part (gravity and offsets)
+	float mean = 0.0f;
+	for (uint16_t idx = 0; idx < num_samples; idx++)
+	{
+		mean += samples[idx];
+	}
+	mean /= (float)num_samples;
+
+	float sum_sq = 0.0f;
+	float peak = 0.0f;
+	for (uint16_t idx = 0; idx < num_samples; idx++)
+	{
+		float ac = samples[idx] - mean;
+		sum_sq += ac * ac;
+		if (fabsf(ac) > peak)
+		{
+			peak = fabsf(ac);
+		}
+	}
+	features->rms = sqrtf(sum_sq / (float)num_samples);
+	features->peak = peak;
+	features->crest = (features->rms > 0.0f) ? (peak / features->rms) : 0.0f;
+
+	// Pack the windowed real samples as VIB_FFT_HALF complex values
+	float z_re[VIB_FFT_HALF] = {0.0f};
+	float z_im[VIB_FFT_HALF] = {0.0f};
+	uint16_t start = (num_samples > VIB_FFT_SIZE) ? (num_samples - VIB_FFT_SIZE) : 0;
+	for (uint16_t n = 0; (n < VIB_FFT_SIZE) && ((start + n) < num_samples); n++)
+	{
+		float value = (samples[start + n] - mean) * hann_window[n];
+		if (n & 0x01)
+		{
+			z_im[n >> 1] = value;
+		}
+		else
+		{
+			z_re[n >> 1] = value;
+		}
+	}
+
+	fft_half(z_re, z_im);
+
+	// Split into the spectrum of the real signal and search the strongest bin, DC is skipped
+	float max_power = 0.0f;
+	uint16_t max_bin = 0;
+	for (uint16_t k = 1; k <= VIB_FFT_HALF; k++)
+	{
+		float x_re;
+		float x_im;
+		if (k == VIB_FFT_HALF)
+		{
+			// Nyquist bin, Xe[0] - Xo[0]
+			x_re = z_re[0] - z_im[0];
+			x_im = 0.0f;
+		}
+		else
+		{
+			uint16_t m = VIB_FFT_HALF - k;
+			// Even part (Z[k] + conj(Z[M-k])) / 2
+			float e_re = 0.5f * (z_re[k] + z_re[m]);
+			float e_im = 0.5f * (z_im[k] - z_im[m]);
+			// Odd part (Z[k] - conj(Z[M-k])) / 2j
+			float o_re = 0.5f * (z_im[k] + z_im[m]);
+			float o_im = -0.5f * (z_re[k] - z_re[m]);
+			// X[k] = E[k] + W_N^k * O[k]
+			x_re = e_re + twiddle_re[k] * o_re - twiddle_im[k] * o_im;
+			x_im = e_im + twiddle_re[k] * o_im + twiddle_im[k] * o_re;
+		}
+		float power = x_re * x_re + x_im * x_im;
+		if (power > max_power)
+		{
+			max_power = power;
+			max_bin = k;
+		}
+	}
+	features->dom_freq = (float)max_bin * sample_rate / (float)VIB_FFT_SIZE;
+
+	return true;
+}
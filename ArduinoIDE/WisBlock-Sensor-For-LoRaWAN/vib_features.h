@@ -0,0 +1,29 @@
+/**
+ * @file vib_features.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for vibration analysis
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef VIB_FEATURES_H
+#define VIB_FEATURES_H
+#include <Arduino.h>
+
+/** Number of samples used for the real FFT, must be a power of 2 */
+#define VIB_FFT_SIZE 32
+
+/** Result of the vibration analysis */
+typedef struct vib_features_s
+{
+	float rms;		// RMS of the signal without DC part
+	float peak;		// Maximum absolute deviation from the DC part
+	float crest;	// Crest factor = peak / rms
+	float dom_freq; // Frequency of the strongest FFT bin in Hz
+} vib_features_t;
+
+bool calc_vib_features(const float *samples, uint16_t num_samples, float sample_rate, vib_features_t *features);
+
+#endif // VIB_FEATURES_H
@@ -0,0 +1,82 @@
+/**
+   @file RAK_SGM58031_Sequencer.ino
+   @author rakwireless.com
+   @brief Scan all four inputs of the SGM58031 with one call using the sequencer
+   @version 1.0
+   @date 2026-10-19
+   @copyright Copyright (c) 2026
+*/
+
+#include "ADC_SGM58031.h"
+
+RAK_ADC_SGM58031 sgm58031(SGM58031_SDA_ADDRESS);
+
+#define RDY_PIN     WB_IO1  //SlotA installation, please do not use it on SLOTB
+//#define RDY_PIN   WB_IO3  //SlotC installation.
+//#define RDY_PIN   WB_IO5  //SlotD installation.
+
+/** Inputs to scan */
+sgm58031_channel_t channels[] = {
+    {SGM58031_MUX_AIN0_GND, SGM58031_PGA_4_096},
+    {SGM58031_MUX_AIN1_GND, SGM58031_PGA_4_096},
+    {SGM58031_MUX_AIN2_GND, SGM58031_PGA_2_048},
+    {SGM58031_MUX_AIN3_GND, SGM58031_PGA_2_048}};
+
+#define NUM_CHANNELS (sizeof(channels) / sizeof(sgm58031_channel_t))
+
+void setup()
+{
+  pinMode(WB_IO2, OUTPUT);
+  digitalWrite(WB_IO2, HIGH);
+  delay(300);
+  time_t timeout = millis();
+  Serial.begin(115200);
+  while (!Serial)
+  {
+    if ((millis() - timeout) < 5000)
+    {
+      delay(100);
+    }
+    else
+    {
+      break;
+    }
+  }
+  sgm58031.begin();
+  Serial.println("ADC_SGM58031 sequencer TEST");
+  if (sgm58031.getChipID() != DEVICE_ID)
+  {
+    Serial.println("No CHIP found ... please check your connection");
+    while (1)
+    {
+      delay(100);
+    }
+  }
+
+  // Single-shot conversions at 800 Hz, end of conversion signalled on ALERT/RDY
+  uint8_t result = sgm58031.setSequence(channels, NUM_CHANNELS, SGM58031_DR_800, false, RDY_PIN);
+  if (result != SGM58031_OK)
+  {
+    Serial.printf("Sequence setup failed with error %d\r\n", result);
+  }
+}
+
+void loop()
+{
+  int16_t results[NUM_CHANNELS];
+  uint8_t converted = 0;
+  uint32_t start = micros();
+  uint8_t result = sgm58031.runSequence(results, &converted);
+  uint32_t duration = micros() - start;
+
+  for (uint8_t idx = 0; idx < converted; idx++)
+  {
+    Serial.printf("AIN%d = %.4fV\r\n", idx, sgm58031.rawToVoltage(results[idx], channels[idx].pga));
+  }
+  if (result != SGM58031_OK)
+  {
+    Serial.printf("Sequence failed after %d inputs with error %d\r\n", converted, result);
+  }
+  Serial.printf("Scan took %ld us\r\n\r\n", duration);
+  delay(1000);
+}
@@ -2,13 +2,23 @@
    @file ADC_SGM58031.cpp
    @author rakwireless.com
    @brief This code is designed to config SGM58031 ADC device and handle the data
-   @version 1.0
+   @version 1.0.2
    @date 2022-01-19
    @copyright Copyright (c) 2022
 */
 
 #include "ADC_SGM58031.h"
 
+/** Conversion time in us for each data rate code, Config1 DR_SEL = 0 */
+static const uint32_t convTime0[8] = {160000, 80000, 40000, 20000, 10000, 5000, 2500, 1250};
+/** Conversion time in us for each data rate code, Config1 DR_SEL = 1 */
+static const uint32_t convTime1[8] = {133334, 66667, 33334, 16667, 8334, 4167, 2084, 1042};
+/** Full scale range for each PGA code */
+static const float pgaRange[8] = {6.144, 4.096, 2.048, 1.024, 0.512, 0.256, 0.256, 0.256};
+
+/** Set by the ALERT/RDY interrupt */
+volatile bool RAK_ADC_SGM58031::rdyFlag = false;
+
 /**
    @brief Create the interface object using hardware IIC
  **/
@@ -64,7 +74,9 @@ uint8_t RAK_ADC_SGM58031::writeByteRegister(uint8_t reg, uint8_t data)
   _wire->beginTransmission(i2cAddress);
   _wire->write(reg);
   _wire->write(data);
-  return _wire->endTransmission();
+  uint8_t result = _wire->endTransmission();
+  pointerReg = (result == 0) ? reg : 0xFF;
+  return result;
 }
 
 /**
@@ -79,7 +91,9 @@ uint8_t RAK_ADC_SGM58031::writeWordRegister(uint8_t reg, uint16_t data)
   _wire->write(reg);
   _wire->write((uint8_t)(data >> 8));
   _wire->write((uint8_t)(data & 0xFF));
-  return _wire->endTransmission();
+  uint8_t result = _wire->endTransmission();
+  pointerReg = (result == 0) ? reg : 0xFF;
+  return result;
 }
 
 /**
@@ -92,7 +106,7 @@ uint8_t RAK_ADC_SGM58031::readByteRegister(uint8_t reg)
   uint8_t regValue = 0;
   _wire->beginTransmission(i2cAddress);
   _wire->write(reg);
-  _wire->endTransmission();
+  pointerReg = (_wire->endTransmission() == 0) ? reg : 0xFF;
   _wire->requestFrom(i2cAddress, 1);
   if (_wire->available())
   {
@@ -104,23 +118,72 @@ uint8_t RAK_ADC_SGM58031::readByteRegister(uint8_t reg)
 /**
    @brief Reads 16-bits from the specified destination register
    @param reg   Register address
-   @return the specified destination register value
+   @return the specified destination register value, 0 on failure, check getLastError()
  **/
 uint16_t RAK_ADC_SGM58031::readWordRegister(uint8_t reg)
 {
-  uint8_t regValue[2] = {0};
-  _wire->beginTransmission(i2cAddress);
-  _wire->write(reg);
-  _wire->endTransmission();
-  _wire->requestFrom(i2cAddress, 2);
-  if (_wire->available())
+  uint16_t regValue = 0;
+  readWordRegister(reg, &regValue);
+  return regValue;
+}
+
+/**
+   @brief Reads 16-bits from the specified destination register
+          The pointer write is skipped when reading the conversion register again,
+          the pointer resets to the conversion register on power up so this is always safe.
+   @param reg   Register address
+   @param data  Pointer to store the register value
+   @return SGM58031_OK on success, SGM58031_ERR_xxx on failure
+ **/
+uint8_t RAK_ADC_SGM58031::readWordRegister(uint8_t reg, uint16_t *data)
+{
+  if ((reg != SGM58031_CONVERSION_REGISTER) || (pointerReg != SGM58031_CONVERSION_REGISTER))
   {
-    for (uint8_t count = 0; count < 2; count++)
+    _wire->beginTransmission(i2cAddress);
+    _wire->write(reg);
+    if (_wire->endTransmission(false) != 0)
     {
-      regValue[count] = _wire->read();
+      pointerReg = 0xFF;
+      lastError = SGM58031_ERR_BUS;
+      return lastError;
     }
+    pointerReg = reg;
+  }
+  if (_wire->requestFrom(i2cAddress, 2) != 2)
+  {
+    lastError = SGM58031_ERR_READ;
+    return lastError;
   }
-  return (uint16_t)(regValue[0] << 8 | regValue[1]);
+  uint16_t regValue = (uint16_t)_wire->read() << 8;
+  regValue |= (uint16_t)_wire->read();
+  *data = regValue;
+  lastError = SGM58031_OK;
+  return lastError;
+}
+
+/**
+   @brief Reads the Conversion Register
+   @param data  Pointer to store the signed conversion result
+   @return SGM58031_OK on success, SGM58031_ERR_xxx on failure
+ **/
+uint8_t RAK_ADC_SGM58031::readConversion(int16_t *data)
+{
+  uint16_t regValue;
+  if (readWordRegister(SGM58031_CONVERSION_REGISTER, &regValue) != SGM58031_OK)
+  {
+    return lastError;
+  }
+  *data = (int16_t)regValue;
+  return SGM58031_OK;
+}
+
+/**
+   @brief Get the result of the last register read or sequencer call
+   @return SGM58031_OK or SGM58031_ERR_xxx
+ **/
+uint8_t RAK_ADC_SGM58031::getLastError()
+{
+  return lastError;
 }
 
 /**
@@ -135,6 +198,16 @@ float RAK_ADC_SGM58031::getVoltage()
   return voltage;
 }
 
+/**
+   @brief Convert an already read conversion value to a voltage
+   @param rawValue  Conversion Register value
+   @return Voltage value after conversion
+ **/
+float RAK_ADC_SGM58031::getVoltage(int16_t rawValue)
+{
+  return rawValue * ReferenceVoltage / 32767.0;
+}
+
 /**
    @brief set the resolution voltage
    @param value  the resolution voltage value
@@ -262,3 +335,257 @@ uint16_t RAK_ADC_SGM58031::getAdcValue()
 {
   return readWordRegister(SGM58031_CONVERSION_REGISTER);
 }
+
+/**
+   @brief Interrupt handler for the ALERT/RDY pin in conversion ready mode
+ **/
+void RAK_ADC_SGM58031::rdyHandler()
+{
+  rdyFlag = true;
+}
+
+/**
+   @brief Program a conversion sequence
+          With rdyPin the ALERT/RDY pin is switched to conversion ready mode,
+          this overwrites the Lo_Thresh and Hi_Thresh registers. Only one
+          instance can use the ALERT/RDY pin at a time.
+   @param channels    List of inputs and gains to convert
+   @param count       Number of entries, max SGM58031_MAX_SEQUENCE
+   @param dataRate    Data rate code SGM58031_DR_xxx
+   @param continuous  true use continuous conversion mode, false single-shot
+   @param rdyPin      GPIO connected to ALERT/RDY, -1 to poll the device instead
+   @return SGM58031_OK on success, SGM58031_ERR_xxx on failure
+ **/
+uint8_t RAK_ADC_SGM58031::setSequence(const sgm58031_channel_t *channels, uint8_t count, uint8_t dataRate, bool continuous, int rdyPin)
+{
+  stopSequence();
+
+  if ((channels == NULL) || (count == 0) || (count > SGM58031_MAX_SEQUENCE) || (dataRate > SGM58031_DR_800))
+  {
+    lastError = SGM58031_ERR_PARAM;
+    return lastError;
+  }
+  for (uint8_t idx = 0; idx < count; idx++)
+  {
+    if ((channels[idx].mux > SGM58031_MUX_AIN3_GND) || (channels[idx].pga > SGM58031_PGA_0_256))
+    {
+      lastError = SGM58031_ERR_PARAM;
+      return lastError;
+    }
+    sequence[idx] = channels[idx];
+  }
+
+  // The data rate table depends on Config1 DR_SEL
+  uint16_t config1;
+  if (readWordRegister(SGM58031_CONFIG1_REGISTER, &config1) != SGM58031_OK)
+  {
+    return lastError;
+  }
+  drSel = (config1 & 0x0080) != 0;
+
+  if (rdyPin >= 0)
+  {
+    // Hi_Thresh MSB = 1 and Lo_Thresh MSB = 0 switches ALERT/RDY to conversion ready
+    if ((writeWordRegister(SGM58031_HIGH_THRESH_REGISTER, 0x8000) != 0) || (writeWordRegister(SGM58031_LOW_THRESH_REGISTER, 0x0000) != 0))
+    {
+      lastError = SGM58031_ERR_BUS;
+      return lastError;
+    }
+    pinMode(rdyPin, INPUT_PULLUP);
+    rdyFlag = false;
+    attachInterrupt(digitalPinToInterrupt(rdyPin), rdyHandler, FALLING);
+  }
+
+  sequenceCount = count;
+  sequenceRate = dataRate;
+  sequenceContinuous = continuous;
+  sequenceRdyPin = rdyPin;
+  lastError = SGM58031_OK;
+  return lastError;
+}
+
+/**
+   @brief Convert all inputs of the sequence
+          In single-shot mode each entry starts one conversion.
+          In continuous mode the config is only written when the input changes,
+          a sequence with one entry returns the next conversion with a single read.
+   @param results    Buffer for one signed result per sequence entry
+   @param converted  Optional, number of entries converted before an error
+   @return SGM58031_OK on success, SGM58031_ERR_xxx on failure
+ **/
+uint8_t RAK_ADC_SGM58031::runSequence(int16_t *results, uint8_t *converted)
+{
+  uint8_t done = 0;
+  uint8_t status = SGM58031_OK;
+
+  if ((sequenceCount == 0) || (results == NULL))
+  {
+    status = SGM58031_ERR_PARAM;
+  }
+
+  for (uint8_t idx = 0; (idx < sequenceCount) && (status == SGM58031_OK); idx++)
+  {
+    uint16_t config = sequenceConfig(idx);
+    bool restart = !sequenceContinuous || (config != activeConfig);
+
+    rdyFlag = false;
+    if (restart)
+    {
+      if (writeWordRegister(SGM58031_CONFIG_REGISTER, config) != 0)
+      {
+        activeConfig = 0;
+        status = SGM58031_ERR_BUS;
+        break;
+      }
+      activeConfig = sequenceContinuous ? config : 0;
+    }
+
+    // In continuous mode the conversion running while the input was switched is discarded
+    uint8_t waits = (sequenceContinuous && restart) ? 2 : 1;
+    for (uint8_t wait = 0; (wait < waits) && (status == SGM58031_OK); wait++)
+    {
+      status = waitReady();
+    }
+    if (status != SGM58031_OK)
+    {
+      break;
+    }
+
+    status = readConversion(&results[idx]);
+    if (status == SGM58031_OK)
+    {
+      done++;
+    }
+  }
+
+  if (converted != NULL)
+  {
+    *converted = done;
+  }
+  lastError = status;
+  return lastError;
+}
+
+/**
+   @brief Stop the sequencer
+          Continuous conversion is stopped and the ALERT/RDY interrupt is released.
+          Thresholds overwritten by setSequence() are not restored.
+ **/
+void RAK_ADC_SGM58031::stopSequence()
+{
+  if (sequenceRdyPin >= 0)
+  {
+    detachInterrupt(digitalPinToInterrupt(sequenceRdyPin));
+    sequenceRdyPin = -1;
+  }
+  if (activeConfig != 0)
+  {
+    // Single-shot mode powers down after the current conversion
+    writeWordRegister(SGM58031_CONFIG_REGISTER, activeConfig | 0x0100);
+    activeConfig = 0;
+  }
+  sequenceCount = 0;
+}
+
+/**
+   @brief Convert a conversion result of the sequencer to a voltage
+   @param rawValue  Conversion result
+   @param pga       PGA code used for the conversion
+   @return Voltage at the input
+ **/
+float RAK_ADC_SGM58031::rawToVoltage(int16_t rawValue, uint8_t pga)
+{
+  return rawValue * pgaRange[pga & 0x07] / 32768.0;
+}
+
+/**
+   @brief Build the Config Register value for one sequence entry
+   @param idx  Sequence entry
+   @return the config value
+ **/
+uint16_t RAK_ADC_SGM58031::sequenceConfig(uint8_t idx)
+{
+  uint16_t config = (uint16_t)(sequence[idx].mux << 12) | (uint16_t)(sequence[idx].pga << 9) | (uint16_t)(sequenceRate << 5);
+  if (!sequenceContinuous)
+  {
+    // Start a conversion in single-shot mode
+    config |= 0x8100;
+  }
+  if (sequenceRdyPin < 0)
+  {
+    // Disable comparator, ALERT/RDY is high impedance
+    config |= 0x0003;
+  }
+  return config;
+}
+
+/**
+   @brief Get the conversion time of the sequence data rate
+   @return conversion time in us
+ **/
+uint32_t RAK_ADC_SGM58031::conversionTime()
+{
+  return drSel ? convTime1[sequenceRate] : convTime0[sequenceRate];
+}
+
+/**
+   @brief Wait for the end of a conversion
+          Sleeps for most of the nominal conversion time, then waits for the
+          ALERT/RDY interrupt, polls the OS bit in single-shot mode or
+          waits the remaining time in continuous mode without ALERT/RDY.
+   @return SGM58031_OK on success, SGM58031_ERR_xxx on failure
+ **/
+uint8_t RAK_ADC_SGM58031::waitReady()
+{
+  uint32_t convTime = conversionTime();
+  // Internal oscillator tolerance is +/- 10%
+  uint32_t timeout = convTime + convTime / 5 + 1000;
+  uint32_t start = micros();
+
+  delay((convTime - convTime / 10) / 1000);
+
+  if (sequenceRdyPin >= 0)
+  {
+    while (!rdyFlag)
+    {
+      if ((micros() - start) > timeout)
+      {
+        return SGM58031_ERR_TIMEOUT;
+      }
+      yield();
+    }
+    rdyFlag = false;
+    return SGM58031_OK;
+  }
+
+  if (!sequenceContinuous)
+  {
+    uint16_t config;
+    while (true)
+    {
+      if (readWordRegister(SGM58031_CONFIG_REGISTER, &config) != SGM58031_OK)
+      {
+        return lastError;
+      }
+      // OS reads 1 when no conversion is in progress
+      if ((config & 0x8000) != 0)
+      {
+        return SGM58031_OK;
+      }
+      if ((micros() - start) > timeout)
+      {
+        return SGM58031_ERR_TIMEOUT;
+      }
+      delayMicroseconds(100);
+    }
+  }
+
+  uint32_t elapsed = micros() - start;
+  if (elapsed < convTime + convTime / 10)
+  {
+    uint32_t remaining = convTime + convTime / 10 - elapsed;
+    delay(remaining / 1000);
+    delayMicroseconds(remaining % 1000);
+  }
+  return SGM58031_OK;
+}
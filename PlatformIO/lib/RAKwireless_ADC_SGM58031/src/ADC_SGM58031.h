@@ -2,7 +2,7 @@
    @file ADC_SGM58031.h
    @author rakwireless.com
    @brief This code is designed to config SGM58031 ADC device and handle the data
-   @version 1.0.1
+   @version 1.0.2
    @date 2022-01-19
 
    @copyright Copyright (c) 2022
@@ -37,8 +37,55 @@
 #define SGM58031_FS_0_512   0.512
 #define SGM58031_FS_0_256   0.256
 
+// MUX, input selection used by the sequencer
+#define SGM58031_MUX_AIN0_AIN1 (0x00)
+#define SGM58031_MUX_AIN0_AIN3 (0x01)
+#define SGM58031_MUX_AIN1_AIN3 (0x02)
+#define SGM58031_MUX_AIN2_AIN3 (0x03)
+#define SGM58031_MUX_AIN0_GND (0x04)
+#define SGM58031_MUX_AIN1_GND (0x05)
+#define SGM58031_MUX_AIN2_GND (0x06)
+#define SGM58031_MUX_AIN3_GND (0x07)
+
+// PGA codes used by the sequencer
+#define SGM58031_PGA_6_144 (0x00)
+#define SGM58031_PGA_4_096 (0x01)
+#define SGM58031_PGA_2_048 (0x02)
+#define SGM58031_PGA_1_024 (0x03)
+#define SGM58031_PGA_0_512 (0x04)
+#define SGM58031_PGA_0_256 (0x05)
+
+// Data rate codes, rate with Config1 DR_SEL = 0 / DR_SEL = 1
+#define SGM58031_DR_6_25 (0x00) // 6.25 / 7.5 Hz
+#define SGM58031_DR_12_5 (0x01) // 12.5 / 15 Hz
+#define SGM58031_DR_25 (0x02)   // 25 / 30 Hz
+#define SGM58031_DR_50 (0x03)   // 50 / 60 Hz
+#define SGM58031_DR_100 (0x04)  // 100 / 120 Hz
+#define SGM58031_DR_200 (0x05)  // 200 / 240 Hz
+#define SGM58031_DR_400 (0x06)  // 400 / 480 Hz
+#define SGM58031_DR_800 (0x07)  // 800 / 960 Hz
+
+// Maximum number of entries in a sequence
+#define SGM58031_MAX_SEQUENCE (8)
+
+// Error codes
+#define SGM58031_OK (0)
+#define SGM58031_ERR_BUS (1)     // I2C transfer was not acknowledged
+#define SGM58031_ERR_READ (2)    // I2C read returned less bytes than requested
+#define SGM58031_ERR_TIMEOUT (3) // Conversion did not finish in time
+#define SGM58031_ERR_PARAM (4)   // Invalid sequence or no sequence set
+
 #define DEVICE_ID 0x0080
 
+/**
+   @brief One entry of a conversion sequence
+ **/
+typedef struct
+{
+  uint8_t mux; // SGM58031_MUX_xxx
+  uint8_t pga; // SGM58031_PGA_xxx
+} sgm58031_channel_t;
+
 class RAK_ADC_SGM58031
 {
 public:
@@ -53,6 +100,9 @@ public:
   uint8_t writeWordRegister(uint8_t reg, uint16_t data);
   uint8_t readByteRegister(uint8_t reg);
   uint16_t readWordRegister(uint8_t reg);
+  uint8_t readWordRegister(uint8_t reg, uint16_t *data);
+  uint8_t readConversion(int16_t *data);
+  uint8_t getLastError();
 
   void setAlertLowThreshold(uint16_t threshold);  // Sets the lower limit threshold used to determine the alert condition
   uint16_t readAlertLowThreshold();               // read the lower limit threshold from register
@@ -74,10 +124,34 @@ public:
   void setVoltageResolution(float value); // the _VOLT_RESOLUTION default is 5.0V if3.3V use 3.3
   float getVoltageResolution();           // readback the ReferenceVoltage
   float getVoltage();
+  float getVoltage(int16_t rawValue); // convert an already read value, no I2C access
+
+  // Sequencer, scans a list of inputs and returns all results in one call
+  uint8_t setSequence(const sgm58031_channel_t *channels, uint8_t count, uint8_t dataRate, bool continuous = false, int rdyPin = -1);
+  uint8_t runSequence(int16_t *results, uint8_t *converted = NULL);
+  void stopSequence();
+  float rawToVoltage(int16_t rawValue, uint8_t pga);
 
 private:
+  uint16_t sequenceConfig(uint8_t idx);
+  uint32_t conversionTime();
+  uint8_t waitReady();
+  static void rdyHandler();
+
   TwoWire *_wire;
   int i2cAddress;
   float ReferenceVoltage = 3.3; // if referencevoltage 5V use 5.0
+
+  uint8_t lastError = SGM58031_OK;
+  uint8_t pointerReg = 0xFF; // register the address pointer is set to, 0xFF unknown
+
+  sgm58031_channel_t sequence[SGM58031_MAX_SEQUENCE];
+  uint8_t sequenceCount = 0;
+  uint8_t sequenceRate = SGM58031_DR_800;
+  bool sequenceContinuous = false;
+  int sequenceRdyPin = -1;
+  bool drSel = false;        // Config1 DR_SEL bit, selects the data rate table
+  uint16_t activeConfig = 0; // config running in continuous mode, 0 none
+  static volatile bool rdyFlag;
 };
 #endif
@@ -2,6 +2,8 @@
  * @file RAK12002_rtc.cpp
  * @author Bernd Giesecke (bernd.giesecke@rakwireless.com)
  * @brief Initialization and usage of RAK12002 RTC module
+ *        The time registers are read in one burst, the result is cached
+ *        as seconds since 2000 and advanced with millis() between reads.
  * @version 0.1
  * @date 2022-02-18
  *
@@ -16,6 +18,54 @@ Melopero_RV3028 rtc;
 
 date_time_s g_date_time;
 
+/** Flag to align the send interval to the wall clock */
+bool g_rtc_align = false;
+
+/** RV3028 I2C address */
+#define RTC_ADDRESS 0x52
+/** First time register, seconds, minutes, hours, weekday, date, month and year follow */
+#define RTC_TIME_REG 0x00
+
+/** Cached RTC time in seconds since 2000 */
+static uint32_t rtc_epoch = 0;
+/** millis() when rtc_epoch was read */
+static time_t rtc_epoch_time = 0;
+/** Flag if the cached time is valid */
+static bool rtc_epoch_valid = false;
+
+/**
+ * @brief Convert a BCD register value
+ *
+ * @param value BCD value
+ * @return uint8_t binary value
+ */
+static uint8_t bcd_to_bin(uint8_t value)
+{
+	return (value >> 4) * 10 + (value & 0x0F);
+}
+
+/**
+ * @brief Convert g_date_time to seconds since 2000-01-01 00:00:00
+ *
+ * @return uint32_t seconds since 2000
+ */
+static uint32_t date_time_to_epoch(void)
+{
+	// Years start in March, so the leap day is the last day of a year
+	uint32_t year = g_date_time.year;
+	uint32_t month = g_date_time.month;
+	if (month <= 2)
+	{
+		year--;
+		month += 12;
+	}
+	// Days since 0000-03-01 minus the days from 0000-03-01 to 2000-01-01
+	uint32_t days = 365UL * year + year / 4 - year / 100 + year / 400 + (153 * (month - 3) + 2) / 5 + g_date_time.date - 1;
+	days -= 730425UL;
+
+	return days * 86400UL + g_date_time.hour * 3600UL + g_date_time.minute * 60UL + g_date_time.second;
+}
+
 /**
  * @brief Initialize the RTC
  *
@@ -34,13 +84,7 @@ bool init_rak12002(void)
 
 	rtc.set24HourMode(); // Set the device to use the 24hour format (default) instead of the 12 hour format
 
-	g_date_time.year = rtc.getYear();
-	g_date_time.month = rtc.getMonth();
-	g_date_time.weekday = rtc.getWeekday();
-	g_date_time.date = rtc.getDate();
-	g_date_time.hour = rtc.getHour();
-	g_date_time.minute = rtc.getMinute();
-	g_date_time.second = rtc.getSecond();
+	read_rak12002();
 
 	MYLOG("RTC", "%d.%02d.%02d %d:%02d:%02d", g_date_time.year, g_date_time.month, g_date_time.date, g_date_time.hour, g_date_time.minute, g_date_time.second);
 	return true;
@@ -60,23 +104,118 @@ void set_rak12002(uint16_t year, uint8_t month, uint8_t date, uint8_t hour, uint
 	uint8_t weekday = (date + (uint16_t)((2.6 * month) - 0.2) - (2 * (year / 100)) + year + (uint16_t)(year / 4) + (uint16_t)(year / 400)) % 7;
 	MYLOG("RTC", "Calculated weekday is %d", weekday);
 	rtc.setTime(year, month, weekday, date, hour, minute, 0);
+	rtc_epoch_valid = false;
+}
+
+/**
+ * @brief Set the RAK12002 date and time from seconds since 2000
+ *
+ * @param epoch seconds since 2000-01-01 00:00:00
+ */
+void set_epoch_rak12002(uint32_t epoch)
+{
+	uint32_t days = epoch / 86400UL;
+	uint32_t seconds = epoch % 86400UL;
+	// 2000-01-01 was a Saturday
+	uint8_t weekday = (days + 6) % 7;
+
+	// Inverse of date_time_to_epoch(), days since 0000-03-01 split into 400 year eras
+	uint32_t day_num = days + 730425UL;
+	uint32_t era = day_num / 146097UL;
+	uint32_t day_of_era = day_num - era * 146097UL;
+	uint32_t year_of_era = (day_of_era - day_of_era / 1460 + day_of_era / 36524 - day_of_era / 146096) / 365;
+	uint32_t day_of_year = day_of_era - (365 * year_of_era + year_of_era / 4 - year_of_era / 100);
+	uint32_t month_index = (5 * day_of_year + 2) / 153;
+	uint8_t date = day_of_year - (153 * month_index + 2) / 5 + 1;
+	uint8_t month = month_index < 10 ? month_index + 3 : month_index - 9;
+	uint16_t year = year_of_era + era * 400 + (month <= 2 ? 1 : 0);
+
+	rtc.setTime(year, month, weekday, date, seconds / 3600, (seconds / 60) % 60, seconds % 60);
+	rtc_epoch_valid = false;
+	MYLOG("RTC", "Set to %d.%02d.%02d %d:%02d:%02d", year, month, date, seconds / 3600, (seconds / 60) % 60, seconds % 60);
 }
 
 /**
  * @brief Update g_data_time structure with current the date
  *        and time from the RTC
+ *        All time registers are read in one burst, which avoids
+ *        a rollover between the single reads
  *
  */
 void read_rak12002(void)
 {
-	g_date_time.year = rtc.getYear();
-	g_date_time.month = rtc.getMonth();
-	g_date_time.weekday = rtc.getWeekday();
-	g_date_time.date = rtc.getDate();
-	g_date_time.hour = rtc.getHour();
-	g_date_time.minute = rtc.getMinute();
-	g_date_time.second = rtc.getSecond();
+	uint8_t regs[7];
+	Wire.beginTransmission(RTC_ADDRESS);
+	Wire.write(RTC_TIME_REG);
+	if ((Wire.endTransmission(false) != 0) || (Wire.requestFrom((uint8_t)RTC_ADDRESS, (uint8_t)7) != 7))
+	{
+		MYLOG("RTC", "Time read failed");
+		return;
+	}
+	for (uint8_t idx = 0; idx < 7; idx++)
+	{
+		regs[idx] = Wire.read();
+	}
+	g_date_time.second = bcd_to_bin(regs[0] & 0x7F);
+	g_date_time.minute = bcd_to_bin(regs[1] & 0x7F);
+	g_date_time.hour = bcd_to_bin(regs[2] & 0x3F);
+	g_date_time.weekday = regs[3] & 0x07;
+	g_date_time.date = bcd_to_bin(regs[4] & 0x3F);
+	g_date_time.month = bcd_to_bin(regs[5] & 0x1F);
+	g_date_time.year = 2000 + bcd_to_bin(regs[6]);
+
+	rtc_epoch = date_time_to_epoch();
+	rtc_epoch_time = millis();
+	rtc_epoch_valid = true;
 	MYLOG("RTC", "Got %d %d %d %02d:%02d:%d",
 		  g_date_time.month, g_date_time.date, g_date_time.year,
 		  g_date_time.hour, g_date_time.minute, g_date_time.second);
+}
+
+/**
+ * @brief Get the RTC time as seconds since 2000-01-01 00:00:00
+ *     Uses the cached time, the RTC is read again after RTC_RESYNC_INTERVAL
+ *
+ * @return uint32_t seconds since 2000
+ */
+uint32_t get_epoch_rak12002(void)
+{
+	if (!rtc_epoch_valid || ((uint32_t)(millis() - rtc_epoch_time) > RTC_RESYNC_INTERVAL))
+	{
+		read_rak12002();
+	}
+	return rtc_epoch + (uint32_t)(millis() - rtc_epoch_time) / 1000;
+}
+
+/**
+ * @brief Get the RTC time as Unix time
+ *
+ * @return uint32_t seconds since 1970-01-01 00:00:00
+ */
+uint32_t get_unix_time_rak12002(void)
+{
+	return get_epoch_rak12002() + RTC_UNIX_OFFSET;
+}
+
+/**
+ * @brief Get the time until the next multiple of the interval on the wall clock
+ *     e.g. the next full 15 minutes for a 15 minutes interval
+ *
+ * @param interval_ms interval in ms, resolution is 1 second
+ * @return uint32_t time until the next boundary in ms
+ */
+uint32_t next_boundary_rak12002(uint32_t interval_ms)
+{
+	uint32_t interval = interval_ms / 1000;
+	if (interval == 0)
+	{
+		return interval_ms;
+	}
+	uint32_t wait = (interval - get_epoch_rak12002() % interval) * 1000;
+	// Woken up shortly before the boundary, skip to the following one
+	if (wait < RTC_ALIGN_MIN_WAIT)
+	{
+		wait += interval * 1000;
+	}
+	return wait;
 }
\ No newline at end of file
@@ -53,25 +53,7 @@ bool init_rak12004(void)
 	// Set math model to calculate the PPM concentration and the value of constants
 	MQ2.setRegressionMethod(0); // PPM =  pow(10, (log10(ratio)-B)/A)
 
-	float calcR0 = 0;
-	for (int i = 1; i <= 100; i++)
-	{
-		calcR0 += MQ2.calibrateR0(RatioGasCleanAir);
-	}
-	MQ2.setR0(calcR0 / 100);
-	if (isinf(calcR0))
-	{
-		MYLOG("MQ2", "Warning: Connection issue founded, R0 is infite (Open circuit detected) please check your wiring and supply");
-		return false;
-	}
-	if (calcR0 == 0)
-	{
-		MYLOG("MQ2", "Warning: Connection issue founded, R0 is zero (Analog pin with short circuit to ground) please check your wiring and supply");
-		return false;
-	}
-
-	float r0 = MQ2.getR0();
-	MYLOG("MQ2", "R0 Value is:%3.2f\r\n", r0);
+	// R0 is calibrated by the measurement engine after the first pre-heat and saved
 	return true;
 }
 
@@ -79,15 +61,31 @@ bool init_rak12004(void)
  * @brief Read MQ2 sensor data
  *     Data is added to Cayenne LPP payload as channels
  *     LPP_CHANNEL_GAS and LPP_CHANNEL_GAS_PERC
+ *     The value is the oversampled result of the measurement engine
  *
  */
 void read_rak12004(void)
 {
-	sensorPPM = MQ2.readSensor();
+	if (!mqx_get_ppm(MQX_MQ2, &sensorPPM))
+	{
+		MYLOG("MQ2", "No valid MQ2 measurement");
+		return;
+	}
 	MYLOG("MQ2", "MQ2 sensor PPM Value is: %3.2f", sensorPPM);
 	PPMpercentage = sensorPPM / 10000;
 	MYLOG("MQ2", "MQ2 PPM percentage Value is:%3.2f%%", PPMpercentage);
 
 	g_solution_data.addAnalogInput(LPP_CHANNEL_GAS, sensorPPM);
 	g_solution_data.addPercentage(LPP_CHANNEL_GAS_PERC, (uint32_t)(PPMpercentage));
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Start the measurement engine for the MQ2 sensor
+ *
+ * @return true engine started
+ * @return false engine could not be started
+ */
+bool start_rak12004(void)
+{
+	return start_mqx(MQX_MQ2, &MQ2);
+}
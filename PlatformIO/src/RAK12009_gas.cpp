@@ -49,26 +49,7 @@ bool init_rak12009(void)
 	// Set math model to calculate the PPM concentration and the value of constants
 	MQ3.setRegressionMethod(0); // PPM =  pow(10, (log10(ratio)-B)/A)
 
-	delay(5000); // Waiting for the power supply stabilization output
-	float calcR0 = 0;
-	for (int i = 1; i <= 100; i++)
-	{
-		calcR0 += MQ3.calibrateR0(RatioGasCleanAir);
-	}
-	MQ3.setR0(calcR0 / 100); // set R0 the resister of sensor in the fresh air
-	if (isinf(calcR0))
-	{
-		MYLOG("MQ2", "Warning: Conection issue founded, R0 is infite (Open circuit detected) please check your wiring and supply");
-		return false;
-	}
-	if (calcR0 == 0)
-	{
-		MYLOG("MQ2", "Warning: Conection issue founded, R0 is zero (Analog pin with short circuit to ground) please check your wiring and supply");
-		return false;
-	}
-
-	float r0 = MQ3.getR0();
-	MYLOG("MQ3", "R0 Value is:%3.2f\r\n", r0);
+	// R0 is calibrated by the measurement engine after the first pre-heat and saved
 	return true;
 }
 
@@ -76,15 +57,31 @@ bool init_rak12009(void)
  * @brief Read data from gas sensor
  *     Data is added to Cayenne LPP payload as channels
  *     LPP_CHANNEL_ALC and LPP_CHANNEL_ALC_PERC
+ *     The value is the oversampled result of the measurement engine
  *
  */
 void read_rak12009(void)
 {
-	sensorPPM = MQ3.readSensor();
+	if (!mqx_get_ppm(MQX_MQ3, &sensorPPM))
+	{
+		MYLOG("MQ3", "No valid MQ3 measurement");
+		return;
+	}
 	MYLOG("MQ3", "MQ3 sensor PPM Value is: %3.2f", sensorPPM);
 	PPMpercentage = sensorPPM / 10000;
 	MYLOG("MQ3", "MQ3 PPM percentage Value is:%3.2f%%", PPMpercentage);
 
 	g_solution_data.addAnalogInput(LPP_CHANNEL_ALC, sensorPPM);
 	g_solution_data.addPercentage(LPP_CHANNEL_ALC_PERC, (uint32_t)(PPMpercentage));
-}
\ No newline at end of file
+}
+
+/**
+ * @brief Start the measurement engine for the MQ3 sensor
+ *
+ * @return true engine started
+ * @return false engine could not be started
+ */
+bool start_rak12009(void)
+{
+	return start_mqx(MQX_MQ3, &MQ3);
+}
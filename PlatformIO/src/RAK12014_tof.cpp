@@ -48,6 +48,100 @@ analog_s analog_val;
 // Power pin for RAK12014
 uint8_t xshut_pin = WB_IO3;
 
+// GPIO1 data ready interrupt pin for RAK12014
+uint8_t tof_int_pin = WB_IO4;
+
+/** Timing budget for one ranging in ms */
+uint16_t g_tof_budget = RAK12014_BUDGET_DEFAULT;
+
+/** Number of rangings per reading */
+#define RAK12014_NUM_SAMPLES 11
+
+/** Samples more than this number of (scaled) MAD's away from the median are rejected */
+#define RAK12014_MAD_LIMIT 3.0
+
+/** Sensor reports 8190 or 8191 if there was no target in range */
+#define RAK12014_OUT_OF_RANGE 8190
+
+#if defined NRF52_SERIES || defined ESP32
+/** Semaphore given by the data ready interrupt */
+SemaphoreHandle_t g_tof_sem;
+
+/** Required for give semaphore from ISR */
+static BaseType_t xHigherPriorityTaskWoken = pdTRUE;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** Flag set by the data ready interrupt */
+volatile bool tof_data_ready = false;
+#endif
+
+/**
+ * @brief Data ready interrupt handler
+ *
+ */
+void int_callback_rak12014(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGiveFromISR(g_tof_sem, &xHigherPriorityTaskWoken);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	tof_data_ready = true;
+#endif
+}
+
+/**
+ * @brief Wait for the data ready interrupt
+ *
+ * @param timeout max time to wait in ms
+ * @return true new ranging available
+ * @return false timeout
+ */
+static bool wait_data_ready_rak12014(uint32_t timeout)
+{
+#if defined NRF52_SERIES || defined ESP32
+	return (xSemaphoreTake(g_tof_sem, pdMS_TO_TICKS(timeout)) == pdTRUE);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	time_t wait_start = millis();
+	while (!tof_data_ready)
+	{
+		if ((millis() - wait_start) > timeout)
+		{
+			return false;
+		}
+		delay(1);
+	}
+	tof_data_ready = false;
+	return true;
+#endif
+}
+
+/**
+ * @brief Setup the sensor after it was powered up with xshut_pin
+ *     The sensor loses all settings when it is switched off
+ *
+ * @return true if sensor was initialized
+ * @return false if sensor was not found
+ */
+static bool setup_rak12014(void)
+{
+	tof_sensor.setTimeout(500);
+	if (!tof_sensor.init())
+	{
+		return false;
+	}
+
+	// Set to long range
+	// lower the return signal rate limit (default is 0.25 MCPS)
+	tof_sensor.setSignalRateLimit(0.1);
+	// increase laser pulse periods (defaults are 14 and 10 PCLKs)
+	tof_sensor.setVcselPulsePeriod(VL53L0X::VcselPeriodPreRange, 18);
+	tof_sensor.setVcselPulsePeriod(VL53L0X::VcselPeriodFinalRange, 14);
+
+	tof_sensor.setMeasurementTimingBudget((uint32_t)g_tof_budget * 1000);
+	return true;
+}
+
 /**
  * @brief Initialize the VL53L01 sensor
  *
@@ -59,6 +153,18 @@ bool init_rak12014(void)
 	// On/Off control pin
 	pinMode(xshut_pin, OUTPUT);
 
+	// Data ready pin, GPIO1 is open drain and active low
+	pinMode(tof_int_pin, INPUT_PULLUP);
+
+#if defined NRF52_SERIES || defined ESP32
+	// Create the data ready semaphore
+	g_tof_sem = xSemaphoreCreateBinary();
+	// Initialize semaphore
+	xSemaphoreGive(g_tof_sem);
+	// Take semaphore
+	xSemaphoreTake(g_tof_sem, 10);
+#endif
+
 	// Sensor on
 	digitalWrite(xshut_pin, HIGH);
 
@@ -67,8 +173,7 @@ bool init_rak12014(void)
 	tof_sensor.setBus(&Wire);
 	Wire.begin();
 
-	tof_sensor.setTimeout(500);
-	if (!tof_sensor.init())
+	if (!setup_rak12014())
 	{
 		MYLOG("ToF", "Failed to detect and initialize sensor!");
 		// Sensor off
@@ -78,13 +183,6 @@ bool init_rak12014(void)
 		return false;
 	}
 
-	// Set to long range
-	// lower the return signal rate limit (default is 0.25 MCPS)
-	tof_sensor.setSignalRateLimit(0.1);
-	// increase laser pulse periods (defaults are 14 and 10 PCLKs)
-	tof_sensor.setVcselPulsePeriod(VL53L0X::VcselPeriodPreRange, 18);
-	tof_sensor.setVcselPulsePeriod(VL53L0X::VcselPeriodFinalRange, 14);
-
 	// Sensor off
 	digitalWrite(xshut_pin, LOW);
 
@@ -92,80 +190,151 @@ bool init_rak12014(void)
 }
 
 /**
- * @brief Read ToF data from VL53L01
- *     Data is added to Cayenne LPP payload as channels
- *     LPP_CHANNEL_TOF
+ * @brief Set the timing budget for one ranging
  *
+ * @param new_budget budget in ms, RAK12014_BUDGET_MIN to RAK12014_BUDGET_MAX
+ * @return true budget is valid
+ * @return false budget is out of range
  */
-void read_rak12014(void)
+bool set_budget_rak12014(uint16_t new_budget)
 {
-	// Sensor on
-	digitalWrite(xshut_pin, HIGH);
-	delay(300);
-
-	uint64_t collected = 0;
-	bool got_valid_data = false;
-
-	// uint64_t single_reading = (uint64_t)tof_sensor.readRangeContinuousMillimeters();
-	uint64_t single_reading = (uint64_t)tof_sensor.readRangeSingleMillimeters();
-	if (tof_sensor.timeoutOccurred() || (single_reading == 65535))
+	if ((new_budget < RAK12014_BUDGET_MIN) || (new_budget > RAK12014_BUDGET_MAX))
 	{
-		collected = analog_val.analog16;
-		MYLOG("ToF", "Timeout");
+		return false;
 	}
-	else
+	g_tof_budget = new_budget;
+	return true;
+}
+
+/**
+ * @brief Reject outliers with the median absolute deviation
+ *
+ * @param samples valid rangings in mm, sorted on return
+ * @param num_samples number of samples
+ * @return uint16_t mean of the samples close to the median
+ */
+static uint16_t robust_mean_rak12014(uint16_t *samples, uint8_t num_samples)
+{
+	uint16_t deviation[RAK12014_NUM_SAMPLES];
+
+	// Insertion sort, only a few samples
+	for (uint8_t idx = 1; idx < num_samples; idx++)
 	{
-		// We are measuring against water surface, sometimes waves or reflections can give too high values
-		// The tank is only 1200mm deep, so any value above should be discarded
-		if (single_reading < 1100)
+		uint16_t value = samples[idx];
+		int8_t pos = idx - 1;
+		while ((pos >= 0) && (samples[pos] > value))
 		{
-			collected = single_reading;
-			// We got at least one measurement
-			got_valid_data = true;
+			samples[pos + 1] = samples[pos];
+			pos--;
 		}
-		else
+		samples[pos + 1] = value;
+	}
+	uint16_t median = samples[num_samples / 2];
+
+	for (uint8_t idx = 0; idx < num_samples; idx++)
+	{
+		deviation[idx] = (samples[idx] > median) ? (samples[idx] - median) : (median - samples[idx]);
+	}
+	for (uint8_t idx = 1; idx < num_samples; idx++)
+	{
+		uint16_t value = deviation[idx];
+		int8_t pos = idx - 1;
+		while ((pos >= 0) && (deviation[pos] > value))
 		{
-			collected = analog_val.analog16;
-			// We got at least one measurement
-			got_valid_data = true;
-			MYLOG("ToF", "Measured > 1100mm");
+			deviation[pos + 1] = deviation[pos];
+			pos--;
 		}
+		deviation[pos + 1] = value;
+	}
+	// 1.4826 * MAD estimates the standard deviation for normal distributed values
+	float limit = RAK12014_MAD_LIMIT * 1.4826 * (float)deviation[num_samples / 2];
+	if (limit < 1.0)
+	{
+		limit = 1.0;
 	}
-	delay(100);
 
-	for (int reading = 0; reading < 10; reading++)
+	uint32_t sum = 0;
+	uint8_t used = 0;
+	for (uint8_t idx = 0; idx < num_samples; idx++)
 	{
-		single_reading = (uint64_t)tof_sensor.readRangeSingleMillimeters();
-		if (tof_sensor.timeoutOccurred() || (single_reading == 65535))
+		uint16_t diff = (samples[idx] > median) ? (samples[idx] - median) : (median - samples[idx]);
+		if ((float)diff <= limit)
 		{
-			MYLOG("ToF", "Timeout");
+			sum += samples[idx];
+			used++;
 		}
-		else
+	}
+	MYLOG("ToF", "Median %d mm, used %d of %d samples", median, used, num_samples);
+	return (uint16_t)(sum / used);
+}
+
+/**
+ * @brief Read ToF data from VL53L01
+ *     The sensor runs back-to-back continuous ranging for one short burst,
+ *     each ranging is collected on the GPIO1 data ready interrupt.
+ *     Data is added to Cayenne LPP payload as channels
+ *     LPP_CHANNEL_TOF
+ *
+ */
+void read_rak12014(void)
+{
+	uint16_t samples[RAK12014_NUM_SAMPLES];
+	uint8_t num_samples = 0;
+
+	// Sensor on, boot time is max 1.2ms
+	digitalWrite(xshut_pin, HIGH);
+	delay(2);
+
+	if (!setup_rak12014())
+	{
+		MYLOG("ToF", "Sensor init failed");
+	}
+	else
+	{
+#if defined NRF52_SERIES || defined ESP32
+		// Discard an old data ready event
+		xSemaphoreTake(g_tof_sem, 0);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+		tof_data_ready = false;
+#endif
+		attachInterrupt(tof_int_pin, int_callback_rak12014, FALLING);
+		tof_sensor.startContinuous();
+
+		for (uint8_t reading = 0; reading < RAK12014_NUM_SAMPLES; reading++)
 		{
-			// We are measuring against water surface, sometimes waves or reflections can give too high values
-			// The tank is only 1100mm deep, so any value above should be discarded
-			if (single_reading < 1100)
+			if (!wait_data_ready_rak12014(g_tof_budget * 2 + 10))
 			{
-				collected += single_reading;
-				collected = collected / 2;
-				// We got at least one measurement
-				got_valid_data = true;
+				MYLOG("ToF", "Timeout");
+				break;
 			}
+			// Data is ready, this reads the result and clears the interrupt
+			uint16_t single_reading = tof_sensor.readRangeContinuousMillimeters();
+			if (tof_sensor.timeoutOccurred() || (single_reading >= RAK12014_OUT_OF_RANGE))
+			{
+				MYLOG("ToF", "No target");
+				continue;
+			}
+			samples[num_samples++] = single_reading;
 		}
-		delay(100);
+
+		tof_sensor.stopContinuous();
+		detachInterrupt(tof_int_pin);
 	}
 
+	// Sensor off
+	digitalWrite(xshut_pin, LOW);
+
 	// If we failed to get a valid reading, we set it to the last measured value
-	if (!got_valid_data)
+	bool got_valid_data = (num_samples != 0);
+	if (got_valid_data)
 	{
-		collected = analog_val.analog16;
+		analog_val.analog16 = robust_mean_rak12014(samples, num_samples);
 	}
+	uint16_t collected = analog_val.analog16;
 
-	MYLOG("ToF", "Water level %d mm", 1100 - (uint16_t)collected);
+	MYLOG("ToF", "Distance %d mm", collected);
 	g_solution_data.addAnalogInput(LPP_CHANNEL_TOF, (float)(collected));
 	g_solution_data.addPresence(LPP_CHANNEL_TOF_VALID, (got_valid_data ? 1 : 0));
-
-	// Sensor off
-	digitalWrite(xshut_pin, LOW);
 	return;
-}
\ No newline at end of file
+}
@@ -40,6 +40,75 @@ I3G4250D gyro_sensor;
 /** Buffer for scaled gyro data */
 I3G4250D_DataScaled gyro_data = {0};
 
+/** Output data rate in Hz set by I3G4250D_Init() */
+#define RAK12025_ODR 800
+
+/** I3G4250D FIFO registers and values */
+#define RAK12025_REG_CTRL5 0x24
+#define RAK12025_REG_OUT_X_L 0x28
+#define RAK12025_REG_FIFO_CTRL 0x2E
+#define RAK12025_REG_FIFO_SRC 0x2F
+#define RAK12025_FIFO_EN 0x40	   // CTRL5 FIFO enable
+#define RAK12025_FIFO_STREAM 0x40  // FIFO_CTRL stream mode
+#define RAK12025_FIFO_OVRN 0x40	   // FIFO_SRC FIFO is full
+#define RAK12025_FIFO_FSS_MASK 0x1F // FIFO_SRC number of unread samples
+
+/** Size of the hardware FIFO */
+#define RAK12025_FIFO_SIZE 32
+
+/** Size of one FIFO entry, x/y/z little endian */
+#define RAK12025_SAMPLE_SIZE 6
+
+/** FIFO entries per I2C burst read, keeps the read within the Wire buffer */
+#define RAK12025_BURST_SAMPLES 8
+
+/** Q8 scale for 500dps range, 17.5 mdps/digit => milli dps */
+#define RAK12025_GYRO_SCALE 4480
+
+/**
+ * @brief Write RAK12025 register
+ *
+ * @param chip_reg register address
+ * @param dataToWrite data to write
+ * @return true write success
+ * @return false write failed
+ */
+static bool rak12025_writeRegister(uint8_t chip_reg, uint8_t dataToWrite)
+{
+	Wire.beginTransmission(found_sensors[GYRO_ID].i2c_addr);
+	Wire.write(chip_reg);
+	Wire.write(dataToWrite);
+	return (Wire.endTransmission() == 0);
+}
+
+/**
+ * @brief Burst read of RAK12025 registers with address auto increment
+ *
+ * @param buffer buffer for the register values
+ * @param chip_reg start register address
+ * @param len number of bytes to read
+ * @return true read success
+ * @return false read failed
+ */
+static bool rak12025_readBurst(uint8_t *buffer, uint8_t chip_reg, uint8_t len)
+{
+	Wire.beginTransmission(found_sensors[GYRO_ID].i2c_addr);
+	Wire.write(chip_reg | 0x80); // MSB set enables address auto increment
+	if (Wire.endTransmission(false) != 0)
+	{
+		return false;
+	}
+	if (Wire.requestFrom(found_sensors[GYRO_ID].i2c_addr, len) != len)
+	{
+		return false;
+	}
+	for (uint8_t idx = 0; idx < len; idx++)
+	{
+		buffer[idx] = Wire.read();
+	}
+	return true;
+}
+
 /**
  * @brief Initialize I3G4250D gyroscope
  *
@@ -80,6 +149,12 @@ bool init_rak12025(void)
 
 	gyro_sensor.I3G4250D_Enable_INT1();
 
+	// Collect the samples in the FIFO in stream mode
+	uint8_t ctrl5 = 0;
+	rak12025_readBurst(&ctrl5, RAK12025_REG_CTRL5, 1);
+	rak12025_writeRegister(RAK12025_REG_CTRL5, ctrl5 | RAK12025_FIFO_EN);
+	rak12025_writeRegister(RAK12025_REG_FIFO_CTRL, RAK12025_FIFO_STREAM);
+
 	pinMode(GYRO_INT_PIN, INPUT); // Connect with I3G4250D INT1.
 	attachInterrupt(digitalPinToInterrupt(GYRO_INT_PIN), int_callback_rak12025, RISING);
 
@@ -103,6 +178,53 @@ void int_callback_rak12025(void)
 void clear_int_rak12025(void)
 {
 	gyro_sensor.I3G4250D_GetInterruptSrc();
+	read_fifo_rak12025();
+}
+
+/**
+ * @brief Drain the FIFO into the inertial pipeline
+ *
+ * @return uint16_t number of samples read
+ */
+uint16_t read_fifo_rak12025(void)
+{
+	uint8_t fifo_src = 0;
+	if (!rak12025_readBurst(&fifo_src, RAK12025_REG_FIFO_SRC, 1))
+	{
+		MYLOG("GYRO", "FIFO status read failed");
+		return 0;
+	}
+	uint32_t last_timestamp = micros();
+	uint8_t num_samples = (fifo_src & RAK12025_FIFO_OVRN) ? RAK12025_FIFO_SIZE : (fifo_src & RAK12025_FIFO_FSS_MASK);
+
+	// With the FIFO enabled the auto increment wraps from OUT_Z_H back to OUT_X_L,
+	// one burst reads several FIFO entries
+	uint8_t raw[RAK12025_BURST_SAMPLES * RAK12025_SAMPLE_SIZE];
+	int16_t values[RAK12025_FIFO_SIZE * 3];
+	uint8_t sample_idx = 0;
+	while (sample_idx < num_samples)
+	{
+		uint8_t chunk = num_samples - sample_idx;
+		if (chunk > RAK12025_BURST_SAMPLES)
+		{
+			chunk = RAK12025_BURST_SAMPLES;
+		}
+		if (!rak12025_readBurst(raw, RAK12025_REG_OUT_X_L, chunk * RAK12025_SAMPLE_SIZE))
+		{
+			MYLOG("GYRO", "FIFO burst read failed");
+			break;
+		}
+		for (uint8_t idx = 0; idx < chunk; idx++)
+		{
+			uint8_t *sample = &raw[idx * RAK12025_SAMPLE_SIZE];
+			for (uint8_t axis = 0; axis < 3; axis++)
+			{
+				values[(sample_idx + idx) * 3 + axis] = (int16_t)(sample[axis * 2] | (sample[axis * 2 + 1] << 8));
+			}
+		}
+		sample_idx += chunk;
+	}
+	return imu_push_block(IMU_SRC_RAK12025, IMU_TYPE_GYRO, values, sample_idx, RAK12025_GYRO_SCALE, RAK12025_ODR, last_timestamp);
 }
 
 /**
@@ -142,6 +264,8 @@ void read_rak12025(void)
 	}
 #endif
 
+	read_fifo_rak12025();
+
 	gyro_data = gyro_sensor.I3G4250D_GetScaledData();
 
 	g_solution_data.addGyrometer(LPP_CHANNEL_GYRO, gyro_data.x, gyro_data.y, gyro_data.z);
@@ -36,5 +36,6 @@
 bool init_rak12025(void);
 void read_rak12025(void);
 void clear_int_rak12025(void);
+uint16_t read_fifo_rak12025(void);
 
 #endif // RAK12025_H
\ No newline at end of file
@@ -52,6 +52,75 @@ RAK_BMX160 bmx160(&Wire);
 /** Interrupt pin, depends on slot */
 uint8_t bmx_int_pin = WB_IO4;
 
+/** Output data rate of accelerometer and gyroscope in Hz */
+#define RAK12034_ODR 400
+
+/** BMX160 FIFO registers and values */
+#define RAK12034_REG_FIFO_LENGTH 0x22 // 11 bit FIFO fill level in bytes
+#define RAK12034_REG_FIFO_DATA 0x24
+#define RAK12034_REG_FIFO_CONFIG_1 0x47
+#define RAK12034_REG_CMD 0x7E
+#define RAK12034_FIFO_ACC_GYR 0xC0 // Headerless mode, gyroscope and accelerometer
+#define RAK12034_FIFO_FLUSH 0xB0
+
+/** Headerless FIFO frame, gyroscope x/y/z followed by accelerometer x/y/z */
+#define RAK12034_FRAME_SIZE 12
+
+/** Frames per I2C burst read, keeps the read within the Wire buffer */
+#define RAK12034_BURST_FRAMES 4
+
+/** Q8 scale for 2g range, 16384 LSB/g => micro g */
+#define RAK12034_ACC_SCALE 15625
+/** Q8 scale for 500dps range, 65.6 LSB/dps => milli dps */
+#define RAK12034_GYRO_SCALE 3902
+/** Q8 scale for magnetometer values in 0.1 uT => nano Tesla */
+#define RAK12034_MAG_SCALE 25600
+
+/**
+ * @brief Write RAK12034 register
+ *
+ * @param chip_reg register address
+ * @param dataToWrite data to write
+ * @return true write success
+ * @return false write failed
+ */
+static bool rak12034_writeRegister(uint8_t chip_reg, uint8_t dataToWrite)
+{
+	Wire.beginTransmission(found_sensors[DOF_ID].i2c_addr);
+	Wire.write(chip_reg);
+	Wire.write(dataToWrite);
+	return (Wire.endTransmission() == 0);
+}
+
+/**
+ * @brief Burst read of RAK12034 registers
+ *     Reading FIFO_DATA repeatedly returns the next FIFO bytes
+ *
+ * @param buffer buffer for the register values
+ * @param chip_reg start register address
+ * @param len number of bytes to read
+ * @return true read success
+ * @return false read failed
+ */
+static bool rak12034_readBurst(uint8_t *buffer, uint8_t chip_reg, uint8_t len)
+{
+	Wire.beginTransmission(found_sensors[DOF_ID].i2c_addr);
+	Wire.write(chip_reg);
+	if (Wire.endTransmission(false) != 0)
+	{
+		return false;
+	}
+	if (Wire.requestFrom(found_sensors[DOF_ID].i2c_addr, len) != len)
+	{
+		return false;
+	}
+	for (uint8_t idx = 0; idx < len; idx++)
+	{
+		buffer[idx] = Wire.read();
+	}
+	return true;
+}
+
 /**
  * @brief Initialize BMX160 9-axis
  * acceleration sensor
@@ -92,7 +161,7 @@ bool init_rak12034(void)
 	bmx160.InterruptConfig(HIGH_G_INT, HIGH_G_THRESHOLD);
 
 	// Set output data rate
-	bmx160.ODR_Config(BMX160_ACCEL_ODR_200HZ, BMX160_GYRO_ODR_200HZ);
+	bmx160.ODR_Config(BMX160_ACCEL_ODR_400HZ, BMX160_GYRO_ODR_400HZ);
 
 	/**
 	   enum{eGyroRange_2000DPS,
@@ -113,6 +182,10 @@ bool init_rak12034(void)
 	*/
 	bmx160.setAccelRange(eAccelRange_2G);
 
+	// Collect gyroscope and accelerometer data in the FIFO
+	rak12034_writeRegister(RAK12034_REG_FIFO_CONFIG_1, RAK12034_FIFO_ACC_GYR);
+	rak12034_writeRegister(RAK12034_REG_CMD, RAK12034_FIFO_FLUSH);
+
 	//  Set the interrupt callback function
 	attachInterrupt(bmx_int_pin, int_callback_rak12034, RISING);
 
@@ -163,4 +236,81 @@ void clear_int_rak12034(void)
 
 	/* Display the accelerometer results (accelerometer data is in m/s^2) */
 	MYLOG("BMX160", "A X: %f Y: %f Z: %f m/s^2", Oaccel.x, Oaccel.y, Oaccel.z);
+
+	// While the fusion is running, the fusion task drains the FIFO
+	if (g_fusion_rate == 0)
+	{
+		read_fifo_rak12034();
+	}
+}
+
+/**
+ * @brief Drain the FIFO into the inertial pipeline
+ *
+ * @return uint16_t number of frames read
+ */
+uint16_t read_fifo_rak12034(void)
+{
+	uint8_t raw[RAK12034_BURST_FRAMES * RAK12034_FRAME_SIZE];
+	int16_t gyro[RAK12034_BURST_FRAMES * 3];
+	int16_t acc[RAK12034_BURST_FRAMES * 3];
+
+	if (!rak12034_readBurst(raw, RAK12034_REG_FIFO_LENGTH, 2))
+	{
+		MYLOG("BMX160", "FIFO length read failed");
+		return 0;
+	}
+	uint16_t num_frames = (raw[0] | ((raw[1] & 0x07) << 8)) / RAK12034_FRAME_SIZE;
+	uint32_t now = micros();
+	uint32_t period = 1000000UL / RAK12034_ODR;
+
+	uint16_t frame_idx = 0;
+	while (frame_idx < num_frames)
+	{
+		uint8_t chunk = num_frames - frame_idx;
+		if (chunk > RAK12034_BURST_FRAMES)
+		{
+			chunk = RAK12034_BURST_FRAMES;
+		}
+		if (!rak12034_readBurst(raw, RAK12034_REG_FIFO_DATA, chunk * RAK12034_FRAME_SIZE))
+		{
+			MYLOG("BMX160", "FIFO burst read failed");
+			break;
+		}
+		for (uint8_t idx = 0; idx < chunk; idx++)
+		{
+			uint8_t *frame = &raw[idx * RAK12034_FRAME_SIZE];
+			for (uint8_t axis = 0; axis < 3; axis++)
+			{
+				gyro[idx * 3 + axis] = (int16_t)(frame[axis * 2] | (frame[axis * 2 + 1] << 8));
+				acc[idx * 3 + axis] = (int16_t)(frame[6 + axis * 2] | (frame[6 + axis * 2 + 1] << 8));
+			}
+		}
+		frame_idx += chunk;
+		// Newest frame in the FIFO was sampled just before the drain started
+		uint32_t last_timestamp = now - (uint32_t)(num_frames - frame_idx) * period;
+		imu_push_block(IMU_SRC_RAK12034, IMU_TYPE_GYRO, gyro, chunk, RAK12034_GYRO_SCALE, RAK12034_ODR, last_timestamp);
+		imu_push_block(IMU_SRC_RAK12034, IMU_TYPE_ACC, acc, chunk, RAK12034_ACC_SCALE, RAK12034_ODR, last_timestamp);
+	}
+	MYLOG("BMX160", "Got %d FIFO frames", frame_idx);
+	return frame_idx;
+}
+
+/**
+ * @brief Read the magnetometer into the inertial pipeline
+ *
+ * @return true value added
+ * @return false magnetometer not available
+ */
+bool read_mag_rak12034(void)
+{
+	sBmx160SensorData_t Omagn, Ogyro, Oaccel;
+	bmx160.getAllData(&Omagn, &Ogyro, &Oaccel);
+
+	int16_t values[3];
+	values[0] = (int16_t)(Omagn.x * 10.0f);
+	values[1] = (int16_t)(Omagn.y * 10.0f);
+	values[2] = (int16_t)(Omagn.z * 10.0f);
+	imu_push_block(IMU_SRC_RAK12034, IMU_TYPE_MAG, values, 1, RAK12034_MAG_SCALE, 1, micros());
+	return true;
 }
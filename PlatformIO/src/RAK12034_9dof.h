@@ -35,5 +35,7 @@
 
 bool init_rak12034(void);
 void clear_int_rak12034(void);
+uint16_t read_fifo_rak12034(void);
+bool read_mag_rak12034(void);
 
 #endif // RAK12034_H
\ No newline at end of file
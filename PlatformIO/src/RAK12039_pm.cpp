@@ -25,6 +25,68 @@ PMSA_Data_t data;
  */
 #define SET_PIN WB_IO6
 
+/** Time the fan is switched on before the uplink in seconds */
+uint16_t g_pms_lead = PMS_LEAD_DEFAULT;
+/** Number of frames averaged per uplink */
+uint8_t g_pms_frames = PMS_FRAMES_DEFAULT;
+
+/** Scheduler states */
+#define PMS_SLEEP 0	   // Sensor off, waiting for the lead time before the next uplink
+#define PMS_SAMPLING 1 // Sensor on, warming up and collecting frames
+#define PMS_DONE 2	   // Averages ready, waiting for the uplink
+volatile uint8_t pms_state = PMS_DONE;
+
+/** Sums of the collected frames */
+static uint32_t pms_sum_pm10 = 0;
+static uint32_t pms_sum_pm25 = 0;
+static uint32_t pms_sum_pm100 = 0;
+/** Number of collected frames */
+static uint8_t pms_count = 0;
+/** Time the sensor was on during the last cycle in ms */
+static uint32_t pms_awake_time = 0;
+
+/** Flag set by the uplink when the averages were sent */
+static volatile bool pms_uplink_done = false;
+/** millis() of the last uplink that consumed the averages */
+static time_t pms_last_uplink = 0;
+
+#if defined NRF52_SERIES || defined ESP32
+/** Task handle */
+TaskHandle_t pms_task_handle;
+
+/** Task declaration */
+void pms_task(void *pvParameters);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** The scheduler thread */
+Thread pms_task_handle(osPriorityLow, 4096);
+
+/** Task declaration */
+void pms_task(void);
+#endif
+
+/**
+ * @brief Check if the sensor has to stay on permanently
+ *     If the lead time does not fit into the send interval, the fan is never switched off
+ *
+ * @return true sensor stays on
+ * @return false sensor is switched off between uplinks
+ */
+static bool pms_always_on(void)
+{
+	return (g_lorawan_settings.send_repeat_time == 0) || (g_lorawan_settings.send_repeat_time <= (uint32_t)g_pms_lead * 1000);
+}
+
+/**
+ * @brief Switch the sensor on or off
+ *
+ * @param on true to switch the sensor on
+ */
+static void pms_power(bool on)
+{
+	digitalWrite(SET_PIN, on ? HIGH : LOW);
+}
+
 /**
  * @brief Initialize the PMSA003I sensor
  *
@@ -37,59 +99,199 @@ bool init_rak12039(void)
 	pinMode(SET_PIN, OUTPUT);
 
 	// Sensor on
-	digitalWrite(SET_PIN, HIGH);
+	pms_power(true);
 
 	// Wait for sensor wake-up
 	delay(300);
 	Wire.begin();
+	// RAK12039 supports only low I2C speed
+	Wire.setClock(100000);
 	if (!PMSA003I.begin())
 	{
 		MYLOG("Dust", "PMSA003I begin fail,please check connection!");
-		digitalWrite(SET_PIN, LOW);
+		pms_power(false);
+		return false;
+	}
+
+	return true;
+}
+
+/**
+ * @brief Collect one frame
+ *
+ * @return true frame was added to the sums
+ * @return false read failed
+ */
+static bool pms_collect(void)
+{
+	// The app loop and other sensor tasks share the I2C bus
+	i2c_lock();
+	bool read_ok = PMSA003I.readDate(&data);
+	i2c_unlock();
+	if (!read_ok)
+	{
+		MYLOG("PMS", "PMSA003I read failed!");
+		return false;
+	}
+	pms_sum_pm10 += data.pm10_env;
+	pms_sum_pm25 += data.pm25_env;
+	pms_sum_pm100 += data.pm100_env;
+	pms_count++;
+	return true;
+}
+
+/**
+ * @brief Scheduler task
+ *     Switches the sensor on the lead time before the next uplink,
+ *     waits for the fan to stabilize, collects the frames one second
+ *     apart and switches the sensor off again
+ *
+ */
+#if defined NRF52_SERIES || defined ESP32
+void pms_task(void *pvParameters)
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	void pms_task(void)
+#endif
+{
+	MYLOG("PMS", "Scheduler task started");
+	pms_last_uplink = millis();
+	while (1)
+	{
+		// Wait until the lead time before the next uplink
+		pms_state = PMS_SLEEP;
+		if (!pms_always_on())
+		{
+			pms_power(false);
+			uint32_t sleep_time = g_lorawan_settings.send_repeat_time - (uint32_t)g_pms_lead * 1000;
+			uint32_t elapsed = millis() - pms_last_uplink;
+			if (elapsed < sleep_time)
+			{
+				delay(sleep_time - elapsed);
+			}
+		}
+
+		// Warm up, the fan needs time to get a stable air flow
+		pms_state = PMS_SAMPLING;
+		time_t on_time = millis();
+		pms_power(true);
+		pms_sum_pm10 = 0;
+		pms_sum_pm25 = 0;
+		pms_sum_pm100 = 0;
+		pms_count = 0;
+		uint32_t warmup = ((uint32_t)g_pms_lead - g_pms_frames - PMS_MARGIN) * 1000;
+		if (!pms_always_on())
+		{
+			delay(warmup);
+		}
+
+		// Collect the frames, the sensor updates once per second
+		for (uint8_t frame = 0; frame < g_pms_frames; frame++)
+		{
+			pms_collect();
+			delay(1000);
+		}
+		if (!pms_always_on())
+		{
+			pms_power(false);
+		}
+		pms_awake_time = millis() - on_time;
+		MYLOG("PMS", "%d frames, awake %ld ms", pms_count, pms_awake_time);
+
+		// Wait for the uplink to take the averages
+		pms_uplink_done = false;
+		pms_state = PMS_DONE;
+		while (!pms_uplink_done)
+		{
+			delay(100);
+		}
+	}
+}
+
+/**
+ * @brief Start the power scheduler task
+ *
+ * @return true task started
+ * @return false task could not be started
+ */
+bool start_rak12039(void)
+{
+#ifdef ARDUINO_ARCH_RP2040
+	pms_task_handle.start(pms_task);
+	pms_task_handle.set_priority(osPriorityLow);
+#endif
+#if defined NRF52_SERIES || defined ESP32
+	if (!xTaskCreate(pms_task, "PMS", 4096, NULL, TASK_PRIO_LOW, &pms_task_handle))
+	{
+		MYLOG("PMS", "Failed to start scheduler task");
 		return false;
 	}
+#endif
+	return true;
+}
 
-	// digitalWrite(SET_PIN, LOW);
+/**
+ * @brief Set the lead time and the number of averaged frames
+ *
+ * @param new_lead lead time in seconds
+ * @param new_frames number of frames
+ * @return true settings are valid
+ * @return false lead time is too short for the warm-up and the frames
+ */
+bool set_rak12039(uint16_t new_lead, uint8_t new_frames)
+{
+	if ((new_frames < PMS_FRAMES_MIN) || (new_frames > PMS_FRAMES_MAX) || (new_lead > PMS_LEAD_MAX))
+	{
+		return false;
+	}
+	if (new_lead < (new_frames + PMS_MARGIN + PMS_WARMUP_MIN))
+	{
+		return false;
+	}
+	g_pms_lead = new_lead;
+	g_pms_frames = new_frames;
 	return true;
 }
 
 /**
- * @brief Read ToF data from VL53L01
+ * @brief Read particle matter values
  *     Data is added to Cayenne LPP payload as channels
- *     LPP_CHANNEL_TOF
+ *     LPP_CHANNEL_PM_1_0, LPP_CHANNEL_PM_2_5 and LPP_CHANNEL_PM_10_0
+ *     as averages of the collected frames, the time the sensor was on as
+ *     LPP_CHANNEL_PM_AWAKE and the number of frames as LPP_CHANNEL_PM_FRAMES
  *
  */
 void read_rak12039(void)
 {
-	// RAK12039 supports only low I2C speed
-	Wire.setClock(100000);
-	// Sensor on
-	// digitalWrite(SET_PIN, HIGH);
-	delay(300);
-
-	if (PMSA003I.readDate(&data))
+	if (pms_state != PMS_DONE)
 	{
+		MYLOG("PMS", "PMSA003I still sampling");
+		return;
+	}
 
-		MYLOG("PMS","PMSA003I read date success.");
+	if (pms_count != 0)
+	{
+		uint16_t pm10 = (pms_sum_pm10 + pms_count / 2) / pms_count;
+		uint16_t pm25 = (pms_sum_pm25 + pms_count / 2) / pms_count;
+		uint16_t pm100 = (pms_sum_pm100 + pms_count / 2) / pms_count;
 
-		g_solution_data.addVoc_index(LPP_CHANNEL_PM_1_0,data.pm10_env);
-		g_solution_data.addVoc_index(LPP_CHANNEL_PM_2_5,data.pm25_env);
-		g_solution_data.addVoc_index(LPP_CHANNEL_PM_10_0,data.pm100_env);
+		g_solution_data.addVoc_index(LPP_CHANNEL_PM_1_0, pm10);
+		g_solution_data.addVoc_index(LPP_CHANNEL_PM_2_5, pm25);
+		g_solution_data.addVoc_index(LPP_CHANNEL_PM_10_0, pm100);
+		g_solution_data.addGenericSensor(LPP_CHANNEL_PM_AWAKE, pms_awake_time / 1000);
+		g_solution_data.addDigitalInput(LPP_CHANNEL_PM_FRAMES, pms_count);
 
-		MYLOG("PMS","Std PM ug/m3: PM 1.0 %d PM 2.5 %d PM 10 %d",data.pm10_standard,data.pm25_standard,data.pm100_standard);
-		MYLOG("PMS","Env PM ug/m3: PM 1.0 %d PM 2.5 %d PM 10 %d",data.pm10_env,data.pm25_env,data.pm100_env);
+		MYLOG("PMS", "Env PM ug/m3: PM 1.0 %d PM 2.5 %d PM 10 %d", pm10, pm25, pm100);
 #if HAS_EPD == 1 || HAS_EPD == 4
-	set_pm_rak14000(data.pm10_env,data.pm25_env,data.pm100_env);
+		set_pm_rak14000(pm10, pm25, pm100);
 #endif
 	}
 	else
 	{
-		Serial.println("PMSA003I read failed!");
+		MYLOG("PMS", "No valid frames");
 	}
 
-	// RAK12039 supports only low I2C speed
-	Wire.setClock(100000); // Wire.setClock(400000);
-	// Sensor off
-	// digitalWrite(SET_PIN, LOW);
-	return;
-}
\ No newline at end of file
+	// Start the next cycle
+	pms_last_uplink = millis();
+	pms_uplink_done = true;
+}
@@ -12,7 +12,23 @@
 #define RAK12039_H
 #include <Arduino.h>
 
+/** Lead time limits in seconds, the fan needs ~30 seconds to stabilize */
+#define PMS_LEAD_MAX 300
+#define PMS_LEAD_DEFAULT 40
+/** Minimum warm-up time in seconds */
+#define PMS_WARMUP_MIN 10
+/** Margin between the last frame and the uplink in seconds */
+#define PMS_MARGIN 2
+/** Limits for the number of averaged frames */
+#define PMS_FRAMES_MIN 1
+#define PMS_FRAMES_MAX 30
+#define PMS_FRAMES_DEFAULT 5
+
 bool init_rak12039(void);
 void read_rak12039(void);
+bool start_rak12039(void);
+bool set_rak12039(uint16_t new_lead, uint8_t new_frames);
+extern uint16_t g_pms_lead;
+extern uint8_t g_pms_frames;
 
 #endif // RAK12039_H
\ No newline at end of file
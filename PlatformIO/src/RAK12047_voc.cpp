@@ -2,9 +2,9 @@
  * @file RAK12047_voc.cpp
  * @author Bernd Giesecke (bernd.giesecke@rakwireless.com)
  * @brief Read values from the RAK12047 VOC sensor
- *        The VOC algorithm requires a reading every one second.
- *        This code uses a timer to set the VOC_REQ every one second
- *        and wake up the loop to perform the readings
+ *        The VOC algorithm requires a reading every 10 seconds.
+ *        Sampling and processing runs in its own task, the app loop
+ *        is not woken up, it only takes the latest VOC index for the uplink
  * @date 2022-02-05
  *
  * @copyright Copyright (c) 2022
@@ -21,22 +21,26 @@ SensirionI2CSgp40 sgp40;
 /** Instance for the VOC algorithm */
 VOCGasIndexAlgorithm voc_algorithm(sampling_interval);
 
-/** Timer for VOC measurement */
-#ifdef NRF52_SERIES
-SoftwareTimer voc_read_timer;
-#endif
-#ifdef ESP32
-Ticker voc_read_timer;
+#if defined NRF52_SERIES || defined ESP32
+/** Task handle */
+TaskHandle_t voc_task_handle;
+
+/** Task declaration */
+void voc_task(void *pvParameters);
 #endif
 #ifdef ARDUINO_ARCH_RP2040
-mbed::Ticker voc_read_timer;
+/** The VOC sampling thread */
+Thread voc_task_handle(osPriorityLow, 4096);
+
+/** Task declaration */
+void voc_task(void);
 #endif
 
 /** Calculated VOC index */
 volatile int32_t voc_index = 0;
 
 /** Flag if the VOC index is valid */
-bool voc_valid = false;
+volatile bool voc_valid = false;
 
 /** Buffer for debug output */
 char errorMessage[256];
@@ -44,23 +48,18 @@ char errorMessage[256];
 /** Counter to discard the first 100 readings */
 uint16_t discard_counter = 0;
 
-/**
- * @brief Timer callback to wakeup the loop with the VOC_REQ event
- *
- * @param unused
- */
-#ifdef NRF52_SERIES
-void voc_read_wakeup(TimerHandle_t unused)
-{
-	api_wake_loop(VOC_REQ);
-}
-#endif
-#if defined ESP32 || defined ARDUINO_ARCH_RP2040
-void voc_read_wakeup(void)
-{
-	api_wake_loop(VOC_REQ);
-}
-#endif
+/** Counter for the readings since the last check of the algorithm state */
+uint16_t checkpoint_counter = 0;
+
+/** Counter for the readings since the last saved checkpoint */
+uint16_t checkpoint_age = 0;
+
+/** Last saved algorithm state, valid if checkpoint_known is true
+ *  A restored checkpoint is not used, it is already old and is saved again on the first check */
+voc_state_s checkpoint_state;
+bool checkpoint_known = false;
+
+void do_read_rak12047(void);
 
 /**
  * @brief Initialize the sensor
@@ -126,19 +125,75 @@ bool init_rak12047(void)
 
 	// Reset discard counter
 	discard_counter = 0;
+	checkpoint_counter = 0;
+	checkpoint_age = 0;
+	checkpoint_known = false;
+
+	// Warm start from a recent checkpoint skips the discard phase and the learning of the baseline
+	// Without the RTC the age of the checkpoint is unknown, then it is a cold start
+	voc_state_s saved_state;
+	if (read_voc_state(&saved_state))
+	{
+		bool recent = false;
+		if (found_sensors[RTC_ID].found_sensor && (saved_state.epoch != 0))
+		{
+			uint32_t now = get_epoch_rak12002();
+			recent = (now >= saved_state.epoch) && ((now - saved_state.epoch) <= VOC_WARM_MAX_AGE);
+		}
+		if (recent)
+		{
+			voc_algorithm.set_states(saved_state.mean, saved_state.std);
+			discard_counter = 101 - VOC_WARM_DISCARD;
+			MYLOG("VOC", "Warm start, mean %ld std %ld", saved_state.mean, saved_state.std);
+		}
+		else
+		{
+			MYLOG("VOC", "Checkpoint too old or no RTC, cold start");
+		}
+	}
+
+	// Start the VOC sampling task
+#ifdef ARDUINO_ARCH_RP2040
+	voc_task_handle.start(voc_task);
+	voc_task_handle.set_priority(osPriorityLow);
+#endif
+#if defined NRF52_SERIES || defined ESP32
+	if (!xTaskCreate(voc_task, "VOC", 4096, NULL, TASK_PRIO_LOW, &voc_task_handle))
+	{
+		MYLOG("VOC", "Failed to start VOC task");
+		return false;
+	}
+#endif
+	return true;
+}
 
-	// Set VOC reading interval to 10 seconds
-#ifdef NRF52_SERIES
-	voc_read_timer.begin(10000, voc_read_wakeup, NULL, true);
-	voc_read_timer.start();
+/**
+ * @brief VOC task, samples the sensor every sampling_interval seconds
+ *     and feeds the VOC algorithm
+ *
+ */
+#if defined NRF52_SERIES || defined ESP32
+void voc_task(void *pvParameters)
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	void voc_task(void)
 #endif
-#ifdef ESP32
-	voc_read_timer.attach_ms(10000, voc_read_wakeup);
+{
+	MYLOG("VOC", "VOC task started");
+#if defined NRF52_SERIES || defined ESP32
+	TickType_t last_wake = xTaskGetTickCount();
+#endif
+	while (1)
+	{
+		do_read_rak12047();
+
+#if defined NRF52_SERIES || defined ESP32
+		vTaskDelayUntil(&last_wake, pdMS_TO_TICKS(sampling_interval * 1000));
 #endif
 #ifdef ARDUINO_ARCH_RP2040
-	voc_read_timer.attach(voc_read_wakeup, (microseconds)(10000000));
+		delay(sampling_interval * 1000);
 #endif
-	return true;
+	}
 }
 
 /**
@@ -170,7 +225,7 @@ void read_rak12047(void)
 /**
  * @brief Read the current VOC and feed it to the
  *        VOC algorithm
- *        Called every 10 second
+ *        Called every 10 second from the VOC task
  *
  */
 void do_read_rak12047(void)
@@ -185,38 +240,22 @@ void do_read_rak12047(void)
 	uint16_t srawVoc = 0;
 	uint16_t defaultRh = 0x8000;
 	uint16_t defaultT = 0x6666;
-	float t_h_values[3] = {0.0}; // temperature [0] & humidity [1] value from T&H sensor
+	float temperature;
+	float humidity;
 
-	if (found_sensors[TEMP_ID].found_sensor)
-	{
-		get_rak1901_values(t_h_values);
-		// MYLOG("VOC", "Rh: %.2f T: %.2f", humidity, temperature);
-
-		if ((t_h_values[0] != 0.0) && (t_h_values[1] != 0.0))
-		{
-			defaultRh = (uint16_t)(t_h_values[1] * 65535 / 100);
-			defaultT = (uint16_t)((t_h_values[0] + 45) * 65535 / 175);
-		}
-	}
-	else if (found_sensors[ENV_ID].found_sensor)
+	// Compensation values from the environment sensors
+	if (env_get_th(&temperature, &humidity, env_max_age()))
 	{
-#if USE_BSEC == 0
-		get_rak1906_values(t_h_values);
-#else
-		get_rak1906_bsec_values(t_h_values);
-#endif
 		// MYLOG("VOC", "Rh: %.2f T: %.2f", humidity, temperature);
-
-		if ((t_h_values[0] != 0.0) && (t_h_values[1] != 0.0))
-		{
-			defaultRh = (uint16_t)(t_h_values[1] * 65535 / 100);
-			defaultT = (uint16_t)((t_h_values[0] + 45) * 65535 / 175);
-		}
+		defaultRh = (uint16_t)(humidity * 65535 / 100);
+		defaultT = (uint16_t)((temperature + 45) * 65535 / 175);
 	}
 
-	// 2. Measure SGP4x signals
+	// 2. Measure SGP4x signals, the app loop and other sensor tasks share the I2C bus
+	i2c_lock();
 	error = sgp40.measureRawSignal(defaultRh, defaultT,
 								   srawVoc);
+	i2c_unlock();
 	MYLOG("VOC", "srawVoc: %d", srawVoc);
 
 	// 3. Process raw signals by Gas Index Algorithm to get the VOC index values
@@ -247,6 +286,33 @@ void do_read_rak12047(void)
 			uint32_t new_voc_index = voc_algorithm.process(srawVoc);
 			voc_index = ((voc_index + new_voc_index) / 2);
 			MYLOG("VOC", "VOC: %ld", voc_index);
+
+			// Save the algorithm state periodically, but only if it moved or the checkpoint gets old
+			checkpoint_counter++;
+			checkpoint_age++;
+			if (checkpoint_counter >= VOC_CHECKPOINT_INTERVAL)
+			{
+				checkpoint_counter = 0;
+				voc_state_s new_state;
+				voc_algorithm.get_states(new_state.mean, new_state.std);
+				bool moved = true;
+				if (checkpoint_known)
+				{
+					int32_t delta = abs(checkpoint_state.std) / VOC_CHECKPOINT_DELTA;
+					moved = (abs(new_state.mean - checkpoint_state.mean) > delta) || (abs(new_state.std - checkpoint_state.std) > delta);
+				}
+				if (moved || (checkpoint_age >= VOC_CHECKPOINT_REFRESH))
+				{
+					i2c_lock();
+					new_state.epoch = found_sensors[RTC_ID].found_sensor ? get_epoch_rak12002() : 0;
+					i2c_unlock();
+					save_voc_state(&new_state);
+					checkpoint_state = new_state;
+					checkpoint_known = true;
+					checkpoint_age = 0;
+					MYLOG("VOC", "Checkpoint saved");
+				}
+			}
 		}
 	}
 
@@ -14,6 +14,29 @@
 
 bool init_rak12047(void);
 void read_rak12047(void);
-void do_read_rak12047(void);
+
+/** Readings between two checks if the algorithm state has to be saved, 30 = 5 minutes */
+#define VOC_CHECKPOINT_INTERVAL 30
+/** The state is saved if mean or std moved by more than std / VOC_CHECKPOINT_DELTA since the last checkpoint */
+#define VOC_CHECKPOINT_DELTA 16
+/** Readings after which an unchanged state is saved again to refresh the time, 180 = 30 minutes
+ *  In stable air the flash is written at most 48 times a day instead of every 5 minutes */
+#define VOC_CHECKPOINT_REFRESH 180
+/** Maximum age of a checkpoint for a warm start in seconds
+ *  Sensirion allows to restore the states only after an interruption of up to 10 minutes.
+ *  An unchanged state is saved only every 30 minutes, the checkpoint can be that much older
+ *  than the interruption. Interruptions of up to 10 minutes always get a warm start,
+ *  longer ones up to 40 minutes can get one with a state close to the last one. */
+#define VOC_WARM_MAX_AGE (600 + VOC_CHECKPOINT_REFRESH * 10)
+/** Readings discarded after a warm start to let the hotplate settle */
+#define VOC_WARM_DISCARD 6
+
+/** Saved VOC algorithm state */
+struct voc_state_s
+{
+	int32_t mean;	// Mean estimator
+	int32_t std;	// Variance estimator
+	uint32_t epoch; // RTC time of the checkpoint, 0 if no RTC was available
+};
 
 #endif // RAK12047_H
\ No newline at end of file
@@ -2,7 +2,10 @@
  * @file RAK12052_temp_array.cpp
  * @author Bernd Giesecke (bernd@giesecke.tk)
  * @brief Initialization and reading of the RAK12052
- * @version 0.1
+ *        Both subpages are read with burst transfers, the calibration
+ *        parameters are extracted once at startup. The frame is reduced
+ *        on the device and packed into a blob for a separate uplink.
+ * @version 0.2
  * @date 2023-09-15
  * 
  * @copyright Copyright (c) 2023
@@ -14,6 +17,201 @@
 /** Sensor instance */
 RAK_MLX90640 MLX90640;
 
+/** MLX90640 I2C address */
+#define MLX_ADDRESS 0x33
+/** Status register, bit 3 is new data, bits 0 to 2 the last measured subpage */
+#define MLX_STATUS_REG 0x8000
+/** Control register 1 */
+#define MLX_CTRL_REG 0x800D
+/** First RAM word, 768 pixels and 64 auxiliary words */
+#define MLX_RAM_REG 0x0400
+/** First EEPROM word */
+#define MLX_EEPROM_REG 0x2400
+/** Words in RAM or EEPROM */
+#define MLX_NUM_WORDS 832
+/** Maximum bytes per I2C read, reduce if the Wire buffer is smaller */
+#define MLX_I2C_CHUNK 128
+/** I2C clock during the frame read, the MLX90640 supports up to 1 MHz */
+#define MLX_I2C_FAST 400000
+/** I2C clock used by the other modules */
+#define MLX_I2C_NORMAL 100000
+/** Timeout waiting for a subpage in ms, one subpage takes 500 ms at 2 Hz */
+#define MLX_SUBPAGE_TIMEOUT 1200
+/** Emissivity used for the temperature calculation */
+#define MLX_EMISSIVITY 0.95
+/** Difference between the sensor temperature and the reflected temperature, from the Melexis driver */
+#define MLX_TA_SHIFT 8.0
+
+/** Frame size */
+#define MLX_WIDTH 32
+#define MLX_HEIGHT 24
+/** Block size for the downsampled grid, 8 x 6 cells */
+#define MLX_GRID_BLOCK 4
+/** Number of hotspots and histogram bins in the blob */
+#define MLX_NUM_SPOTS 3
+#define MLX_NUM_BINS 8
+
+/** Cached calibration parameters, extracted once in init_rak12052() */
+static paramsMLX90640 mlx_params;
+/** Flag if the cached parameters are valid, otherwise the library frame read is used */
+static bool mlx_params_valid = false;
+/** Raw frame data of one subpage plus control and subpage number, used for the EEPROM dump as well */
+static uint16_t mlx_raw[MLX_NUM_WORDS + 2];
+
+/** Frame buffer, pixel temperatures in 0.01 degree C */
+static int16_t mlx_frame[MLX_WIDTH * MLX_HEIGHT];
+
+/** Analytics settings, a person is 1.5 degree C above the background and covers at least 4 pixels */
+thermal_params_t mlx_params_analytics = {150, 4, true};
+
+/** Packed frame for the separate uplink */
+static uint8_t mlx_blob[MLX_BLOB_MAX];
+/** Size of the packed frame, 0 if nothing to send */
+static uint8_t mlx_blob_size = 0;
+
+/** Sensor uplinks between two frame blobs, 0 = no blob */
+uint8_t g_mlx_blob_interval = MLX_BLOB_INTERVAL_DEFAULT;
+/** Sensor uplinks since the last sent blob */
+static uint8_t mlx_blob_counter = 0;
+
+/**
+ * @brief Read words from the MLX90640 in bursts
+ *     Words are big endian, the register address increments by one per word
+ *
+ * @param reg first register
+ * @param data buffer for the words
+ * @param num_words number of words to read
+ * @return true words read
+ * @return false I2C error
+ */
+static bool mlx_read_words(uint16_t reg, uint16_t *data, uint16_t num_words)
+{
+	uint16_t done = 0;
+	while (done < num_words)
+	{
+		uint16_t chunk = num_words - done;
+		if (chunk > MLX_I2C_CHUNK / 2)
+		{
+			chunk = MLX_I2C_CHUNK / 2;
+		}
+		uint16_t chunk_reg = reg + done;
+		Wire.beginTransmission(MLX_ADDRESS);
+		Wire.write((uint8_t)(chunk_reg >> 8));
+		Wire.write((uint8_t)(chunk_reg & 0xFF));
+		if (Wire.endTransmission(false) != 0)
+		{
+			return false;
+		}
+		if (Wire.requestFrom((uint8_t)MLX_ADDRESS, (uint8_t)(chunk * 2)) != chunk * 2)
+		{
+			return false;
+		}
+		for (uint16_t idx = 0; idx < chunk; idx++)
+		{
+			uint16_t value = (uint16_t)Wire.read() << 8;
+			value |= Wire.read();
+			data[done + idx] = value;
+		}
+		done += chunk;
+	}
+	return true;
+}
+
+/**
+ * @brief Write a word to the MLX90640
+ *
+ * @param reg register
+ * @param value word to write
+ * @return true word written
+ * @return false I2C error
+ */
+static bool mlx_write_word(uint16_t reg, uint16_t value)
+{
+	Wire.beginTransmission(MLX_ADDRESS);
+	Wire.write((uint8_t)(reg >> 8));
+	Wire.write((uint8_t)(reg & 0xFF));
+	Wire.write((uint8_t)(value >> 8));
+	Wire.write((uint8_t)(value & 0xFF));
+	return Wire.endTransmission() == 0;
+}
+
+/**
+ * @brief Wait for the next subpage and read it into mlx_raw
+ *     Same sequence as MLX90640_GetFrameData() of the Melexis driver,
+ *     but the 832 RAM words are read in bursts
+ *
+ * @return int8_t subpage number 0 or 1, -1 on error
+ */
+static int8_t mlx_read_subpage(void)
+{
+	uint16_t status = 0;
+	time_t start = millis();
+	while (1)
+	{
+		if (!mlx_read_words(MLX_STATUS_REG, &status, 1))
+		{
+			return -1;
+		}
+		if ((status & 0x0008) != 0)
+		{
+			break;
+		}
+		if ((millis() - start) > MLX_SUBPAGE_TIMEOUT)
+		{
+			MYLOG("IR_ARR", "Timeout waiting for subpage");
+			return -1;
+		}
+		delay(5);
+	}
+
+	// Clear the new data flag and start the next measurement
+	if (!mlx_write_word(MLX_STATUS_REG, 0x0030))
+	{
+		return -1;
+	}
+	if (!mlx_read_words(MLX_RAM_REG, mlx_raw, MLX_NUM_WORDS))
+	{
+		return -1;
+	}
+	if (!mlx_read_words(MLX_CTRL_REG, &mlx_raw[MLX_NUM_WORDS], 1))
+	{
+		return -1;
+	}
+	mlx_raw[MLX_NUM_WORDS + 1] = status & 0x0001;
+	return status & 0x0001;
+}
+
+/**
+ * @brief Read both subpages and calculate the temperatures into MLX90640.frame
+ *     Uses the cached calibration parameters
+ *
+ * @return true frame read
+ * @return false I2C error or timeout
+ */
+static bool mlx_read_frame(void)
+{
+	bool result = true;
+	uint8_t subpages = 0;
+
+	Wire.setClock(MLX_I2C_FAST);
+	// Chess mode alternates the subpages, allow one extra read in case a subpage repeats
+	for (uint8_t attempt = 0; (attempt < 3) && (subpages != 0x03); attempt++)
+	{
+		int8_t subpage = mlx_read_subpage();
+		if (subpage < 0)
+		{
+			result = false;
+			break;
+		}
+		float ta = MLX90640_GetTa(mlx_raw, &mlx_params);
+		MLX90640_CalculateTo(mlx_raw, &mlx_params, MLX_EMISSIVITY, ta - MLX_TA_SHIFT, MLX90640.frame);
+		subpages |= 1 << subpage;
+	}
+	Wire.setClock(MLX_I2C_NORMAL);
+
+	return result && (subpages == 0x03);
+}
+
 /**
  * @brief Initialize the MLX90640 sensor
  *
@@ -41,27 +239,84 @@ bool init_rak12052(void)
 	// Set sensor to 2Hz refresh rate
 	MLX90640.setRefreshRate(MLX90640_2_HZ);
 
+	// Extract the calibration parameters once, mlx_raw is used as buffer for the EEPROM dump
+	Wire.setClock(MLX_I2C_FAST);
+	mlx_params_valid = mlx_read_words(MLX_EEPROM_REG, mlx_raw, MLX_NUM_WORDS) && (MLX90640_ExtractParameters(mlx_raw, &mlx_params) >= 0);
+	Wire.setClock(MLX_I2C_NORMAL);
+	if (!mlx_params_valid)
+	{
+		MYLOG("IR_ARR", "Parameter extraction failed, using library frame read");
+	}
+
 	return true;
 }
 
 /**
- * @brief Read and display measured values
+ * @brief Read the frame, reduce it and prepare the blob
+ *     Adds LPP_CHANNEL_TARR_MIN, LPP_CHANNEL_TARR_MAX, LPP_CHANNEL_TARR_MEAN,
+ *     LPP_CHANNEL_TARR_HOT_X, LPP_CHANNEL_TARR_HOT_Y and LPP_CHANNEL_TARR_PERSONS
+ *     The blob with grid, hotspots and histogram is sent after every g_mlx_blob_interval'th
+ *     uplink on MLX_BLOB_FPORT
  *
  */
 void read_rak12052()
 {
-	if (MLX90640.getFrame(MLX90640.frame) != 0)
+	mlx_blob_size = 0;
+#if MY_DEBUG > 0
+	time_t start = millis();
+#endif
+	bool frame_ok = mlx_params_valid ? mlx_read_frame() : (MLX90640.getFrame(MLX90640.frame) == 0);
+	if (!frame_ok)
 	{
 		MYLOG("IR_ARR", "MLX90640 reading failed");
 		return;
 	}
 
+	for (uint16_t idx = 0; idx < MLX_WIDTH * MLX_HEIGHT; idx++)
+	{
+		mlx_frame[idx] = (int16_t)(MLX90640.frame[idx] * 100.0);
+	}
+	MYLOG("IR_ARR", "Frame read in %ld ms", (uint32_t)(millis() - start));
+
+	thermal_result_t result;
+	if (!thermal_analyze(mlx_frame, MLX_WIDTH, MLX_HEIGHT, &mlx_params_analytics, &result))
+	{
+		MYLOG("IR_ARR", "Frame analysis failed");
+		return;
+	}
+
+	g_solution_data.addTemperature(LPP_CHANNEL_TARR_MIN, result.min / 100.0);
+	g_solution_data.addTemperature(LPP_CHANNEL_TARR_MAX, result.max / 100.0);
+	g_solution_data.addTemperature(LPP_CHANNEL_TARR_MEAN, result.mean / 100.0);
+	g_solution_data.addAnalogInput(LPP_CHANNEL_TARR_HOT_X, (float)result.hot_x / THERMAL_SUBPIXEL);
+	g_solution_data.addAnalogInput(LPP_CHANNEL_TARR_HOT_Y, (float)result.hot_y / THERMAL_SUBPIXEL);
+	g_solution_data.addPresence(LPP_CHANNEL_TARR_PERSONS, result.persons);
+
+	// Reduce the frame and pack it, the counter restarts only when a blob was sent
+	if ((g_mlx_blob_interval != 0) && (mlx_blob_counter < 0xFF))
+	{
+		mlx_blob_counter++;
+	}
+	if ((g_mlx_blob_interval != 0) && (mlx_blob_counter >= g_mlx_blob_interval))
+	{
+		int16_t grid[(MLX_WIDTH / MLX_GRID_BLOCK) * (MLX_HEIGHT / MLX_GRID_BLOCK)];
+		thermal_downsample(mlx_frame, MLX_WIDTH, MLX_HEIGHT, MLX_GRID_BLOCK, grid);
+		thermal_hotspot_t spots[MLX_NUM_SPOTS];
+		uint8_t num_spots = thermal_hotspots(mlx_frame, MLX_WIDTH, MLX_HEIGHT, result.background + mlx_params_analytics.person_delta, spots, MLX_NUM_SPOTS);
+		uint8_t bins[MLX_NUM_BINS];
+		thermal_histogram(mlx_frame, MLX_WIDTH * MLX_HEIGHT, result.min, result.max, bins, MLX_NUM_BINS);
+		mlx_blob_size = thermal_pack(&result, grid, MLX_WIDTH / MLX_GRID_BLOCK, MLX_HEIGHT / MLX_GRID_BLOCK,
+									 spots, num_spots, bins, MLX_NUM_BINS, mlx_blob, MLX_BLOB_MAX);
+		MYLOG("IR_ARR", "Blob %d bytes, flags %02X, %d hotspots", mlx_blob_size, mlx_blob[0] & 0x0F, num_spots);
+	}
+
+#if MY_DEBUG > 0
 	Serial.println();
-	for (uint8_t h = 0; h < 24; h++)
+	for (uint8_t h = 0; h < MLX_HEIGHT; h++)
 	{
-		for (uint8_t w = 0; w < 32; w++)
+		for (uint8_t w = 0; w < MLX_WIDTH; w++)
 		{
-			float t = MLX90640.frame[h * 32 + w];
+			float t = MLX90640.frame[h * MLX_WIDTH + w];
 			char c = '&';
 			if (t < 20)
 				c = ' ';
@@ -85,4 +340,43 @@ void read_rak12052()
 		}
 		Serial.println();
 	}
+#endif
+}
+
+/**
+ * @brief Get the blob of the last frame
+ *     The blob is returned only once
+ *
+ * @param blob pointer to the blob buffer
+ * @return uint8_t size of the blob, 0 if nothing to send
+ */
+uint8_t get_blob_rak12052(uint8_t **blob)
+{
+	uint8_t size = mlx_blob_size;
+	*blob = mlx_blob;
+	mlx_blob_size = 0;
+	if (size != 0)
+	{
+		mlx_blob_counter = 0;
+	}
+	return size;
+}
+
+/**
+ * @brief Set the frame blob interval
+ *
+ * @param new_interval sensor uplinks between two blobs, 0 = no blob, max MLX_BLOB_INTERVAL_MAX
+ * @return true interval is valid
+ * @return false interval is out of range
+ */
+bool set_blob_rak12052(uint8_t new_interval)
+{
+	if (new_interval > MLX_BLOB_INTERVAL_MAX)
+	{
+		return false;
+	}
+	g_mlx_blob_interval = new_interval;
+	mlx_blob_counter = 0;
+	mlx_blob_size = 0;
+	return true;
 }
@@ -12,7 +12,18 @@
 #define RAK12052_H
 #include <Arduino.h>
 
+/** Maximum size of the frame blob, fits into DR0 of most regions */
+#define MLX_BLOB_MAX 51
+/** fPort for the frame blob */
+#define MLX_BLOB_FPORT 12
+/** Sensor uplinks between two frame blobs, 0 = no blob */
+#define MLX_BLOB_INTERVAL_MAX 100
+#define MLX_BLOB_INTERVAL_DEFAULT 4
+
 bool init_rak12052(void);
 void read_rak12052(void);
+uint8_t get_blob_rak12052(uint8_t **blob);
+bool set_blob_rak12052(uint8_t new_interval);
+extern uint8_t g_mlx_blob_interval;
 
 #endif // RAK12052_H
\ No newline at end of file
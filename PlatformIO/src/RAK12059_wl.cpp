@@ -52,20 +52,20 @@ uint16_t g_low_level = 0x8000;
 /** High level treshold */
 uint16_t g_high_level = 0x7FFF;
 /** Flag for interrupt */
-bool interrupt_flag = false;
+volatile bool interrupt_flag = false;
 
 /** Configuration */
-uint16_t config_value = 0xC2E0;
-// 1100001011100000
+uint16_t config_value = 0xC211;
+// 1100001000010001
 // 1                 Single Start conversion
 //  100              AINp = AIN0, AINn = GND
 //     001           FS 4.096V
 //        0          0 Continuous conversion mode 1 Power Down single-shot mode
-//         111       Data rate 800/960 Hz
-//            0      Traditional Comparator
+//         000       Data rate 6.25/7.5 Hz
+//            1      Window Comparator, ALERT on leaving Lo_Thresh..Hi_Thresh
 //             0     Polarity of Alert active low
 //              0    Non latching comparator
-//               00  Assert after one conversion
+//               01  Assert after two conversions (filters waves)
 
 /** Configuration 1 */
 uint16_t config1_value = 0x0180;
@@ -125,29 +125,31 @@ bool read_rak12059(void)
 	bool low_alert = false;
 	bool high_alert = false;
 
-	// Check if interrupt was set
-	// if (interrupt_flag) // Interrupts are not working atm, just check the levels
+	// Read the last conversion once, all values are derived from it
+	uint16_t adc_value = sgm58031.getAdcValue();
+
+	if (interrupt_flag)
 	{
 		interrupt_flag = false;
-		if (sgm58031.getAdcValue() > g_high_level)
-		{
-			MYLOG("WL", "High threshold triggered");
-			high_alert = true;
-		}
-		else if (sgm58031.getAdcValue() < g_low_level)
-		{
-			MYLOG("WL", "Low threshold triggered");
-			low_alert = true;
-		}
-		// Reset interrupts
-		reset_int_rak12059();
+		MYLOG("WL", "ALERT pin triggered");
+	}
+
+	// The window comparator does not tell which threshold was crossed
+	if ((int16_t)adc_value > (int16_t)g_high_level)
+	{
+		MYLOG("WL", "High threshold triggered");
+		high_alert = true;
+	}
+	else if ((int16_t)adc_value < (int16_t)g_low_level)
+	{
+		MYLOG("WL", "Low threshold triggered");
+		low_alert = true;
 	}
 
-	// Read sensor
 	// Get voltage
-	sensor_voltage = sgm58031.getVoltage();
+	sensor_voltage = (float)((int16_t)adc_value) * sgm58031.getVoltageResolution() / 32767.0;
 	MYLOG("WL", "sensor_voltage= %.6f\n", sensor_voltage);
-	MYLOG("WL", "ADC value = %04X\n", sgm58031.getAdcValue());
+	MYLOG("WL", "ADC value = %04X\n", adc_value);
 
 	// Calculate water level
 	distance_inch = ((sensor_voltage - g_v_low) * s_len / v_diff) + 1;
@@ -175,15 +177,19 @@ bool read_rak12059(void)
 	g_solution_data.addAnalogInput(LPP_CHANNEL_WLEVEL, distance_cm);
 	g_solution_data.addPresence(LPP_CHANNEL_WL_LOW, low_alert);
 	g_solution_data.addPresence(LPP_CHANNEL_WL_HIGH, high_alert);
+	return true;
 }
 
 /**
- * @brief Interrupt handler
+ * @brief Interrupt handler for the ALERT pin
+ * Wakes up application with signal WL_ALERT
+ * Activated when the level leaves the low/high threshold window
  *
  */
 void int_rak10259(void)
 {
 	interrupt_flag = true;
+	api_wake_loop(STATUS | WL_ALERT);
 }
 
 /**
@@ -238,7 +244,7 @@ void set_threshold_rak12059(void)
 void reset_int_rak12059(void)
 {
 	set_threshold_rak12059();
-	sgm58031.setConfig(0xC2E0);
+	sgm58031.setConfig(config_value);
 }
 
 /**
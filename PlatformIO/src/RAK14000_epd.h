@@ -18,7 +18,7 @@ void wake_rak14000(void);
 void clear_rak14000(void);
 void refresh_rak14000(void);
 void set_voc_rak14000(uint16_t voc_value);
-extern bool voc_valid;
+extern volatile bool voc_valid;
 void set_temp_rak14000(float temp_value);
 void set_humid_rak14000(float humid_value);
 void set_baro_rak14000(float baro_value);
@@ -33,4 +33,23 @@ void pm_rak14000(void);
 void status_general_rak14000(bool has_pm);
 void status_rak14000(void);
 
+/** Tiles of the EPD layout */
+#define EPD_TILE_HEADER 0
+#define EPD_TILE_VOC 1
+#define EPD_TILE_CO2 2
+#define EPD_TILE_TEMP 3
+#define EPD_TILE_HUMID 4
+#define EPD_TILE_BARO 5
+#define EPD_TILE_PM 6
+#define EPD_NUM_TILES 7
+/** Number of refreshes between two full refreshes, partial refreshes leave ghosting */
+#define EPD_FULL_REFRESH 20
+/** Start value of a tile key */
+#define EPD_KEY_INIT 2166136261UL
+
+uint32_t epd_key(uint32_t key, int32_t value);
+bool epd_tile_changed(uint8_t tile, uint32_t key);
+void epd_tiles_invalidate(void);
+uint8_t epd_dirty_tiles(void);
+
 #endif // RAK14000_H
\ No newline at end of file
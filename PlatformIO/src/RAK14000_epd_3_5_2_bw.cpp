@@ -97,31 +97,21 @@ void epd_task(void);
 /** Flag for first screen update */
 bool first_time = true;
 
-/** Counter for partial refreshes. Every 20 times a full update should be done */
+/** Counter for partial refreshes. Every EPD_FULL_REFRESH times a full update should be done */
 uint8_t partial_refresh_counter = 0;
 
 /** Months as char arrays */
 char *months_txt[] = {(char *)"Jan", (char *)"Feb", (char *)"Mar", (char *)"Apr", (char *)"May", (char *)"Jun", (char *)"Jul", (char *)"Aug", (char *)"Sep", (char *)"Oct", (char *)"Nov", (char *)"Dec"};
 
-// For text length calculations
-int16_t txt_x1;
-int16_t txt_y1;
-uint16_t txt_w;
-uint16_t txt_w2;
-uint16_t txt_h;
-
-// For text and image placements
-uint16_t x_text;
-uint16_t y_text;
-uint16_t s_text;
-uint16_t w_text;
-uint16_t h_text;
-uint16_t x_graph;
-uint16_t y_graph;
-uint16_t h_bar;
-uint16_t w_bar;
-float bar_divider;
-uint16_t spacer;
+/** Width of the static unit texts in the small font, measured once */
+typedef struct unit_width_s
+{
+	uint16_t ppm;
+	uint16_t celsius;
+	uint16_t humid;
+	uint16_t mbar;
+} unit_width_t;
+static unit_width_t unit_width = {0, 0, 0, 0};
 
 // Forward declaration
 void rak14000_text(int16_t x, int16_t y, char *text, uint16_t text_color, uint32_t text_size);
@@ -209,15 +199,33 @@ void clear_rak14000(void)
 	// SE0352.fillScreen(bg_color);
 }
 
+/**
+ * @brief Measure the static unit texts once
+ *
+ */
+static void measure_units(void)
+{
+	unit_width.ppm = SE0352.strWidth((char *)"ppm", SMALL_FONT);
+	unit_width.celsius = SE0352.strWidth((char *)"~C", SMALL_FONT);
+	unit_width.humid = SE0352.strWidth((char *)"%RH", SMALL_FONT);
+	unit_width.mbar = SE0352.strWidth((char *)"mBar", SMALL_FONT);
+}
+
 /**
  * @brief Update screen content
  *
  */
 void refresh_rak14000(void)
 {
+	if (unit_width.ppm == 0)
+	{
+		measure_units();
+	}
+
 	if (partial_refresh_counter == 0)
 	{ // Clear display buffer
 		clear_rak14000();
+		epd_tiles_invalidate();
 	}
 
 	voc_rak14000();
@@ -228,7 +236,9 @@ void refresh_rak14000(void)
 
 	if (found_sensors[RTC_ID].found_sensor)
 	{
+		i2c_lock();
 		read_rak12002();
+		i2c_unlock();
 
 		if ((found_sensors[PM_ID].found_sensor) || (found_sensors[CO2_ID].found_sensor))
 		{
@@ -257,8 +267,11 @@ void refresh_rak14000(void)
 		}
 	}
 
-	txt_w = SE0352.strWidth(disp_text, SMALL_FONT);
-	rak14000_text((DEPG_HP.width / 2) - (txt_w / 2), 10, disp_text, (uint16_t)txt_color, 1);
+	// The header is not partial refreshed, only draw it for a full refresh
+	if (partial_refresh_counter == 0)
+	{
+		rak14000_text((DEPG_HP.width / 2) - (SE0352.strWidth(disp_text, SMALL_FONT) / 2), 10, disp_text, (uint16_t)txt_color, 1);
+	}
 
 	if (found_sensors[PM_ID].found_sensor)
 	{
@@ -282,10 +295,11 @@ void refresh_rak14000(void)
 		SE0352.refresh();
 		delay(100);
 	}
+	MYLOG("EPD", "Changed tiles %02X", epd_dirty_tiles());
 
 	partial_refresh_counter += 1;
 
-	if (partial_refresh_counter == 20)
+	if (partial_refresh_counter == EPD_FULL_REFRESH)
 	{
 		MYLOG("EPD", "Force full refresh on next loop");
 		partial_refresh_counter = 0;
@@ -456,14 +470,26 @@ void set_pm_rak14000(uint16_t pm10_env, uint16_t pm25_env, uint16_t pm100_env)
  */
 void voc_rak14000(void)
 {
-	x_text = 2;
-	y_text = 10;
-	s_text = 2;
-	x_graph = 0;
-	y_graph = 60;
-	h_bar = DEPG_HP.height / 2 - 60;
-	w_bar = 2;
-	bar_divider = 500.0 / h_bar;
+	uint16_t x_text = 2;
+	uint16_t y_text = 10;
+	uint16_t s_text = 2;
+	uint16_t w_text = 0;
+	uint16_t x_graph = 0;
+	uint16_t y_graph = 60;
+	uint16_t h_bar = DEPG_HP.height / 2 - 60;
+	uint16_t w_bar = 2;
+	float bar_divider = 500.0 / h_bar;
+
+	// Skip the tile if the value and the bar heights as shown did not change
+	uint32_t key = epd_key(EPD_KEY_INIT, voc_valid ? voc_values[voc_idx - 1] : -1);
+	for (int idx = 0; idx < num_values; idx++)
+	{
+		key = epd_key(key, (int32_t)(voc_values[idx] / bar_divider));
+	}
+	if (!epd_tile_changed(EPD_TILE_VOC, key))
+	{
+		return;
+	}
 
 	// Write value
 	SE0352.drawBitmap(32, 32, x_text, y_text, frame, (uint8_t *)voc_img, scr_orientation);
@@ -541,19 +567,26 @@ void voc_rak14000(void)
  */
 void co2_rak14000(bool has_pm)
 {
+	uint16_t x_text;
+	uint16_t y_text;
+	uint16_t s_text;
+	uint16_t txt_w;
+
 	if (has_pm)
 	{
 		x_text = DEPG_HP.width / 2 + 53;
 		y_text = 15;
 		s_text = 2;
-		spacer = 20;
+		uint16_t spacer = 20;
+
+		if (!epd_tile_changed(EPD_TILE_CO2, epd_key(EPD_KEY_INIT, lroundf(co2_values[co2_idx - 1]))))
+		{
+			return;
+		}
 
 		// Write value
 		SE0352.drawBitmap(32, 32, x_text, y_text, 0, 0, 0, frame, (uint8_t *)co2_img, scr_orientation);
-		snprintf(disp_text, 29, "ppm");
-		txt_w = SE0352.strWidth(disp_text, SMALL_FONT);
-
-		rak14000_text(DEPG_HP.width - txt_w - 1, y_text + spacer + 4, disp_text, (uint16_t)txt_color, 1);
+		rak14000_text(DEPG_HP.width - unit_width.ppm - 1, y_text + spacer + 4, (char *)"ppm", (uint16_t)txt_color, 1);
 
 		if (co2_values[co2_idx - 1] > 1500)
 		{
@@ -570,7 +603,7 @@ void co2_rak14000(bool has_pm)
 
 		txt_w = SE0352.strWidth(disp_text, SMALL_FONT);
 
-		rak14000_text(DEPG_HP.width - txt_w - txt_w2 - 4, y_text, disp_text, (uint16_t)txt_color, s_text);
+		rak14000_text(DEPG_HP.width - txt_w - 4, y_text, disp_text, (uint16_t)txt_color, s_text);
 
 		// For partial update only
 		if (partial_refresh_counter != 0)
@@ -585,11 +618,11 @@ void co2_rak14000(bool has_pm)
 		x_text = 2;
 		y_text = DEPG_HP.height / 2;
 		s_text = 2;
-		x_graph = 0;
-		y_graph = DEPG_HP.height / 2 + 60;
-		h_bar = DEPG_HP.height / 2 - 62;
-		w_bar = 2;
-		bar_divider = 2500 / h_bar;
+		uint16_t w_text = 0;
+		uint16_t x_graph = 0;
+		uint16_t y_graph = DEPG_HP.height / 2 + 60;
+		uint16_t h_bar = DEPG_HP.height / 2 - 62;
+		uint16_t w_bar = 2;
 
 		// Get min and max values => maybe adjust graph to the min and max values
 		int fmin = 2500;
@@ -615,10 +648,22 @@ void co2_rak14000(bool has_pm)
 		}
 		// make it an even number
 		fmax = ((fmax / 100) + 1) * 100;
-		bar_divider = fmax / h_bar;
+		float bar_divider = fmax / h_bar;
 
 		MYLOG("EPD", "CO2 min %d max %d", fmin, fmax);
 
+		// Skip the tile if the value, the scale and the bar heights as shown did not change
+		uint32_t key = epd_key(EPD_KEY_INIT, lroundf(co2_values[co2_idx - 1]));
+		key = epd_key(key, fmax);
+		for (int idx = 0; idx < num_values; idx++)
+		{
+			key = epd_key(key, (co2_values[idx] != 0.0) ? (int32_t)(co2_values[idx] / bar_divider) : -1);
+		}
+		if (!epd_tile_changed(EPD_TILE_CO2, key))
+		{
+			return;
+		}
+
 		// Write value
 		SE0352.drawBitmap(32, 32, x_text, y_text, 0, 0, 0, frame, (uint8_t *)co2_img, scr_orientation);
 
@@ -696,9 +741,18 @@ void co2_rak14000(bool has_pm)
  */
 void pm_rak14000(void)
 {
-	x_text = DEPG_HP.width / 2 + 53;
-	y_text = DEPG_HP.height / 4;
-	s_text = 2;
+	uint16_t x_text = DEPG_HP.width / 2 + 53;
+	uint16_t y_text = DEPG_HP.height / 4;
+	uint16_t s_text = 2;
+	uint16_t txt_w;
+
+	uint32_t key = epd_key(EPD_KEY_INIT, pm10_values[pm_idx - 1]);
+	key = epd_key(key, pm25_values[pm_idx - 1]);
+	key = epd_key(key, pm100_values[pm_idx - 1]);
+	if (!epd_tile_changed(EPD_TILE_PM, key))
+	{
+		return;
+	}
 
 	// Write value
 	SE0352.drawBitmap(32, 32, x_text, y_text, 0, 0, 0, frame, (uint8_t *)pm_img, scr_orientation);
@@ -786,10 +840,18 @@ void pm_rak14000(void)
  */
 void temp_rak14000(bool has_pm)
 {
-	x_text = 25;
-	y_text = DEPG_HP.height / 2 + 10;
-	s_text = 2;
-	spacer = 60;
+	uint16_t x_text = 25;
+	uint16_t y_text = DEPG_HP.height / 2 + 10;
+	uint16_t s_text = 2;
+	uint16_t spacer = 60;
+	uint16_t txt_w;
+	uint16_t txt_w2;
+
+	// Temperature is shown with 2 digits
+	if (!epd_tile_changed(EPD_TILE_TEMP, epd_key(EPD_KEY_INIT, lroundf(temp_values[temp_idx - 1] * 100))))
+	{
+		return;
+	}
 
 	// If PM sensor is not available, position is different
 	if (!has_pm)
@@ -803,7 +865,7 @@ void temp_rak14000(bool has_pm)
 		SE0352.drawBitmap(32, 32, DEPG_HP.width - (DEPG_HP.width / 4 - 16), y_text, 0, 0, 0, frame, (uint8_t *)celsius_img, scr_orientation);
 
 		snprintf(disp_text, 29, "~C");
-		txt_w2 = SE0352.strWidth(disp_text, SMALL_FONT);
+		txt_w2 = unit_width.celsius;
 
 		rak14000_text(DEPG_HP.width - txt_w2 - 3, y_text + spacer, disp_text, (uint16_t)txt_color, 1);
 
@@ -859,6 +921,14 @@ void humid_rak14000(bool has_pm)
 	uint16_t y_text = DEPG_HP.height / 2 + (DEPG_HP.height / 2 / 3) + 10;
 	uint16_t s_text = 2;
 	uint16_t spacer = 60;
+	uint16_t txt_w;
+	uint16_t txt_w2;
+
+	// Humidity is shown with 2 digits
+	if (!epd_tile_changed(EPD_TILE_HUMID, epd_key(EPD_KEY_INIT, lroundf(humid_values[humid_idx - 1] * 100))))
+	{
+		return;
+	}
 
 	// If PM sensor is not available, position is different
 	if (!has_pm)
@@ -872,7 +942,7 @@ void humid_rak14000(bool has_pm)
 		SE0352.drawBitmap(32, 32, DEPG_HP.width - (DEPG_HP.width / 4 - 16), y_text, 0, 0, 0, frame, (uint8_t *)humidity_img, scr_orientation);
 
 		snprintf(disp_text, 29, "%%RH");
-		txt_w2 = SE0352.strWidth(disp_text, SMALL_FONT);
+		txt_w2 = unit_width.humid;
 
 		rak14000_text(DEPG_HP.width - txt_w2 - 3, y_text + spacer, disp_text, (uint16_t)txt_color, 1);
 
@@ -906,7 +976,7 @@ void humid_rak14000(bool has_pm)
 		// For partial update only
 		if (partial_refresh_counter != 0)
 		{
-			SE0352.clearRect(252, 207, DEPG_HP.width  - txt_w2 - 4, 223, scr_orientation, frame);
+			SE0352.clearRect(252, 207, DEPG_HP.width - 4, 223, scr_orientation, frame);
 		}
 
 		rak14000_text(x_text + spacer, y_text + 16, disp_text, (uint16_t)txt_color, s_text);
@@ -930,10 +1000,18 @@ void humid_rak14000(bool has_pm)
  */
 void baro_rak14000(bool has_pm)
 {
-	x_text = 25;
-	y_text = DEPG_HP.height / 2 + (DEPG_HP.height / 2 / 3 * 2) + 10;
-	s_text = 2;
-	spacer = 60;
+	uint16_t x_text = 25;
+	uint16_t y_text = DEPG_HP.height / 2 + (DEPG_HP.height / 2 / 3 * 2) + 10;
+	uint16_t s_text = 2;
+	uint16_t spacer = 60;
+	uint16_t txt_w;
+	uint16_t txt_w2;
+
+	// Barometric pressure is shown with 2 digits, without PM sensor with 1 digit
+	if (!epd_tile_changed(EPD_TILE_BARO, epd_key(EPD_KEY_INIT, lroundf(baro_values[baro_idx - 1] * (has_pm ? 100 : 10)))))
+	{
+		return;
+	}
 
 	// If PM sensor is not available, position is different
 	if (!has_pm)
@@ -947,7 +1025,7 @@ void baro_rak14000(bool has_pm)
 		SE0352.drawBitmap(32, 32, DEPG_HP.width - (DEPG_HP.width / 4 - 16), y_text, 0, 0, 0, frame, (uint8_t *)barometer_img, scr_orientation);
 
 		snprintf(disp_text, 29, "mBar");
-		txt_w2 = SE0352.strWidth(disp_text, SMALL_FONT);
+		txt_w2 = unit_width.mbar;
 
 		// For partial update only
 		if (partial_refresh_counter != 0)
@@ -1010,6 +1088,8 @@ void epd_task(void *pvParameters)
 	epd_task_id = osThreadGetId();
 #endif
 
+	uint16_t txt_w;
+
 	scr_orientation = 0;
 	memset(frame, PIC_WHITE, 10800);
 	SE0352.fillScreen(PIC_WHITE);
@@ -40,7 +40,10 @@ typedef struct DEPG
 
 // DEPG  DEPG_HP = {250,122};  //use 2.13" DEPG0213RWS800F41HP as default B/W/R
 // DEPG  DEPG_HP = {212,104};  //  this is for 2.13" DEPG0213BNS800F42HP B/W
-DEPG DEPG_HP = {400, 300}; //  this is for 4.2" DEPG0420BNS19AF4 B/W
+/** Display size, the layouts are calculated from it */
+#define DISP_W 400
+#define DISP_H 300
+DEPG DEPG_HP = {DISP_W, DISP_H}; //  this is for 4.2" DEPG0420BNS19AF4 B/W
 
 // 4.2" EPD with SSD1683
 Adafruit_SSD1681 display(DEPG_HP.height, DEPG_HP.width, EPD_MOSI,
@@ -97,25 +100,102 @@ void epd_task(void);
 // Forward declaration
 void rak14000_text(int16_t x, int16_t y, char *text, uint16_t text_color, uint32_t text_size);
 
-// For text length calculations
-int16_t txt_x1;
-int16_t txt_y1;
-uint16_t txt_w;
-uint16_t txt_w2;
-uint16_t txt_h;
-
-// For text and image placements
-uint16_t x_text;
-uint16_t y_text;
-uint16_t s_text;
-uint16_t w_text;
-uint16_t h_text;
-uint16_t x_graph;
-uint16_t y_graph;
-uint16_t h_bar;
-uint16_t w_bar;
-float bar_divider;
-uint16_t spacer;
+/** Split of the screen between the left and the right tiles */
+#define SPLIT_X (DISP_W / 2 + 50)
+/** Split of the screen between the upper and the lower tiles with PM sensor */
+#define SPLIT_Y (DISP_H / 2 + 3)
+/** Left edge of the icons in the right column */
+#define RIGHT_ICON (DISP_W - (DISP_W / 4 - 16))
+
+/** Layout of a bar graph */
+typedef struct graph_layout_s
+{
+	int16_t x;		 // Left edge of the bars
+	int16_t y;		 // Top of the bars
+	int16_t h;		 // Height of the bars
+	int16_t w;		 // Width of one bar
+	int16_t x_scale; // Vertical line of the scale
+} graph_layout_t;
+
+/** Screen layout, the position of the tiles depends on the PM sensor */
+typedef struct screen_layout_s
+{
+	int16_t area[EPD_NUM_TILES][4]; // x1, y1, x2, y2 of the tiles
+	int16_t icon[EPD_NUM_TILES][2]; // x, y of the tile icons
+	int16_t spacer;					// Distance of the values from the icon
+	graph_layout_t voc;
+	graph_layout_t co2; // Only shown without PM sensor
+	float voc_divider;	// VOC index per pixel of the bars
+} screen_layout_t;
+
+/** Layout with PM sensor, temperature, humidity and barometer are stacked below the VOC graph */
+static constexpr screen_layout_t layout_pm = {
+	{{0, 0, DISP_W, 12},
+	 {0, 10, SPLIT_X, SPLIT_Y},
+	 {SPLIT_X, 10, DISP_W, DISP_H / 5},
+	 {0, SPLIT_Y, SPLIT_X, SPLIT_Y + (DISP_H - SPLIT_Y) / 3},
+	 {0, SPLIT_Y + (DISP_H - SPLIT_Y) / 3, SPLIT_X, SPLIT_Y + (DISP_H - SPLIT_Y) * 2 / 3},
+	 {0, SPLIT_Y + (DISP_H - SPLIT_Y) * 2 / 3, SPLIT_X, DISP_H},
+	 {SPLIT_X, DISP_H / 5, DISP_W, DISP_H}},
+	{{0, 0},
+	 {2, 10},
+	 {DISP_W / 2 + 53, 15},
+	 {25, DISP_H / 2 + 10},
+	 {25, DISP_H / 2 + (DISP_H / 2 / 3) + 10},
+	 {25, DISP_H / 2 + (DISP_H / 2 / 3 * 2) + 10},
+	 {DISP_W / 2 + 53, DISP_H / 4}},
+	60,
+	{0, 60, DISP_H / 2 - 60, 2, DISP_W / 2 + 10},
+	{0, 0, 0, 0, 0},
+	500.0 / (DISP_H / 2 - 60)};
+
+/** Layout without PM sensor, temperature, humidity and barometer are stacked in the right column */
+static constexpr screen_layout_t layout_no_pm = {
+	{{0, 0, DISP_W, 12},
+	 {0, 10, SPLIT_X, SPLIT_Y},
+	 {0, DISP_H / 2, SPLIT_X, DISP_H},
+	 {SPLIT_X, 0, DISP_W, DISP_H / 3},
+	 {SPLIT_X, DISP_H / 3, DISP_W, DISP_H / 3 * 2},
+	 {SPLIT_X, DISP_H / 3 * 2, DISP_W, DISP_H},
+	 {0, 0, 0, 0}},
+	{{0, 0},
+	 {2, 10},
+	 {2, DISP_H / 2},
+	 {RIGHT_ICON, 12},
+	 {RIGHT_ICON, DISP_H / 3 + 15},
+	 {RIGHT_ICON, DISP_H / 3 * 2 + 15},
+	 {0, 0}},
+	50,
+	{0, 60, DISP_H / 2 - 60, 2, DISP_W / 2 + 10},
+	{0, DISP_H / 2 + 60, DISP_H / 2 - 62, 2, DISP_W / 2 + 10},
+	500.0 / (DISP_H / 2 - 60)};
+
+/** Width of the static unit texts in the small font, measured once */
+typedef struct unit_width_s
+{
+	uint16_t ppm;
+	uint16_t celsius;
+	uint16_t humid;
+	uint16_t mbar;
+} unit_width_t;
+static unit_width_t unit_width = {0, 0, 0, 0};
+
+/** Font that is selected in the display driver */
+static const GFXfont *current_font = NULL;
+
+/**
+ * @brief Select a font, skipped if it is already selected
+ *
+ * @param font font to use
+ */
+static void set_font(const GFXfont *font)
+{
+	if (font != current_font)
+	{
+		display.setFont(font);
+		current_font = font;
+	}
+}
 
 /**
  * @brief Initialization of RAK14000 EPD
@@ -178,12 +258,12 @@ void rak14000_text(int16_t x, int16_t y, char *text, uint16_t text_color, uint32
 {
 	if (text_size == 1)
 	{
-		display.setFont(SMALL_FONT); // Font_5x7_practical8pt7b
+		set_font(SMALL_FONT); // Font_5x7_practical8pt7b
 		y = y + 7;
 	}
 	else
 	{
-		display.setFont(LARGE_FONT);
+		set_font(LARGE_FONT);
 		y = y + 12;
 	}
 	display.setCursor(x, y);
@@ -206,28 +286,93 @@ void clear_rak14000(void)
 /** Flag for first screen update */
 bool first_time = true;
 
+/** Counter for partial refreshes. Every EPD_FULL_REFRESH times a full update is done */
+uint8_t partial_refresh_counter = 0;
+
 char *months_txt[] = {(char *)"Jan", (char *)"Feb", (char *)"Mar", (char *)"Apr", (char *)"May", (char *)"Jun", (char *)"Jul", (char *)"Aug", (char *)"Sep", (char *)"Oct", (char *)"Nov", (char *)"Dec"};
 
+/**
+ * @brief Get the screen layout
+ *
+ * @param has_pm true if the PM sensor is available
+ * @return const screen_layout_t* layout of the tiles
+ */
+static const screen_layout_t *get_layout(bool has_pm)
+{
+	return has_pm ? &layout_pm : &layout_no_pm;
+}
+
+/**
+ * @brief Get the width of a text
+ *
+ * @param text text to measure
+ * @param font font of the text
+ * @return uint16_t width in pixels
+ */
+static uint16_t text_width(const char *text, const GFXfont *font)
+{
+	int16_t x1;
+	int16_t y1;
+	uint16_t w;
+	uint16_t h;
+
+	set_font(font);
+	display.setTextSize(1);
+	display.getTextBounds(text, 0, 0, &x1, &y1, &w, &h);
+	return w;
+}
+
+/**
+ * @brief Measure the static unit texts once
+ *
+ */
+static void measure_units(void)
+{
+	unit_width.ppm = text_width("ppm", SMALL_FONT);
+	unit_width.celsius = text_width("~C", SMALL_FONT);
+	unit_width.humid = text_width("%RH", SMALL_FONT);
+	unit_width.mbar = text_width("mBar", SMALL_FONT);
+}
+
 /**
  * @brief Update screen content
+ *     The buffer is always drawn complete, the tiles overlap by a few pixels.
+ *     Only the area of the tiles that changed is sent to the display with
+ *     a partial refresh. The header changes with every new minute of the
+ *     clock, it gets its own partial refresh so the area of the sensor
+ *     tiles does not grow to the full width and the top of the display.
+ *     Every EPD_FULL_REFRESH updates a full refresh removes the ghosting.
  *
  */
 void refresh_rak14000(void)
 {
+	bool has_pm = found_sensors[PM_ID].found_sensor;
+	const screen_layout_t *layout = get_layout(has_pm);
+
+	if (unit_width.ppm == 0)
+	{
+		measure_units();
+	}
+
+	if (partial_refresh_counter == 0)
+	{
+		epd_tiles_invalidate();
+	}
+
 	// Clear display buffer
 	clear_rak14000();
 
 	voc_rak14000();
-	co2_rak14000(found_sensors[PM_ID].found_sensor);
-	temp_rak14000(found_sensors[PM_ID].found_sensor);
-	humid_rak14000(found_sensors[PM_ID].found_sensor);
-	baro_rak14000(found_sensors[PM_ID].found_sensor);
+	co2_rak14000(has_pm);
+	temp_rak14000(has_pm);
+	humid_rak14000(has_pm);
+	baro_rak14000(has_pm);
 
-	display.setFont(SMALL_FONT);
-	display.setTextSize(1);
 	if (found_sensors[RTC_ID].found_sensor)
 	{
+		i2c_lock();
 		read_rak12002();
+		i2c_unlock();
 
 		if ((found_sensors[PM_ID].found_sensor) || (found_sensors[CO2_ID].found_sensor))
 		{
@@ -256,32 +401,78 @@ void refresh_rak14000(void)
 		}
 	}
 
-	display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text((DEPG_HP.width / 2) - (txt_w / 2), 1, disp_text, (uint16_t)txt_color, 1);
+	uint32_t key = EPD_KEY_INIT;
+	for (char *pos = disp_text; *pos != 0; pos++)
+	{
+		key = epd_key(key, *pos);
+	}
+	epd_tile_changed(EPD_TILE_HEADER, key);
+
+	rak14000_text((DISP_W / 2) - (text_width(disp_text, SMALL_FONT) / 2), 1, disp_text, (uint16_t)txt_color, 1);
 
-	if (found_sensors[PM_ID].found_sensor)
+	if (has_pm)
 	{
 		pm_rak14000();
-		display.drawLine(0, DEPG_HP.height / 2 + 3, DEPG_HP.width / 2 + 50, DEPG_HP.height / 2 + 3, (uint16_t)txt_color);
-		display.drawLine(DEPG_HP.width / 2 + 50, DEPG_HP.height / 5, DEPG_HP.width, DEPG_HP.height / 5, (uint16_t)txt_color);
-		display.drawLine(DEPG_HP.width / 2 + 50, 10, DEPG_HP.width / 2 + 50, DEPG_HP.height, (uint16_t)txt_color);
+		display.drawLine(0, SPLIT_Y, SPLIT_X, SPLIT_Y, (uint16_t)txt_color);
+		display.drawLine(SPLIT_X, DISP_H / 5, DISP_W, DISP_H / 5, (uint16_t)txt_color);
+		display.drawLine(SPLIT_X, 10, SPLIT_X, DISP_H, (uint16_t)txt_color);
 	}
 	else
 	{
-		display.drawLine(DEPG_HP.width / 2 + 50, 10, DEPG_HP.width / 2 + 50, DEPG_HP.height, (uint16_t)txt_color);
-		display.drawLine(DEPG_HP.width / 2 + 50, DEPG_HP.height / 3, DEPG_HP.width, DEPG_HP.height / 3, (uint16_t)txt_color);
-		display.drawLine(DEPG_HP.width / 2 + 50, DEPG_HP.height / 3 * 2, DEPG_HP.width, DEPG_HP.height / 3 * 2, (uint16_t)txt_color);
+		display.drawLine(SPLIT_X, 10, SPLIT_X, DISP_H, (uint16_t)txt_color);
+		display.drawLine(SPLIT_X, DISP_H / 3, DISP_W, DISP_H / 3, (uint16_t)txt_color);
+		display.drawLine(SPLIT_X, DISP_H / 3 * 2, DISP_W, DISP_H / 3 * 2, (uint16_t)txt_color);
+	}
+
+	uint8_t dirty = epd_dirty_tiles();
+	if (partial_refresh_counter == 0)
+	{
+		delay(100);
+		display.display();
+		delay(100);
+	}
+	else if (dirty != 0)
+	{
+		if ((dirty & (1 << EPD_TILE_HEADER)) != 0)
+		{
+			// Header line on its own, it is thin but spans the full width
+			const int16_t *header = layout->area[EPD_TILE_HEADER];
+			MYLOG("EPD", "Header updating x1 %d y1 %d x2 %d y2 %d", header[0], header[1], header[2], header[3]);
+			display.displayPartial(header[0], header[1], header[2], header[3]);
+			dirty &= ~(1 << EPD_TILE_HEADER);
+		}
+		if (dirty != 0)
+		{
+			// One partial refresh over all changed sensor tiles
+			int16_t update[4] = {DISP_W, DISP_H, 0, 0};
+			for (uint8_t tile = 0; tile < EPD_NUM_TILES; tile++)
+			{
+				if ((dirty & (1 << tile)) != 0)
+				{
+					update[0] = min(update[0], layout->area[tile][0]);
+					update[1] = min(update[1], layout->area[tile][1]);
+					update[2] = max(update[2], layout->area[tile][2]);
+					update[3] = max(update[3], layout->area[tile][3]);
+				}
+			}
+			MYLOG("EPD", "Tiles %02X Updating x1 %d y1 %d x2 %d y2 %d", dirty, update[0], update[1], update[2], update[3]);
+			display.displayPartial(update[0], update[1], update[2], update[3]);
+		}
+	}
+	else
+	{
+		MYLOG("EPD", "No visible change, skip refresh");
+		// Partial refreshes without change do not add ghosting
+		return;
+	}
+
+	partial_refresh_counter += 1;
+
+	if (partial_refresh_counter == EPD_FULL_REFRESH)
+	{
+		MYLOG("EPD", "Force full refresh on next loop");
+		partial_refresh_counter = 0;
 	}
-	// For partial update only
-	// if (first_time)
-	// {
-	// 	first_time = false;
-	// 	display.display(true);
-	// }
-	// return;
-	delay(100);
-	display.display();
-	delay(100);
 }
 
 /**
@@ -443,21 +634,24 @@ void set_pm_rak14000(uint16_t pm10_env, uint16_t pm25_env, uint16_t pm100_env)
 /**
  * @brief Update display for VOC values
  *
- * @param full unused
  */
 void voc_rak14000(void)
 {
-	x_text = 2;
-	y_text = 10;
-	s_text = 2;
-	x_graph = 0;
-	y_graph = 60;
-	h_bar = DEPG_HP.height / 2 - 60;
-	w_bar = 2;
-	bar_divider = 500.0 / h_bar;
+	const int16_t x_img = layout_pm.icon[EPD_TILE_VOC][0];
+	const int16_t y_img = layout_pm.icon[EPD_TILE_VOC][1];
+	const graph_layout_t *graph = &layout_pm.voc;
+	const float bar_divider = layout_pm.voc_divider;
+
+	// Track the value and the bar heights as shown
+	uint32_t key = epd_key(EPD_KEY_INIT, voc_valid ? voc_values[voc_idx - 1] : -1);
+	for (int idx = 0; idx < num_values; idx++)
+	{
+		key = epd_key(key, (int32_t)(voc_values[idx] / bar_divider));
+	}
+	epd_tile_changed(EPD_TILE_VOC, key);
 
 	// Write value
-	display.drawBitmap(x_text, y_text, voc_img, 32, 32, txt_color);
+	display.drawBitmap(x_img, y_img, voc_img, 32, 32, txt_color);
 
 	if (!voc_valid)
 	{
@@ -478,54 +672,47 @@ void voc_rak14000(void)
 			snprintf(disp_text, 29, "VOC %d", voc_values[voc_idx - 1]);
 		}
 	}
-	rak14000_text(x_text + 40, y_text + 20, disp_text, txt_color, s_text);
+	rak14000_text(x_img + 40, y_img + 20, disp_text, txt_color, 2);
 
-	rak14000_text(DEPG_HP.width / 2 + 15, y_graph + h_bar - 7, (char *)"0", txt_color, 1);
-	rak14000_text(DEPG_HP.width / 2 + 15, y_graph - 7, (char *)"500", txt_color, 1);
+	rak14000_text(graph->x_scale + 5, graph->y + graph->h - 7, (char *)"0", txt_color, 1);
+	rak14000_text(graph->x_scale + 5, graph->y - 7, (char *)"500", txt_color, 1);
 
-	display.drawLine(DEPG_HP.width / 2 + 10, y_graph + h_bar, DEPG_HP.width / 2 + 10, y_graph, (uint16_t)txt_color);
-	display.drawLine(DEPG_HP.width / 2 + 5, y_graph + h_bar, DEPG_HP.width / 2 + 10, y_graph + h_bar, (uint16_t)txt_color);
-	display.drawLine(DEPG_HP.width / 2 + 5, y_graph, DEPG_HP.width / 2 + 10, y_graph, (uint16_t)txt_color);
+	display.drawLine(graph->x_scale, graph->y + graph->h, graph->x_scale, graph->y, (uint16_t)txt_color);
+	display.drawLine(graph->x_scale - 5, graph->y + graph->h, graph->x_scale, graph->y + graph->h, (uint16_t)txt_color);
+	display.drawLine(graph->x_scale - 5, graph->y, graph->x_scale, graph->y, (uint16_t)txt_color);
 
 	// Draw VOC values
 	for (int idx = 0; idx < num_values; idx++)
 	{
-		display.drawLine((int16_t)(x_graph + (idx * w_bar)),
-						 (int16_t)(y_graph + ((h_bar) - (voc_values[idx] / bar_divider))),
-						 (int16_t)(x_graph + (idx * w_bar)),
-						 (int16_t)(y_graph + h_bar),
+		display.drawLine((int16_t)(graph->x + (idx * graph->w)),
+						 (int16_t)(graph->y + ((graph->h) - (voc_values[idx] / bar_divider))),
+						 (int16_t)(graph->x + (idx * graph->w)),
+						 (int16_t)(graph->y + graph->h),
 						 txt_color);
 	}
-	display.drawLine(x_graph, y_graph + h_bar, x_graph + DEPG_HP.width / 2, y_graph + h_bar, (uint16_t)txt_color);
-
-	// For partial update only
-	// MYLOG("EPD", "Updating x1 %d y1 %d x2 %d y2 %d", x_text, y_text, x_text + w_text, y_text + h_text);
-	// display.displayPartial(x_text, y_text, x_text + w_text, y_text + h_text);
+	display.drawLine(graph->x, graph->y + graph->h, graph->x + DISP_W / 2, graph->y + graph->h, (uint16_t)txt_color);
 }
 
 /**
  * @brief Update display for CO2 values
  *
- * @param full unused
+ * @param has_pm true if the PM sensor is available
  */
 void co2_rak14000(bool has_pm)
 {
+	const screen_layout_t *layout = get_layout(has_pm);
+	const int16_t x_img = layout->icon[EPD_TILE_CO2][0];
+	const int16_t y_img = layout->icon[EPD_TILE_CO2][1];
+	uint16_t value_w;
+
 	if (has_pm)
 	{
-		x_text = DEPG_HP.width / 2 + 53;
-		y_text = 15;
-		s_text = 2;
-		spacer = 20;
+		epd_tile_changed(EPD_TILE_CO2, epd_key(EPD_KEY_INIT, lroundf(co2_values[co2_idx - 1])));
 
 		// Write value
-		display.drawBitmap(x_text, y_text, co2_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "ppm");
-		display.setFont(SMALL_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
+		display.drawBitmap(x_img, y_img, co2_img, 32, 32, txt_color);
 
-		rak14000_text(DEPG_HP.width - txt_w - 1, y_text + spacer + 4, disp_text, (uint16_t)txt_color, 1);
+		rak14000_text(DISP_W - unit_width.ppm - 1, y_img + 20 + 4, (char *)"ppm", (uint16_t)txt_color, 1);
 
 		if (co2_values[co2_idx - 1] > 1500)
 		{
@@ -539,23 +726,13 @@ void co2_rak14000(bool has_pm)
 		{
 			snprintf(disp_text, 29, "%.0f", co2_values[co2_idx - 1]);
 		}
+		value_w = text_width(disp_text, LARGE_FONT);
 
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w2, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - txt_w2 - 4, y_text + spacer, disp_text, (uint16_t)txt_color, s_text);
+		rak14000_text(DISP_W - unit_width.ppm - value_w - 4, y_img + 20, disp_text, (uint16_t)txt_color, 2);
 	}
 	else
 	{
-		x_text = 2;
-		y_text = DEPG_HP.height / 2;
-		s_text = 2;
-		x_graph = 0;
-		y_graph = DEPG_HP.height / 2 + 60;
-		h_bar = DEPG_HP.height / 2 - 62;
-		w_bar = 2;
-		bar_divider = 2500 / h_bar;
+		const graph_layout_t *graph = &layout->co2;
 
 		// Get min and max values => maybe adjust graph to the min and max values
 		int fmin = 2500;
@@ -581,12 +758,21 @@ void co2_rak14000(bool has_pm)
 		}
 		// make it an even number
 		fmax = ((fmax / 100) + 1) * 100;
-		bar_divider = fmax / h_bar;
+		float bar_divider = fmax / graph->h;
 
 		MYLOG("EPD", "CO2 min %d max %d", fmin, fmax);
 
+		// Track the value, the scale and the bar heights as shown
+		uint32_t key = epd_key(EPD_KEY_INIT, lroundf(co2_values[co2_idx - 1]));
+		key = epd_key(key, fmax);
+		for (int idx = 0; idx < num_values; idx++)
+		{
+			key = epd_key(key, (co2_values[idx] >= 200.0) ? (int32_t)((co2_values[idx] - 200) / bar_divider) : -1);
+		}
+		epd_tile_changed(EPD_TILE_CO2, key);
+
 		// Write value
-		display.drawBitmap(x_text, y_text, co2_img, 32, 32, txt_color);
+		display.drawBitmap(x_img, y_img, co2_img, 32, 32, txt_color);
 
 		if (co2_values[co2_idx - 1] > 1500)
 		{
@@ -600,62 +786,55 @@ void co2_rak14000(bool has_pm)
 		{
 			snprintf(disp_text, 29, "%.0f", co2_values[co2_idx - 1]);
 		}
-		rak14000_text(x_text + 40, y_text + 20, disp_text, txt_color, s_text);
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w2, &txt_h);
+		rak14000_text(x_img + 40, y_img + 20, disp_text, txt_color, 2);
+		value_w = text_width(disp_text, LARGE_FONT);
 
-		rak14000_text(x_text + 40 + txt_w2 + 3, y_text + 24, (char *)"ppm", txt_color, 1);
+		rak14000_text(x_img + 40 + value_w + 3, y_img + 24, (char *)"ppm", txt_color, 1);
 
 		sprintf(disp_text, "%d", fmax);
-		rak14000_text(DEPG_HP.width / 2 + 15, y_graph + h_bar - 17, (char *)"200", txt_color, 1);
-		rak14000_text(DEPG_HP.width / 2 + 15, y_graph + h_bar - 7, (char *)"ppm", txt_color, 1);
-		// rak14000_text(DEPG_HP.width / 2 + 15, y_graph + h_bar - 7, (char *)"0ppm", txt_color, 1);
-		rak14000_text(DEPG_HP.width / 2 + 15, y_graph - 7, disp_text, txt_color, 1);
-		rak14000_text(DEPG_HP.width / 2 + 15, y_graph + 3, (char *)"ppm", txt_color, 1);
+		rak14000_text(graph->x_scale + 5, graph->y + graph->h - 17, (char *)"200", txt_color, 1);
+		rak14000_text(graph->x_scale + 5, graph->y + graph->h - 7, (char *)"ppm", txt_color, 1);
+		rak14000_text(graph->x_scale + 5, graph->y - 7, disp_text, txt_color, 1);
+		rak14000_text(graph->x_scale + 5, graph->y + 3, (char *)"ppm", txt_color, 1);
 
-		display.drawLine(DEPG_HP.width / 2 + 10, y_graph + h_bar, DEPG_HP.width / 2 + 10, y_graph, (uint16_t)txt_color);
-		display.drawLine(DEPG_HP.width / 2 + 5, y_graph + h_bar, DEPG_HP.width / 2 + 10, y_graph + h_bar, (uint16_t)txt_color);
-		display.drawLine(DEPG_HP.width / 2 + 5, y_graph, DEPG_HP.width / 2 + 10, y_graph, (uint16_t)txt_color);
+		display.drawLine(graph->x_scale, graph->y + graph->h, graph->x_scale, graph->y, (uint16_t)txt_color);
+		display.drawLine(graph->x_scale - 5, graph->y + graph->h, graph->x_scale, graph->y + graph->h, (uint16_t)txt_color);
+		display.drawLine(graph->x_scale - 5, graph->y, graph->x_scale, graph->y, (uint16_t)txt_color);
 
 		// Draw CO2 values
 		for (int idx = 0; idx < num_values; idx++)
 		{
-			// if (co2_values[idx] != 0.0)
 			if (co2_values[idx] >= 200.0)
 			{
-				display.drawLine((int16_t)(x_graph + (idx * w_bar)),
-								//  (int16_t)(y_graph + ((h_bar) - (co2_values[idx] / bar_divider))),
-								 (int16_t)(y_graph + ((h_bar) - ((co2_values[idx] - 200) / bar_divider))),
-								 (int16_t)(x_graph + (idx * w_bar)),
-								 (int16_t)(y_graph + h_bar),
+				display.drawLine((int16_t)(graph->x + (idx * graph->w)),
+								 (int16_t)(graph->y + ((graph->h) - ((co2_values[idx] - 200) / bar_divider))),
+								 (int16_t)(graph->x + (idx * graph->w)),
+								 (int16_t)(graph->y + graph->h),
 								 txt_color);
 			}
 		}
-		display.drawLine(x_graph, y_graph + h_bar, x_graph + DEPG_HP.width / 2, y_graph + h_bar, (uint16_t)txt_color);
-
-		// For partial update only
-		// MYLOG("EPD", "Updating x1 %d y1 %d x2 %d y2 %d", x_text, y_text, x_text + w_text, y_text + h_text);
-		// display.displayPartial(x_text, y_text, x_text + w_text, y_text + h_text);
+		display.drawLine(graph->x, graph->y + graph->h, graph->x + DISP_W / 2, graph->y + graph->h, (uint16_t)txt_color);
 	}
 }
 
 /**
  * @brief Update display with particle matter values
  *
- * @param full unused
  */
 void pm_rak14000(void)
 {
-	x_text = DEPG_HP.width / 2 + 53;
-	y_text = DEPG_HP.height / 4;
-	s_text = 2;
+	const int16_t x_img = layout_pm.icon[EPD_TILE_PM][0];
+	const int16_t y_img = layout_pm.icon[EPD_TILE_PM][1];
+
+	uint32_t key = epd_key(EPD_KEY_INIT, pm10_values[pm_idx - 1]);
+	key = epd_key(key, pm25_values[pm_idx - 1]);
+	key = epd_key(key, pm100_values[pm_idx - 1]);
+	epd_tile_changed(EPD_TILE_PM, key);
 
 	// Write value
-	display.drawBitmap(x_text, y_text, pm_img, 32, 32, txt_color);
+	display.drawBitmap(x_img, y_img, pm_img, 32, 32, txt_color);
 
-	snprintf(disp_text, 29, "PM");
-	rak14000_text(x_text + 40, y_text + 20, disp_text, txt_color, s_text);
+	rak14000_text(x_img + 40, y_img + 20, (char *)"PM", txt_color, 2);
 
 	// PM 1.0 levels
 	if (pm10_values[pm_idx - 1] > 75)
@@ -670,15 +849,12 @@ void pm_rak14000(void)
 	{
 		snprintf(disp_text, 29, "1.0:");
 	}
-	rak14000_text(x_text, y_text + 60, disp_text, txt_color, s_text);
+	rak14000_text(x_img, y_img + 60, disp_text, txt_color, 2);
 
 	snprintf(disp_text, 29, "%d", pm10_values[pm_idx - 1]);
-	display.setFont(LARGE_FONT);
-	display.setTextSize(1);
-	display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text(DEPG_HP.width - txt_w - 45, y_text + 60, disp_text, txt_color, s_text);
+	rak14000_text(DISP_W - text_width(disp_text, LARGE_FONT) - 45, y_img + 60, disp_text, txt_color, 2);
 	snprintf(disp_text, 29, "%cg/m%c", 0x7F, 0x80);
-	rak14000_text(DEPG_HP.width - 38, y_text + 65, disp_text, txt_color, 1);
+	rak14000_text(DISP_W - 38, y_img + 65, disp_text, txt_color, 1);
 
 	// PM 2.5 levels
 	if (pm25_values[pm_idx - 1] > 75)
@@ -693,15 +869,12 @@ void pm_rak14000(void)
 	{
 		snprintf(disp_text, 29, "2.5:");
 	}
-	rak14000_text(x_text, y_text + 120, disp_text, txt_color, s_text);
+	rak14000_text(x_img, y_img + 120, disp_text, txt_color, 2);
 
 	snprintf(disp_text, 29, "%d", pm25_values[pm_idx - 1]);
-	display.setFont(LARGE_FONT);
-	display.setTextSize(1);
-	display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text(DEPG_HP.width - txt_w - 45, y_text + 120, disp_text, txt_color, s_text);
+	rak14000_text(DISP_W - text_width(disp_text, LARGE_FONT) - 45, y_img + 120, disp_text, txt_color, 2);
 	snprintf(disp_text, 29, "%cg/m%c", 0x7F, 0x80);
-	rak14000_text(DEPG_HP.width - 38, y_text + 125, disp_text, txt_color, 1);
+	rak14000_text(DISP_W - 38, y_img + 125, disp_text, txt_color, 1);
 
 	// PM 10 levels
 	if (pm100_values[pm_idx - 1] > 199)
@@ -716,180 +889,87 @@ void pm_rak14000(void)
 	{
 		snprintf(disp_text, 29, "10:");
 	}
-	rak14000_text(x_text, y_text + 180, disp_text, txt_color, s_text);
+	rak14000_text(x_img, y_img + 180, disp_text, txt_color, 2);
 
 	snprintf(disp_text, 29, "%d", pm100_values[pm_idx - 1]);
-	display.setFont(LARGE_FONT);
-	display.setTextSize(1);
-	display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text(DEPG_HP.width - txt_w - 45, y_text + 180, disp_text, txt_color, s_text);
+	rak14000_text(DISP_W - text_width(disp_text, LARGE_FONT) - 45, y_img + 180, disp_text, txt_color, 2);
 	snprintf(disp_text, 29, "%cg/m%c", 0x7F, 0x80);
-	rak14000_text(DEPG_HP.width - 38, y_text + 185, disp_text, txt_color, 1);
+	rak14000_text(DISP_W - 38, y_img + 185, disp_text, txt_color, 1);
 }
 
 /**
- * @brief Update display for temperature values
+ * @brief Draw a tile with icon, value and unit
+ *     With PM sensor the value is right of the icon,
+ *     without PM sensor it is right aligned below the icon
  *
- * @param full unused
+ * @param tile tile number, EPD_TILE_xxx
+ * @param has_pm true if the PM sensor is available
+ * @param img icon of the tile
+ * @param value formatted value
+ * @param unit unit of the value
+ * @param unit_w width of the unit text
  */
-void temp_rak14000(bool has_pm)
+static void value_tile(uint8_t tile, bool has_pm, const unsigned char *img, char *value, char *unit, uint16_t unit_w)
 {
-	x_text = 25;
-	y_text = DEPG_HP.height / 2 + 10;
-	s_text = 2;
-	spacer = 60;
+	const screen_layout_t *layout = get_layout(has_pm);
+	const int16_t x_img = layout->icon[tile][0];
+	const int16_t y_img = layout->icon[tile][1];
+	uint16_t value_w = text_width(value, LARGE_FONT);
+
+	display.drawBitmap(x_img, y_img, img, 32, 32, txt_color);
 
-	// If PM sensor is not available, position is different
 	if (!has_pm)
 	{
-		x_text = DEPG_HP.width / 2 + 53;
-		y_text = 12;
-		s_text = 2;
-		spacer = 50;
-
-		// Write value
-		display.drawBitmap(DEPG_HP.width - (DEPG_HP.width / 4 - 16), y_text, celsius_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "~C");
-		display.setFont(SMALL_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - 3, y_text + spacer + 4, disp_text, (uint16_t)txt_color, 1);
-
-		snprintf(disp_text, 29, "%.2f ", temp_values[temp_idx - 1]);
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w2, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - txt_w2 - 6, y_text + spacer, disp_text, (uint16_t)txt_color, s_text);
+		rak14000_text(DISP_W - unit_w - 3, y_img + layout->spacer + 4, unit, (uint16_t)txt_color, 1);
+		rak14000_text(DISP_W - unit_w - value_w - 6, y_img + layout->spacer, value, (uint16_t)txt_color, 2);
 	}
 	else
 	{
-		// Write value
-		display.drawBitmap(x_text, y_text, celsius_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "%.2f", temp_values[temp_idx - 1]);
-
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
+		rak14000_text(x_img + layout->spacer, y_img + 16, value, (uint16_t)txt_color, 2);
+		rak14000_text(x_img + layout->spacer + value_w + 4, y_img + 16 + 4, unit, (uint16_t)txt_color, 1);
+	}
+}
 
-		rak14000_text(x_text + spacer, y_text + 16, disp_text, (uint16_t)txt_color, s_text);
+/**
+ * @brief Update display for temperature values
+ *
+ * @param has_pm true if the PM sensor is available
+ */
+void temp_rak14000(bool has_pm)
+{
+	// Temperature is shown with 2 digits
+	epd_tile_changed(EPD_TILE_TEMP, epd_key(EPD_KEY_INIT, lroundf(temp_values[temp_idx - 1] * 100)));
 
-		snprintf(disp_text, 29, "~C");
-		rak14000_text(x_text + spacer + txt_w + 4, y_text + 16 + 4, disp_text, (uint16_t)txt_color, 1);
-	}
+	snprintf(disp_text, 29, has_pm ? "%.2f" : "%.2f ", temp_values[temp_idx - 1]);
+	value_tile(EPD_TILE_TEMP, has_pm, celsius_img, disp_text, (char *)"~C", unit_width.celsius);
 }
 
 /**
  * @brief Update display for humidity values
  *
- * @param full unused
+ * @param has_pm true if the PM sensor is available
  */
 void humid_rak14000(bool has_pm)
 {
-	uint16_t x_text = 25;
-	uint16_t y_text = DEPG_HP.height / 2 + (DEPG_HP.height / 2 / 3) + 10;
-	uint16_t s_text = 2;
-	uint16_t spacer = 60;
+	// Humidity is shown with 2 digits
+	epd_tile_changed(EPD_TILE_HUMID, epd_key(EPD_KEY_INIT, lroundf(humid_values[humid_idx - 1] * 100)));
 
-	// If PM sensor is not available, position is different
-	if (!has_pm)
-	{
-		x_text = DEPG_HP.width / 2 + 53;
-		y_text = DEPG_HP.height / 3 + 15;
-		s_text = 2;
-		spacer = 50;
-
-		// Write value
-		display.drawBitmap(DEPG_HP.width - (DEPG_HP.width / 4 - 16), y_text, humidity_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "%%RH");
-		display.setFont(SMALL_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - 3, y_text + spacer + 4, disp_text, (uint16_t)txt_color, 1);
-
-		snprintf(disp_text, 29, "%.2f ", humid_values[humid_idx - 1]);
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w2, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - txt_w2 - 6, y_text + spacer, disp_text, (uint16_t)txt_color, s_text);
-	}
-	else
-	{
-		// Write value
-		display.drawBitmap(x_text, y_text, humidity_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "%.2f", humid_values[humid_idx - 1]);
-
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-
-		rak14000_text(x_text + spacer, y_text + 16, disp_text, (uint16_t)txt_color, s_text);
-
-		snprintf(disp_text, 29, "%%RH");
-		rak14000_text(x_text + spacer + txt_w + 4, y_text + 16 + 4, disp_text, (uint16_t)txt_color, 1);
-	}
+	snprintf(disp_text, 29, has_pm ? "%.2f" : "%.2f ", humid_values[humid_idx - 1]);
+	value_tile(EPD_TILE_HUMID, has_pm, humidity_img, disp_text, (char *)"%RH", unit_width.humid);
 }
 
 /**
  * @brief Update display for barometric pressure
  *
- * @param full unused
+ * @param has_pm true if the PM sensor is available
  */
 void baro_rak14000(bool has_pm)
 {
-	x_text = 25;
-	y_text = DEPG_HP.height / 2 + (DEPG_HP.height / 2 / 3 * 2) + 10;
-	s_text = 2;
-	spacer = 60;
-
-	// If PM sensor is not available, position is different
-	if (!has_pm)
-	{
-		x_text = DEPG_HP.width / 2 + 53;
-		y_text = DEPG_HP.height / 3 * 2 + 15;
-		s_text = 2;
-		spacer = 50;
+	// Barometric pressure is shown with 2 digits, without PM sensor with 1 digit
+	epd_tile_changed(EPD_TILE_BARO, epd_key(EPD_KEY_INIT, lroundf(baro_values[baro_idx - 1] * (has_pm ? 100 : 10))));
 
-		// Write value
-		display.drawBitmap(DEPG_HP.width - (DEPG_HP.width / 4 - 16), y_text, barometer_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "mBar");
-		display.setFont(SMALL_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - 3, y_text + spacer + 4, disp_text, (uint16_t)txt_color, 1);
-
-		snprintf(disp_text, 29, "%.1f ", baro_values[baro_idx - 1]);
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w2, &txt_h);
-
-		rak14000_text(DEPG_HP.width - txt_w - txt_w2 - 6, y_text + spacer, disp_text, (uint16_t)txt_color, s_text);
-	}
-	else
-	{
-		// Write value
-		display.drawBitmap(x_text, y_text, barometer_img, 32, 32, txt_color);
-
-		snprintf(disp_text, 29, "%.2f", baro_values[baro_idx - 1]);
-
-		display.setFont(LARGE_FONT);
-		display.setTextSize(1);
-		display.getTextBounds(disp_text, 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-
-		rak14000_text(x_text + spacer, y_text + 16, disp_text, (uint16_t)txt_color, s_text);
-
-		snprintf(disp_text, 29, "mBar");
-		rak14000_text(x_text + spacer + txt_w + 4, y_text + 16 + 4, disp_text, (uint16_t)txt_color, 1);
-	}
+	snprintf(disp_text, 29, has_pm ? "%.2f" : "%.1f ", baro_values[baro_idx - 1]);
+	value_tile(EPD_TILE_BARO, has_pm, barometer_img, disp_text, (char *)"mBar", unit_width.mbar);
 }
 
 /**
@@ -925,28 +1005,21 @@ void epd_task(void *pvParameters)
 	// If RTC is available, write the date
 	if (found_sensors[RTC_ID].found_sensor)
 	{
+		i2c_lock();
 		read_rak12002();
+		i2c_unlock();
 		snprintf(disp_text, 59, "%d/%d/%d %d:%d", g_date_time.date, g_date_time.month, g_date_time.year,
 				 g_date_time.hour, g_date_time.minute);
 		rak14000_text(0, 0, disp_text, (uint16_t)txt_color, 2);
 	}
 
-	display.setFont(LARGE_FONT);
-	display.setTextSize(1);
-	display.getTextBounds((char *)"IoT Made Easy", 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text(DEPG_HP.width / 2 - (txt_w / 2), 110, (char *)"IoT Made Easy", (uint16_t)txt_color, 2);
+	rak14000_text(DEPG_HP.width / 2 - (text_width("IoT Made Easy", LARGE_FONT) / 2), 110, (char *)"IoT Made Easy", (uint16_t)txt_color, 2);
 
-	display.setFont(LARGE_FONT);
-	display.setTextSize(1);
-	display.getTextBounds((char *)"RAK10702 Air Quality", 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text(DEPG_HP.width / 2 - (txt_w / 2), 150, (char *)"RAK10702 Air Quality", (uint16_t)txt_color, 2);
+	rak14000_text(DEPG_HP.width / 2 - (text_width("RAK10702 Air Quality", LARGE_FONT) / 2), 150, (char *)"RAK10702 Air Quality", (uint16_t)txt_color, 2);
 
 	display.drawBitmap(DEPG_HP.width / 2 - 63, 190, built_img, 126, 66, txt_color);
 
-	display.setFont(SMALL_FONT);
-	display.setTextSize(1);
-	display.getTextBounds((char *)"Wait for connect", 0, 0, &txt_x1, &txt_y1, &txt_w, &txt_h);
-	rak14000_text(DEPG_HP.width / 2 - (txt_w / 2), 260, (char *)"Wait for connect", (uint16_t)txt_color, 1);
+	rak14000_text(DEPG_HP.width / 2 - (text_width("Wait for connect", SMALL_FONT) / 2), 260, (char *)"Wait for connect", (uint16_t)txt_color, 1);
 
 	display.display(false);
 
@@ -0,0 +1,81 @@
+/**
+ * @file RAK14000_epd_tiles.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Change tracking for the tiles of the EPD layout
+ *        Each tile is described by a key built from its content at display
+ *        precision. A tile is only redrawn and refreshed if its key changed.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+#if HAS_EPD > 0
+
+/** Content keys of the last drawn tiles */
+static uint32_t tile_keys[EPD_NUM_TILES];
+/** Tiles that have to be drawn, one bit per tile */
+static uint8_t tile_dirty = 0;
+/** Tiles that have to be drawn regardless of their key */
+static uint8_t tile_invalid = (1 << EPD_NUM_TILES) - 1;
+
+/**
+ * @brief Add a value to a tile key (FNV-1a)
+ *
+ * @param key key of the values added so far, start with EPD_KEY_INIT
+ * @param value value as shown on the display
+ * @return uint32_t new key
+ */
+uint32_t epd_key(uint32_t key, int32_t value)
+{
+	for (uint8_t idx = 0; idx < 4; idx++)
+	{
+		key ^= (uint8_t)(value >> (idx * 8));
+		key *= 16777619UL;
+	}
+	return key;
+}
+
+/**
+ * @brief Check if the content of a tile changed since it was drawn last
+ *     A changed tile is marked as dirty
+ *
+ * @param tile tile number, EPD_TILE_xxx
+ * @param key key of the new content
+ * @return true tile has to be drawn
+ * @return false tile shows already the same content
+ */
+bool epd_tile_changed(uint8_t tile, uint32_t key)
+{
+	if (((tile_invalid & (1 << tile)) == 0) && (tile_keys[tile] == key))
+	{
+		return false;
+	}
+	tile_keys[tile] = key;
+	tile_invalid &= ~(1 << tile);
+	tile_dirty |= (1 << tile);
+	return true;
+}
+
+/**
+ * @brief Force all tiles to be drawn, used before a full refresh
+ *
+ */
+void epd_tiles_invalidate(void)
+{
+	tile_invalid = (1 << EPD_NUM_TILES) - 1;
+}
+
+/**
+ * @brief Get the tiles that changed since the last call
+ *
+ * @return uint8_t changed tiles, one bit per tile
+ */
+uint8_t epd_dirty_tiles(void)
+{
+	uint8_t dirty = tile_dirty;
+	tile_dirty = 0;
+	return dirty;
+}
+#endif
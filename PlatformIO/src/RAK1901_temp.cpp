@@ -62,6 +62,9 @@ void read_rak1901(void)
 		_last_humid = shtc3.toPercent();
 		_has_last_values = true;
 
+		// Share the values for compensation of other sensors
+		env_publish_th(_last_temp, _last_humid, ENV_SRC_RAK1901);
+
 #if HAS_EPD > 0
 		set_humid_rak14000(shtc3.toPercent());
 		set_temp_rak14000(shtc3.toDegC());
@@ -57,6 +57,9 @@ void read_rak1902(void)
 
 	MYLOG("PRESS", "P: %.2f MSL: %.2f", pressure, at_MSL);
 
+	// Share the value for compensation of other sensors
+	env_publish_p(pressure, ENV_SRC_RAK1902);
+
 	g_solution_data.addBarometricPressure(LPP_CHANNEL_PRESS, pressure);
 
 #if HAS_EPD > 0
@@ -25,5 +25,7 @@
 
 bool init_rak1905(void);
 void clear_int_rak1905(void);
+uint16_t read_fifo_rak1905(void);
+bool read_mag_rak1905(void);
 
 #endif // RAK1905_H
\ No newline at end of file
@@ -55,6 +55,17 @@ volatile float _last_pressure_rak1906_bsec = 0;
 /** Last IAQ index read */
 volatile float _last_iaq_rak1906_bsec = 0;
 
+/** BSEC state save interval in hours, 0 = saving disabled */
+uint16_t g_bsec_save_hours = BSEC_SAVE_DEFAULT;
+/** Buffer for the BSEC state */
+static uint8_t bsec_state[BSEC_MAX_STATE_BLOB_SIZE];
+/** IAQ accuracy of the saved state */
+static uint8_t bsec_saved_accuracy = 0;
+/** millis() of the last state save */
+static time_t bsec_last_save = 0;
+/** Flag if the state was saved since power up */
+static bool bsec_saved = false;
+
 bsec_virtual_sensor_t sensorList[10] = {
 	BSEC_OUTPUT_RAW_TEMPERATURE,
 	BSEC_OUTPUT_RAW_PRESSURE,
@@ -108,6 +119,21 @@ bool init_rak1906_bsec(void)
 
 	iaqSensor.setConfig(bsec_config_iaq);
 
+	// Restore the saved state, otherwise the IAQ accuracy starts again at 0
+	if (read_bsec_state(bsec_state, BSEC_MAX_STATE_BLOB_SIZE, &bsec_saved_accuracy))
+	{
+		iaqSensor.setState(bsec_state);
+		if (check_rak1906_status())
+		{
+			MYLOG("BSEC", "State restored, IAQ accuracy was %d", bsec_saved_accuracy);
+		}
+		else
+		{
+			MYLOG("BSEC", "Saved state rejected");
+			bsec_saved_accuracy = 0;
+		}
+	}
+
 	iaqSensor.updateSubscription(sensorList, 10, BSEC_SAMPLE_RATE_ULP);
 
 	if (!check_rak1906_status())
@@ -233,6 +259,12 @@ bool do_read_rak1906_bsec(void)
 		_last_pressure_rak1906_bsec = iaqSensor.pressure / 100;
 		_last_iaq_rak1906_bsec = iaqSensor.iaq;
 
+		// Share the values for compensation of other sensors
+		env_publish_th(_last_temp_rak1906_bsec, _last_humid_rak1906_bsec, ENV_SRC_RAK1906);
+		env_publish_p(_last_pressure_rak1906_bsec, ENV_SRC_RAK1906);
+
+		check_save_rak1906_bsec();
+
 #if MY_DEBUG > 0
 		MYLOG("BSEC", "RH= %.2f T= %.2f", _last_humid_rak1906_bsec, _last_temp_rak1906_bsec);
 		MYLOG("BSEC", "P= %.3f IAQ= %.2f", _last_pressure_rak1906_bsec, _last_iaq_rak1906_bsec);
@@ -245,6 +277,70 @@ bool do_read_rak1906_bsec(void)
 	return check_rak1906_status();
 }
 
+/**
+ * @brief Save the BSEC state if required
+ *     The state is saved when the IAQ accuracy improved over the saved state
+ *     and after that only every g_bsec_save_hours if the accuracy is 3.
+ *     This limits the flash writes to a few per day.
+ *
+ */
+void check_save_rak1906_bsec(void)
+{
+	if (g_bsec_save_hours == 0)
+	{
+		return;
+	}
+
+	bool save_state = false;
+	if (iaqSensor.iaqAccuracy > bsec_saved_accuracy)
+	{
+		save_state = true;
+	}
+	else if ((iaqSensor.iaqAccuracy >= 3) && ((millis() - bsec_last_save) >= ((uint32_t)g_bsec_save_hours * 3600000)))
+	{
+		save_state = true;
+	}
+
+	if (save_state)
+	{
+		iaqSensor.getState(bsec_state);
+		if (!check_rak1906_status())
+		{
+			MYLOG("BSEC", "Failed to get state");
+			return;
+		}
+		save_bsec_state(bsec_state, BSEC_MAX_STATE_BLOB_SIZE, iaqSensor.iaqAccuracy);
+		bsec_saved_accuracy = iaqSensor.iaqAccuracy;
+		bsec_last_save = millis();
+		bsec_saved = true;
+		MYLOG("BSEC", "State saved, IAQ accuracy %d", bsec_saved_accuracy);
+	}
+}
+
+/**
+ * @brief Get the IAQ accuracy
+ *
+ * @return uint8_t 0 = stabilizing, 1 = uncertain, 2 = calibrating, 3 = calibrated
+ */
+uint8_t get_accuracy_rak1906_bsec(void)
+{
+	return iaqSensor.iaqAccuracy;
+}
+
+/**
+ * @brief Get the time since the BSEC state was saved
+ *
+ * @return int32_t age in seconds, -1 if not saved since power up
+ */
+int32_t get_save_age_rak1906_bsec(void)
+{
+	if (!bsec_saved)
+	{
+		return -1;
+	}
+	return (millis() - bsec_last_save) / 1000;
+}
+
 /**
  * @brief Calculate and return the altitude
  *        based on the barometric pressure
@@ -23,16 +23,32 @@ void disp_show(void);
 #define LINE_HEIGHT 10
 
 /** Number of message lines */
-#define NUM_OF_LINES (OLED_HEIGHT - STATUS_BAR_HEIGHT) / LINE_HEIGHT
-
-/** Line buffer for messages */
-char disp_buffer[NUM_OF_LINES + 1][32] = {0};
-
-/** Current line used */
+#define NUM_OF_LINES ((OLED_HEIGHT - STATUS_BAR_HEIGHT) / LINE_HEIGHT)
+/** Length of a message line */
+#define LINE_LENGTH 32
+/** Pixels of ArialMT_Plain_10 that reach into the next line */
+#define LINE_OVERFLOW 3
+/** Number of 8 pixel high pages of the SSD1306 */
+#define NUM_OF_PAGES (OLED_HEIGHT / 8)
+/** Number of data bytes per I2C transmission */
+#define OLED_I2C_CHUNK 16
+/** I2C address of the SSD1306 */
+#define OLED_ADDR 0x3c
+
+/** Ring buffer for messages */
+char disp_buffer[NUM_OF_LINES][LINE_LENGTH] = {0};
+/** Ring buffer index of the oldest message */
+uint8_t first_line = 0;
+/** Number of messages in the ring buffer */
 uint8_t current_line = 0;
 
+/** Messages as they are drawn on the display, one per display row */
+char disp_shown[NUM_OF_LINES][LINE_LENGTH] = {0};
+/** Pages that changed since the last transfer, one bit per page */
+uint8_t dirty_pages = 0;
+
 /** Display class using Wire */
-SSD1306Wire oled_display(0x3c, PIN_WIRE_SDA, PIN_WIRE_SCL, GEOMETRY_128_64, &Wire);
+SSD1306Wire oled_display(OLED_ADDR, PIN_WIRE_SDA, PIN_WIRE_SCL, GEOMETRY_128_64, &Wire);
 
 /**
  * @brief Initialize the display
@@ -60,6 +76,66 @@ bool init_rak1921(void)
 	return true;
 }
 
+/**
+ * @brief Mark the pages of a pixel row range as changed
+ *
+ * @param top first pixel row
+ * @param bottom pixel row after the last changed row
+ */
+static void mark_dirty(uint8_t top, uint8_t bottom)
+{
+	for (uint8_t page = top / 8; page <= (bottom - 1) / 8; page++)
+	{
+		dirty_pages |= (1 << page);
+	}
+}
+
+/**
+ * @brief Send the changed pages to the display
+ *     Consecutive changed pages are sent with one address window
+ *
+ */
+static void send_dirty_pages(void)
+{
+	uint8_t page = 0;
+	while (page < NUM_OF_PAGES)
+	{
+		if ((dirty_pages & (1 << page)) == 0)
+		{
+			page++;
+			continue;
+		}
+		uint8_t last_page = page;
+		while ((last_page + 1 < NUM_OF_PAGES) && ((dirty_pages & (1 << (last_page + 1))) != 0))
+		{
+			last_page++;
+		}
+
+		// Set the address window, the SSD1306 runs in horizontal addressing mode
+		Wire.beginTransmission(OLED_ADDR);
+		Wire.write(0x00);
+		Wire.write(0x21); // Column address
+		Wire.write(0);
+		Wire.write(OLED_WIDTH - 1);
+		Wire.write(0x22); // Page address
+		Wire.write(page);
+		Wire.write(last_page);
+		Wire.endTransmission();
+
+		uint8_t *data = &oled_display.buffer[page * OLED_WIDTH];
+		uint16_t length = (last_page - page + 1) * OLED_WIDTH;
+		for (uint16_t idx = 0; idx < length; idx += OLED_I2C_CHUNK)
+		{
+			Wire.beginTransmission(OLED_ADDR);
+			Wire.write(0x40);
+			Wire.write(&data[idx], OLED_I2C_CHUNK);
+			Wire.endTransmission();
+		}
+		page = last_page + 1;
+	}
+	dirty_pages = 0;
+}
+
 /**
  * @brief Write the top line of the display
  */
@@ -79,12 +155,14 @@ void rak1921_write_header(char *header_line)
 
 	// draw divider line
 	oled_display.drawLine(0, 11, 128, 11);
-	oled_display.display();
+	mark_dirty(0, STATUS_BAR_HEIGHT + 1);
+	rak1921_show();
 	// taskEXIT_CRITICAL();
 }
 
 /**
  * @brief Add a line to the display buffer
+ *     The display is updated with the next rak1921_show()
  *
  * @param line Pointer to char array with the new line
  */
@@ -93,39 +171,64 @@ void rak1921_add_line(char *line)
 	// taskENTER_CRITICAL();
 	if (current_line == NUM_OF_LINES)
 	{
-		// Display is full, shift text one line up
-		for (int idx = 0; idx < NUM_OF_LINES; idx++)
-		{
-			memcpy(disp_buffer[idx], disp_buffer[idx + 1], 32);
-		}
-		current_line--;
+		// Display is full, the oldest line is replaced
+		snprintf(disp_buffer[first_line], LINE_LENGTH, "%s", line);
+		first_line = (first_line + 1) % NUM_OF_LINES;
 	}
-	snprintf(disp_buffer[current_line], 32, "%s", line);
-
-	if (current_line != NUM_OF_LINES)
+	else
 	{
+		snprintf(disp_buffer[(first_line + current_line) % NUM_OF_LINES], LINE_LENGTH, "%s", line);
 		current_line++;
 	}
-
-	rak1921_show();
 	// taskEXIT_CRITICAL();
 }
 
 /**
  * @brief Update display messages
+ *     Only the rows that changed since the last call are redrawn
+ *     and only the pages with changes are sent to the display
  *
  */
 void rak1921_show(void)
 {
-	oled_display.setColor(BLACK);
-	oled_display.fillRect(0, STATUS_BAR_HEIGHT + 1, OLED_WIDTH, OLED_HEIGHT);
+	// Find the rows with a changed text
+	int8_t first_dirty = -1;
+	int8_t last_dirty = -1;
+	for (int8_t row = 0; row < NUM_OF_LINES; row++)
+	{
+		const char *text = row < current_line ? disp_buffer[(first_line + row) % NUM_OF_LINES] : "";
+		if (strcmp(text, disp_shown[row]) != 0)
+		{
+			snprintf(disp_shown[row], LINE_LENGTH, "%s", text);
+			first_dirty = first_dirty < 0 ? row : first_dirty;
+			last_dirty = row;
+		}
+	}
 
-	oled_display.setFont(ArialMT_Plain_10);
-	oled_display.setColor(WHITE);
-	oled_display.setTextAlignment(TEXT_ALIGN_LEFT);
-	for (int line = 0; line < current_line; line++)
+	if (first_dirty >= 0)
 	{
-		oled_display.drawString(0, (line * LINE_HEIGHT) + STATUS_BAR_HEIGHT + 1, disp_buffer[line]);
+		// Clear the changed rows including the part of the font that reaches into the next row
+		uint8_t top = (first_dirty * LINE_HEIGHT) + STATUS_BAR_HEIGHT + 1;
+		uint8_t bottom = ((last_dirty + 1) * LINE_HEIGHT) + STATUS_BAR_HEIGHT + 1 + LINE_OVERFLOW;
+		bottom = bottom > OLED_HEIGHT ? OLED_HEIGHT : bottom;
+		oled_display.setColor(BLACK);
+		oled_display.fillRect(0, top, OLED_WIDTH, bottom - top);
+
+		// Redraw the changed rows and their neighbours, which overlap with the cleared area
+		oled_display.setFont(ArialMT_Plain_10);
+		oled_display.setColor(WHITE);
+		oled_display.setTextAlignment(TEXT_ALIGN_LEFT);
+		int8_t first_row = first_dirty == 0 ? 0 : first_dirty - 1;
+		int8_t last_row = last_dirty == NUM_OF_LINES - 1 ? last_dirty : last_dirty + 1;
+		for (int8_t row = first_row; row <= last_row; row++)
+		{
+			oled_display.drawString(0, (row * LINE_HEIGHT) + STATUS_BAR_HEIGHT + 1, disp_shown[row]);
+		}
+		mark_dirty(top, bottom);
+	}
+
+	if (dirty_pages != 0)
+	{
+		send_dirty_pages();
 	}
-	oled_display.display();
 }
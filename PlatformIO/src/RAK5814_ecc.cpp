@@ -32,29 +32,267 @@ bool init_rak5814(void)
 	MYLOG("ECC", "Serial number %s", eccx08.serialNumber().c_str());
 
 	MYLOG("ECC", "Chip is %slocked", eccx08.locked() ? "" : "not");
+	if (!eccx08.locked())
+	{
+		MYLOG("ECC", "Random numbers are a test pattern until the chip is locked");
+	}
 
 	Wire.setClock(100000); // Wire.setClock(400000);
+
+	// Fill the random number pool
+	refill_rak5814();
+	return true;
+}
+
+/** Random number pool */
+static uint8_t ecc_pool[ECC_POOL_SIZE];
+/** Number of unused bytes in the pool */
+static uint16_t ecc_pool_fill = 0;
+
+/** State of the fast software random generator */
+static uint32_t prng_state[4] = {0x9E3779B9, 0x243F6A88, 0xB7E15162, 0x6A09E667};
+
+/**
+ * @brief Fill the random number pool with 32 byte blocks from the ATECC608
+ *     Called at low load, e.g. after an uplink, when the pool is below the watermark
+ *
+ * @return true pool is full
+ * @return false chip not answering
+ */
+bool refill_rak5814(void)
+{
+	Wire.setClock(100000);
+	while (ecc_pool_fill + ECC_POOL_BLOCK <= ECC_POOL_SIZE)
+	{
+		if (eccx08.random(&ecc_pool[ecc_pool_fill], ECC_POOL_BLOCK) != 1)
+		{
+			Wire.setClock(100000); // Wire.setClock(400000);
+			return false;
+		}
+		ecc_pool_fill += ECC_POOL_BLOCK;
+	}
+	Wire.setClock(100000); // Wire.setClock(400000);
+	return true;
+}
+
+/**
+ * @brief Check if the random number pool needs a refill
+ *
+ * @return true pool is below the watermark
+ * @return false pool has enough random bytes
+ */
+bool random_low_rak5814(void)
+{
+	return ecc_pool_fill < ECC_POOL_LOW;
+}
+
+/**
+ * @brief Get random bytes from the pool
+ *     Used bytes are cleared from the pool. Only if the pool is empty
+ *     the bytes are read directly from the ATECC608
+ *
+ * @param data buffer for the random bytes
+ * @param length number of bytes
+ * @return true random bytes available
+ * @return false pool empty and chip not answering
+ */
+bool random_bytes_rak5814(uint8_t *data, uint16_t length)
+{
+	while (length != 0)
+	{
+		if (ecc_pool_fill == 0)
+		{
+			refill_rak5814();
+			if (ecc_pool_fill == 0)
+			{
+				return false;
+			}
+		}
+		uint16_t take = length > ecc_pool_fill ? ecc_pool_fill : length;
+		ecc_pool_fill -= take;
+		memcpy(data, &ecc_pool[ecc_pool_fill], take);
+		memset(&ecc_pool[ecc_pool_fill], 0, take);
+		data += take;
+		length -= take;
+	}
 	return true;
 }
 
 /**
  * @brief Get random number for EXXX08
- * 
+ *     Served from the random number pool
+ *
  * @param min lower limit
- * @param max upper limit
+ * @param max upper limit, not included
  * @return uint16_t random number
  */
 uint16_t random_num_rak5814(uint16_t min, uint16_t max)
 {
-	Wire.setClock(100000);
-	uint16_t result = eccx08.random(min, max);
-	Wire.setClock(100000); // Wire.setClock(400000);
+	uint32_t value = 0;
+	if ((max <= min) || !random_bytes_rak5814((uint8_t *)&value, sizeof(value)))
+	{
+		return min;
+	}
+	return min + (uint16_t)(((uint64_t)value * (max - min)) >> 32);
+}
+
+/**
+ * @brief Seed the fast software random generator
+ *     Uses the pool of the ATECC608 if available. The DevEUI is always
+ *     mixed in, devices without RAK5814 still get different sequences
+ *
+ * @param use_ecc true to seed from the ATECC608
+ */
+void seed_fast_random(bool use_ecc)
+{
+	uint32_t seed[4] = {0, 0, 0, 0};
+	if (use_ecc)
+	{
+		random_bytes_rak5814((uint8_t *)seed, sizeof(seed));
+	}
+	seed[0] ^= micros();
+	for (uint8_t idx = 0; idx < 8; idx++)
+	{
+		seed[1 + idx / 4] ^= (uint32_t)g_lorawan_settings.node_device_eui[idx] << ((idx % 4) * 8);
+	}
+	for (uint8_t idx = 0; idx < 4; idx++)
+	{
+		prng_state[idx] ^= seed[idx];
+	}
+	// An all zero state would stay zero
+	if ((prng_state[0] | prng_state[1] | prng_state[2] | prng_state[3]) == 0)
+	{
+		prng_state[0] = 0x9E3779B9;
+	}
+}
+
+/**
+ * @brief Get a number from the fast software random generator (xoshiro128**)
+ *     Not for security, only for jitter and similar
+ *
+ * @return uint32_t random number
+ */
+uint32_t fast_random(void)
+{
+	uint32_t result = prng_state[1] * 5;
+	result = ((result << 7) | (result >> 25)) * 9;
+	uint32_t t = prng_state[1] << 9;
+	prng_state[2] ^= prng_state[0];
+	prng_state[3] ^= prng_state[1];
+	prng_state[1] ^= prng_state[2];
+	prng_state[0] ^= prng_state[3];
+	prng_state[2] ^= t;
+	prng_state[3] = (prng_state[3] << 11) | (prng_state[3] >> 21);
 	return result;
 }
 
+/**
+ * @brief Get a number in a range from the fast software random generator
+ *
+ * @param min lower limit
+ * @param max upper limit, not included
+ * @return uint32_t random number
+ */
+uint32_t fast_random_range(uint32_t min, uint32_t max)
+{
+	if (max <= min)
+	{
+		return min;
+	}
+	return min + (uint32_t)(((uint64_t)fast_random() * (max - min)) >> 32);
+}
+
+/** Partial SHA256 block, the ATECC608 takes only full 64 byte blocks */
+static byte sha_block[ECC_SHA_BLOCK];
+/** Number of bytes in the partial block */
+static uint8_t sha_fill = 0;
+/** Flag if a SHA256 calculation is running */
+static bool sha_active = false;
+
+/**
+ * @brief Start a SHA256 calculation in the ATECC608
+ *     Only one calculation can run at a time, the context is kept in the chip
+ *
+ * @return true calculation started
+ * @return false chip not answering
+ */
+bool sha256_begin_rak5814(void)
+{
+	Wire.setClock(100000);
+	sha_fill = 0;
+	sha_active = (eccx08.beginSHA256() == 1);
+	return sha_active;
+}
+
+/**
+ * @brief Add data to the running SHA256 calculation
+ *     Full 64 byte blocks are sent to the chip, the rest is kept until the next call
+ *
+ * @param data buffer with the data
+ * @param length length of the buffer
+ * @return true data added
+ * @return false no calculation running or chip not answering
+ */
+bool sha256_update_rak5814(const byte *data, uint32_t length)
+{
+	if (!sha_active)
+	{
+		return false;
+	}
+	while (length != 0)
+	{
+		// Full blocks directly from the buffer
+		if ((sha_fill == 0) && (length >= ECC_SHA_BLOCK))
+		{
+			if (eccx08.updateSHA256(data) != 1)
+			{
+				sha_active = false;
+				return false;
+			}
+			data += ECC_SHA_BLOCK;
+			length -= ECC_SHA_BLOCK;
+			continue;
+		}
+		uint32_t copy = ECC_SHA_BLOCK - sha_fill;
+		copy = copy > length ? length : copy;
+		memcpy(&sha_block[sha_fill], data, copy);
+		sha_fill += copy;
+		data += copy;
+		length -= copy;
+		if (sha_fill == ECC_SHA_BLOCK)
+		{
+			if (eccx08.updateSHA256(sha_block) != 1)
+			{
+				sha_active = false;
+				return false;
+			}
+			sha_fill = 0;
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Finish the SHA256 calculation
+ *     The chip adds the padding to the last partial block
+ *
+ * @param result buffer for the 32 byte SHA256
+ * @return true calculation success
+ * @return false no calculation running or chip not answering
+ */
+bool sha256_end_rak5814(byte *result)
+{
+	if (!sha_active)
+	{
+		return false;
+	}
+	sha_active = false;
+	return (eccx08.endSHA256(sha_block, sha_fill, result) == 1);
+}
+
 /**
  * @brief Calculate SHA256
- * 
+ *
  * @param data buffer with the data
  * @param length length of the buffer
  * @param result variable to write SHA256 to
@@ -63,42 +301,13 @@ uint16_t random_num_rak5814(uint16_t min, uint16_t max)
  */
 bool sha256_rak5814(byte *data, uint32_t length, byte *result)
 {
-	// Wire.setClock(100000);
-	// uint32_t index = 0;
-	// int result = 0;
-	// if (eccx08.beginSHA256() != 0)
-	// {
-	// 	Wire.setClock(100000); // Wire.setClock(400000);
-	// 	return false;
-	// }
-	// while ((length - 32) > 64)
-	// {
-	// 	if (eccx08.updateSHA256(&data[index]) != 0)
-	// 	{
-	// 		Wire.setClock(100000); // Wire.setClock(400000);
-	// 		return false;
-	// 	}
-	// 	index += 32;
-	// 	length -= 32;
-	// }
-	// if (length != 0)
-	// {
-	// 	byte left_over[64] = {0};
-	// 	memcpy(left_over, &data[index], length);
-	// 	if (eccx08.updateSHA256(left_over) != 0)
-	// 	{
-	// 		Wire.setClock(100000); // Wire.setClock(400000);
-	// 		return false;
-	// 	}
-	// }
-	// if (eccx08.endSHA256(result) != 0)
-	// {
-	// 	Wire.setClock(100000); // Wire.setClock(400000);
-	// 	return false;
-	// }
-	// Wire.setClock(100000); // Wire.setClock(400000);
-	// return true;
-
-	// eccx08.ecdsaVerify()
-	return true;
-}
\ No newline at end of file
+	if (!sha256_begin_rak5814())
+	{
+		return false;
+	}
+	if (!sha256_update_rak5814(data, length))
+	{
+		return false;
+	}
+	return sha256_end_rak5814(result);
+}
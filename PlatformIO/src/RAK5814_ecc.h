@@ -12,8 +12,26 @@
 #define RAK5814_H
 #include <Arduino.h>
 
+/** Block size of the SHA256 engine */
+#define ECC_SHA_BLOCK 64
+/** Size of a SHA256 */
+#define ECC_SHA_SIZE 32
+/** Random number pool size, refill block size and refill watermark in bytes */
+#define ECC_POOL_SIZE 128
+#define ECC_POOL_BLOCK 32
+#define ECC_POOL_LOW 32
+
 bool init_rak5814(void);
 uint16_t random_num_rak5814(uint16_t min, uint16_t max);
+bool random_bytes_rak5814(uint8_t *data, uint16_t length);
+bool refill_rak5814(void);
+bool random_low_rak5814(void);
+void seed_fast_random(bool use_ecc);
+uint32_t fast_random(void);
+uint32_t fast_random_range(uint32_t min, uint32_t max);
 bool sha256_rak5814(byte *data, uint32_t length, byte *result);
+bool sha256_begin_rak5814(void);
+bool sha256_update_rak5814(const byte *data, uint32_t length);
+bool sha256_end_rak5814(byte *result);
 
 #endif // RAK5814_H
\ No newline at end of file
@@ -59,6 +59,9 @@ bool low_batt_protection = false;
 /** LoRaWAN packet */
 WisCayenne g_solution_data(255);
 
+/** Packet cut to the maximum payload of the current DR */
+uint8_t packed_data[255];
+
 /** Initialization result */
 bool init_result = true;
 
@@ -107,8 +110,15 @@ void setup_app(void)
 
 	delay(500);
 
-	// Scan the I2C interfaces for devices
+	// Settings, the inertial samples and the environment context are accessed from the sensor tasks too, create the locks before they start
+	init_settings_lock();
+	init_imu_pipeline();
+	init_env_context();
+
+	// Scan the I2C interfaces for devices, sensor tasks may start already
+	i2c_lock();
 	find_modules();
+	i2c_unlock();
 
 	// Initialize the User AT command list
 	init_user_at();
@@ -141,9 +151,100 @@ bool init_app(void)
 
 	api_set_version(SW_VERSION_1, SW_VERSION_2, SW_VERSION_3);
 
+	// The sensor tasks started here share the I2C bus with the app loop
+	i2c_lock();
+
 	// Get the battery check setting
 	read_batt_settings();
 
+	// Get the fragmented uplink settings
+	read_frag_settings();
+
+	// Get the uplink packer mode and channel priorities
+	read_pack_settings();
+	if (!pack_check_types())
+	{
+		// Packing would fail on the first oversized uplink, send in fragments instead
+		AT_PRINTF("+EVT:PACK_TYPE_ERROR\n");
+		set_pack_mode(PACK_MODE_OFF);
+	}
+
+	// Get the payload authentication settings
+	read_auth_settings();
+
+	// Get the periodic time sync setting
+	read_tsync_settings();
+
+	// Seed the random generator used for jitter
+	seed_fast_random(found_sensors[ECC_ID].found_sensor);
+
+	if (found_sensors[RTC_ID].found_sensor)
+	{
+		// Get the wall clock alignment
+		read_align_settings();
+	}
+
+	if (found_sensors[ACC_ID].found_sensor)
+	{
+		// Get the vibration analysis setting
+		read_vib_settings();
+	}
+
+	if (found_sensors[MPU_ID].found_sensor || found_sensors[DOF_ID].found_sensor)
+	{
+		// Get the orientation fusion setting and start the fusion task
+		read_fusion_settings();
+		init_fusion();
+	}
+
+	if (found_sensors[TOF_ID].found_sensor)
+	{
+		// Get the ToF timing budget
+		read_tof_settings();
+	}
+
+	if (found_sensors[CURRENT_ID].found_sensor)
+	{
+		// Get the sampler rate and start the current sampler task
+		read_ina_settings();
+		start_rak16000();
+	}
+
+	if (found_sensors[PM_ID].found_sensor)
+	{
+		// Get the power schedule and start the particle matter scheduler task
+		read_pms_settings();
+		start_rak12039();
+	}
+
+	if (found_sensors[TEMP_ARR_2_ID].found_sensor)
+	{
+		// Get the interval of the thermal frame blob uplinks
+		read_tblob_settings();
+	}
+
+	if (found_sensors[MQ2_ID].found_sensor || found_sensors[MQ3_ID].found_sensor)
+	{
+		// Get the heater schedule and R0 and start the gas sensor measurement engine
+		read_mqx_settings();
+		if (found_sensors[MQ2_ID].found_sensor)
+		{
+			start_rak12004();
+		}
+		if (found_sensors[MQ3_ID].found_sensor)
+		{
+			start_rak12009();
+		}
+	}
+
+#if USE_BSEC == 1
+	if (found_sensors[ENV_ID].found_sensor)
+	{
+		// Get the BSEC state save interval
+		read_bsec_settings();
+	}
+#endif
+
 	if (found_sensors[GNSS_ID].found_sensor)
 	{
 		// Get precision settings
@@ -221,17 +322,19 @@ bool init_app(void)
 			snprintf(disp_txt, 64, "Init finished");
 		}
 		rak1921_add_line(disp_txt);
+		rak1921_show();
 	}
 
+	i2c_unlock();
 	return true;
 }
 
 /**
- * @brief Application specific event handler
+ * @brief Handle the events of one wake up
  *        Requires as minimum the handling of STATUS event
  *        Here you handle as well your application specific events
  */
-void app_event_handler(void)
+static void handle_app_event(void)
 {
 	// Handle wake up call
 	if ((g_task_event_type & AT_CMD) == AT_CMD)
@@ -249,6 +352,12 @@ void app_event_handler(void)
 		g_task_event_type &= N_STATUS;
 		MYLOG("APP", "Timer wakeup");
 
+		if (found_sensors[RTC_ID].found_sensor && g_rtc_align && !low_batt_protection && (g_lorawan_settings.send_repeat_time != 0))
+		{
+			// Next wakeup at the next full send interval of the wall clock plus a random delay
+			api_timer_restart(next_boundary_rak12002(g_lorawan_settings.send_repeat_time) + fast_random_range(0, RTC_ALIGN_JITTER));
+		}
+
 #if USE_BSEC == 0
 		/*********************************************/
 		/** Select between Bosch BSEC algorithm for  */
@@ -306,6 +415,12 @@ void app_event_handler(void)
 		float batt_level_f = read_batt();
 		g_solution_data.addVoltage(LPP_CHANNEL_BATT, batt_level_f / 1000.0);
 
+		if (clock_valid())
+		{
+			// Timestamp of the readings
+			g_solution_data.addUnixTime(LPP_CHANNEL_TIME, clock_get_unix());
+		}
+
 		if ((found_sensors[OLED_ID].found_sensor) && !g_is_tester)
 		{
 			if (found_sensors[RTC_ID].found_sensor)
@@ -372,13 +487,6 @@ void app_event_handler(void)
 				// Read environment data
 				read_rak1902();
 			}
-			// Read the CO2 sensor last, it needs temperature and humidity values first
-			if (found_sensors[SCT31_ID].found_sensor)
-			{
-				// Read CO2 data
-				read_rak12008();
-			}
-
 			if (found_sensors[SEISM_ID].found_sensor)
 			{
 				if ((earthquake_end) && !(g_task_event_type & SEISMIC_EVENT) && !(g_task_event_type & SEISMIC_ALERT))
@@ -461,10 +569,53 @@ void app_event_handler(void)
 				return;
 			}
 
+			// Handle water level threshold crossing, values were read already, just send them
+			if ((g_task_event_type & WL_ALERT) == WL_ALERT)
+			{
+				MYLOG("APP", "Water level alert");
+				g_task_event_type &= N_WL_ALERT;
+			}
+
 			MYLOG("APP", "Packetsize %d", g_solution_data.getSize());
-			if (g_lorawan_settings.lorawan_enable)
+			uint8_t *packet = g_solution_data.getBuffer();
+			uint8_t packet_size = g_solution_data.getSize();
+			if (g_lorawan_settings.lorawan_enable && (g_pack_mode == PACK_MODE_FILL))
 			{
-				lmh_error_status result = send_lora_packet(g_solution_data.getBuffer(), g_solution_data.getSize());
+				// Fill the packet up to the current DR by channel priority, the rest goes with the next uplink
+				uint8_t max_size = frag_max_payload() > g_auth_mac_len ? frag_max_payload() - g_auth_mac_len : 0;
+				uint8_t packed_size = pack_uplink(packet, packet_size, max_size, packed_data);
+				if (packed_size != 0)
+				{
+					packet = packed_data;
+					packet_size = packed_size;
+				}
+			}
+			if (g_lorawan_settings.lorawan_enable && (g_auth_mac_len != 0))
+			{
+				// Append the truncated HMAC for the end-to-end authentication
+				if (packet != packed_data)
+				{
+					memcpy(packed_data, packet, packet_size);
+					packet = packed_data;
+				}
+				packet_size = auth_append_mac(packet, packet_size, g_lorawan_settings.app_port, sizeof(packed_data));
+			}
+			if (g_lorawan_settings.lorawan_enable && (packet_size > frag_max_payload()))
+			{
+				// Too big for the current DR, send it in fragments
+				if (frag_send(packet, packet_size, g_lorawan_settings.app_port))
+				{
+					MYLOG("APP", "Packet too big, sending fragments");
+				}
+				else
+				{
+					AT_PRINTF("+EVT:SIZE_ERROR\n");
+					MYLOG("APP", "Packet too big, fragmented transfer busy or packet too large");
+				}
+			}
+			else if (g_lorawan_settings.lorawan_enable)
+			{
+				lmh_error_status result = send_lora_packet(packet, packet_size);
 				switch (result)
 				{
 				case LMH_SUCCESS:
@@ -473,11 +624,11 @@ void app_event_handler(void)
 						if (found_sensors[RTC_ID].found_sensor)
 						{
 							read_rak12002();
-							snprintf(disp_txt, 64, "%d:%02d Pkg %d b", g_date_time.hour, g_date_time.minute, g_solution_data.getSize());
+							snprintf(disp_txt, 64, "%d:%02d Pkg %d b", g_date_time.hour, g_date_time.minute, packet_size);
 						}
 						else
 						{
-							snprintf(disp_txt, 64, "Packet sent %d b", g_solution_data.getSize());
+							snprintf(disp_txt, 64, "Packet sent %d b", packet_size);
 						}
 						rak1921_add_line(disp_txt);
 					}
@@ -539,12 +690,26 @@ void app_event_handler(void)
 		}
 	}
 
-	// VOC read request event
-	if ((g_task_event_type & VOC_REQ) == VOC_REQ)
+	// Sensor data ready event, CO2 measurement or RAK1904 FIFO burst
+	if ((g_task_event_type & SENSOR_REQ) == SENSOR_REQ)
 	{
-		g_task_event_type &= N_VOC_REQ;
+		g_task_event_type &= N_SENSOR_REQ;
+
+		if (found_sensors[CO2_ID].found_sensor)
+		{
+			fetch_rak12037();
+		}
+		if (found_sensors[ACC_ID].found_sensor)
+		{
+			fetch_rak1904();
+		}
+	}
 
-		do_read_rak12047();
+	// Next fragment of a fragmented uplink
+	if ((g_task_event_type & FRAG_REQ) == FRAG_REQ)
+	{
+		g_task_event_type &= N_FRAG_REQ;
+		frag_next();
 	}
 
 	/*********************************************/
@@ -716,12 +881,6 @@ void app_event_handler(void)
 				// Get Environment data
 				read_rak1902();
 			}
-			if (found_sensors[SCT31_ID].found_sensor)
-			{
-				// Read CO2 data
-				read_rak12008();
-			}
-
 			// // Get battery level
 			// float batt_level_f = read_batt();
 			// g_solution_data.addVoltage(LPP_CHANNEL_BATT, batt_level_f / 1000.0);
@@ -796,6 +955,23 @@ void app_event_handler(void)
 	}
 }
 
+/**
+ * @brief Application specific event handler
+ *        Display lines added while handling the events are sent in one update
+ *        The I2C bus is locked against the sensor tasks while the events are handled
+ */
+void app_event_handler(void)
+{
+	i2c_lock();
+	handle_app_event();
+
+	if (found_sensors[OLED_ID].found_sensor)
+	{
+		rak1921_show();
+	}
+	i2c_unlock();
+}
+
 // ESP32 is handling the received BLE UART data different, this works only for nRF52
 #if defined NRF52_SERIES
 /**
@@ -835,6 +1011,7 @@ void ble_data_handler(void)
  */
 void lora_data_handler(void)
 {
+	i2c_lock();
 	// LoRa Join finished handling
 	if ((g_task_event_type & LORA_JOIN_FIN) == LORA_JOIN_FIN)
 	{
@@ -853,6 +1030,7 @@ void lora_data_handler(void)
 					snprintf(disp_txt, 64, "Join success");
 				}
 				rak1921_add_line(disp_txt);
+				rak1921_show();
 			}
 			MYLOG("APP", "Successfully joined network");
 			AT_PRINTF("+EVT:JOINED\n");
@@ -933,6 +1111,50 @@ void lora_data_handler(void)
 				api_reset();
 			}
 		}
+
+		// Schedule the next fragment of a fragmented uplink
+		frag_tx_finished();
+
+		// Send the thermal frame blob in its own uplink after the sensor data, read_rak12052()
+		// prepares it only every g_mlx_blob_interval'th uplink. While fragments are pending it waits
+		bool extra_sent = false;
+		if (found_sensors[TEMP_ARR_2_ID].found_sensor && g_lorawan_settings.lorawan_enable && !frag_busy())
+		{
+			uint8_t *blob;
+			uint8_t blob_size = get_blob_rak12052(&blob);
+			if ((blob_size != 0) && (blob_size > frag_max_payload()))
+			{
+				if (frag_send(blob, blob_size, MLX_BLOB_FPORT))
+				{
+					MYLOG("APP", "Thermal blob too big, sending fragments");
+					extra_sent = true;
+				}
+			}
+			else if (blob_size != 0)
+			{
+				if (send_lora_packet(blob, blob_size, MLX_BLOB_FPORT) == LMH_SUCCESS)
+				{
+					MYLOG("APP", "Thermal blob enqueued, %d bytes", blob_size);
+					extra_sent = true;
+				}
+				else
+				{
+					MYLOG("APP", "Thermal blob not sent");
+				}
+			}
+		}
+
+		// Time sync request or answer, only if the channel is free
+		if (g_lorawan_settings.lorawan_enable && !extra_sent && !frag_busy())
+		{
+			clock_sync_send();
+		}
+
+		// Refill the random number pool while the radio is idle
+		if (found_sensors[ECC_ID].found_sensor && random_low_rak5814())
+		{
+			refill_rak5814();
+		}
 	}
 
 	// LoRa data handling
@@ -968,6 +1190,7 @@ void lora_data_handler(void)
 				float batt_level_f = read_batt();
 				snprintf(disp_txt, 64, "Battery %.3fV", batt_level_f / 1000);
 				rak1921_add_line(disp_txt);
+				rak1921_show();
 			}
 		}
 		else
@@ -997,6 +1220,12 @@ void lora_data_handler(void)
 				}
 			}
 
+			// Check if downlink is for the time sync
+			if (g_last_fport == CLOCK_SYNC_FPORT)
+			{
+				clock_sync_handle(g_rx_lora_data, g_rx_data_len);
+			}
+
 			if (g_lorawan_settings.lorawan_enable)
 			{
 				AT_PRINTF("+EVT:RX_1, RSSI %d, SNR %d\n", g_last_rssi, g_last_snr);
@@ -1019,6 +1248,7 @@ void lora_data_handler(void)
 			}
 		}
 	}
+	i2c_unlock();
 }
 
 /**
@@ -0,0 +1,43 @@
+/**
+ * @file clock_sync.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the network clock synchronization
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef CLOCK_SYNC_H
+#define CLOCK_SYNC_H
+#include <Arduino.h>
+
+/** fPort of the LoRaWAN application layer clock synchronization */
+#define CLOCK_SYNC_FPORT 202
+/** Seconds from 2000-01-01 to the GPS epoch 1980-01-06 plus the leap seconds since 1980 */
+#define CLOCK_GPS_OFFSET (630720000UL + 18UL)
+/** Sync interval limits in seconds */
+#define CLOCK_SYNC_MIN 3600UL
+#define CLOCK_SYNC_MAX 604800UL
+#define CLOCK_SYNC_DEFAULT 86400UL
+/** Time before a request without answer is repeated in ms */
+#define CLOCK_RETRY 3600000UL
+/** Allowed clock error between two syncs in seconds, used to adapt the sync interval */
+#define CLOCK_MAX_ERROR 2
+/** Corrections larger than this in seconds are not used for the drift estimation */
+#define CLOCK_STEP_LIMIT 60
+/** Size of the buffer for answers to the server */
+#define CLOCK_ANSWER_SIZE 16
+
+bool clock_valid(void);
+uint32_t clock_get_epoch(void);
+uint32_t clock_get_unix(void);
+void clock_sync_send(void);
+void clock_sync_handle(uint8_t *data, uint16_t size);
+void clock_sync_force(void);
+extern int32_t g_clock_offset;
+extern float g_clock_drift;
+extern uint32_t g_clock_interval;
+extern bool g_clock_auto;
+
+#endif // CLOCK_SYNC_H
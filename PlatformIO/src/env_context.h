@@ -0,0 +1,31 @@
+/**
+ * @file env_context.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for the shared environment context
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef ENV_CONTEXT_H
+#define ENV_CONTEXT_H
+#include <Arduino.h>
+
+/** Sources publishing into the context, a higher value has priority */
+#define ENV_SRC_NONE 0
+#define ENV_SRC_RAK1906 1 // BME680, self heating, lower priority for T/RH
+#define ENV_SRC_RAK1901 2 // SHTC3
+#define ENV_SRC_RAK1902 2 // LPS22HB
+
+/** Oldest accepted value if no send interval is set, in ms */
+#define ENV_MAX_AGE_DEFAULT 600000
+
+void init_env_context(void);
+void env_publish_th(float temperature, float humidity, uint8_t source);
+void env_publish_p(float pressure, uint8_t source);
+bool env_get_th(float *temperature, float *humidity, uint32_t max_age);
+bool env_get_p(float *pressure, uint32_t max_age);
+uint32_t env_max_age(void);
+
+#endif // ENV_CONTEXT_H
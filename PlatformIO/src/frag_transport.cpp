@@ -0,0 +1,322 @@
+/**
+ * @file frag_transport.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Fragmented uplink of objects larger than one LoRaWAN frame
+ *        The object is split into fragments sized to the maximum payload
+ *        of the current data rate. After each group of data fragments an
+ *        optional XOR parity fragment is sent, the server can rebuild one
+ *        lost fragment per group.
+ *        One fragment is sent per TX cycle, the MAC delays the transmission
+ *        if the duty cycle requires it.
+ *
+ *        Fragment header:
+ *        [0] object id << 4 | parity group size (0 = no parity)
+ *        [1] 0x80 for parity fragments | data fragment index or group index
+ *        [2] number of data fragments
+ *        [3] size of the last data fragment
+ *        [4] fPort of the object
+ *        Data fragments except the last and parity fragments have the same size.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Parity group size */
+uint8_t g_frag_group = FRAG_GROUP_DEFAULT;
+/** Gap between two fragments in seconds */
+uint16_t g_frag_gap = FRAG_GAP_DEFAULT;
+
+/** Object being sent */
+static uint8_t frag_object[FRAG_MAX_OBJECT];
+/** Size of the object */
+static uint16_t frag_object_size = 0;
+/** fPort of the object */
+static uint8_t frag_object_port = 0;
+/** Object id, increments with every object */
+static uint8_t frag_object_id = 0;
+/** Data bytes per fragment */
+static uint8_t frag_size = 0;
+/** Number of data fragments */
+static uint8_t frag_count = 0;
+/** Parity group size used for the object */
+static uint8_t frag_group = 0;
+/** Next fragment, counts data and parity fragments in sending order */
+static uint16_t frag_pos = 0;
+/** Total number of fragments including parity */
+static uint16_t frag_total = 0;
+/** Flag if a transfer is running */
+static volatile bool frag_active = false;
+/** Flag if the MAC rejected the fragment size once already */
+static bool frag_resized = false;
+
+/** Buffer for one fragment */
+static uint8_t frag_buffer[FRAG_HEADER_SIZE + 255];
+
+/** Timer for the next fragment */
+#ifdef NRF52_SERIES
+SoftwareTimer frag_timer;
+/** Flag if the timer was created */
+static bool frag_timer_ready = false;
+#endif
+#ifdef ESP32
+Ticker frag_timer;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+mbed::Ticker frag_timer;
+#endif
+
+/**
+ * @brief Timer callback to wake up the loop for the next fragment
+ *
+ */
+#ifdef NRF52_SERIES
+void frag_wakeup(TimerHandle_t unused)
+{
+	api_wake_loop(FRAG_REQ);
+}
+#endif
+#if defined ESP32 || defined ARDUINO_ARCH_RP2040
+void frag_wakeup(void)
+{
+	frag_timer.detach();
+	api_wake_loop(FRAG_REQ);
+}
+#endif
+
+/**
+ * @brief Start the timer for the next fragment
+ *
+ * @param delay_ms delay in ms
+ */
+static void frag_schedule(uint32_t delay_ms)
+{
+#ifdef NRF52_SERIES
+	frag_timer.stop();
+	frag_timer.setPeriod(delay_ms);
+	frag_timer.start();
+#endif
+#ifdef ESP32
+	frag_timer.detach();
+	frag_timer.attach_ms(delay_ms, frag_wakeup);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	frag_timer.detach();
+	frag_timer.attach(frag_wakeup, (microseconds)(delay_ms * 1000));
+#endif
+}
+
+/**
+ * @brief Get the maximum payload size of the current data rate
+ *     Pending MAC commands are taken into account by the MAC
+ *
+ * @return uint8_t maximum payload size
+ */
+uint8_t frag_max_payload(void)
+{
+	LoRaMacTxInfo_t tx_info;
+	if ((LoRaMacQueryTxPossible(0, &tx_info) != LORAMAC_STATUS_OK) || (tx_info.MaxPossiblePayload < FRAG_MIN_PAYLOAD))
+	{
+		return FRAG_MIN_PAYLOAD;
+	}
+	return tx_info.MaxPossiblePayload;
+}
+
+/**
+ * @brief Split the object into fragments for the current data rate
+ *
+ * @return true fragments fit into the limits
+ * @return false object is too large for the current data rate
+ */
+static bool frag_prepare(void)
+{
+	frag_size = frag_max_payload() - FRAG_HEADER_SIZE;
+	uint16_t count = (frag_object_size + frag_size - 1) / frag_size;
+	if (count > FRAG_MAX_FRAGMENTS)
+	{
+		MYLOG("FRAG", "%d bytes need %d fragments", frag_object_size, count);
+		return false;
+	}
+	frag_count = count;
+	frag_group = g_frag_group;
+	uint16_t num_groups = frag_group == 0 ? 0 : (frag_count + frag_group - 1) / frag_group;
+	frag_total = frag_count + num_groups;
+	frag_pos = 0;
+	frag_object_id = (frag_object_id + 1) & 0x0F;
+	MYLOG("FRAG", "Object %d, %d bytes, %d fragments of %d bytes, %d parity", frag_object_id, frag_object_size, frag_count, frag_size, num_groups);
+	return true;
+}
+
+/**
+ * @brief Build a fragment into frag_buffer
+ *
+ * @param pos position in sending order
+ * @return uint8_t size of the fragment including the header
+ */
+static uint8_t frag_build(uint16_t pos)
+{
+	// Sending order is data fragments of a group followed by its parity fragment
+	uint16_t group_len = frag_group == 0 ? frag_total : frag_group + 1;
+	uint16_t group = pos / group_len;
+	uint16_t in_group = pos % group_len;
+	uint16_t first = group * (group_len - (frag_group == 0 ? 0 : 1));
+	bool parity = (frag_group != 0) && ((in_group == frag_group) || (first + in_group >= frag_count));
+	uint8_t last_size = frag_object_size - (frag_count - 1) * frag_size;
+
+	frag_buffer[0] = (frag_object_id << 4) | frag_group;
+	frag_buffer[2] = frag_count;
+	frag_buffer[3] = last_size;
+	frag_buffer[4] = frag_object_port;
+	uint8_t *payload = &frag_buffer[FRAG_HEADER_SIZE];
+
+	if (!parity)
+	{
+		uint16_t index = first + in_group;
+		uint8_t len = index == frag_count - 1 ? last_size : frag_size;
+		frag_buffer[1] = index;
+		memcpy(payload, &frag_object[index * frag_size], len);
+		return FRAG_HEADER_SIZE + len;
+	}
+
+	// XOR of the data fragments of the group, the last fragment is padded with 0
+	frag_buffer[1] = 0x80 | group;
+	memset(payload, 0, frag_size);
+	for (uint16_t index = first; (index < first + frag_group) && (index < frag_count); index++)
+	{
+		uint8_t len = index == frag_count - 1 ? last_size : frag_size;
+		const uint8_t *data = &frag_object[index * frag_size];
+		for (uint8_t idx = 0; idx < len; idx++)
+		{
+			payload[idx] ^= data[idx];
+		}
+	}
+	return FRAG_HEADER_SIZE + frag_size;
+}
+
+/**
+ * @brief Start sending an object in fragments
+ *
+ * @param data object
+ * @param size object size
+ * @param fport fPort the object would have been sent on
+ * @return true transfer started
+ * @return false transfer running or object too large
+ */
+bool frag_send(const uint8_t *data, uint16_t size, uint8_t fport)
+{
+	if (frag_active || (size == 0) || (size > FRAG_MAX_OBJECT))
+	{
+		return false;
+	}
+	memcpy(frag_object, data, size);
+	frag_object_size = size;
+	frag_object_port = fport;
+	frag_resized = false;
+	if (!frag_prepare())
+	{
+		return false;
+	}
+
+#ifdef NRF52_SERIES
+	if (!frag_timer_ready)
+	{
+		frag_timer.begin(1000, frag_wakeup, NULL, false);
+		frag_timer_ready = true;
+	}
+#endif
+	frag_active = true;
+	frag_next();
+	return true;
+}
+
+/**
+ * @brief Send the next fragment, called on FRAG_REQ
+ *
+ */
+void frag_next(void)
+{
+	if (!frag_active)
+	{
+		return;
+	}
+
+	uint8_t len = frag_build(frag_pos);
+	lmh_error_status result = send_lora_packet(frag_buffer, len, FRAG_FPORT);
+	switch (result)
+	{
+	case LMH_SUCCESS:
+		MYLOG("FRAG", "Fragment %d/%d enqueued", frag_pos + 1, frag_total);
+		frag_pos++;
+		break;
+	case LMH_BUSY:
+		MYLOG("FRAG", "LoRa transceiver is busy, retry");
+		frag_schedule((uint32_t)g_frag_gap * 1000);
+		break;
+	case LMH_ERROR:
+		// The data rate was lowered, restart once with smaller fragments
+		if (!frag_resized && (frag_max_payload() - FRAG_HEADER_SIZE < frag_size) && frag_prepare())
+		{
+			frag_resized = true;
+			frag_schedule((uint32_t)g_frag_gap * 1000);
+		}
+		else
+		{
+			MYLOG("FRAG", "Fragment too big for current DR, object dropped");
+			AT_PRINTF("+EVT:FRAG_FAIL\n");
+			frag_active = false;
+		}
+		break;
+	}
+}
+
+/**
+ * @brief Schedule the next fragment after a finished TX cycle
+ *
+ */
+void frag_tx_finished(void)
+{
+	if (!frag_active)
+	{
+		return;
+	}
+	if (frag_pos >= frag_total)
+	{
+		MYLOG("FRAG", "Object %d sent", frag_object_id);
+		AT_PRINTF("+EVT:FRAG_DONE\n");
+		frag_active = false;
+		return;
+	}
+	frag_schedule((uint32_t)g_frag_gap * 1000);
+}
+
+/**
+ * @brief Check if a transfer is running
+ *
+ * @return true fragments are pending
+ * @return false no transfer
+ */
+bool frag_busy(void)
+{
+	return frag_active;
+}
+
+/**
+ * @brief Set the parity group size and the gap between fragments
+ *
+ * @param new_group data fragments per parity fragment, 0 = no parity
+ * @param new_gap gap between fragments in seconds
+ * @return true settings are valid
+ * @return false settings are out of range
+ */
+bool set_frag(uint8_t new_group, uint16_t new_gap)
+{
+	if ((new_group > FRAG_GROUP_MAX) || (new_gap < FRAG_GAP_MIN) || (new_gap > FRAG_GAP_MAX))
+	{
+		return false;
+	}
+	g_frag_group = new_group;
+	g_frag_gap = new_gap;
+	return true;
+}
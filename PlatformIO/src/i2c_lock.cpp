@@ -0,0 +1,56 @@
+/**
+ * @file i2c_lock.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Shared I2C bus lock
+ *        Wire is not thread safe. The app loop and every sensor task that
+ *        talks to a module on the I2C bus hold this lock for the whole transfer
+ *        sequence. The lock is recursive, a holder can call functions that
+ *        take it again.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+#if defined NRF52_SERIES || defined ESP32
+/** Bus access from the app loop and the sensor tasks */
+static SemaphoreHandle_t i2c_mutex = NULL;
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+/** Bus access from the app loop and the sensor threads, mbed mutexes are recursive */
+static Mutex i2c_mutex;
+#endif
+
+/**
+ * @brief Lock the I2C bus
+ *
+ */
+void i2c_lock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	if (i2c_mutex == NULL)
+	{
+		i2c_mutex = xSemaphoreCreateRecursiveMutex();
+	}
+	xSemaphoreTakeRecursive(i2c_mutex, portMAX_DELAY);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	i2c_mutex.lock();
+#endif
+}
+
+/**
+ * @brief Unlock the I2C bus
+ *
+ */
+void i2c_unlock(void)
+{
+#if defined NRF52_SERIES || defined ESP32
+	xSemaphoreGiveRecursive(i2c_mutex);
+#endif
+#ifdef ARDUINO_ARCH_RP2040
+	i2c_mutex.unlock();
+#endif
+}
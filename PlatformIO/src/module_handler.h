@@ -18,8 +18,8 @@
 #define N_MOTION_TRIGGER    0b0111111111111111
 #define GNSS_FIN            0b0100000000000000
 #define N_GNSS_FIN          0b1011111111111111
-#define VOC_REQ             0b0010000000000000
-#define N_VOC_REQ           0b1101111111111111
+#define FRAG_REQ            0b0010000000000000
+#define N_FRAG_REQ          0b1101111111111111
 #define TOUCH_EVENT         0b0001000000000000
 #define N_TOUCH_EVENT       0b1110111111111111
 #define SEISMIC_EVENT       0b0000100000000000
@@ -28,6 +28,10 @@
 #define N_SEISMIC_ALERT     0b1111101111111111
 #define BSEC_REQ            0b0000001000000000
 #define N_BSEC_REQ          0b1111110111111111
+#define WL_ALERT            0b0000000100000000
+#define N_WL_ALERT          0b1111111011111111
+#define SENSOR_REQ          0b0000000010000000
+#define N_SENSOR_REQ        0b1111111101111111
 
 typedef struct sensors_s
 {
@@ -91,6 +95,26 @@ extern sensors_t found_sensors[];
 #define LPP_CHANNEL_WLEVEL 61		   // RAK12059
 #define LPP_CHANNEL_WL_LOW 62		   // RAK12059
 #define LPP_CHANNEL_WL_HIGH 63		   // RAK12059
+#define LPP_CHANNEL_VIB_RMS 64		   // RAK1904
+#define LPP_CHANNEL_VIB_PEAK 65		   // RAK1904
+#define LPP_CHANNEL_VIB_CREST 66	   // RAK1904
+#define LPP_CHANNEL_VIB_FREQ 67		   // RAK1904
+#define LPP_CHANNEL_ROLL 68		   // RAK1905 / RAK12034
+#define LPP_CHANNEL_PITCH 69	   // RAK1905 / RAK12034
+#define LPP_CHANNEL_YAW 70		   // RAK1905 / RAK12034
+#define LPP_CHANNEL_CURRENT_CHARGE 71 // RAK16000
+#define LPP_CHANNEL_CURRENT_ENERGY 72 // RAK16000
+#define LPP_CHANNEL_CURRENT_PEAK 73   // RAK16000
+#define LPP_CHANNEL_CO2_AGE 74		   // RAK12037
+#define LPP_CHANNEL_PM_AWAKE 75	   // RAK12039
+#define LPP_CHANNEL_PM_FRAMES 76	   // RAK12039
+#define LPP_CHANNEL_TARR_MIN 77	   // RAK12040
+#define LPP_CHANNEL_TARR_MAX 78	   // RAK12040
+#define LPP_CHANNEL_TARR_MEAN 79	   // RAK12040
+#define LPP_CHANNEL_TARR_HOT_X 80	   // RAK12040
+#define LPP_CHANNEL_TARR_HOT_Y 81	   // RAK12040
+#define LPP_CHANNEL_TARR_PERSONS 82 // RAK12040
+#define LPP_CHANNEL_TIME 83		   // RAK12002
 
 extern WisCayenne g_solution_data;
 
@@ -126,6 +150,7 @@ extern WisCayenne g_solution_data;
 #define PM_ID 28		  // RAK12039 particle matter sensor
 #define SEISM_ID 29		  // RAK12027 D7S seismic sensor
 #define WATER_LEVEL_ID 30 // RAK12059 Water Level sensor
+#define ECC_ID 40		  // RAK5814 ATECC608 crypto module
 #define TEMP_ARR_2_ID 41	  // RAK12040 Temp Array sensor
 
 /** Sensor functions */
@@ -187,6 +212,17 @@ typedef struct touch_area_s
 #endif // ARDUINO_ARCH_RP2040
 #include "RAK16000_current.h"
 #include "RAK12059_wl.h"
+#include "vib_features.h"
+#include "imu_pipeline.h"
+#include "imu_fusion.h"
+#include "env_context.h"
+#include "i2c_lock.h"
+#include "mqx_engine.h"
+#include "thermal_analytics.h"
+#include "frag_transport.h"
+#include "uplink_packer.h"
+#include "clock_sync.h"
+#include "payload_auth.h"
 
 #include "user_at_cmd.h"
 
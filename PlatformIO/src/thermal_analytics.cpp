@@ -0,0 +1,493 @@
+/**
+ * @file thermal_analytics.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Analytics for thermal array frames (min/max/mean, background,
+ *        hotspot location and person count).
+ *        Frames are fixed point in 0.01 degree C, the calculation uses
+ *        only integer math and static buffers.
+ *        Persons are counted as 4-connected blobs of pixels that are
+ *        warmer than the background (median) by a configurable delta.
+ *        For uplinks a frame is reduced to a coarse grid, a hotspot list
+ *        and a histogram and packed into a quantized, delta coded blob.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "app.h"
+
+/** Copy of the frame for the median search */
+static int16_t scratch[THERMAL_MAX_PIXELS];
+/** Flags for pixels already assigned to a blob */
+static uint8_t visited[THERMAL_MAX_PIXELS];
+/** Stack for the flood fill */
+static uint16_t fill_stack[THERMAL_MAX_PIXELS];
+
+/**
+ * @brief Find the median with Wirth's selection algorithm
+ *     The buffer is reordered
+ *
+ * @param values buffer with the values
+ * @param num_values number of values
+ * @return int16_t median
+ */
+static int16_t find_median(int16_t *values, uint16_t num_values)
+{
+	int32_t k = num_values / 2;
+	int32_t left = 0;
+	int32_t right = num_values - 1;
+	while (left < right)
+	{
+		int16_t pivot = values[k];
+		int32_t i = left;
+		int32_t j = right;
+		do
+		{
+			while (values[i] < pivot)
+			{
+				i++;
+			}
+			while (pivot < values[j])
+			{
+				j--;
+			}
+			if (i <= j)
+			{
+				int16_t temp = values[i];
+				values[i] = values[j];
+				values[j] = temp;
+				i++;
+				j--;
+			}
+		} while (i <= j);
+		if (j < k)
+		{
+			left = i;
+		}
+		if (k < i)
+		{
+			right = j;
+		}
+	}
+	return values[k];
+}
+
+/**
+ * @brief Measure a blob of warm pixels with a flood fill
+ *
+ * @param frame frame data
+ * @param width frame width
+ * @param height frame height
+ * @param start index of the first pixel of the blob
+ * @param threshold minimum temperature of a warm pixel
+ * @return uint16_t number of pixels in the blob
+ */
+static uint16_t fill_blob(const int16_t *frame, uint8_t width, uint8_t height, uint16_t start, int16_t threshold)
+{
+	uint16_t stack_size = 0;
+	uint16_t blob_size = 0;
+	fill_stack[stack_size++] = start;
+	visited[start] = 1;
+	while (stack_size > 0)
+	{
+		uint16_t idx = fill_stack[--stack_size];
+		blob_size++;
+		uint8_t x = idx % width;
+		uint8_t y = idx / width;
+		// Check the 4 neighbours
+		uint16_t neighbours[4];
+		uint8_t num_neighbours = 0;
+		if (x > 0)
+		{
+			neighbours[num_neighbours++] = idx - 1;
+		}
+		if (x < width - 1)
+		{
+			neighbours[num_neighbours++] = idx + 1;
+		}
+		if (y > 0)
+		{
+			neighbours[num_neighbours++] = idx - width;
+		}
+		if (y < height - 1)
+		{
+			neighbours[num_neighbours++] = idx + width;
+		}
+		for (uint8_t n = 0; n < num_neighbours; n++)
+		{
+			uint16_t next = neighbours[n];
+			if (!visited[next] && (frame[next] >= threshold))
+			{
+				// Each pixel is pushed only once, the stack cannot overflow
+				visited[next] = 1;
+				fill_stack[stack_size++] = next;
+			}
+		}
+	}
+	return blob_size;
+}
+
+/**
+ * @brief Sub pixel offset of a peak from a parabola through three neighbouring pixels
+ *
+ * @param before pixel left of or above the peak
+ * @param peak warmest pixel
+ * @param after pixel right of or below the peak
+ * @return int16_t offset of the vertex in 1/THERMAL_SUBPIXEL pixels, -THERMAL_SUBPIXEL/2 to THERMAL_SUBPIXEL/2
+ */
+static int16_t peak_offset(int16_t before, int16_t peak, int16_t after)
+{
+	int32_t den = 2 * (2 * (int32_t)peak - before - after);
+	if (den <= 0)
+	{
+		// Flat, the vertex is not defined
+		return 0;
+	}
+	int32_t num = THERMAL_SUBPIXEL * ((int32_t)after - before);
+	// Round to the nearest sub pixel
+	return (int16_t)(num >= 0 ? (num + den / 2) / den : -((-num + den / 2) / den));
+}
+
+/**
+ * @brief Analyze a thermal frame
+ *
+ * @param frame frame data in 0.01 degree C, row by row
+ * @param width frame width
+ * @param height frame height
+ * @param params analytics settings
+ * @param result pointer to the result structure
+ * @return true analytics done
+ * @return false frame too large or empty
+ */
+bool thermal_analyze(const int16_t *frame, uint8_t width, uint8_t height, const thermal_params_t *params, thermal_result_t *result)
+{
+	uint16_t num_pixels = (uint16_t)width * height;
+	if ((num_pixels == 0) || (num_pixels > THERMAL_MAX_PIXELS))
+	{
+		return false;
+	}
+
+	// Min, max and mean
+	int32_t sum = 0;
+	uint16_t max_idx = 0;
+	result->min = frame[0];
+	result->max = frame[0];
+	for (uint16_t idx = 0; idx < num_pixels; idx++)
+	{
+		sum += frame[idx];
+		if (frame[idx] < result->min)
+		{
+			result->min = frame[idx];
+		}
+		if (frame[idx] > result->max)
+		{
+			result->max = frame[idx];
+			max_idx = idx;
+		}
+	}
+	result->mean = (int16_t)(sum / num_pixels);
+
+	// Background is the median, it is not shifted by a few warm pixels like the mean
+	memcpy(scratch, frame, num_pixels * sizeof(int16_t));
+	result->background = find_median(scratch, num_pixels);
+
+	// Hotspot, the vertex of a parabola through the warmest pixel and its neighbours
+	// gives the location with sub pixel resolution. Pixels on the border are not refined
+	// in the direction without neighbour.
+	uint8_t hot_x = max_idx % width;
+	uint8_t hot_y = max_idx / width;
+	result->hot_x = hot_x * THERMAL_SUBPIXEL;
+	result->hot_y = hot_y * THERMAL_SUBPIXEL;
+	if (params->subpixel)
+	{
+		if ((hot_x > 0) && (hot_x < width - 1))
+		{
+			result->hot_x += peak_offset(frame[max_idx - 1], frame[max_idx], frame[max_idx + 1]);
+		}
+		if ((hot_y > 0) && (hot_y < height - 1))
+		{
+			result->hot_y += peak_offset(frame[max_idx - width], frame[max_idx], frame[max_idx + width]);
+		}
+	}
+
+	// Count blobs of warm pixels
+	int16_t threshold = result->background + params->person_delta;
+	memset(visited, 0, num_pixels);
+	result->persons = 0;
+	for (uint16_t idx = 0; idx < num_pixels; idx++)
+	{
+		if (!visited[idx] && (frame[idx] >= threshold))
+		{
+			if ((fill_blob(frame, width, height, idx, threshold) >= params->min_blob) && (result->persons < 0xFF))
+			{
+				result->persons++;
+			}
+		}
+	}
+	return true;
+}
+
+/**
+ * @brief Downsample a frame by averaging blocks of pixels
+ *     width and height must be multiples of block
+ *
+ * @param frame frame data
+ * @param width frame width
+ * @param height frame height
+ * @param block size of the averaged blocks
+ * @param out buffer for (width / block) * (height / block) values
+ */
+void thermal_downsample(const int16_t *frame, uint8_t width, uint8_t height, uint8_t block, int16_t *out)
+{
+	uint8_t out_width = width / block;
+	uint8_t out_height = height / block;
+	int32_t area = (int32_t)block * block;
+	for (uint8_t out_y = 0; out_y < out_height; out_y++)
+	{
+		for (uint8_t out_x = 0; out_x < out_width; out_x++)
+		{
+			int32_t sum = 0;
+			for (uint8_t y = 0; y < block; y++)
+			{
+				const int16_t *row = &frame[(out_y * block + y) * width + out_x * block];
+				for (uint8_t x = 0; x < block; x++)
+				{
+					sum += row[x];
+				}
+			}
+			out[out_y * out_width + out_x] = (int16_t)(sum / area);
+		}
+	}
+}
+
+/**
+ * @brief Find the warmest local maxima of a frame
+ *     A pixel is a local maximum if no 8-connected neighbour is warmer
+ *
+ * @param frame frame data
+ * @param width frame width
+ * @param height frame height
+ * @param threshold minimum temperature of a hotspot
+ * @param spots buffer for the hotspots, sorted from warmest to coldest
+ * @param max_spots size of the buffer
+ * @return uint8_t number of hotspots found
+ */
+uint8_t thermal_hotspots(const int16_t *frame, uint8_t width, uint8_t height, int16_t threshold, thermal_hotspot_t *spots, uint8_t max_spots)
+{
+	uint8_t num_spots = 0;
+	for (uint8_t y = 0; y < height; y++)
+	{
+		for (uint8_t x = 0; x < width; x++)
+		{
+			int16_t temp = frame[y * width + x];
+			if (temp < threshold)
+			{
+				continue;
+			}
+			bool is_max = true;
+			for (int8_t dy = -1; (dy <= 1) && is_max; dy++)
+			{
+				for (int8_t dx = -1; dx <= 1; dx++)
+				{
+					int16_t nx = x + dx;
+					int16_t ny = y + dy;
+					if (((dx == 0) && (dy == 0)) || (nx < 0) || (ny < 0) || (nx >= width) || (ny >= height))
+					{
+						continue;
+					}
+					if (frame[ny * width + nx] > temp)
+					{
+						is_max = false;
+						break;
+					}
+				}
+			}
+			if (!is_max)
+			{
+				continue;
+			}
+
+			// Insert sorted, drop the coldest if the list is full
+			uint8_t pos = (num_spots < max_spots) ? num_spots++ : max_spots;
+			while ((pos > 0) && (spots[pos - 1].temp < temp))
+			{
+				if (pos < max_spots)
+				{
+					spots[pos] = spots[pos - 1];
+				}
+				pos--;
+			}
+			if (pos < max_spots)
+			{
+				spots[pos].x = x;
+				spots[pos].y = y;
+				spots[pos].temp = temp;
+			}
+		}
+	}
+	return num_spots;
+}
+
+/**
+ * @brief Calculate a histogram of the frame between min and max
+ *
+ * @param frame frame data
+ * @param num_pixels number of pixels
+ * @param min lower limit of the first bin
+ * @param max upper limit of the last bin
+ * @param bins buffer for the bins, share of the pixels scaled to 0 to 255
+ * @param num_bins number of bins
+ */
+void thermal_histogram(const int16_t *frame, uint16_t num_pixels, int16_t min, int16_t max, uint8_t *bins, uint8_t num_bins)
+{
+	uint16_t counts[num_bins];
+	memset(counts, 0, sizeof(counts));
+	int32_t range = (int32_t)max - min + 1;
+	for (uint16_t idx = 0; idx < num_pixels; idx++)
+	{
+		int32_t bin = ((int32_t)frame[idx] - min) * num_bins / range;
+		bin = bin < 0 ? 0 : (bin >= num_bins ? num_bins - 1 : bin);
+		counts[bin]++;
+	}
+	for (uint8_t bin = 0; bin < num_bins; bin++)
+	{
+		bins[bin] = (uint8_t)(((uint32_t)counts[bin] * 255 + num_pixels / 2) / num_pixels);
+	}
+}
+
+/**
+ * @brief Quantize a temperature to a level of the packed frame
+ *
+ * @param temp temperature in 0.01 degree C
+ * @param base temperature of level 0 in 0.1 degree C
+ * @param step temperature step per level in 0.1 degree C
+ * @return uint8_t level
+ */
+static uint8_t quantize(int16_t temp, int16_t base, uint8_t step)
+{
+	int32_t level = (((int32_t)temp + 5) / 10 - base + step / 2) / step;
+	return level < 0 ? 0 : (level > 255 ? 255 : level);
+}
+
+/**
+ * @brief Pack the reduced frame into a blob
+ *     Format, multi byte values are big endian:
+ *     [0]    version << 4 | section flags (THERMAL_PACK_xxx)
+ *     [1..2] base, minimum temperature in 0.1 degree C
+ *     [3]    step, temperature per level in 0.1 degree C
+ *     [4]    number of persons
+ *     Grid:      [width << 4 | height] [first level] then one 4 bit signed delta per cell
+ *                in row order, a delta of -8 is an escape followed by the level in two nibbles.
+ *                The last byte is padded with 0 nibbles
+ *     Hotspots:  [count] then per hotspot [x << 5 | y] as 2 bytes and the level
+ *     Histogram: [count] then one byte per bin, share of the pixels scaled to 0 to 255
+ *     Sections are added in this order as long as they fit into max_size.
+ *
+ * @param result analytics result
+ * @param grid downsampled frame
+ * @param grid_width grid width, max 15
+ * @param grid_height grid height, max 15
+ * @param spots hotspot list
+ * @param num_spots number of hotspots
+ * @param bins histogram
+ * @param num_bins number of bins
+ * @param blob buffer for the packed frame
+ * @param max_size size of the buffer, maximum payload size
+ * @return uint8_t size of the packed frame, 0 if not even the header fits
+ */
+uint8_t thermal_pack(const thermal_result_t *result, const int16_t *grid, uint8_t grid_width, uint8_t grid_height,
+					 const thermal_hotspot_t *spots, uint8_t num_spots, const uint8_t *bins, uint8_t num_bins,
+					 uint8_t *blob, uint8_t max_size)
+{
+	if (max_size < 5)
+	{
+		return 0;
+	}
+
+	// Levels cover min to max with a step of at least 0.1 degree C
+	int16_t base = (result->min - 5) / 10;
+	int32_t range = ((int32_t)result->max + 5) / 10 - base;
+	uint8_t step = (range + 254) / 255;
+	step = step == 0 ? 1 : step;
+
+	uint8_t flags = 0;
+	blob[1] = (uint8_t)(base >> 8);
+	blob[2] = (uint8_t)(base & 0xFF);
+	blob[3] = step;
+	blob[4] = result->persons;
+	uint8_t size = 5;
+
+	// Grid as nibble stream, packed into a scratch buffer first to check the size
+	// Worst case is an escape with 3 nibbles for each cell of a 15 x 15 grid
+	uint8_t grid_blob[2 + (15 * 15 * 3 + 1) / 2];
+	uint16_t nibbles = 0;
+	uint16_t num_cells = (uint16_t)grid_width * grid_height;
+	grid_blob[0] = (grid_width << 4) | (grid_height & 0x0F);
+	uint8_t last = quantize(grid[0], base, step);
+	grid_blob[1] = last;
+	for (uint16_t cell = 1; cell < num_cells; cell++)
+	{
+		uint8_t level = quantize(grid[cell], base, step);
+		int16_t delta = (int16_t)level - last;
+		uint8_t codes[3];
+		uint8_t num_codes = 0;
+		if ((delta >= -7) && (delta <= 7))
+		{
+			codes[num_codes++] = delta & 0x0F;
+		}
+		else
+		{
+			codes[num_codes++] = 0x08;
+			codes[num_codes++] = level >> 4;
+			codes[num_codes++] = level & 0x0F;
+		}
+		for (uint8_t code = 0; code < num_codes; code++)
+		{
+			uint16_t pos = 2 + nibbles / 2;
+			if ((nibbles & 1) == 0)
+			{
+				grid_blob[pos] = codes[code] << 4;
+			}
+			else
+			{
+				grid_blob[pos] |= codes[code];
+			}
+			nibbles++;
+		}
+		last = level;
+	}
+	uint16_t grid_size = 2 + (nibbles + 1) / 2;
+	if ((num_cells > 0) && (size + grid_size <= max_size))
+	{
+		memcpy(&blob[size], grid_blob, grid_size);
+		size += grid_size;
+		flags |= THERMAL_PACK_GRID;
+	}
+
+	// Hotspots
+	if ((num_spots > 0) && (size + 1 + num_spots * 3 <= max_size))
+	{
+		blob[size++] = num_spots;
+		for (uint8_t spot = 0; spot < num_spots; spot++)
+		{
+			uint16_t pos = ((uint16_t)spots[spot].x << 5) | (spots[spot].y & 0x1F);
+			blob[size++] = (uint8_t)(pos >> 8);
+			blob[size++] = (uint8_t)(pos & 0xFF);
+			blob[size++] = quantize(spots[spot].temp, base, step);
+		}
+		flags |= THERMAL_PACK_HOTSPOTS;
+	}
+
+	// Histogram
+	if ((num_bins > 0) && (size + 1 + num_bins <= max_size))
+	{
+		blob[size++] = num_bins;
+		memcpy(&blob[size], bins, num_bins);
+		size += num_bins;
+		flags |= THERMAL_PACK_HISTOGRAM;
+	}
+
+	blob[0] = (THERMAL_PACK_VERSION << 4) | flags;
+	return size;
+}
@@ -0,0 +1,63 @@
+/**
+ * @file thermal_analytics.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Global definitions and forward declarations for thermal frame analytics
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef THERMAL_ANALYTICS_H
+#define THERMAL_ANALYTICS_H
+#include <Arduino.h>
+
+/** Largest frame that can be analyzed, 32 x 24 pixels of the MLX90640 */
+#define THERMAL_MAX_PIXELS 768
+/** Hotspot coordinates are given in 1/THERMAL_SUBPIXEL pixels */
+#define THERMAL_SUBPIXEL 4
+
+/** Version of the packed frame format */
+#define THERMAL_PACK_VERSION 1
+/** Flags for the sections in the packed frame */
+#define THERMAL_PACK_GRID 0x01
+#define THERMAL_PACK_HOTSPOTS 0x02
+#define THERMAL_PACK_HISTOGRAM 0x04
+
+/** Analytics settings */
+typedef struct thermal_params_s
+{
+	int16_t person_delta; // Minimum difference to the background for a warm pixel in 0.01 degree C
+	uint16_t min_blob;	  // Minimum number of connected warm pixels counted as a person
+	bool subpixel;		  // Locate the hotspot with sub pixel resolution by a parabolic fit
+} thermal_params_t;
+
+/** Analytics result, temperatures in 0.01 degree C */
+typedef struct thermal_result_s
+{
+	int16_t min;
+	int16_t max;
+	int16_t mean;
+	int16_t background; // Median of the frame
+	uint16_t hot_x;		// Hotspot column in 1/THERMAL_SUBPIXEL pixels
+	uint16_t hot_y;		// Hotspot row in 1/THERMAL_SUBPIXEL pixels
+	uint8_t persons;	// Number of warm blobs
+} thermal_result_t;
+
+/** Local temperature maximum */
+typedef struct thermal_hotspot_s
+{
+	uint8_t x;
+	uint8_t y;
+	int16_t temp; // in 0.01 degree C
+} thermal_hotspot_t;
+
+bool thermal_analyze(const int16_t *frame, uint8_t width, uint8_t height, const thermal_params_t *params, thermal_result_t *result);
+void thermal_downsample(const int16_t *frame, uint8_t width, uint8_t height, uint8_t block, int16_t *out);
+uint8_t thermal_hotspots(const int16_t *frame, uint8_t width, uint8_t height, int16_t threshold, thermal_hotspot_t *spots, uint8_t max_spots);
+void thermal_histogram(const int16_t *frame, uint16_t num_pixels, int16_t min, int16_t max, uint8_t *bins, uint8_t num_bins);
+uint8_t thermal_pack(const thermal_result_t *result, const int16_t *grid, uint8_t grid_width, uint8_t grid_height,
+					 const thermal_hotspot_t *spots, uint8_t num_spots, const uint8_t *bins, uint8_t num_bins,
+					 uint8_t *blob, uint8_t max_size);
+
+#endif // THERMAL_ANALYTICS_H
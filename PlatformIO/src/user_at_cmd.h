@@ -12,6 +12,9 @@
 #define USER_AT_CMD_H
 #include <Arduino.h>
 
+// Settings storage shared by the app loop and the sensor tasks
+void init_settings_lock(void);
+
 // Battery AT command
 void read_batt_settings(void);
 void save_batt_settings(bool check_batt_enables);
@@ -25,6 +28,46 @@ union batt_s
 	uint8_t batt8[2];
 };
 
+// Vibration analysis AT command
+void read_vib_settings(void);
+void save_vib_settings(void);
+
+// Orientation fusion AT command
+void read_fusion_settings(void);
+void save_fusion_settings(void);
+
+// ToF sensor AT command
+void read_tof_settings(void);
+void save_tof_settings(void);
+
+// Current sensor AT command
+void read_ina_settings(void);
+void save_ina_settings(void);
+void read_pms_settings(void);
+void save_pms_settings(void);
+void read_tblob_settings(void);
+void save_tblob_settings(void);
+void read_mqx_settings(void);
+void save_mqx_settings(void);
+void read_frag_settings(void);
+void save_frag_settings(void);
+void read_pack_settings(void);
+void save_pack_settings(void);
+void read_align_settings(void);
+void save_align_settings(void);
+void read_tsync_settings(void);
+void save_tsync_settings(void);
+void read_auth_settings(void);
+void save_auth_settings(void);
+bool read_voc_state(voc_state_s *state);
+void save_voc_state(voc_state_s *state);
+#if USE_BSEC == 1
+void read_bsec_settings(void);
+void save_bsec_settings(void);
+bool read_bsec_state(uint8_t *state, uint16_t size, uint8_t *accuracy);
+void save_bsec_state(uint8_t *state, uint16_t size, uint8_t accuracy);
+#endif
+
 // Sleep AT command
 extern bool g_device_sleep;
 int at_wake(void);
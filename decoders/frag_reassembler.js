@@ -0,0 +1,180 @@
+/**
+ * @file frag_reassembler.js
+ * @brief Network side reassembler for the fragmented uplinks on fPort 13
+ *        Collects the fragments of an object, rebuilds one lost data fragment
+ *        per group from the XOR parity fragment and returns the original
+ *        packet with its fPort once it is complete.
+ *
+ *        Fragment header:
+ *        [0] object id << 4 | parity group size (0 = no parity)
+ *        [1] 0x80 for parity fragments | data fragment index or group index
+ *        [2] number of data fragments
+ *        [3] size of the last data fragment
+ *        [4] fPort of the object
+ *        Data fragments except the last and parity fragments have the same size.
+ *
+ *        The reassembler keeps state between uplinks, it cannot run as a
+ *        stateless payload formatter. Use one instance per device in the
+ *        application that receives the uplinks (Node-RED, MQTT client, ...).
+ *
+ *        Usage:
+ *        const FragReassembler = require('./frag_reassembler.js');
+ *        const reassembler = new FragReassembler();
+ *        // for every uplink on fPort 13 of the device
+ *        const result = reassembler.add(bytes, fCnt);
+ *        if (result) {
+ *            // result.fPort and result.bytes are the original packet,
+ *            // decode them with the Cayenne LPP decoder. result.fCnt is the
+ *            // frame counter of the first fragment, used by the payload MAC
+ *        }
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+
+/** fPort of the fragments */
+var FRAG_FPORT = 13;
+/** Size of the fragment header */
+var FRAG_HEADER_SIZE = 5;
+
+/**
+ * @brief Create a reassembler for one device
+ *
+ */
+function FragReassembler() {
+	this.object = null;
+	this.lastDone = -1;
+}
+
+/**
+ * @brief Start collecting a new object
+ *
+ * @param id object id
+ * @param group parity group size
+ * @param count number of data fragments
+ * @param lastSize size of the last data fragment
+ * @param fPort fPort of the object
+ */
+FragReassembler.prototype.start = function (id, group, count, lastSize, fPort) {
+	this.object = {
+		id: id,
+		group: group,
+		count: count,
+		lastSize: lastSize,
+		fPort: fPort,
+		fCnt: null,
+		fCntExact: false,
+		fragSize: 0,
+		data: new Array(count).fill(null),
+		parity: []
+	};
+};
+
+/**
+ * @brief Add a fragment
+ *
+ * @param bytes fragment as received on fPort 13
+ * @param fCnt optional frame counter of the fragment
+ * @return {fPort, bytes, fCnt} of the object when it is complete, otherwise null
+ */
+FragReassembler.prototype.add = function (bytes, fCnt) {
+	if (bytes.length <= FRAG_HEADER_SIZE) {
+		return null;
+	}
+	var id = bytes[0] >> 4;
+	var group = bytes[0] & 0x0F;
+	var isParity = (bytes[1] & 0x80) !== 0;
+	var index = bytes[1] & 0x7F;
+	var count = bytes[2];
+	var lastSize = bytes[3];
+	var fPort = bytes[4];
+	var payload = Array.prototype.slice.call(bytes, FRAG_HEADER_SIZE);
+
+	var obj = this.object;
+	if ((obj === null) || (obj.id !== id) || (obj.count !== count) || (obj.lastSize !== lastSize) || (obj.group !== group)) {
+		// A late fragment of an object that was already delivered
+		if ((obj === null) && (id === this.lastDone)) {
+			return null;
+		}
+		// A new object, an incomplete one before it is lost
+		this.start(id, group, count, lastSize, fPort);
+		obj = this.object;
+	}
+
+	var sendPos;
+	if (isParity) {
+		obj.parity[index] = payload;
+		obj.fragSize = payload.length;
+		sendPos = index * (group + 1) + Math.min(group, count - index * group);
+	} else if (index < count) {
+		obj.data[index] = payload;
+		if (index !== count - 1) {
+			obj.fragSize = payload.length;
+		}
+		sendPos = group === 0 ? index : Math.floor(index / group) * (group + 1) + (index % group);
+	}
+	if ((typeof fCnt === 'number') && (sendPos !== undefined)) {
+		// Counter of the first fragment, exact if it was received. Otherwise
+		// estimated from the position, other uplinks between the fragments shift it
+		var first = fCnt - sendPos;
+		if ((sendPos === 0) || (obj.fCnt === null) || (!obj.fCntExact && (first < obj.fCnt))) {
+			obj.fCnt = first;
+			obj.fCntExact = sendPos === 0;
+		}
+	}
+	return this.complete();
+};
+
+/**
+ * @brief Check if the object is complete, rebuild lost fragments from parity
+ *
+ * @return {fPort, bytes, fCnt} of the object when it is complete, otherwise null
+ */
+FragReassembler.prototype.complete = function () {
+	var obj = this.object;
+	var groupSize = obj.group === 0 ? obj.count : obj.group;
+	var numGroups = Math.ceil(obj.count / groupSize);
+
+	for (var group = 0; group < numGroups; group++) {
+		var first = group * groupSize;
+		var end = Math.min(first + groupSize, obj.count);
+		var missing = [];
+		for (var index = first; index < end; index++) {
+			if (obj.data[index] === null) {
+				missing.push(index);
+			}
+		}
+		if (missing.length === 0) {
+			continue;
+		}
+		if ((obj.group === 0) || (missing.length > 1) || !obj.parity[group] || (obj.fragSize === 0)) {
+			return null;
+		}
+		// XOR of the parity and the received fragments of the group, shorter fragments are padded with 0
+		var rebuilt = obj.parity[group].slice(0, obj.fragSize);
+		for (index = first; index < end; index++) {
+			if (obj.data[index] !== null) {
+				for (var idx = 0; idx < obj.data[index].length; idx++) {
+					rebuilt[idx] ^= obj.data[index][idx];
+				}
+			}
+		}
+		var lost = missing[0];
+		obj.data[lost] = rebuilt.slice(0, lost === obj.count - 1 ? obj.lastSize : obj.fragSize);
+	}
+
+	var result = [];
+	for (index = 0; index < obj.count; index++) {
+		result = result.concat(obj.data[index]);
+	}
+	this.lastDone = obj.id;
+	this.object = null;
+	return { fPort: obj.fPort, bytes: result, fCnt: obj.fCnt };
+};
+
+if (typeof module !== 'undefined') {
+	module.exports = FragReassembler;
+	module.exports.FRAG_FPORT = FRAG_FPORT;
+}
@@ -0,0 +1,51 @@
+/**
+ * @file payload_auth.js
+ * @brief Check the truncated HMAC-SHA256 appended to the uplinks (AT+MAC)
+ *        The MAC is calculated over the fPort, the frame counter FCntUp
+ *        (4 bytes, LSB first) and the payload. For a fragmented packet the
+ *        frame counter of the first fragment is used, see frag_reassembler.js.
+ *        Because the frame counter is part of the MAC a replayed uplink fails
+ *        the check, the server must still reject frame counters it has seen.
+ *
+ *        Usage:
+ *        const checkMac = require('./payload_auth.js');
+ *        const result = checkMac(bytes, fPort, fCnt, key, macLength);
+ *        if (result) {
+ *            // result is the payload without the MAC
+ *        }
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+var crypto = require('crypto');
+
+/**
+ * @brief Check and remove the MAC of an uplink
+ *
+ * @param bytes payload as received, with the MAC at the end
+ * @param fPort fPort of the payload
+ * @param fCnt FCntUp of the uplink, of the first fragment for a fragmented packet
+ * @param key HMAC key as set with AT+MACKEY, Buffer or hex string
+ * @param macLength MAC length as set with AT+MAC
+ * @return Array payload without the MAC, null if the MAC does not match
+ */
+function checkMac(bytes, fPort, fCnt, key, macLength) {
+	if (bytes.length < macLength) {
+		return null;
+	}
+	var payload = Buffer.from(bytes.slice(0, bytes.length - macLength));
+	var mac = Buffer.from(bytes.slice(bytes.length - macLength));
+	var prefix = Buffer.from([fPort, fCnt & 0xFF, (fCnt >> 8) & 0xFF, (fCnt >> 16) & 0xFF, (fCnt >>> 24) & 0xFF]);
+	var hmac = crypto.createHmac('sha256', typeof key === 'string' ? Buffer.from(key, 'hex') : key);
+	hmac.update(prefix);
+	hmac.update(payload);
+	var expected = hmac.digest().slice(0, macLength);
+	if (!crypto.timingSafeEqual(expected, mac)) {
+		return null;
+	}
+	return Array.prototype.slice.call(payload);
+}
+
+module.exports = checkMac;
@@ -0,0 +1,127 @@
+/**
+ * @file host_stubs.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host implementations of the Arduino, FreeRTOS and WisBlock-API functions
+ *        Only what the firmware sources under test call. Time is simulated,
+ *        tasks are not started, mutexes do nothing because the tests are
+ *        single threaded.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include <stdarg.h>
+#include <chrono>
+#include <WisBlock-API-V2.h>
+#include <wisblock_cayenne.h>
+#include "host_stubs.h"
+
+uint64_t host_time_us = 0;
+int host_failures = 0;
+bool host_serial_mute = false;
+
+int host_result(const char *name)
+{
+	printf("%s: %s\n", name, host_failures == 0 ? "PASS" : "FAIL");
+	return host_failures == 0 ? 0 : 1;
+}
+
+double host_seconds(void)
+{
+	return std::chrono::duration<double>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+// Arduino
+unsigned long millis(void) { return (unsigned long)(host_time_us / 1000); }
+unsigned long micros(void) { return (unsigned long)host_time_us; }
+void delay(unsigned long ms) { host_time_us += (uint64_t)ms * 1000; }
+void delayMicroseconds(unsigned int us) { host_time_us += us; }
+void pinMode(uint8_t, uint8_t) {}
+void digitalWrite(uint8_t, uint8_t) {}
+int digitalRead(uint8_t) { return 0; }
+int analogRead(uint8_t) { return 0; }
+void attachInterrupt(uint32_t, void (*)(void), int) {}
+void detachInterrupt(uint32_t) {}
+
+size_t Print::print(const char *str) { return printf("%s", str); }
+size_t Print::print(int value, int) { return printf("%d", value); }
+size_t Print::print(float value, int) { return printf("%f", value); }
+size_t Print::println(const char *str) { return printf("%s\n", str); }
+size_t Print::println(int value, int) { return printf("%d\n", value); }
+size_t Print::println(float value, int) { return printf("%f\n", value); }
+int Print::printf(const char *format, ...)
+{
+	if (host_serial_mute)
+	{
+		return 0;
+	}
+	va_list args;
+	va_start(args, format);
+	int len = vprintf(format, args);
+	va_end(args);
+	return len;
+}
+size_t Print::write(uint8_t) { return 1; }
+size_t Print::write(const uint8_t *, size_t size) { return size; }
+HardwareSerial Serial;
+
+// FreeRTOS, single threaded, handles only have to be non NULL
+static int host_handle;
+BaseType_t xTaskCreate(void (*)(void *), const char *, uint32_t, void *, int, TaskHandle_t *task)
+{
+	if (task != NULL)
+	{
+		*task = &host_handle;
+	}
+	return pdPASS;
+}
+SemaphoreHandle_t xSemaphoreCreateBinary(void) { return &host_handle; }
+SemaphoreHandle_t xSemaphoreCreateMutex(void) { return &host_handle; }
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void) { return &host_handle; }
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t) { return pdTRUE; }
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGive(SemaphoreHandle_t) { return pdTRUE; }
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t) { return pdTRUE; }
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t, BaseType_t *) { return pdTRUE; }
+void vTaskDelay(TickType_t ticks) { host_time_us += (uint64_t)ticks * 1000; }
+TickType_t xTaskGetTickCount(void) { return (TickType_t)(host_time_us / 1000); }
+void vTaskDelayUntil(TickType_t *last_wake, TickType_t ticks)
+{
+	*last_wake += ticks;
+	host_time_us = (uint64_t)*last_wake * 1000;
+}
+void taskENTER_CRITICAL(void) {}
+void taskEXIT_CRITICAL(void) {}
+void SoftwareTimer::begin(uint32_t, void (*)(TimerHandle_t), void *, bool) {}
+void SoftwareTimer::start() {}
+void SoftwareTimer::stop() {}
+void SoftwareTimer::reset() {}
+void SoftwareTimer::setPeriod(uint32_t) {}
+
+// WisBlock-API
+bool g_ble_uart_is_connected = false;
+BLEUart g_ble_uart;
+
+// Cayenne LPP, only the size is tracked
+static uint8_t host_lpp_buffer[256];
+static uint8_t host_lpp_size = 0;
+WisCayenne::WisCayenne(uint8_t) {}
+void WisCayenne::reset() { host_lpp_size = 0; }
+uint8_t WisCayenne::getSize() { return host_lpp_size; }
+uint8_t *WisCayenne::getBuffer() { return host_lpp_buffer; }
+uint8_t WisCayenne::addAnalogInput(uint8_t, float)
+{
+	host_lpp_size += 4;
+	return host_lpp_size;
+}
+uint8_t WisCayenne::addTemperature(uint8_t, float)
+{
+	host_lpp_size += 4;
+	return host_lpp_size;
+}
+uint8_t WisCayenne::addPresence(uint8_t, uint8_t)
+{
+	host_lpp_size += 3;
+	return host_lpp_size;
+}
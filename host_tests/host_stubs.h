@@ -0,0 +1,56 @@
+/**
+ * @file host_stubs.h
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Controls of the host stubs used by the host tests
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#ifndef HOST_STUBS_H
+#define HOST_STUBS_H
+#include <stdint.h>
+#include <stdio.h>
+
+/** Simulated time in micro seconds, returned by micros() and millis(), advanced by delay() */
+extern uint64_t host_time_us;
+
+/** Number of failed checks */
+extern int host_failures;
+
+/** Suppress the output of Serial, e.g. the AT events of many transfers */
+extern bool host_serial_mute;
+
+/**
+ * @brief Report a check, counts the failures
+ *
+ */
+#define HOST_CHECK(cond, ...)                           \
+	do                                                  \
+	{                                                   \
+		if (!(cond))                                    \
+		{                                               \
+			printf("FAIL %s:%d ", __FILE__, __LINE__);  \
+			printf(__VA_ARGS__);                        \
+			printf("\n");                               \
+			host_failures++;                            \
+		}                                               \
+	} while (0)
+
+/**
+ * @brief Print the result of a test and return the exit code
+ *
+ * @param name test name
+ * @return int 0 if all checks passed
+ */
+int host_result(const char *name);
+
+/**
+ * @brief Wall clock time for benchmarks
+ *
+ * @return double seconds
+ */
+double host_seconds(void);
+
+#endif // HOST_STUBS_H
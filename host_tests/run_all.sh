@@ -0,0 +1,58 @@
+#!/bin/bash
+# Build and run the host tests
+# The firmware sources are compiled for the host against the stub headers in
+# stubs/, as NRF52_SERIES target. Each test includes the source it tests.
+# Usage: ./run_all.sh [test name ...]
+cd "$(dirname "$0")"
+mkdir -p build
+
+CXX=${CXX:-g++}
+CXXFLAGS="-std=gnu++17 -O2 -Wall -Wno-unused-function -Wno-unused-variable -Wno-format -I. -Istubs -I../PlatformIO/src -DMY_DEBUG=0 -DUSE_BSEC=0 -DHAS_EPD=0 -DBASE_BOARD=0"
+
+# Firmware sources linked to a test in addition to the one it includes
+declare -A SOURCES
+SOURCES[test_epd_render]="RAK14000_epd_tiles.cpp"
+SOURCES[test_frag_transport]=""
+SOURCES[test_imu_fusion]=""
+SOURCES[test_ina_integrate]=""
+SOURCES[test_thermal_analytics]=""
+SOURCES[test_thermal_blob]="thermal_analytics.cpp"
+
+# Additional compiler flags of a test
+declare -A EXTRA_FLAGS
+EXTRA_FLAGS[test_epd_render]="-UHAS_EPD -DHAS_EPD=1"
+
+# Node.js checks of a test, run with the file the test writes to build/<test>.txt
+declare -A NODE_CHECKS
+NODE_CHECKS[test_frag_transport]="test_frag_reassembler.js"
+
+TESTS=("$@")
+if [ ${#TESTS[@]} -eq 0 ]; then
+	TESTS=(${!SOURCES[@]})
+fi
+
+failed=0
+for test in $(printf '%s\n' "${TESTS[@]}" | sort); do
+	echo "=== $test"
+	extra=""
+	for src in ${SOURCES[$test]}; do
+		extra="$extra ../PlatformIO/src/$src"
+	done
+	if ! $CXX $CXXFLAGS ${EXTRA_FLAGS[$test]} -o build/$test $test.cpp host_stubs.cpp $extra; then
+		echo "$test: BUILD FAILED"
+		failed=1
+		continue
+	fi
+	if ! ./build/$test; then
+		failed=1
+		continue
+	fi
+	for script in ${NODE_CHECKS[$test]}; do
+		if ! command -v node > /dev/null; then
+			echo "$script: SKIPPED, node not found"
+		elif ! node $script build/$test.txt; then
+			failed=1
+		fi
+	done
+done
+exit $failed
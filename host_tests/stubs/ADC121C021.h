@@ -0,0 +1,4 @@
+/** Host test stub of ADC121C021, only what the firmware sources use */
+#pragma once
+#include <Wire.h>
+class ADC121C021 { public: bool begin(uint8_t, TwoWire&); void setRL(float); void setA(float); void setB(float); void setRegressionMethod(int); float calibrateR0(float); void setR0(float); float getR0(); float readSensor(); };
@@ -0,0 +1,15 @@
+/** Host test stub of Adafruit_EPD, only what the firmware sources use, the buffer is the canvas of the Adafruit_GFX stub */
+#pragma once
+#include <Adafruit_GFX.h>
+#define EPD_WHITE 0
+#define EPD_BLACK 1
+class Adafruit_EPD : public Adafruit_GFX {
+public:
+  Adafruit_EPD(int w, int h, int16_t a, int16_t b, int16_t c, int16_t d, int16_t e, int16_t f, int16_t g, int16_t i) : Adafruit_GFX(w, h) {}
+  void begin(bool reset = true) {}
+  void clearBuffer(void) { memset(canvas, 0, sizeof(canvas)); }
+  void display(bool sleep = false) {}
+  void displayPartial(uint16_t x1, uint16_t y1, uint16_t x2, uint16_t y2) {}
+};
+class Adafruit_SSD1681 : public Adafruit_EPD { using Adafruit_EPD::Adafruit_EPD; };
+class Adafruit_SSD1680 : public Adafruit_EPD { using Adafruit_EPD::Adafruit_EPD; };
@@ -0,0 +1,105 @@
+/** Host test stub of Adafruit_GFX, only what the firmware sources use
+    Draws into a byte per pixel canvas with the font, line and bitmap rules of the
+    library and counts the font calls, so the display drivers can be compared on the host */
+#pragma once
+#include <Arduino.h>
+#include <string.h>
+typedef struct { uint16_t bitmapOffset; uint8_t width, height, xAdvance; int8_t xOffset, yOffset; } GFXglyph;
+typedef struct { uint8_t *bitmap; GFXglyph *glyph; uint16_t first, last; uint8_t yAdvance; } GFXfont;
+#define GFX_CANVAS_MAX (400 * 400)
+class Adafruit_GFX {
+public:
+  Adafruit_GFX(int16_t w, int16_t h) : WIDTH(w), HEIGHT(h), _w(w), _h(h) {}
+  void setFont(const GFXfont *f) { calls_setFont++; gfxFont = f; }
+  void setCursor(int16_t x, int16_t y) { cursor_x = x; cursor_y = y; }
+  void setTextColor(uint16_t c) { textcolor = c; }
+  void setTextSize(uint8_t s) { textsize = s; }
+  void setTextWrap(bool w) { wrap = w; }
+  size_t print(const char *s) { size_t n = 0; while (*s) { write((uint8_t)*s++); n++; } return n; }
+  void getTextBounds(const char *s, int16_t x, int16_t y, int16_t *x1, int16_t *y1, uint16_t *w, uint16_t *h) {
+    calls_getTextBounds++;
+    *x1 = x; *y1 = y; *w = *h = 0;
+    int16_t minx = _w, miny = _h, maxx = -1, maxy = -1;
+    while (*s) charBounds((uint8_t)*s++, &x, &y, &minx, &miny, &maxx, &maxy);
+    if (maxx >= minx) { *x1 = minx; *w = maxx - minx + 1; }
+    if (maxy >= miny) { *y1 = miny; *h = maxy - miny + 1; }
+  }
+  void drawBitmap(int16_t x, int16_t y, const uint8_t *b, int16_t w, int16_t h, uint16_t c) {
+    int16_t byteWidth = (w + 7) / 8; uint8_t byte = 0;
+    for (int16_t j = 0; j < h; j++, y++)
+      for (int16_t i = 0; i < w; i++) {
+        if (i & 7) byte <<= 1; else byte = b[j * byteWidth + i / 8];
+        if (byte & 0x80) drawPixel(x + i, y, c);
+      }
+  }
+  void drawLine(int16_t x0, int16_t y0, int16_t x1, int16_t y1, uint16_t c) {
+    bool steep = abs(y1 - y0) > abs(x1 - x0);
+    if (steep) { swap(x0, y0); swap(x1, y1); }
+    if (x0 > x1) { swap(x0, x1); swap(y0, y1); }
+    int16_t dx = x1 - x0, dy = abs(y1 - y0), err = dx / 2, ystep = y0 < y1 ? 1 : -1;
+    for (; x0 <= x1; x0++) {
+      if (steep) drawPixel(y0, x0, c); else drawPixel(x0, y0, c);
+      err -= dy;
+      if (err < 0) { y0 += ystep; err += dx; }
+    }
+  }
+  void fillRect(int16_t x, int16_t y, int16_t w, int16_t h, uint16_t c) {
+    for (int16_t j = y; j < y + h; j++) for (int16_t i = x; i < x + w; i++) drawPixel(i, j, c);
+  }
+  void setRotation(uint8_t r) { rotation = r & 3; _w = (rotation & 1) ? HEIGHT : WIDTH; _h = (rotation & 1) ? WIDTH : HEIGHT; }
+  uint8_t getRotation(void) { return rotation; }
+  int16_t width(void) { return _w; }
+  int16_t height(void) { return _h; }
+  void drawPixel(int16_t x, int16_t y, uint16_t c) { if ((x >= 0) && (y >= 0) && (x < _w) && (y < _h)) canvas[y * _w + x] = (uint8_t)c; }
+  /** Canvas in the rotated coordinates, width() * height() pixels */
+  uint8_t canvas[GFX_CANVAS_MAX] = {0};
+  /** Call counters */
+  static inline uint32_t calls_setFont = 0;
+  static inline uint32_t calls_getTextBounds = 0;
+protected:
+  static void swap(int16_t &a, int16_t &b) { int16_t t = a; a = b; b = t; }
+  void write(uint8_t c) {
+    if (gfxFont == NULL) return;
+    if (c == '\n') { cursor_x = 0; cursor_y += textsize * gfxFont->yAdvance; return; }
+    if ((c == '\r') || (c < gfxFont->first) || (c > gfxFont->last)) return;
+    const GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+    if ((glyph->width > 0) && (glyph->height > 0)) {
+      if (wrap && ((cursor_x + textsize * (glyph->xOffset + glyph->width)) > _w)) { cursor_x = 0; cursor_y += textsize * gfxFont->yAdvance; }
+      drawChar(cursor_x, cursor_y, glyph);
+    }
+    cursor_x += glyph->xAdvance * textsize;
+  }
+  void drawChar(int16_t x, int16_t y, const GFXglyph *glyph) {
+    const uint8_t *bitmap = gfxFont->bitmap; uint16_t bo = glyph->bitmapOffset; uint8_t bits = 0, bit = 0;
+    for (uint8_t yy = 0; yy < glyph->height; yy++)
+      for (uint8_t xx = 0; xx < glyph->width; xx++) {
+        if (!(bit++ & 7)) bits = bitmap[bo++];
+        if (bits & 0x80) {
+          if (textsize == 1) drawPixel(x + glyph->xOffset + xx, y + glyph->yOffset + yy, textcolor);
+          else fillRect(x + (glyph->xOffset + xx) * textsize, y + (glyph->yOffset + yy) * textsize, textsize, textsize, textcolor);
+        }
+        bits <<= 1;
+      }
+  }
+  void charBounds(uint8_t c, int16_t *x, int16_t *y, int16_t *minx, int16_t *miny, int16_t *maxx, int16_t *maxy) {
+    if (gfxFont == NULL) return;
+    if (c == '\n') { *x = 0; *y += textsize * gfxFont->yAdvance; return; }
+    if ((c == '\r') || (c < gfxFont->first) || (c > gfxFont->last)) return;
+    const GFXglyph *glyph = &gfxFont->glyph[c - gfxFont->first];
+    if (wrap && ((*x + ((glyph->xOffset + glyph->width) * textsize)) > _w)) { *x = 0; *y += textsize * gfxFont->yAdvance; }
+    int16_t x1 = *x + glyph->xOffset * textsize, y1 = *y + glyph->yOffset * textsize;
+    int16_t x2 = x1 + glyph->width * textsize - 1, y2 = y1 + glyph->height * textsize - 1;
+    if (x1 < *minx) *minx = x1;
+    if (y1 < *miny) *miny = y1;
+    if (x2 > *maxx) *maxx = x2;
+    if (y2 > *maxy) *maxy = y2;
+    *x += glyph->xAdvance * textsize;
+  }
+  const int16_t WIDTH, HEIGHT;
+  int16_t _w, _h;
+  const GFXfont *gfxFont = NULL;
+  int16_t cursor_x = 0, cursor_y = 0;
+  uint16_t textcolor = 0;
+  uint8_t textsize = 1, rotation = 0;
+  bool wrap = true;
+};
@@ -0,0 +1,21 @@
+/** Host test stub of Adafruit_LIS3DH, only what the firmware sources use */
+#pragma once
+#include <Wire.h>
+#define LIS3DH_DEFAULT_ADDRESS 0x18
+#define LIS3DH_REG_CTRL1 0x20
+#define LIS3DH_REG_CTRL2 0x21
+#define LIS3DH_REG_CTRL3 0x22
+#define LIS3DH_REG_CTRL4 0x23
+#define LIS3DH_REG_CTRL5 0x24
+#define LIS3DH_REG_CTRL6 0x25
+#define LIS3DH_REG_REFERENCE 0x26
+#define LIS3DH_REG_OUT_X_L 0x28
+#define LIS3DH_REG_FIFOCTRL 0x2E
+#define LIS3DH_REG_FIFOSRC 0x2F
+#define LIS3DH_REG_INT1CFG 0x30
+#define LIS3DH_REG_INT1SRC 0x31
+#define LIS3DH_REG_INT1THS 0x32
+#define LIS3DH_REG_INT1DUR 0x33
+typedef enum { LIS3DH_RANGE_16_G = 0b11, LIS3DH_RANGE_8_G = 0b10, LIS3DH_RANGE_4_G = 0b01, LIS3DH_RANGE_2_G = 0b00 } lis3dh_range_t;
+typedef enum { LIS3DH_DATARATE_400_HZ = 0b0111, LIS3DH_DATARATE_200_HZ = 0b0110, LIS3DH_DATARATE_100_HZ = 0b0101, LIS3DH_DATARATE_50_HZ = 0b0100, LIS3DH_DATARATE_25_HZ = 0b0011, LIS3DH_DATARATE_10_HZ = 0b0010, LIS3DH_DATARATE_1_HZ = 0b0001 } lis3dh_dataRate_t;
+class Adafruit_LIS3DH { public: Adafruit_LIS3DH(TwoWire*); bool begin(uint8_t addr = 0x18); void setDataRate(lis3dh_dataRate_t); void setRange(lis3dh_range_t); void enableDRDY(bool, uint8_t); uint8_t readAndClearInterrupt(); void read(); int16_t x, y, z; float x_g, y_g, z_g; };
@@ -0,0 +1,8 @@
+/** Host test stub of Adafruit_LittleFS, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#define FILE_O_READ 0
+#define FILE_O_WRITE 1
+namespace Adafruit_LittleFS_Namespace { class File; }
+class LittleFSStub { public: bool begin(); bool exists(const char*); bool remove(const char*); };
+namespace Adafruit_LittleFS_Namespace { class File { public: File(LittleFSStub&); bool open(const char*, uint8_t); int read(void*, uint16_t); size_t write(const char*); size_t write(const uint8_t*, size_t); size_t write(const char*, size_t); void close(); operator bool(); bool seek(uint32_t); uint32_t size(); }; }
@@ -0,0 +1,65 @@
+/** Host test stub of Arduino, only what the firmware sources use */
+#pragma once
+#include <ctype.h>
+#include <stdint.h>
+#include <stddef.h>
+#include <string.h>
+#include <stdio.h>
+#include <stdlib.h>
+#include <math.h>
+#include <time.h>
+typedef uint8_t byte;
+#define NRF52_SERIES 1
+#define HIGH 1
+#define LOW 0
+#define INPUT 0
+#define OUTPUT 1
+#define INPUT_PULLDOWN 3
+#define INPUT_PULLUP 2
+#define RISING 1
+#define FALLING 2
+#define CHANGE 3
+#define WB_IO1 1
+#define WB_IO2 2
+#define WB_IO3 3
+#define WB_IO4 4
+#define WB_IO5 5
+#define WB_IO6 6
+#define WB_A0 7
+#define WB_A1 8
+#define LED_BUILTIN 9
+#define LED_BLUE 10
+#define LED_GREEN 11
+#define HEX 16
+#define DEC 10
+unsigned long millis(void);
+unsigned long micros(void);
+void delay(unsigned long);
+void delayMicroseconds(unsigned int);
+void pinMode(uint8_t, uint8_t);
+void digitalWrite(uint8_t, uint8_t);
+int digitalRead(uint8_t);
+int analogRead(uint8_t);
+void attachInterrupt(uint32_t, void (*)(void), int);
+void detachInterrupt(uint32_t);
+#define digitalPinToInterrupt(p) (p)
+template <class T, class L> auto min(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (b < a) ? b : a; }
+template <class T, class L> auto max(const T &a, const L &b) -> decltype((b < a) ? b : a) { return (a < b) ? b : a; }
+class Print { public: size_t print(const char*); size_t print(int, int = DEC); size_t print(float, int = 2); size_t println(const char* = ""); size_t println(int, int = DEC); size_t println(float, int=2); int printf(const char*, ...); size_t write(uint8_t); size_t write(const uint8_t*, size_t);};
+class Stream : public Print { public: int available(); int read(); void flush(); };
+class HardwareSerial : public Stream { public: void begin(unsigned long); operator bool(); void end(); };
+extern HardwareSerial Serial;
+extern HardwareSerial Serial1;
+class String { public: String(const char* = ""); const char* c_str() const; };
+char *itoa(int, char*, int);
+#define PRINTF printf
+inline void yield(void) {}
+inline long map(long x, long in_min, long in_max, long out_min, long out_max) { return (x - in_min) * (out_max - out_min) / (in_max - in_min) + out_min; }
+#ifndef PROGMEM
+#define PROGMEM
+#endif
+#ifndef MOSI
+#define MOSI 1
+#define SCK 2
+#define SS 3
+#endif
@@ -0,0 +1,18 @@
+/** Host test stub of ArduinoECCX08, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+class ECCX08Class {
+public:
+ ECCX08Class(TwoWire&, uint8_t){}
+ int begin(){return 1;}
+ String serialNumber(){return String();}
+ int locked(){return 0;}
+ long random(long, long){return 0;}
+ long random(long){return 0;}
+ int random(byte data[], size_t length){return 1;}
+ int beginSHA256(){return 1;}
+ int updateSHA256(const byte data[]){return 1;}
+ int endSHA256(byte result[]){return 1;}
+ int endSHA256(const byte data[], int length, byte result[]){return 1;}
+};
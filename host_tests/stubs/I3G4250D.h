@@ -0,0 +1,12 @@
+/** Host test stub of I3G4250D, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#define I3G4250D_SCALE_500 1
+#define I3G4250D_INT_CTR_XLI_ON 0x01
+#define I3G4250D_INT_CTR_XHI_ON 0x02
+#define I3G4250D_INT_CTR_YLI_ON 0x04
+#define I3G4250D_INT_CTR_YHI_ON 0x08
+#define I3G4250D_INT_CTR_ZLI_ON 0x10
+#define I3G4250D_INT_CTR_ZHI_ON 0x20
+typedef struct { float x,y,z; } I3G4250D_DataScaled;
+class I3G4250D { public: uint8_t I3G4250D_Init(uint8_t,uint8_t,uint8_t,uint8_t,uint8_t,uint8_t); void readRegister(uint8_t,uint8_t*,uint8_t); void I3G4250D_SetTresholds(uint16_t,uint16_t,uint16_t); void I3G4250D_InterruptCtrl(uint8_t); void I3G4250D_Enable_INT1(); uint8_t I3G4250D_GetInterruptSrc(); I3G4250D_DataScaled I3G4250D_GetScaledData(); };
@@ -0,0 +1,8 @@
+/** Host test stub of INA219_WE, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+typedef enum { BIT_MODE_9, BIT_MODE_10, BIT_MODE_11, BIT_MODE_12, SAMPLE_MODE_2, SAMPLE_MODE_4, SAMPLE_MODE_8, SAMPLE_MODE_16, SAMPLE_MODE_32, SAMPLE_MODE_64, SAMPLE_MODE_128 } INA219_ADC_MODE;
+typedef enum { POWER_DOWN, TRIGGERED, ADC_OFF, CONTINUOUS } INA219_MEASURE_MODE;
+typedef enum { PG_40, PG_80, PG_160, PG_320 } INA219_PGAIN;
+typedef enum { BRNG_16, BRNG_32 } INA219_BUS_RANGE;
+class INA219_WE { public: INA219_WE(int); bool init(); void setADCMode(INA219_ADC_MODE); void setMeasureMode(INA219_MEASURE_MODE); void setPGain(INA219_PGAIN); void setBusRange(INA219_BUS_RANGE); void setShuntSizeInOhms(float); void setCorrectionFactor(float); float getShuntVoltage_mV(); float getBusVoltage_V(); float getBusPower(); bool getOverflow(); };
@@ -0,0 +1,4 @@
+/** Host test stub of InternalFileSystem, only what the firmware sources use */
+#pragma once
+#include <Adafruit_LittleFS.h>
+extern LittleFSStub InternalFS;
@@ -0,0 +1,13 @@
+/** Host test stub of MPU9250_WE, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+typedef enum {MPU9250_ACC_RANGE_2G} MPU9250_accRange;
+typedef enum {MPU9250_DLPF_0,MPU9250_DLPF_1,MPU9250_DLPF_2,MPU9250_DLPF_3,MPU9250_DLPF_4,MPU9250_DLPF_5,MPU9250_DLPF_6,MPU9250_DLPF_7} MPU9250_dlpf;
+typedef enum {MPU9250_ACT_HIGH} MPU9250_intPinPol;
+typedef enum {MPU9250_DATA_READY=1,MPU9250_FIFO_OVF=2,MPU9250_WOM_INT=4} MPU9250_intType;
+typedef enum {MPU9250_WOM_DISABLE,MPU9250_WOM_ENABLE} MPU9250_womEn;
+typedef enum {MPU9250_WOM_COMP_DISABLE,MPU9250_WOM_COMP_ENABLE} MPU9250_womCompEn;
+typedef enum {AK8963_PWR_DOWN,AK8963_CONT_MODE_8HZ,AK8963_CONT_MODE_100HZ} AK8963_opMode;
+typedef enum {MPU9250_GYRO_RANGE_250} MPU9250_gyroRange;
+struct xyzFloat { float x,y,z; };
+class MPU9250_WE { public: MPU9250_WE(){} bool init(); uint8_t whoAmI(); uint8_t whoAmIMag(); void autoOffsets(); void setSampleRateDivider(uint8_t); void setAccRange(MPU9250_accRange); void enableAccDLPF(bool); void setAccDLPF(MPU9250_dlpf); void enableGyrDLPF(); void setGyrDLPF(MPU9250_dlpf); void setIntPinPolarity(MPU9250_intPinPol); void enableIntLatch(bool); void enableClearIntByAnyRead(bool); void enableInterrupt(MPU9250_intType); void setWakeOnMotionThreshold(uint8_t); void enableWakeOnMotion(MPU9250_womEn,MPU9250_womCompEn); uint8_t readAndClearInterrupts(); bool checkInterrupt(uint8_t,MPU9250_intType); bool initMagnetometer(); void setMagOpMode(AK8963_opMode); xyzFloat getMagValues(); xyzFloat getGValues(); xyzFloat getGyrValues(); void setGyrRange(MPU9250_gyroRange); };
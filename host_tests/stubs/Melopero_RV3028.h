@@ -0,0 +1,4 @@
+/** Host test stub of Melopero_RV3028, only what the firmware sources use */
+#pragma once
+#include <Wire.h>
+class Melopero_RV3028 { public: void initI2C(TwoWire&); void useEEPROM(bool); void writeToRegister(uint8_t,uint8_t); uint8_t readFromRegister(uint8_t); void set24HourMode(); uint16_t getYear(); uint8_t getMonth(); uint8_t getWeekday(); uint8_t getDate(); uint8_t getHour(); uint8_t getMinute(); uint8_t getSecond(); void setTime(uint16_t,uint8_t,uint8_t,uint8_t,uint8_t,uint8_t,uint8_t); };
@@ -0,0 +1,5 @@
+/** Host test stub of RAK12039_PMSA003I, only what the firmware sources use */
+#pragma once
+#include <stdint.h>
+typedef struct { uint16_t pm10_standard, pm25_standard, pm100_standard, pm10_env, pm25_env, pm100_env; } PMSA_Data_t;
+class RAK_PMSA003I { public: bool begin(){return true;} bool readDate(PMSA_Data_t*){return true;} };
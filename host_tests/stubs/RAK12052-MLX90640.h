@@ -0,0 +1,11 @@
+/** Host test stub of RAK12052-MLX90640, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+typedef struct { int16_t kVdd; float KsTa; uint16_t brokenPixels[5]; } paramsMLX90640;
+int MLX90640_ExtractParameters(uint16_t *eeData, paramsMLX90640 *mlx90640);
+float MLX90640_GetTa(uint16_t *frameData, const paramsMLX90640 *params);
+void MLX90640_CalculateTo(uint16_t *frameData, const paramsMLX90640 *params, float emissivity, float tr, float *result);
+typedef enum { MLX90640_INTERLEAVED, MLX90640_CHESS } mlx90640_mode_t;
+typedef enum { MLX90640_ADC_16BIT, MLX90640_ADC_17BIT, MLX90640_ADC_18BIT, MLX90640_ADC_19BIT } mlx90640_resolution_t;
+typedef enum { MLX90640_0_5_HZ, MLX90640_1_HZ, MLX90640_2_HZ, MLX90640_4_HZ } mlx90640_refreshrate_t;
+class RAK_MLX90640 { public: bool begin(); uint16_t serialNumber[3]; void setMode(mlx90640_mode_t); void setResolution(mlx90640_resolution_t); void setRefreshRate(mlx90640_refreshrate_t); int getFrame(float *f); float frame[768]; };
@@ -0,0 +1,14 @@
+/** Host test stub of Rak_BMX160, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#define BMX160_CHIP_ID_ADDR 0x00
+#define BMX160_CHIP_ID 0xD8
+#define BMX160_ACCEL_ODR_200HZ 9
+#define BMX160_GYRO_ODR_200HZ 9
+#define BMX160_ACCEL_ODR_400HZ 10
+#define BMX160_GYRO_ODR_400HZ 10
+typedef enum {eGyroRange_2000DPS,eGyroRange_1000DPS,eGyroRange_500DPS,eGyroRange_250DPS,eGyroRange_125DPS} eGyroRange_t;
+typedef enum {eAccelRange_2G,eAccelRange_4G,eAccelRange_8G,eAccelRange_16G} eAccelRange_t;
+typedef struct { float x,y,z; uint32_t sensortime; } sBmx160SensorData_t;
+class RAK_BMX160 { public: RAK_BMX160(TwoWire*){} bool begin(); void readReg(uint8_t,uint8_t*,uint16_t); void wakeUp(); void InterruptConfig(uint8_t,uint8_t); void ODR_Config(uint8_t,uint8_t); void setGyroRange(eGyroRange_t); void setAccelRange(eAccelRange_t); void getTemperature(float*); void getAllData(sBmx160SensorData_t*,sBmx160SensorData_t*,sBmx160SensorData_t*); void setLowPower(); };
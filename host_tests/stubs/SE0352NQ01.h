@@ -0,0 +1,22 @@
+/** Host test stub of SE0352NQ01, only what the firmware sources use */
+#pragma once
+#include <Adafruit_GFX.h>
+#define PIC_WHITE 0xFF
+#define PIC_BLACK 0x00
+class SE0352NQ01 {
+public:
+  void begin(void) {}
+  void drawString(const char *t, int16_t x, int16_t y, const GFXfont &f, uint8_t o, unsigned char *fr) {}
+  uint16_t strWidth(const char *t, const GFXfont &f) { return 0; }
+  void fillScreen(uint8_t c) {}
+  void refresh(void) {}
+  void send(unsigned char *fr) {}
+  void clearRect(int16_t a, int16_t b, int16_t c, int16_t d, uint8_t o, unsigned char *fr) {}
+  void partialRefresh(int16_t a, int16_t b, int16_t c, int16_t d, uint8_t o, unsigned char *fr) {}
+  void drawBitmap(int16_t w, int16_t h, int16_t x, int16_t y, unsigned char *fr, uint8_t *b, uint8_t o) {}
+  void drawBitmap(int16_t w, int16_t h, int16_t x, int16_t y, int a, int b, int c, unsigned char *fr, uint8_t *bm, uint8_t o) {}
+  void drawLine(int16_t a, int16_t b, int16_t c, int16_t d, uint8_t o, unsigned char *fr) {}
+  void drawVLine(int16_t a, int16_t b, int16_t c, uint8_t o, unsigned char *fr) {}
+  void drawHLine(int16_t a, int16_t b, int16_t c, uint8_t o, unsigned char *fr) {}
+};
+extern SE0352NQ01 SE0352;
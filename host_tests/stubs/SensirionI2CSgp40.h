@@ -0,0 +1,5 @@
+/** Host test stub of SensirionI2CSgp40, only what the firmware sources use */
+#pragma once
+#include <Wire.h>
+void errorToString(uint16_t, char*, size_t);
+class SensirionI2CSgp40 { public: void begin(TwoWire&); uint16_t getSerialNumber(uint16_t*, uint8_t); uint16_t executeSelfTest(uint16_t&); uint16_t measureRawSignal(uint16_t, uint16_t, uint16_t&); };
@@ -0,0 +1,10 @@
+/** Host test stub of SparkFunADXL313, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#define ADXL313_RANGE_2_G 1
+#define ADXL313_INT_ACTIVITY_BIT 4
+#define ADXL313_INT_INACTIVITY_BIT 3
+#define ADXL313_INT1_PIN 0
+#define ADXL313_INT2_PIN 1
+struct adxl_is { bool activity, inactivity, dataReady; };
+class ADXL313 { public: bool begin(); bool checkPartId(); void softReset(); void standby(); void setRange(uint8_t); void setActivityX(bool); void setActivityY(bool); void setActivityZ(bool); void setActivityThreshold(uint8_t); void setInactivityX(bool); void setInactivityY(bool); void setInactivityZ(bool); void setInactivityThreshold(uint8_t); void setTimeInactivity(uint8_t); void setInterruptMapping(uint8_t,uint8_t); void ActivityINT(bool); void InactivityINT(bool); void DataReadyINT(bool); void autosleepOn(); void measureModeOn(); void updateIntSourceStatuses(); void readAccel(); adxl_is intSource; int16_t x,y,z; };
@@ -0,0 +1,4 @@
+/** Host test stub of SparkFun_GridEYE_Arduino_Library, only what the firmware sources use */
+#pragma once
+#include <Wire.h>
+class GridEYE { public: void begin(uint8_t, TwoWire&); void setFramerate10FPS(); float getPixelTemperature(uint8_t); };
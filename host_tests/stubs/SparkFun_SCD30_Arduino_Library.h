@@ -0,0 +1,5 @@
+/** Host test stub of SparkFun_SCD30_Arduino_Library, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+class SCD30 { public: bool begin(TwoWire &, bool a = false, bool m = true); bool setMeasurementInterval(uint16_t); bool getMeasurementInterval(uint16_t *); bool setAutoSelfCalibration(bool); bool beginMeasuring(void); bool beginMeasuring(uint16_t); bool dataAvailable(); bool readMeasurement(); uint16_t getCO2(); float getTemperature(); float getHumidity(); bool setAmbientPressure(uint16_t); };
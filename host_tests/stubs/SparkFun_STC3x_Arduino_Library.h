@@ -0,0 +1,5 @@
+/** Host test stub of SparkFun_STC3x_Arduino_Library, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#define STC3X_BINARY_GAS_CO2_AIR_25 3
+class STC3x { public: bool begin(uint8_t); bool setBinaryGas(int); bool enableAutomaticSelfCalibration(); bool setTemperature(float); bool setRelativeHumidity(float); bool setPressure(uint16_t); bool measureGasConcentration(); float getCO2(); };
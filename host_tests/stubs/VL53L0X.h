@@ -0,0 +1,5 @@
+/** Host test stub of VL53L0X, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+class VL53L0X { public: enum vcselPeriodType { VcselPeriodPreRange, VcselPeriodFinalRange }; void setBus(TwoWire*); void setTimeout(uint16_t); bool init(bool io_2v8 = true); bool setSignalRateLimit(float); bool setVcselPulsePeriod(vcselPeriodType, uint8_t); bool setMeasurementTimingBudget(uint32_t); void startContinuous(uint32_t period_ms = 0); void stopContinuous(); uint16_t readRangeContinuousMillimeters(); uint16_t readRangeSingleMillimeters(); bool timeoutOccurred(); };
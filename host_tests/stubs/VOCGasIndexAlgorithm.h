@@ -0,0 +1,4 @@
+/** Host test stub of VOCGasIndexAlgorithm, only what the firmware sources use */
+#pragma once
+#include <stdint.h>
+class VOCGasIndexAlgorithm { public: VOCGasIndexAlgorithm(float); int32_t process(int32_t); void get_states(int32_t&, int32_t&); void set_states(int32_t, int32_t); void get_tuning_parameters(int32_t&,int32_t&,int32_t&,int32_t&,int32_t&,int32_t&); };
@@ -0,0 +1,5 @@
+/** Host test stub of Wire, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+class TwoWire : public Stream { public: void begin(); void end(); void setClock(uint32_t); void beginTransmission(uint8_t); uint8_t endTransmission(bool stop = true); uint8_t requestFrom(uint8_t, uint8_t, uint8_t stop = 1); size_t write(uint8_t); size_t write(const uint8_t*, size_t); int available(); int read(); };
+extern TwoWire Wire;
@@ -0,0 +1,89 @@
+/** Host test stub of WisBlock-API-V2, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+typedef void* TimerHandle_t;
+typedef void* TaskHandle_t;
+typedef void* SemaphoreHandle_t;
+typedef long BaseType_t;
+typedef unsigned long TickType_t;
+#define pdTRUE 1
+#define pdFALSE 0
+#define pdPASS 1
+#define portMAX_DELAY 0xffffffff
+#define TASK_PRIO_LOW 1
+#define pdMS_TO_TICKS(x) (x)
+BaseType_t xTaskCreate(void (*)(void*), const char*, uint32_t, void*, int, TaskHandle_t*);
+SemaphoreHandle_t xSemaphoreCreateBinary(void);
+SemaphoreHandle_t xSemaphoreCreateMutex(void);
+SemaphoreHandle_t xSemaphoreCreateRecursiveMutex(void);
+BaseType_t xSemaphoreGiveRecursive(SemaphoreHandle_t);
+BaseType_t xSemaphoreTakeRecursive(SemaphoreHandle_t, TickType_t);
+BaseType_t xSemaphoreGive(SemaphoreHandle_t);
+BaseType_t xSemaphoreTake(SemaphoreHandle_t, TickType_t);
+BaseType_t xSemaphoreGiveFromISR(SemaphoreHandle_t, BaseType_t*);
+void vTaskDelay(TickType_t);
+TickType_t xTaskGetTickCount(void);
+void vTaskDelayUntil(TickType_t*, TickType_t);
+void vTaskSuspend(TaskHandle_t);
+void vTaskResume(TaskHandle_t);
+void taskENTER_CRITICAL(void);
+void taskEXIT_CRITICAL(void);
+void portYIELD_FROM_ISR(BaseType_t);
+class SoftwareTimer { public: void begin(uint32_t ms, void (*cb)(TimerHandle_t), void* = NULL, bool repeating = true); void start(); void stop(); void reset(); void setPeriod(uint32_t); };
+#define STATUS 0b0000000000000001
+#define N_STATUS 0b1111111111111110
+#define BLE_DATA 0b0000000000000100
+#define N_BLE_DATA 0b1111111111111011
+#define AT_CMD 0b0000000000001000
+#define LORA_DATA 0b0000000000010000
+#define N_LORA_DATA 0b1111111111101111
+#define LORA_TX_FIN 0b0000000000100000
+#define N_LORA_TX_FIN 0b1111111111011111
+#define LORA_JOIN_FIN 0b0000000001000000
+#define N_LORA_JOIN_FIN 0b1111111110111111
+extern volatile uint16_t g_task_event_type;
+void api_wake_loop(uint16_t);
+void api_timer_restart(uint32_t);
+void api_timer_stop(void);
+void api_set_version(uint16_t, uint16_t, uint16_t);
+void api_log_settings(void);
+void api_reset(void);
+float read_batt(void);
+void restart_advertising(uint16_t);
+void save_settings(void);
+void at_serial_input(uint8_t);
+struct s_lorawan_settings { bool lorawan_enable; uint32_t send_repeat_time; uint8_t app_port; bool confirmed_msg_enabled; uint8_t node_device_eui[8]; uint8_t lora_region; uint8_t data_rate; bool adr_enabled; };
+extern s_lorawan_settings g_lorawan_settings;
+typedef enum { LMH_SUCCESS = 0, LMH_BUSY = -1, LMH_ERROR = -2 } lmh_error_status;
+lmh_error_status send_lora_packet(uint8_t*, uint8_t, uint8_t = 0);
+bool send_p2p_packet(uint8_t*, uint8_t);
+void lmh_join(void);
+extern bool g_lpwan_has_joined; extern bool g_join_result; extern bool g_rx_fin_result;
+extern uint8_t g_rx_lora_data[256]; extern uint16_t g_rx_data_len; extern int16_t g_last_rssi; extern int8_t g_last_snr;
+extern bool g_enable_ble; extern uint8_t g_lora_p2p_rx_mode;
+#define RX_MODE_RX 1
+extern char g_custom_fw_ver[64]; extern uint16_t g_sw_ver_1, g_sw_ver_2, g_sw_ver_3;
+extern bool g_ble_uart_is_connected;
+class BLEUart : public Stream {}; extern BLEUart g_ble_uart;
+typedef struct atcmd_s { const char *cmd_name; const char *cmd_desc; int (*query_cb)(void); int (*exec_cb)(char *str); int (*exec_cb_no_para)(void); const char *permission; } atcmd_t;
+#define ATQUERY_SIZE 128
+extern char g_at_query_buf[ATQUERY_SIZE];
+#define AT_ERRNO_PARA_VAL 5
+#define AT_ERRNO_PARA_NUM 6
+#define AT_ERRNO_EXEC_FAIL 3
+#define AT_ERRNO_NOALLOW 7
+class RadioClass { public: void Sleep(); }; extern RadioClass Radio;
+#include <Adafruit_LittleFS.h>
+#include <InternalFileSystem.h>
+extern char g_ble_dev_name[10];
+extern bool g_is_helium; extern bool g_is_tester; extern bool g_gps_prec_6; extern bool g_gnss_power_off;
+extern time_t min_delay; extern time_t last_pos_send;
+extern uint8_t g_last_fport;
+typedef enum { LORAMAC_STATUS_OK, LORAMAC_STATUS_BUSY, LORAMAC_STATUS_LENGTH_ERROR } LoRaMacStatus_t;
+typedef struct { uint8_t MaxPossiblePayload; uint8_t CurrentPayloadSize; } LoRaMacTxInfo_t;
+LoRaMacStatus_t LoRaMacQueryTxPossible(uint8_t size, LoRaMacTxInfo_t *txInfo);
+typedef enum { MIB_UPLINK_COUNTER, MIB_DOWNLINK_COUNTER } Mib_t;
+typedef union { uint32_t UpLinkCounter; uint32_t DownLinkCounter; } MibParam_t;
+typedef struct { Mib_t Type; MibParam_t Param; } MibRequestConfirm_t;
+LoRaMacStatus_t LoRaMacMibGetRequestConfirm(MibRequestConfirm_t *mibGet);
@@ -0,0 +1,11 @@
+/** Host test stub of bsec, only what the firmware sources use */
+#pragma once
+#include <Wire.h>
+#define BSEC_MAX_STATE_BLOB_SIZE 139
+#define BSEC_OK 0
+#define BME680_OK 0
+#define BME680_I2C_ADDR_PRIMARY 0x76
+#define BSEC_SAMPLE_RATE_ULP 0.0033f
+typedef enum { BSEC_OUTPUT_RAW_TEMPERATURE, BSEC_OUTPUT_RAW_PRESSURE, BSEC_OUTPUT_RAW_HUMIDITY, BSEC_OUTPUT_RAW_GAS, BSEC_OUTPUT_IAQ, BSEC_OUTPUT_STATIC_IAQ, BSEC_OUTPUT_CO2_EQUIVALENT, BSEC_OUTPUT_BREATH_VOC_EQUIVALENT, BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_TEMPERATURE, BSEC_OUTPUT_SENSOR_HEAT_COMPENSATED_HUMIDITY } bsec_virtual_sensor_t;
+struct bsec_version_t { uint8_t major, minor, major_bugfix, minor_bugfix; };
+class Bsec { public: void begin(uint8_t, TwoWire&); bsec_version_t version; int status; int8_t bme680Status; void setConfig(const uint8_t*); void updateSubscription(bsec_virtual_sensor_t*, uint8_t, float); bool run(); float temperature, humidity, pressure, iaq; uint8_t iaqAccuracy; void getState(uint8_t*); void setState(uint8_t*); };
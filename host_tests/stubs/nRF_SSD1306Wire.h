@@ -0,0 +1,23 @@
+/** Host test stub of nRF_SSD1306Wire, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+#include <Wire.h>
+#define GEOMETRY_128_64 0
+#define PIN_WIRE_SDA 13
+#define PIN_WIRE_SCL 14
+#define BLACK 0
+#define WHITE 1
+#define TEXT_ALIGN_LEFT 0
+extern const uint8_t ArialMT_Plain_10[];
+class SSD1306Wire {
+public:
+ uint8_t *buffer;
+ SSD1306Wire(uint8_t, int, int, int, TwoWire *){}
+ void setI2cAutoInit(bool){}
+ bool init(){return true;}
+ void displayOff(){} void displayOn(){} void clear(){} void flipScreenVertically(){}
+ void setContrast(uint8_t){} void setFont(const uint8_t*){} void display(){}
+ void setColor(int){} void fillRect(int,int,int,int){} void setTextAlignment(int){}
+ void drawString(int,int,const char*){} void drawString(int,int,String){}
+ void drawLine(int,int,int,int){}
+};
@@ -0,0 +1,4 @@
+/** Host test stub of wisblock_cayenne, only what the firmware sources use */
+#pragma once
+#include <Arduino.h>
+class WisCayenne { public: WisCayenne(uint8_t); void reset(); uint8_t getSize(); uint8_t *getBuffer(); uint8_t addAnalogInput(uint8_t, float); uint8_t addVoltage(uint8_t, float); uint8_t addPresence(uint8_t, uint8_t); uint8_t addTemperature(uint8_t, float); uint8_t addRelativeHumidity(uint8_t, float); uint8_t addBarometricPressure(uint8_t, float); uint8_t addLuminosity(uint8_t, uint32_t); uint8_t addGyrometer(uint8_t, float, float, float); uint8_t addAccelerometer(uint8_t, float, float, float); uint8_t addVoc_index(uint8_t, uint32_t); uint8_t addConcentration(uint8_t, uint32_t); uint8_t addPercentage(uint8_t, uint32_t); uint8_t addDigitalInput(uint8_t, uint32_t); uint8_t addDevID(uint8_t, uint8_t*); uint8_t addGNSS_4(uint8_t, int32_t, int32_t, int32_t); uint8_t addGNSS_6(uint8_t, int32_t, int32_t, int32_t); uint8_t addGNSS_H(int32_t, int32_t, int16_t, int16_t, int16_t); uint8_t addGNSS_T(int32_t, int32_t, int16_t, float, int8_t); uint8_t addGenericSensor(uint8_t, float); uint8_t addUnixTime(uint8_t, uint32_t); uint8_t addFrequency(uint8_t, uint32_t); uint8_t addDistance(uint8_t, float); uint8_t addEnergy(uint8_t, float); uint8_t addPower(uint8_t, uint32_t); uint8_t addCurrent(uint8_t, float); };
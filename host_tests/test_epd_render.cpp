@@ -0,0 +1,141 @@
+/**
+ * @file test_epd_render.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host test and benchmark of the RAK14000 4.2" screen rendering
+ *        Random sensor values are rendered with refresh_rak14000() into the
+ *        canvas of the Adafruit GFX stub, with and without PM sensor. The
+ *        screens are compared by a hash with the output of the driver before
+ *        the layout tables (EPD_REF_xxx), the font calls are counted.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "RAK14000_epd_4_2_bw.cpp"
+#include <random>
+#include "host_stubs.h"
+
+sensors_t found_sensors[64];
+volatile bool voc_valid = false;
+date_time_s g_date_time;
+void i2c_lock(void) {}
+void i2c_unlock(void) {}
+void read_rak12002(void) {}
+float read_batt(void) { return 3950.0f; }
+
+/** Screens rendered per layout */
+#define EPD_SCREENS 3000
+
+/** Hash of all screens of a layout rendered by the driver before the layout tables */
+#define EPD_REF_NO_PM 0xc06dec2374485693ULL
+#define EPD_REF_PM 0x4808cb5914670c44ULL
+
+/** Font calls per refresh of the driver before the layout tables, getTextBounds() and setFont() */
+#define EPD_OLD_BOUNDS_NO_PM 8
+#define EPD_OLD_BOUNDS_PM 9
+#define EPD_OLD_FONTS_NO_PM 24
+#define EPD_OLD_FONTS_PM 31
+
+static std::mt19937 rng(1402);
+
+/**
+ * @brief Random integer in a range
+ *
+ */
+static int32_t random_int(int32_t min, int32_t max)
+{
+	return std::uniform_int_distribution<int32_t>(min, max)(rng);
+}
+
+/**
+ * @brief Random sensor values, date and time for one screen
+ *     Covers the VOC and CO2 warnings, the header with and without clock and battery
+ *
+ */
+static void random_values(bool has_pm)
+{
+	voc_valid = random_int(0, 9) != 0;
+	set_voc_rak14000(random_int(0, 500));
+	set_temp_rak14000(random_int(-2000, 4500) / 100.0f);
+	set_humid_rak14000(random_int(0, 10000) / 100.0f);
+	set_baro_rak14000(random_int(95000, 105000) / 100.0f);
+	set_co2_rak14000((float)random_int(250, 2500));
+	if (has_pm)
+	{
+		set_pm_rak14000(random_int(0, 100), random_int(0, 150), random_int(0, 250));
+	}
+	found_sensors[RTC_ID].found_sensor = random_int(0, 3) != 0;
+	found_sensors[CO2_ID].found_sensor = random_int(0, 1) != 0;
+	g_date_time.year = random_int(2020, 2030);
+	g_date_time.month = random_int(1, 12);
+	g_date_time.date = random_int(1, 31);
+	g_date_time.hour = random_int(0, 23);
+	g_date_time.minute = random_int(0, 59);
+}
+
+/**
+ * @brief Hash of the canvas (FNV-1a)
+ *
+ */
+static uint64_t canvas_hash(uint64_t hash)
+{
+	for (int32_t idx = 0; idx < display.width() * display.height(); idx++)
+	{
+		hash ^= display.canvas[idx];
+		hash *= 0x100000001b3ULL;
+	}
+	return hash;
+}
+
+/**
+ * @brief Render the screens of one layout
+ *
+ * @param has_pm layout with PM sensor
+ * @param ref hash of the screens of the previous driver
+ * @param old_bounds getTextBounds() calls per refresh of the previous driver
+ * @param old_fonts setFont() calls per refresh of the previous driver
+ */
+static void test_layout(bool has_pm, uint64_t ref, uint32_t old_bounds, uint32_t old_fonts)
+{
+	found_sensors[PM_ID].found_sensor = has_pm;
+	display.setRotation(3);
+
+	// The static texts are measured with the first refresh
+	random_values(has_pm);
+	refresh_rak14000();
+
+	uint64_t hash = 0xcbf29ce484222325ULL;
+	uint32_t bounds_start = Adafruit_GFX::calls_getTextBounds;
+	uint32_t fonts_start = Adafruit_GFX::calls_setFont;
+	double seconds = 0.0;
+	for (uint16_t screen = 0; screen < EPD_SCREENS; screen++)
+	{
+		random_values(has_pm);
+		double start = host_seconds();
+		refresh_rak14000();
+		seconds += host_seconds() - start;
+		hash = canvas_hash(hash);
+	}
+	uint32_t black = 0;
+	for (int32_t idx = 0; idx < display.width() * display.height(); idx++)
+	{
+		black += display.canvas[idx] == EPD_BLACK ? 1 : 0;
+	}
+	uint32_t bounds = (Adafruit_GFX::calls_getTextBounds - bounds_start) / EPD_SCREENS;
+	uint32_t fonts = (Adafruit_GFX::calls_setFont - fonts_start) / EPD_SCREENS;
+
+	printf("Layout %s: %d screens, hash %016llx, per refresh getTextBounds %u (before %u), setFont %u (before %u), %.1f us per screen (host CPU)\n",
+		   has_pm ? "PM" : "no PM", EPD_SCREENS, (unsigned long long)hash, bounds, old_bounds, fonts, old_fonts, seconds * 1e6 / EPD_SCREENS);
+	HOST_CHECK(black > 5000, "layout %s only %u black pixels", has_pm ? "PM" : "no PM", black);
+	HOST_CHECK(hash == ref, "layout %s screens differ from the previous driver", has_pm ? "PM" : "no PM");
+	HOST_CHECK(bounds < old_bounds, "layout %s getTextBounds %u", has_pm ? "PM" : "no PM", bounds);
+	HOST_CHECK(fonts < old_fonts, "layout %s setFont %u", has_pm ? "PM" : "no PM", fonts);
+}
+
+int main(void)
+{
+	test_layout(false, EPD_REF_NO_PM, EPD_OLD_BOUNDS_NO_PM, EPD_OLD_FONTS_NO_PM);
+	test_layout(true, EPD_REF_PM, EPD_OLD_BOUNDS_PM, EPD_OLD_FONTS_PM);
+	return host_result("test_epd_render");
+}
@@ -0,0 +1,150 @@
+/**
+ * @file test_frag_reassembler.js
+ * @brief Host test of the network side reassembler
+ *        Reads the objects and fragments written by test_frag_transport and
+ *        feeds the fragments into decoders/frag_reassembler.js. All fragments
+ *        must return every object with its fPort and the frame counter of the
+ *        first fragment. With one random fragment lost per parity group every
+ *        object with parity must still be returned.
+ *        Usage: node test_frag_reassembler.js build/test_frag_transport.txt
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+var fs = require('fs');
+var FragReassembler = require('../decoders/frag_reassembler.js');
+
+var failed = 0;
+
+/** State of the random generator, fixed seed for repeatable runs */
+var seed = 4242;
+
+/**
+ * @brief Random integer 0 .. max - 1 (Park-Miller)
+ *
+ */
+function randomInt(max) {
+	seed = (seed * 48271) % 2147483647;
+	return seed % max;
+}
+
+/**
+ * @brief Report a failed check, only the first ones are printed
+ *
+ */
+function check(condition, message) {
+	if (!condition) {
+		if (failed < 10) {
+			console.log('FAIL: ' + message);
+		}
+		failed++;
+	}
+}
+
+/**
+ * @brief Read the objects and their fragments
+ *
+ * @param name file written by test_frag_transport
+ * @return list of {fPort, bytes, fragments: [{fCnt, bytes}]}
+ */
+function readObjects(name) {
+	var objects = [];
+	fs.readFileSync(name, 'utf8').split('\n').forEach(function (line) {
+		var parts = line.trim().split(' ');
+		if (parts.length !== 3) {
+			return;
+		}
+		var bytes = Buffer.from(parts[2], 'hex');
+		if (parts[0] === 'O') {
+			objects.push({ fPort: parseInt(parts[1], 10), bytes: bytes, fragments: [] });
+		} else if (parts[0] === 'F') {
+			objects[objects.length - 1].fragments.push({ fCnt: parseInt(parts[1], 10), bytes: bytes });
+		}
+	});
+	return objects;
+}
+
+/**
+ * @brief Compare a returned object with the sent one
+ *
+ */
+function checkResult(result, obj, num, pass) {
+	check(result !== null, pass + ' object ' + num + ' not returned');
+	if (result === null) {
+		return false;
+	}
+	var same = (result.fPort === obj.fPort) && (result.fCnt === obj.fragments[0].fCnt) &&
+		Buffer.from(result.bytes).equals(obj.bytes);
+	check(same, pass + ' object ' + num + ' differs');
+	return same;
+}
+
+/**
+ * @brief All fragments received, in order
+ *
+ */
+function testAll(objects) {
+	var reassembler = new FragReassembler();
+	var returned = 0;
+	objects.forEach(function (obj, num) {
+		var result = null;
+		obj.fragments.forEach(function (fragment) {
+			var value = reassembler.add(fragment.bytes, fragment.fCnt);
+			if (value !== null) {
+				check(result === null, 'all fragments: object ' + num + ' returned twice');
+				result = value;
+			}
+		});
+		if (checkResult(result, obj, num, 'all fragments:')) {
+			returned++;
+		}
+	});
+	console.log('All fragments: ' + returned + ' of ' + objects.length + ' objects returned');
+}
+
+/**
+ * @brief One random fragment of each parity group lost
+ *     A group is sent as its data fragments followed by the parity fragment
+ *
+ */
+function testLoss(objects) {
+	var reassembler = new FragReassembler();
+	var withParity = 0;
+	var recovered = 0;
+	var lost = 0;
+	objects.forEach(function (obj, num) {
+		var group = obj.fragments[0].bytes[0] & 0x0F;
+		var fragments = obj.fragments;
+		if (group !== 0) {
+			withParity++;
+			fragments = [];
+			for (var start = 0; start < obj.fragments.length; start += group + 1) {
+				var chunk = obj.fragments.slice(start, start + group + 1);
+				var drop = randomInt(chunk.length);
+				chunk.splice(drop, 1);
+				lost++;
+				fragments = fragments.concat(chunk);
+			}
+		}
+		var result = null;
+		fragments.forEach(function (fragment) {
+			var value = reassembler.add(fragment.bytes, fragment.fCnt);
+			if (value !== null) {
+				result = value;
+			}
+		});
+		if (checkResult(result, obj, num, 'one lost per group:') && (group !== 0)) {
+			recovered++;
+		}
+	});
+	console.log('One lost per group: ' + recovered + ' of ' + withParity + ' objects with parity recovered, ' + lost + ' fragments lost');
+}
+
+var objects = readObjects(process.argv[2] || 'build/test_frag_transport.txt');
+check(objects.length > 0, 'no objects');
+testAll(objects);
+testLoss(objects);
+console.log('test_frag_reassembler: ' + (failed === 0 ? 'PASS' : 'FAIL (' + failed + ' checks)'));
+process.exit(failed === 0 ? 0 : 1);
@@ -0,0 +1,149 @@
+/**
+ * @file test_frag_transport.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host test of the fragmented uplink transport
+ *        Random objects are sent with frag_send() through a fake MAC with
+ *        different maximum payloads and parity group sizes. The fragments are
+ *        checked for size and order and written to build/test_frag_transport.txt,
+ *        test_frag_reassembler.js feeds them into decoders/frag_reassembler.js.
+ *
+ *        File format, one line per object followed by one line per fragment:
+ *        O <fPort> <object hex>
+ *        F <fCnt> <fragment hex>
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "frag_transport.cpp"
+#include <random>
+#include <vector>
+#include "host_stubs.h"
+
+sensors_t found_sensors[64];
+void api_wake_loop(uint16_t) {}
+
+/** Maximum payload the fake MAC reports */
+static uint8_t sim_max_payload = FRAG_MIN_PAYLOAD;
+
+/** Fragments enqueued by the transport */
+static std::vector<std::vector<uint8_t>> sent;
+
+LoRaMacStatus_t LoRaMacQueryTxPossible(uint8_t, LoRaMacTxInfo_t *txInfo)
+{
+	txInfo->MaxPossiblePayload = sim_max_payload;
+	txInfo->CurrentPayloadSize = 0;
+	return LORAMAC_STATUS_OK;
+}
+
+lmh_error_status send_lora_packet(uint8_t *data, uint8_t size, uint8_t fport)
+{
+	if ((fport != FRAG_FPORT) || (size > sim_max_payload))
+	{
+		return LMH_ERROR;
+	}
+	sent.push_back(std::vector<uint8_t>(data, data + size));
+	return LMH_SUCCESS;
+}
+
+static std::mt19937 rng(4242);
+
+/**
+ * @brief Random integer in a range
+ *
+ */
+static int32_t random_int(int32_t min, int32_t max)
+{
+	return std::uniform_int_distribution<int32_t>(min, max)(rng);
+}
+
+/**
+ * @brief Write bytes as hex
+ *
+ */
+static void write_hex(FILE *file, const uint8_t *data, size_t size)
+{
+	for (size_t idx = 0; idx < size; idx++)
+	{
+		fprintf(file, "%02x", data[idx]);
+	}
+	fprintf(file, "\n");
+}
+
+/**
+ * @brief Random objects with the payloads of the data rates and the parity group sizes
+ *     One TX cycle per fragment, like the app does on LORA_TX_FIN and FRAG_REQ
+ *
+ */
+static void test_objects(FILE *file)
+{
+	const uint8_t payloads[4] = {11, 51, 115, 222};
+	const uint16_t num_objects = 3000;
+	uint16_t num_sent = 0;
+	uint16_t num_rejected = 0;
+	uint32_t num_fragments = 0;
+	uint32_t fcnt = 0;
+
+	host_serial_mute = true;
+	for (uint16_t object = 0; object < num_objects; object++)
+	{
+		uint16_t size = random_int(12, 1011);
+		uint8_t group = random_int(0, 5);
+		uint8_t fport = random_int(1, 223);
+		sim_max_payload = payloads[random_int(0, 3)];
+		set_frag(group, FRAG_GAP_DEFAULT);
+
+		std::vector<uint8_t> data(size);
+		for (uint8_t &byte : data)
+		{
+			byte = random_int(0, 255);
+		}
+
+		uint8_t frag_bytes = sim_max_payload - FRAG_HEADER_SIZE;
+		uint16_t count = (size + frag_bytes - 1) / frag_bytes;
+		sent.clear();
+		bool started = frag_send(data.data(), size, fport);
+		if (count > FRAG_MAX_FRAGMENTS)
+		{
+			HOST_CHECK(!started, "object %d, %d fragments accepted", object, count);
+			num_rejected++;
+			continue;
+		}
+		HOST_CHECK(started, "object %d not started", object);
+		while (frag_busy())
+		{
+			frag_tx_finished();
+			frag_next();
+		}
+
+		uint16_t groups = group == 0 ? 0 : (count + group - 1) / group;
+		HOST_CHECK(sent.size() == (size_t)(count + groups), "object %d, %zu fragments, expected %d", object, sent.size(), count + groups);
+		fprintf(file, "O %d ", fport);
+		write_hex(file, data.data(), size);
+		for (std::vector<uint8_t> &fragment : sent)
+		{
+			HOST_CHECK(fragment.size() <= sim_max_payload, "object %d fragment of %zu bytes", object, fragment.size());
+			HOST_CHECK((fragment[0] & 0x0F) == group, "object %d group in header", object);
+			fprintf(file, "F %u ", fcnt++);
+			write_hex(file, fragment.data(), fragment.size());
+		}
+		num_sent++;
+		num_fragments += sent.size();
+	}
+	host_serial_mute = false;
+	printf("Objects: %d sent in %u fragments, %d rejected with more than %d fragments\n", num_sent, num_fragments, num_rejected, FRAG_MAX_FRAGMENTS);
+}
+
+int main(void)
+{
+	FILE *file = fopen("build/test_frag_transport.txt", "w");
+	if (file == NULL)
+	{
+		printf("Can not write build/test_frag_transport.txt\n");
+		return 1;
+	}
+	test_objects(file);
+	fclose(file);
+	return host_result("test_frag_transport");
+}
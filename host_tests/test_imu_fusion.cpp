@@ -0,0 +1,306 @@
+/**
+ * @file test_imu_fusion.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host test of the orientation fusion
+ *        Feeds a synthetic rotation trace with gyroscope bias and noise through
+ *        the fusion cycle and compares roll and pitch with the true orientation.
+ *        Checks that a gap in the samples keeps the orientation and measures
+ *        the filter throughput.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "imu_fusion.cpp"
+#include <random>
+#include <vector>
+#include "host_stubs.h"
+
+sensors_t found_sensors[64];
+WisCayenne g_solution_data(255);
+
+void i2c_lock(void) {}
+void i2c_unlock(void) {}
+
+/** Samples the fake modules deliver on the next fusion cycle */
+static std::vector<imu_sample_t> pending[3];
+
+uint16_t read_fifo_rak1905(void) { return (uint16_t)pending[IMU_TYPE_ACC].size(); }
+bool read_mag_rak1905(void) { return !pending[IMU_TYPE_MAG].empty(); }
+uint16_t read_fifo_rak12034(void) { return 0; }
+bool read_mag_rak12034(void) { return false; }
+
+uint16_t imu_get_samples(uint8_t source, uint8_t type, imu_sample_t *samples, uint16_t max_samples)
+{
+	uint16_t num = 0;
+	for (imu_sample_t &sample : pending[type])
+	{
+		if ((sample.source == source) && (num < max_samples))
+		{
+			samples[num++] = sample;
+		}
+	}
+	pending[type].clear();
+	return num;
+}
+
+/** Sample rate of the simulated module in Hz */
+#define SIM_ODR 100
+/** Fusion rate in Hz */
+#define SIM_RATE 10
+/** Gravity in micro g */
+#define SIM_G 1000000.0
+
+/** True orientation of the simulated module */
+struct sim_state
+{
+	double w = 1.0, x = 0.0, y = 0.0, z = 0.0;
+	std::mt19937 rng{1234};
+	std::normal_distribution<double> noise{0.0, 1.0};
+	uint32_t timestamp = 0;
+};
+
+/**
+ * @brief Rotate the true orientation by a body rate
+ *
+ * @param sim simulation
+ * @param gx gy gz body rate in rad/s
+ * @param dt time step in s
+ */
+static void sim_rotate(sim_state &sim, double gx, double gy, double gz, double dt)
+{
+	double angle = sqrt(gx * gx + gy * gy + gz * gz) * dt;
+	if (angle < 1e-12)
+	{
+		return;
+	}
+	double s = sin(angle * 0.5) / (angle / dt);
+	double rw = cos(angle * 0.5), rx = gx * s, ry = gy * s, rz = gz * s;
+	double w = sim.w * rw - sim.x * rx - sim.y * ry - sim.z * rz;
+	double x = sim.w * rx + sim.x * rw + sim.y * rz - sim.z * ry;
+	double y = sim.w * ry - sim.x * rz + sim.y * rw + sim.z * rx;
+	double z = sim.w * rz + sim.x * ry - sim.y * rx + sim.z * rw;
+	double norm = sqrt(w * w + x * x + y * y + z * z);
+	sim.w = w / norm;
+	sim.x = x / norm;
+	sim.y = y / norm;
+	sim.z = z / norm;
+}
+
+/**
+ * @brief Queue one accelerometer and gyroscope sample of the true orientation
+ *
+ * @param sim simulation
+ * @param rate body rate in deg/s
+ * @param bias gyroscope bias in deg/s
+ */
+static void sim_sample(sim_state &sim, const double *rate, const double *bias)
+{
+	// Gravity in the body frame
+	double ax = 2.0 * (sim.x * sim.z - sim.w * sim.y);
+	double ay = 2.0 * (sim.w * sim.x + sim.y * sim.z);
+	double az = sim.w * sim.w - sim.x * sim.x - sim.y * sim.y + sim.z * sim.z;
+	imu_sample_t acc = {sim.timestamp,
+						(int32_t)(ax * SIM_G + sim.noise(sim.rng) * 2000.0),
+						(int32_t)(ay * SIM_G + sim.noise(sim.rng) * 2000.0),
+						(int32_t)(az * SIM_G + sim.noise(sim.rng) * 2000.0),
+						IMU_SRC_RAK1905, IMU_TYPE_ACC};
+	imu_sample_t gyro = {sim.timestamp,
+						 (int32_t)((rate[0] + bias[0] + sim.noise(sim.rng) * 0.05) * 1000.0),
+						 (int32_t)((rate[1] + bias[1] + sim.noise(sim.rng) * 0.05) * 1000.0),
+						 (int32_t)((rate[2] + bias[2] + sim.noise(sim.rng) * 0.05) * 1000.0),
+						 IMU_SRC_RAK1905, IMU_TYPE_GYRO};
+	pending[IMU_TYPE_ACC].push_back(acc);
+	pending[IMU_TYPE_GYRO].push_back(gyro);
+}
+
+/**
+ * @brief Advance the simulation by one sample period
+ *
+ * @param sim simulation
+ * @param rate body rate in deg/s, constant over the period
+ * @param bias gyroscope bias in deg/s
+ * @param deliver false to lose the sample
+ */
+static void sim_step(sim_state &sim, const double *rate, const double *bias, bool deliver)
+{
+	const double dt = 1.0 / SIM_ODR;
+	sim_rotate(sim, rate[0] * M_PI / 180.0, rate[1] * M_PI / 180.0, rate[2] * M_PI / 180.0, dt);
+	sim.timestamp += 1000000 / SIM_ODR;
+	if (deliver)
+	{
+		sim_sample(sim, rate, bias);
+	}
+}
+
+/**
+ * @brief Roll, pitch and yaw of the true orientation in degrees
+ *
+ */
+static void sim_angles(const sim_state &sim, double *roll, double *pitch, double *yaw)
+{
+	double sin_pitch = -2.0 * (sim.x * sim.z - sim.w * sim.y);
+	sin_pitch = sin_pitch > 1.0 ? 1.0 : (sin_pitch < -1.0 ? -1.0 : sin_pitch);
+	*roll = atan2(sim.w * sim.x + sim.y * sim.z, 0.5 - sim.x * sim.x - sim.y * sim.y) * 180.0 / M_PI;
+	*pitch = asin(sin_pitch) * 180.0 / M_PI;
+	*yaw = atan2(sim.x * sim.y + sim.w * sim.z, 0.5 - sim.y * sim.y - sim.z * sim.z) * 180.0 / M_PI;
+}
+
+/**
+ * @brief Difference of two angles, wrapped to +-180 degrees
+ *
+ */
+static double angle_error(double a, double b)
+{
+	double diff = fmod(a - b + 540.0, 360.0) - 180.0;
+	return fabs(diff);
+}
+
+/**
+ * @brief Tilt error, angle between the estimated and the true direction of gravity
+ *     Same as the roll and pitch error, but also defined close to +-90 degrees pitch
+ *     where roll and heading cannot be separated
+ *
+ * @return double error in degrees
+ */
+static double tilt_error(const sim_state &sim)
+{
+	double ex = 2.0 * (q1 * q3 - q0 * q2);
+	double ey = 2.0 * (q0 * q1 + q2 * q3);
+	double ez = q0 * q0 - q1 * q1 - q2 * q2 + q3 * q3;
+	double tx = 2.0 * (sim.x * sim.z - sim.w * sim.y);
+	double ty = 2.0 * (sim.w * sim.x + sim.y * sim.z);
+	double tz = sim.w * sim.w - sim.x * sim.x - sim.y * sim.y + sim.z * sim.z;
+	double dot = (ex * tx + ey * ty + ez * tz) / sqrt((ex * ex + ey * ey + ez * ez) * (tx * tx + ty * ty + tz * tz));
+	dot = dot > 1.0 ? 1.0 : dot;
+	return acos(dot) * 180.0 / M_PI;
+}
+
+/**
+ * @brief Restart the filter state between the scenarios
+ *
+ */
+static void fusion_reset(void)
+{
+	fusion_started = false;
+	fusion_valid = false;
+	last_sample_time = 0;
+	for (std::vector<imu_sample_t> &queue : pending)
+	{
+		queue.clear();
+	}
+}
+
+/**
+ * @brief Ten minutes of rotation around all axes with gyroscope bias
+ *     The tilt (roll and pitch) must follow the true orientation within
+ *     1 degree once the bias is learned.
+ *
+ */
+static void test_rotation_trace(void)
+{
+	sim_state sim;
+	const double bias[3] = {0.5, -0.3, 0.4};
+	double max_error = 0.0;
+	double sum_error = 0.0;
+	uint32_t num_checks = 0;
+
+	fusion_reset();
+	for (uint32_t step = 0; step < 600 * SIM_ODR; step++)
+	{
+		double t = (double)step / SIM_ODR;
+		const double rate[3] = {40.0 * sin(2.0 * M_PI * 0.13 * t),
+								25.0 * sin(2.0 * M_PI * 0.07 * t + 1.0),
+								30.0 * sin(2.0 * M_PI * 0.05 * t + 2.0)};
+		sim_step(sim, rate, bias, true);
+		if ((step % (SIM_ODR / SIM_RATE)) != (SIM_ODR / SIM_RATE - 1))
+		{
+			continue;
+		}
+		fusion_cycle();
+		// 60 seconds to learn the gyroscope bias
+		if (t < 60.0)
+		{
+			continue;
+		}
+		double error = tilt_error(sim);
+		max_error = error > max_error ? error : max_error;
+		sum_error += error;
+		num_checks++;
+	}
+	printf("Rotation trace: max tilt error %.3f deg, mean %.3f deg over %u cycles\n", max_error, sum_error / num_checks, num_checks);
+	HOST_CHECK(fusion_valid, "no result");
+	HOST_CHECK(max_error < 1.0, "tilt error %.3f deg", max_error);
+}
+
+/**
+ * @brief Turn by 60 degrees, lose one second of samples while standing still
+ *     The heading must be kept, it was reset to 0 when the filter restarted
+ *
+ */
+static void test_gap(void)
+{
+	sim_state sim;
+	const double bias[3] = {0.0, 0.0, 0.0};
+	const double still[3] = {0.0, 0.0, 0.0};
+	const double turn[3] = {0.0, 0.0, 30.0};
+
+	fusion_reset();
+	// 1 s still, 2 s turning with 30 deg/s, 1 s still, 1 s lost, 1 s still
+	for (uint32_t step = 0; step < 6 * SIM_ODR; step++)
+	{
+		double t = (double)step / SIM_ODR;
+		bool turning = (t >= 1.0) && (t < 3.0);
+		bool lost = (t >= 4.0) && (t < 5.0);
+		sim_step(sim, turning ? turn : still, bias, !lost);
+		if ((step % (SIM_ODR / SIM_RATE)) == (SIM_ODR / SIM_RATE - 1))
+		{
+			fusion_cycle();
+		}
+	}
+	double roll, pitch, yaw;
+	sim_angles(sim, &roll, &pitch, &yaw);
+	printf("Gap: yaw %.2f deg after the gap, true %.2f deg\n", fusion_angles.yaw, yaw);
+	HOST_CHECK(angle_error(fusion_angles.yaw, yaw) < 1.0, "yaw %.2f deg after the gap", fusion_angles.yaw);
+	HOST_CHECK(angle_error(fusion_angles.roll, roll) < 0.5, "roll %.2f deg after the gap", fusion_angles.roll);
+}
+
+/**
+ * @brief Filter updates per second, with and without magnetometer
+ *
+ */
+static void test_throughput(void)
+{
+	const uint32_t num_updates = 5000000;
+	const float mag[3] = {20000.0f, 5000.0f, -40000.0f};
+
+	fusion_start(0.0f, 0.0f, 1000000.0f);
+	double start = host_seconds();
+	for (uint32_t idx = 0; idx < num_updates; idx++)
+	{
+		mahony_update(0.01f, -0.02f, 0.03f, 1000.0f, -2000.0f, 1000000.0f, NULL, 0.01f);
+	}
+	double no_mag = num_updates / (host_seconds() - start);
+
+	start = host_seconds();
+	for (uint32_t idx = 0; idx < num_updates; idx++)
+	{
+		mahony_update(0.01f, -0.02f, 0.03f, 1000.0f, -2000.0f, 1000000.0f, mag, 0.01f);
+	}
+	double with_mag = num_updates / (host_seconds() - start);
+	printf("Throughput: %.1f M updates/s without, %.1f M updates/s with magnetometer (host CPU)\n", no_mag / 1e6, with_mag / 1e6);
+	HOST_CHECK(isfinite(q0) && isfinite(q1) && isfinite(q2) && isfinite(q3), "quaternion diverged");
+}
+
+int main(void)
+{
+	found_sensors[MPU_ID].found_sensor = true;
+	init_fusion();
+	set_fusion(SIM_RATE, false);
+
+	test_rotation_trace();
+	test_gap();
+	test_throughput();
+	return host_result("test_imu_fusion");
+}
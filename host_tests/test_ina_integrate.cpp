@@ -0,0 +1,240 @@
+/**
+ * @file test_ina_integrate.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host test of the RAK16000 charge and energy integration
+ *        A simulated 1 hour load profile, 5 mA base current with 300 mA
+ *        bursts, is sampled at 10 Hz through ina_sample(). The integrated
+ *        charge and energy are compared with the exact integrals of the profile,
+ *        with a stable supply and with a supply that sags during the bursts.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "RAK16000_current.cpp"
+#include <random>
+#include <vector>
+#include "host_stubs.h"
+
+sensors_t found_sensors[64];
+WisCayenne g_solution_data(255);
+void i2c_lock(void) {}
+void i2c_unlock(void) {}
+
+TwoWire Wire;
+void TwoWire::begin() {}
+
+/** Values the fake INA219 returns */
+static float sim_shunt_mv = 0.0f;
+static float sim_bus_v = 0.0f;
+
+INA219_WE::INA219_WE(int) {}
+bool INA219_WE::init() { return true; }
+void INA219_WE::setADCMode(INA219_ADC_MODE) {}
+void INA219_WE::setMeasureMode(INA219_MEASURE_MODE) {}
+void INA219_WE::setPGain(INA219_PGAIN) {}
+void INA219_WE::setBusRange(INA219_BUS_RANGE) {}
+void INA219_WE::setShuntSizeInOhms(float) {}
+void INA219_WE::setCorrectionFactor(float) {}
+float INA219_WE::getShuntVoltage_mV() { return sim_shunt_mv; }
+float INA219_WE::getBusVoltage_V() { return sim_bus_v; }
+float INA219_WE::getBusPower() { return sim_shunt_mv / INA_SHUNT_OHM * sim_bus_v; }
+bool INA219_WE::getOverflow() { return false; }
+
+static std::mt19937 rng(1604);
+
+/** Load profile */
+#define BASE_MA 5.0
+#define BURST_MA 300.0
+/** Battery voltage without load */
+#define BATT_V 3.7
+
+/** Internal resistance of the supply in Ohm */
+static double batt_ohm = 0.0;
+
+/** One burst of the load profile */
+struct burst
+{
+	uint64_t start_us;
+	uint64_t end_us;
+};
+
+/**
+ * @brief Current of the load profile
+ *
+ */
+static double load_ma(bool in_burst)
+{
+	return in_burst ? BURST_MA : BASE_MA;
+}
+
+/**
+ * @brief Bus voltage at a load current
+ *
+ */
+static double load_v(double current_ma)
+{
+	return BATT_V - batt_ohm * current_ma / 1000.0;
+}
+
+/**
+ * @brief Integrals of the load profile over a time window
+ *     The bursts are sorted, the window is walked from burst to burst
+ *
+ * @param bursts burst list
+ * @param next first burst that can overlap the window, moved forward
+ * @param from window start in us
+ * @param to window end in us
+ * @param charge charge in mA * us
+ * @param energy energy in mW * us
+ * @param volt_time bus voltage in V * us
+ */
+static void load_integrals(const std::vector<burst> &bursts, size_t &next, uint64_t from, uint64_t to,
+						   double &charge, double &energy, double &volt_time)
+{
+	charge = 0.0;
+	energy = 0.0;
+	volt_time = 0.0;
+	uint64_t now = from;
+	while (now < to)
+	{
+		while ((next < bursts.size()) && (bursts[next].end_us <= now))
+		{
+			next++;
+		}
+		bool in_burst = (next < bursts.size()) && (bursts[next].start_us <= now);
+		uint64_t until = to;
+		if (next < bursts.size())
+		{
+			uint64_t edge = in_burst ? bursts[next].end_us : bursts[next].start_us;
+			until = edge < to ? edge : to;
+		}
+		double current = load_ma(in_burst);
+		double dt = (double)(until - now);
+		charge += current * dt;
+		energy += current * load_v(current) * dt;
+		volt_time += load_v(current) * dt;
+		now = until;
+	}
+}
+
+/**
+ * @brief 1 hour profile sampled at 10 Hz
+ *     The fake INA219 returns the mean of the shunt and bus voltage since the
+ *     previous sample, as the ADC averaging does. The sample period jitters
+ *     like the task scheduling.
+ *     With a sagging supply the power from the mean voltage and the mean current
+ *     differs from the mean power in the periods with a burst edge.
+ *
+ * @param ohm internal resistance of the supply
+ * @param energy_limit allowed energy error in %
+ */
+static void test_profile(double ohm, double energy_limit)
+{
+	batt_ohm = ohm;
+	const uint64_t duration_us = 3600ULL * 1000000ULL;
+
+	// Bursts of 20 ms to 2 s, 1 to 10 s apart
+	std::vector<burst> bursts;
+	uint64_t time_us = 0;
+	while (true)
+	{
+		time_us += std::uniform_int_distribution<uint64_t>(1000000, 10000000)(rng);
+		uint64_t length = std::uniform_int_distribution<uint64_t>(20000, 2000000)(rng);
+		if (time_us + length >= duration_us)
+		{
+			break;
+		}
+		bursts.push_back({time_us, time_us + length});
+		time_us += length;
+	}
+
+	init_rak16000();
+	set_rate_rak16000(10);
+	host_time_us = 0;
+
+	double true_charge = 0.0;
+	double true_energy = 0.0;
+	size_t next = 0;
+	uint64_t last_us = 0;
+	bool first = true;
+	uint32_t num_samples = 0;
+	while (true)
+	{
+		uint64_t now_us = last_us + 100000 + std::uniform_int_distribution<int>(-2000, 2000)(rng);
+		if (first)
+		{
+			now_us = 100000;
+		}
+		if (now_us > duration_us)
+		{
+			break;
+		}
+		double charge, energy, volt_time;
+		load_integrals(bursts, next, last_us, now_us, charge, energy, volt_time);
+		double dt = (double)(now_us - last_us);
+		double mean_ma = charge / dt;
+		sim_shunt_mv = (float)(mean_ma * INA_SHUNT_OHM);
+		sim_bus_v = (float)(volt_time / dt);
+		host_time_us = now_us;
+		ina_sample();
+		num_samples++;
+
+		// The integration starts with the first sample
+		if (!first)
+		{
+			true_charge += charge;
+			true_energy += energy;
+		}
+		first = false;
+		last_us = now_us;
+	}
+	// Ground truth in µAh and µWh
+	true_charge = true_charge * 1000.0 / 3600e6;
+	true_energy = true_energy * 1000.0 / 3600e6;
+	double charge_uah = ina_accu.charge_uah + (double)ina_accu.charge_rem / INA_US_PER_HOUR;
+	double energy_uwh = ina_accu.energy_uwh + (double)ina_accu.energy_rem / INA_US_PER_HOUR;
+	double charge_error = fabs(charge_uah - true_charge) / true_charge * 100.0;
+	double energy_error = fabs(energy_uwh - true_energy) / true_energy * 100.0;
+
+	printf("Profile %.1f Ohm supply: %zu bursts, %u samples in %u ms, charge %.3f mAh (true %.3f) error %.4f %%, energy %.3f mWh (true %.3f) error %.4f %%, peak %.1f mA\n",
+		   batt_ohm, bursts.size(), ina_accu.samples, ina_accu.duration_ms, charge_uah / 1000.0, true_charge / 1000.0, charge_error,
+		   energy_uwh / 1000.0, true_energy / 1000.0, energy_error, ina_accu.peak_ua / 1000.0);
+	HOST_CHECK(ina_accu.samples == num_samples - 1, "%u samples integrated, expected %u", ina_accu.samples, num_samples - 1);
+	HOST_CHECK(charge_error < 0.01, "charge error %.4f %%", charge_error);
+	HOST_CHECK(energy_error < energy_limit, "energy error %.4f %%", energy_error);
+	HOST_CHECK(ina_accu.peak_ua > 0.99 * BURST_MA * 1000.0, "peak %d uA", ina_accu.peak_ua);
+}
+
+/**
+ * @brief Remainders move into the whole units, the sum of many tiny areas is exact
+ *
+ */
+static void test_remainder(void)
+{
+	ina_accu_t accu;
+	memset(&accu, 0, sizeof(accu));
+	// 1 µA for 1 ms, 3.6e6 times is exactly 1 µAh
+	for (uint32_t idx = 0; idx < 3600000; idx++)
+	{
+		ina_integrate(&accu, 1, 1, 1, 1, 1000);
+	}
+	HOST_CHECK((accu.charge_uah == 1) && (accu.charge_rem == 0), "charge %lld µAh rem %lld", (long long)accu.charge_uah, (long long)accu.charge_rem);
+	HOST_CHECK(accu.duration_ms == 3600000, "duration %u ms", accu.duration_ms);
+
+	// Negative currents, charging the battery
+	memset(&accu, 0, sizeof(accu));
+	ina_integrate(&accu, -250000, -900000, -250000, -900000, 3600000);
+	HOST_CHECK(accu.charge_uah == -250, "charge %lld µAh", (long long)accu.charge_uah);
+	HOST_CHECK(accu.peak_ua == -250000, "peak %d µA", accu.peak_ua);
+	printf("Remainder: 3.6 million steps of 1 uA for 1 ms give 1 uAh, negative currents\n");
+}
+
+int main(void)
+{
+	test_profile(0.0, 0.01);
+	test_profile(0.2, 0.1);
+	test_remainder();
+	return host_result("test_ina_integrate");
+}
@@ -0,0 +1,213 @@
+/**
+ * @file test_thermal_analytics.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host test of the thermal frame analytics
+ *        Random and synthetic frames in the sizes of the RAK12040 (8 x 8)
+ *        and the RAK12052 (32 x 24). Checks the median against std::nth_element,
+ *        min/max/mean, the person count and the sub pixel hotspot location.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "thermal_analytics.cpp"
+#include <algorithm>
+#include <random>
+#include <vector>
+#include "host_stubs.h"
+
+static std::mt19937 rng(4711);
+
+/** Frame sizes of the supported modules */
+static const uint8_t sizes[2][2] = {{8, 8}, {32, 24}};
+
+/**
+ * @brief Random integer in a range
+ *
+ */
+static int32_t random_int(int32_t min, int32_t max)
+{
+	return std::uniform_int_distribution<int32_t>(min, max)(rng);
+}
+
+/**
+ * @brief Median, min, max and mean of random frames
+ *     Narrow value ranges give many duplicates, which are the hard case for the selection
+ *
+ */
+static void test_statistics(void)
+{
+	thermal_params_t params = {150, 2, true};
+	thermal_result_t result;
+	uint32_t num_frames = 0;
+	for (uint16_t frame_idx = 0; frame_idx < 2000; frame_idx++)
+	{
+		uint8_t width = sizes[frame_idx & 1][0];
+		uint8_t height = sizes[frame_idx & 1][1];
+		uint16_t num_pixels = width * height;
+		int32_t spread = (frame_idx % 4 < 2) ? 20 : 4000;
+		int32_t base = random_int(-2000, 4000);
+		std::vector<int16_t> frame(num_pixels);
+		for (int16_t &pixel : frame)
+		{
+			pixel = (int16_t)(base + random_int(0, spread));
+		}
+
+		HOST_CHECK(thermal_analyze(frame.data(), width, height, &params, &result), "analyze failed");
+		std::vector<int16_t> sorted = frame;
+		std::nth_element(sorted.begin(), sorted.begin() + num_pixels / 2, sorted.end());
+		HOST_CHECK(result.background == sorted[num_pixels / 2], "frame %d median %d expected %d", frame_idx, result.background, sorted[num_pixels / 2]);
+
+		int32_t sum = 0;
+		for (int16_t pixel : frame)
+		{
+			sum += pixel;
+		}
+		HOST_CHECK(result.min == *std::min_element(frame.begin(), frame.end()), "frame %d min", frame_idx);
+		HOST_CHECK(result.max == *std::max_element(frame.begin(), frame.end()), "frame %d max", frame_idx);
+		HOST_CHECK(result.mean == (int16_t)(sum / num_pixels), "frame %d mean", frame_idx);
+		num_frames++;
+	}
+	printf("Statistics: %u random frames, median matches nth_element\n", num_frames);
+}
+
+/**
+ * @brief Person count with rectangular warm blobs on a noisy background
+ *     Blobs are separated by at least one background pixel, blobs smaller
+ *     than min_blob must not be counted
+ *
+ */
+static void test_persons(void)
+{
+	thermal_params_t params = {150, 4, true};
+	thermal_result_t result;
+	uint32_t num_frames = 0;
+	for (uint16_t frame_idx = 0; frame_idx < 2000; frame_idx++)
+	{
+		uint8_t width = sizes[frame_idx & 1][0];
+		uint8_t height = sizes[frame_idx & 1][1];
+		std::vector<int16_t> frame(width * height);
+		for (int16_t &pixel : frame)
+		{
+			pixel = (int16_t)(2200 + random_int(-30, 30));
+		}
+
+		// Place blobs on a grid of cells so they never touch
+		uint8_t cell = width == 8 ? 4 : 6;
+		uint8_t expected = 0;
+		for (uint8_t cell_y = 0; cell_y + cell <= height; cell_y += cell)
+		{
+			for (uint8_t cell_x = 0; cell_x + cell <= width; cell_x += cell)
+			{
+				if (random_int(0, 2) == 0)
+				{
+					continue;
+				}
+				uint8_t blob_w = (uint8_t)random_int(1, cell - 1);
+				uint8_t blob_h = (uint8_t)random_int(1, cell - 1);
+				if (blob_w * blob_h >= params.min_blob)
+				{
+					expected++;
+				}
+				for (uint8_t y = 0; y < blob_h; y++)
+				{
+					for (uint8_t x = 0; x < blob_w; x++)
+					{
+						frame[(cell_y + y) * width + cell_x + x] = (int16_t)(3300 + random_int(-100, 300));
+					}
+				}
+			}
+		}
+
+		thermal_analyze(frame.data(), width, height, &params, &result);
+		HOST_CHECK(result.persons == expected, "frame %d %dx%d persons %d expected %d", frame_idx, width, height, result.persons, expected);
+		num_frames++;
+	}
+	printf("Persons: %u frames, blob count correct\n", num_frames);
+}
+
+/**
+ * @brief Hotspot location of a blurred point source at a random sub pixel position
+ *     The blur of a thermal sensor is about one pixel wide. The location has to be
+ *     within one sub pixel step (1/THERMAL_SUBPIXEL), the warmest pixel alone is off
+ *     by up to half a pixel per axis
+ *
+ */
+static void test_hotspot(void)
+{
+	thermal_params_t params = {150, 2, true};
+	thermal_params_t no_subpixel = {150, 2, false};
+	thermal_result_t result;
+	for (uint8_t size = 0; size < 2; size++)
+	{
+		uint8_t width = sizes[size][0];
+		uint8_t height = sizes[size][1];
+		double max_error = 0.0;
+		double sum_error = 0.0;
+		double sum_error_pixel = 0.0;
+		const uint16_t num_frames = 2000;
+		for (uint16_t frame_idx = 0; frame_idx < num_frames; frame_idx++)
+		{
+			// Keep the source one pixel away from the border, there the fit has no neighbour
+			double src_x = std::uniform_real_distribution<double>(1.0, width - 2.0)(rng);
+			double src_y = std::uniform_real_distribution<double>(1.0, height - 2.0)(rng);
+			std::vector<int16_t> frame(width * height);
+			for (uint8_t y = 0; y < height; y++)
+			{
+				for (uint8_t x = 0; x < width; x++)
+				{
+					double dist2 = (x - src_x) * (x - src_x) + (y - src_y) * (y - src_y);
+					frame[y * width + x] = (int16_t)(2200 + 1500 * exp(-dist2 / 2.0));
+				}
+			}
+			thermal_analyze(frame.data(), width, height, &params, &result);
+			double error_x = fabs((double)result.hot_x / THERMAL_SUBPIXEL - src_x);
+			double error_y = fabs((double)result.hot_y / THERMAL_SUBPIXEL - src_y);
+			double error = error_x > error_y ? error_x : error_y;
+			max_error = error > max_error ? error : max_error;
+			sum_error += error;
+
+			thermal_analyze(frame.data(), width, height, &no_subpixel, &result);
+			error_x = fabs((double)result.hot_x / THERMAL_SUBPIXEL - src_x);
+			error_y = fabs((double)result.hot_y / THERMAL_SUBPIXEL - src_y);
+			sum_error_pixel += error_x > error_y ? error_x : error_y;
+		}
+		printf("Hotspot %dx%d: max error %.3f pixel, mean %.3f pixel, without sub pixel fit mean %.3f pixel\n",
+			   width, height, max_error, sum_error / num_frames, sum_error_pixel / num_frames);
+		HOST_CHECK(max_error <= 1.0 / THERMAL_SUBPIXEL, "%dx%d hotspot error %.3f pixel", width, height, max_error);
+		HOST_CHECK(sum_error < sum_error_pixel, "%dx%d sub pixel fit not better than the pixel", width, height);
+	}
+}
+
+/**
+ * @brief Analytics time per frame
+ *
+ */
+static void test_speed(void)
+{
+	thermal_params_t params = {150, 4, true};
+	thermal_result_t result;
+	std::vector<int16_t> frame(32 * 24);
+	for (int16_t &pixel : frame)
+	{
+		pixel = (int16_t)(2200 + random_int(-50, 600));
+	}
+	const uint32_t num_runs = 20000;
+	double start = host_seconds();
+	for (uint32_t run = 0; run < num_runs; run++)
+	{
+		frame[run % frame.size()] ^= 1;
+		thermal_analyze(frame.data(), 32, 24, &params, &result);
+	}
+	printf("Speed: %.2f us per 32x24 frame (host CPU)\n", (host_seconds() - start) * 1e6 / num_runs);
+}
+
+int main(void)
+{
+	test_statistics();
+	test_persons();
+	test_hotspot();
+	test_speed();
+	return host_result("test_thermal_analytics");
+}
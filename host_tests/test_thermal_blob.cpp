@@ -0,0 +1,288 @@
+/**
+ * @file test_thermal_blob.cpp
+ * @author Bernd Giesecke (bernd@giesecke.tk)
+ * @brief Host test and benchmark of the RAK12052 frame blob
+ *        Synthetic 32 x 24 frames with persons and heaters go through
+ *        read_rak12052(), the blob is decoded and compared with the frame.
+ *        Checks the blob size, the grid quantization error, the hotspots and
+ *        histogram and the blob interval.
+ * @version 0.1
+ * @date 2026-10-19
+ *
+ * @copyright Copyright (c) 2026
+ *
+ */
+#include "RAK12052_temp_array.cpp"
+#include <random>
+#include <vector>
+#include "host_stubs.h"
+
+sensors_t found_sensors[64];
+WisCayenne g_solution_data(255);
+
+// The calibration parameters are not valid, read_rak12052() takes the frame from getFrame()
+int MLX90640_ExtractParameters(uint16_t *, paramsMLX90640 *) { return -1; }
+float MLX90640_GetTa(uint16_t *, const paramsMLX90640 *) { return 0.0f; }
+void MLX90640_CalculateTo(uint16_t *, const paramsMLX90640 *, float, float, float *) {}
+bool RAK_MLX90640::begin() { return true; }
+void RAK_MLX90640::setMode(mlx90640_mode_t) {}
+void RAK_MLX90640::setResolution(mlx90640_resolution_t) {}
+void RAK_MLX90640::setRefreshRate(mlx90640_refreshrate_t) {}
+
+/** Frame the fake sensor returns, in degree C */
+static float sim_frame[MLX_WIDTH * MLX_HEIGHT];
+
+int RAK_MLX90640::getFrame(float *frame)
+{
+	memcpy(frame, sim_frame, sizeof(sim_frame));
+	return 0;
+}
+
+TwoWire Wire;
+void TwoWire::begin() {}
+void TwoWire::setClock(uint32_t) {}
+void TwoWire::beginTransmission(uint8_t) {}
+uint8_t TwoWire::endTransmission(bool) { return 2; }
+uint8_t TwoWire::requestFrom(uint8_t, uint8_t, uint8_t) { return 0; }
+size_t TwoWire::write(uint8_t) { return 1; }
+int TwoWire::read() { return 0; }
+
+static std::mt19937 rng(815);
+
+/**
+ * @brief Random value in a range
+ *
+ */
+static double random_real(double min, double max)
+{
+	return std::uniform_real_distribution<double>(min, max)(rng);
+}
+
+/**
+ * @brief Fill the simulated frame with a room, some persons and sometimes a heater
+ *
+ */
+static void sim_scene(void)
+{
+	double room = random_real(16.0, 26.0);
+	std::normal_distribution<double> noise(0.0, 0.15);
+	for (float &pixel : sim_frame)
+	{
+		pixel = (float)(room + noise(rng));
+	}
+	int persons = std::uniform_int_distribution<int>(0, 3)(rng);
+	int heaters = std::uniform_int_distribution<int>(0, 3)(rng) == 0 ? 1 : 0;
+	for (int source = 0; source < persons + heaters; source++)
+	{
+		bool heater = source >= persons;
+		double center_x = random_real(0.0, MLX_WIDTH - 1);
+		double center_y = random_real(0.0, MLX_HEIGHT - 1);
+		double size_x = heater ? random_real(1.0, 3.0) : random_real(1.5, 4.0);
+		double size_y = heater ? random_real(1.0, 3.0) : random_real(2.5, 6.0);
+		double temp = heater ? random_real(40.0, 120.0) : random_real(30.0, 35.0);
+		for (uint8_t y = 0; y < MLX_HEIGHT; y++)
+		{
+			for (uint8_t x = 0; x < MLX_WIDTH; x++)
+			{
+				double dx = (x - center_x) / size_x;
+				double dy = (y - center_y) / size_y;
+				double weight = exp(-(dx * dx + dy * dy));
+				float &pixel = sim_frame[y * MLX_WIDTH + x];
+				pixel = (float)(pixel + (temp - pixel) * weight);
+			}
+		}
+	}
+}
+
+/** Decoded blob */
+struct decoded_blob
+{
+	uint8_t flags;
+	int16_t base;
+	uint8_t step;
+	uint8_t persons;
+	uint8_t grid_width;
+	uint8_t grid_height;
+	std::vector<uint8_t> grid;
+	std::vector<uint8_t> spots;
+	std::vector<uint8_t> bins;
+};
+
+/**
+ * @brief Decode a blob like the network side would
+ *
+ * @return true blob is well formed
+ */
+static bool decode_blob(const uint8_t *blob, uint8_t size, decoded_blob &out)
+{
+	if (size < 5)
+	{
+		return false;
+	}
+	out.flags = blob[0] & 0x0F;
+	if ((blob[0] >> 4) != THERMAL_PACK_VERSION)
+	{
+		return false;
+	}
+	out.base = (int16_t)((blob[1] << 8) | blob[2]);
+	out.step = blob[3];
+	out.persons = blob[4];
+	uint16_t pos = 5;
+	if (out.flags & THERMAL_PACK_GRID)
+	{
+		out.grid_width = blob[pos] >> 4;
+		out.grid_height = blob[pos] & 0x0F;
+		uint16_t num_cells = out.grid_width * out.grid_height;
+		uint8_t level = blob[pos + 1];
+		out.grid.push_back(level);
+		uint32_t nibble = (pos + 2) * 2;
+		auto next_nibble = [&]()
+		{
+			uint8_t value = (nibble & 1) ? (blob[nibble / 2] & 0x0F) : (blob[nibble / 2] >> 4);
+			nibble++;
+			return value;
+		};
+		while (out.grid.size() < num_cells)
+		{
+			uint8_t code = next_nibble();
+			if (code == 0x08)
+			{
+				level = next_nibble() << 4;
+				level |= next_nibble();
+			}
+			else
+			{
+				level = (uint8_t)(level + ((code & 0x08) ? (int8_t)(code | 0xF0) : code));
+			}
+			out.grid.push_back(level);
+		}
+		pos = (nibble + 1) / 2;
+	}
+	if (out.flags & THERMAL_PACK_HOTSPOTS)
+	{
+		uint8_t count = blob[pos++];
+		out.spots.assign(&blob[pos], &blob[pos + count * 3]);
+		pos += count * 3;
+	}
+	if (out.flags & THERMAL_PACK_HISTOGRAM)
+	{
+		uint8_t count = blob[pos++];
+		out.bins.assign(&blob[pos], &blob[pos + count]);
+		pos += count;
+	}
+	return pos == size;
+}
+
+/**
+ * @brief Synthetic frames through read_rak12052(), decode and compare
+ *
+ */
+static void test_blobs(void)
+{
+	const uint16_t num_frames = 2000;
+	uint8_t max_size = 0;
+	uint16_t with_grid = 0;
+	double max_grid_error = 0.0;
+	double seconds = 0.0;
+
+	set_blob_rak12052(1);
+	for (uint16_t frame_idx = 0; frame_idx < num_frames; frame_idx++)
+	{
+		sim_scene();
+		double start = host_seconds();
+		read_rak12052();
+		uint8_t *blob;
+		uint8_t size = get_blob_rak12052(&blob);
+		seconds += host_seconds() - start;
+		g_solution_data.reset();
+
+		HOST_CHECK((size != 0) && (size <= MLX_BLOB_MAX), "frame %d blob size %d", frame_idx, size);
+		max_size = size > max_size ? size : max_size;
+		decoded_blob decoded;
+		HOST_CHECK(decode_blob(blob, size, decoded), "frame %d blob not decodable", frame_idx);
+
+		// Grid levels against the averaged blocks, error from the quantization and the 0.1 degree rounding
+		if (decoded.flags & THERMAL_PACK_GRID)
+		{
+			with_grid++;
+			int16_t grid[(MLX_WIDTH / MLX_GRID_BLOCK) * (MLX_HEIGHT / MLX_GRID_BLOCK)];
+			thermal_downsample(mlx_frame, MLX_WIDTH, MLX_HEIGHT, MLX_GRID_BLOCK, grid);
+			HOST_CHECK(decoded.grid.size() == sizeof(grid) / sizeof(grid[0]), "frame %d grid cells %zu", frame_idx, decoded.grid.size());
+			for (size_t cell = 0; cell < decoded.grid.size(); cell++)
+			{
+				double decoded_temp = (decoded.base + decoded.grid[cell] * decoded.step) * 0.1;
+				double error = fabs(decoded_temp - grid[cell] * 0.01);
+				double limit = decoded.step * 0.05 + 0.05;
+				HOST_CHECK(error <= limit + 1e-9, "frame %d cell %zu error %.2f > %.2f", frame_idx, cell, error, limit);
+				double rel_error = error / (decoded.step * 0.1);
+				max_grid_error = rel_error > max_grid_error ? rel_error : max_grid_error;
+			}
+		}
+
+		// Hotspots are inside the frame and sorted
+		for (size_t spot = 0; spot + 3 <= decoded.spots.size(); spot += 3)
+		{
+			uint16_t pos = (decoded.spots[spot] << 8) | decoded.spots[spot + 1];
+			HOST_CHECK(((pos >> 5) < MLX_WIDTH) && ((pos & 0x1F) < MLX_HEIGHT), "frame %d hotspot outside", frame_idx);
+			HOST_CHECK((spot == 0) || (decoded.spots[spot + 2] <= decoded.spots[spot - 1]), "frame %d hotspots not sorted", frame_idx);
+		}
+
+		// Histogram shares add up to 255 within the rounding of the bins
+		int32_t sum = 0;
+		for (uint8_t bin : decoded.bins)
+		{
+			sum += bin;
+		}
+		HOST_CHECK(decoded.bins.empty() || (abs(sum - 255) <= (int32_t)decoded.bins.size()), "frame %d histogram sum %d", frame_idx, sum);
+	}
+	printf("Blobs: %d frames, max %d bytes, %d with grid, max grid error %.2f step including the 0.1 degree rounding, %.1f us per frame (host CPU)\n",
+		   num_frames, max_size, with_grid, max_grid_error, seconds * 1e6 / num_frames);
+}
+
+/**
+ * @brief A blob only every n'th uplink, a blob that was not taken is kept
+ *
+ */
+static void test_interval(void)
+{
+	uint8_t *blob;
+	sim_scene();
+
+	HOST_CHECK(!set_blob_rak12052(MLX_BLOB_INTERVAL_MAX + 1), "interval above the maximum accepted");
+	HOST_CHECK(set_blob_rak12052(3), "interval 3 not accepted");
+	uint8_t sent = 0;
+	for (uint8_t uplink = 1; uplink <= 9; uplink++)
+	{
+		read_rak12052();
+		uint8_t size = get_blob_rak12052(&blob);
+		HOST_CHECK((size != 0) == (uplink % 3 == 0), "interval 3, uplink %d blob %d bytes", uplink, size);
+		sent += size != 0 ? 1 : 0;
+	}
+	HOST_CHECK(sent == 3, "interval 3, %d blobs in 9 uplinks", sent);
+
+	// Fragments pending on the 3rd uplink, the app does not take the blob. The next uplink has one
+	set_blob_rak12052(3);
+	read_rak12052();
+	read_rak12052();
+	read_rak12052();
+	read_rak12052();
+	HOST_CHECK(get_blob_rak12052(&blob) != 0, "blob lost after a skipped uplink");
+	read_rak12052();
+	HOST_CHECK(get_blob_rak12052(&blob) == 0, "blob right after the sent one");
+
+	set_blob_rak12052(0);
+	for (uint8_t uplink = 0; uplink < 10; uplink++)
+	{
+		read_rak12052();
+		HOST_CHECK(get_blob_rak12052(&blob) == 0, "blob with interval 0");
+	}
+	g_solution_data.reset();
+	printf("Interval: blob every 3rd uplink, kept while not sent, off with 0\n");
+}
+
+int main(void)
+{
+	test_blobs();
+	test_interval();
+	return host_result("test_thermal_blob");
+}